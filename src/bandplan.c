@@ -0,0 +1,163 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Regional FM band plans and channel index conversion tables.                   *
+ *                                                                               *
+ * Frequencies, labels and channel lookups are computed once when the plans are  *
+ * set up, so tuning, scanning and the UI work with integer channel indexes.     *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "bandplan.h"
+
+static BandPlan bandPlans[BP_COUNT] =
+{
+    {BP_EUROPE_US, "eu", 87500, 108000, 100, 200},
+    {BP_JAPAN, "jp", 76000, 95000, 100, 100},
+    {BP_OIRT, "oirt", 65000, 74000, 50, 50},
+    {BP_WIDE, "wide", 60000, 108000, 50, 200}
+};
+
+static BandPlan *activePlan = &bandPlans[DEFAULT_BAND_PLAN];
+
+void band_plan_init()
+{
+    BandPlan *plan;
+    uint32_t frequencyKHz;
+    uint8_t planPos;
+    uint16_t channel;
+
+    for(planPos = 0; planPos < BP_COUNT; planPos++)
+    {
+        plan = &bandPlans[planPos];
+        if(plan->frequencies != NULL)
+        {
+            continue;
+        }
+
+        plan->channelCount = (uint16_t)(((plan->endKHz - plan->startKHz) / plan->stepKHz) + 1);
+        plan->frequencies = g_new(double, plan->channelCount);
+        plan->labels = g_malloc(plan->channelCount * BAND_PLAN_LABEL_SIZE);
+
+        for(channel = 0; channel < plan->channelCount; channel++)
+        {
+            frequencyKHz = band_plan_channel_khz(plan, channel);
+            plan->frequencies[channel] = frequencyKHz / 1000.0;
+            g_snprintf(plan->labels[channel], BAND_PLAN_LABEL_SIZE, "%u.%02u MHz", (frequencyKHz / 1000), ((frequencyKHz % 1000) / 10));
+        }
+    }
+}
+
+const BandPlan *band_plan_get()
+{
+    return (const BandPlan *)g_atomic_pointer_get(&activePlan);
+}
+
+const BandPlan *band_plan_select(BandPlanId planId)
+{
+    if(planId >= BP_COUNT)
+    {
+        return NULL;
+    }
+
+    // Tables of all plans are built up front, readers never see a half initialized plan.
+    g_atomic_pointer_set(&activePlan, &bandPlans[planId]);
+    return &bandPlans[planId];
+}
+
+const BandPlan *band_plan_find(const char *name)
+{
+    uint8_t planPos;
+
+    for(planPos = 0; planPos < BP_COUNT; planPos++)
+    {
+        if(g_ascii_strcasecmp(bandPlans[planPos].name, name) == 0)
+        {
+            return &bandPlans[planPos];
+        }
+    }
+
+    return NULL;
+}
+
+uint16_t band_plan_get_scan_step(const BandPlan *plan)
+{
+    return (uint16_t)g_atomic_int_get(&plan->scanStepKHz);
+}
+
+uint8_t band_plan_set_scan_step(const BandPlan *plan, uint16_t stepKHz)
+{
+    // The tuner supports 50, 100 and 200 kHz seek steps, the step must land on channels of the plan.
+    if(((stepKHz != 50) && (stepKHz != 100) && (stepKHz != BAND_PLAN_MAX_SCAN_STEP)) || ((stepKHz % plan->stepKHz) != 0))
+    {
+        return RESULT_FAIL;
+    }
+
+    g_atomic_int_set(&bandPlans[plan->id].scanStepKHz, stepKHz);
+    return RESULT_SUCCESS;
+}
+
+int32_t band_plan_khz_to_channel(const BandPlan *plan, uint32_t frequencyKHz)
+{
+    uint32_t halfStep = plan->stepKHz / 2;
+
+    // Frequencies within half a step of the band edges still belong to the first/last channel.
+    if(((frequencyKHz + halfStep) < plan->startKHz) || (frequencyKHz > (plan->endKHz + halfStep)))
+    {
+        return BAND_PLAN_NO_CHANNEL;
+    }
+
+    if(frequencyKHz <= plan->startKHz)
+    {
+        return 0;
+    }
+
+    return MIN((int32_t)((frequencyKHz - plan->startKHz + halfStep) / plan->stepKHz), (int32_t)band_plan_last_channel(plan));
+}
+
+int32_t band_plan_khz_to_exact_channel(const BandPlan *plan, uint32_t frequencyKHz)
+{
+    // Tuned frequency is reported as a channel only if it sits on the raster of the plan.
+    if((frequencyKHz < plan->startKHz) || (frequencyKHz > plan->endKHz) || (((frequencyKHz - plan->startKHz) % plan->stepKHz) != 0))
+    {
+        return BAND_PLAN_NO_CHANNEL;
+    }
+
+    return (int32_t)((frequencyKHz - plan->startKHz) / plan->stepKHz);
+}
+
+int32_t band_plan_mhz_to_channel(const BandPlan *plan, double frequency)
+{
+    // User input is rounded to the nearest kHz instead of truncated.
+    if(frequency <= 0)
+    {
+        return BAND_PLAN_NO_CHANNEL;
+    }
+
+    return band_plan_khz_to_channel(plan, (uint32_t)((frequency * 1000) + 0.5));
+}
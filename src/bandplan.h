@@ -0,0 +1,93 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Regional FM band plans and channel index conversion tables.                   *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_BANDPLAN_HEADER_
+#define _GTK_FM_TUNER_BANDPLAN_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+// Largest channel count of all band plans (wide band, 60 - 108 MHz in 50 kHz steps).
+#define BAND_PLAN_MAX_CHANNELS  961
+
+// Size of the precomputed channel label ("100.05 MHz").
+#define BAND_PLAN_LABEL_SIZE    12
+
+// Channel index value of frequencies outside the band plan (or unknown).
+#define BAND_PLAN_NO_CHANNEL    (-1)
+
+// Largest hardware seek step in kHz, user input above it is rejected before it is narrowed.
+#define BAND_PLAN_MAX_SCAN_STEP 200
+
+typedef enum
+{
+    BP_EUROPE_US,   // 87.5 - 108 MHz.
+    BP_JAPAN,       // 76 - 95 MHz.
+    BP_OIRT,        // 65 - 74 MHz.
+    BP_WIDE,        // 60 - 108 MHz.
+    BP_COUNT
+} BandPlanId;
+
+// Channel n of a band plan is at startKHz + (n * stepKHz).
+typedef struct BandPlan
+{
+    BandPlanId id;
+    const char *name;           // Name used on the command line and by the daemon.
+    uint32_t startKHz;
+    uint32_t endKHz;
+    uint16_t stepKHz;
+    volatile gint scanStepKHz;  // Hardware seek step (50, 100 or 200 kHz), changed at runtime.
+    uint16_t channelCount;
+    double *frequencies;        // Channel frequency in MHz, for the double based tuner functions.
+    char (*labels)[BAND_PLAN_LABEL_SIZE];
+} BandPlan;
+
+void band_plan_init(void);
+
+const BandPlan *band_plan_get(void);
+const BandPlan *band_plan_select(BandPlanId planId);
+const BandPlan *band_plan_find(const char *name);
+
+uint16_t band_plan_get_scan_step(const BandPlan *plan);
+uint8_t band_plan_set_scan_step(const BandPlan *plan, uint16_t stepKHz);
+
+int32_t band_plan_khz_to_channel(const BandPlan *plan, uint32_t frequencyKHz);
+int32_t band_plan_khz_to_exact_channel(const BandPlan *plan, uint32_t frequencyKHz);
+int32_t band_plan_mhz_to_channel(const BandPlan *plan, double frequency);
+
+static inline uint32_t band_plan_channel_khz(const BandPlan *plan, uint16_t channel)
+{
+    return plan->startKHz + ((uint32_t)channel * plan->stepKHz);
+}
+
+// Last channel of the band plan.
+static inline uint16_t band_plan_last_channel(const BandPlan *plan)
+{
+    return plan->channelCount - 1;
+}
+
+#endif /* _GTK_FM_TUNER_BANDPLAN_HEADER_ */
@@ -0,0 +1,385 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Band scope window, live RSSI/SNR plot of the whole FM band.                   *
+ * Plot is kept in a backing surface and only the columns measured since the     *
+ * previous frame are rendered and invalidated.                                  *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <gtk/gtk.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bandscope.h"
+#include "sweep.h"
+
+// Plot colors (0xRRGGBB).
+#define COLOR_BACKGROUND    0x2E3436
+#define COLOR_GRID          0x555753
+#define COLOR_TEXT          0xD3D7CF
+#define COLOR_RSSI          0x73D216
+#define COLOR_SNR           0x729FCF
+
+// RSSI grid line interval in dBuV.
+#define SCOPE_GRID_STEP     20
+
+// Frequency axis label interval in MHz.
+#define SCOPE_LABEL_STEP    4
+
+BandScopeWindow bandScope;
+
+static void set_color(cairo_t *cr, uint32_t color)
+{
+    cairo_set_source_rgb(cr, ((color >> 16) & 0xFF) / 255.0, ((color >> 8) & 0xFF) / 255.0, (color & 0xFF) / 255.0);
+}
+
+static int scope_plot_height()
+{
+    return bandScope.height - BAND_SCOPE_AXIS_HEIGHT;
+}
+
+static int scope_value_height(int16_t value, int plotHeight)
+{
+    if(value <= 0)
+    {
+        return 0;
+    }
+
+    return (value >= BAND_SCOPE_RSSI_SCALE) ? plotHeight : ((value * plotHeight) / BAND_SCOPE_RSSI_SCALE);
+}
+
+static int scope_column_x(uint16_t index, gint pointCount)
+{
+    return (index * bandScope.width) / pointCount;
+}
+
+static void render_column(cairo_t *cr, uint16_t index, gint pointCount)
+{
+    int plotHeight = scope_plot_height();
+    int columnX = scope_column_x(index, pointCount);
+    int columnWidth = MAX(scope_column_x(index + 1, pointCount) - columnX, 1);
+    int barHeight, gridValue;
+    int16_t rssi, snr;
+
+    sweep_get_point(index, &rssi, &snr);
+
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_rectangle(cr, columnX, 0, columnWidth, plotHeight);
+    cairo_fill(cr);
+
+    // Segments of the horizontal RSSI grid lines which belong to this column.
+    set_color(cr, COLOR_GRID);
+    for(gridValue = SCOPE_GRID_STEP; gridValue < BAND_SCOPE_RSSI_SCALE; gridValue += SCOPE_GRID_STEP)
+    {
+        cairo_rectangle(cr, columnX, plotHeight - scope_value_height(gridValue, plotHeight), columnWidth, 1);
+    }
+    cairo_fill(cr);
+
+    // Channel was not measured, leave it empty.
+    if(rssi == SWEEP_POINT_INVALID)
+    {
+        return;
+    }
+
+    barHeight = scope_value_height(rssi, plotHeight);
+    set_color(cr, COLOR_RSSI);
+    cairo_rectangle(cr, columnX, plotHeight - barHeight, columnWidth, barHeight);
+    cairo_fill(cr);
+
+    set_color(cr, COLOR_SNR);
+    cairo_rectangle(cr, columnX, MAX(plotHeight - scope_value_height(snr, plotHeight) - 2, 0), columnWidth, 2);
+    cairo_fill(cr);
+}
+
+static void render_axis(cairo_t *cr)
+{
+    char labelText[8];
+    cairo_text_extents_t extents;
+    int plotHeight = scope_plot_height();
+    const BandPlan *plan = band_plan_get();
+    double lowFreq = plan->frequencies[0];
+    double highFreq = plan->frequencies[band_plan_last_channel(plan)];
+    int freq;
+    double labelX;
+
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_rectangle(cr, 0, plotHeight, bandScope.width, BAND_SCOPE_AXIS_HEIGHT);
+    cairo_fill(cr);
+
+    set_color(cr, COLOR_TEXT);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 9);
+
+    for(freq = (int)ceil(lowFreq / SCOPE_LABEL_STEP) * SCOPE_LABEL_STEP; freq <= highFreq; freq += SCOPE_LABEL_STEP)
+    {
+        sprintf(labelText, "%d", freq);
+        cairo_text_extents(cr, labelText, &extents);
+
+        // Center the label on its frequency and keep it inside the plot.
+        labelX = ((freq - lowFreq) * bandScope.width) / (highFreq - lowFreq) - (extents.width / 2);
+        labelX = CLAMP(labelX, 0, bandScope.width - extents.width);
+
+        cairo_move_to(cr, labelX, bandScope.height - 3);
+        cairo_show_text(cr, labelText);
+    }
+}
+
+static void render_band_scope()
+{
+    cairo_t *cr;
+    uint16_t index;
+
+    cr = cairo_create(bandScope.backingSurface);
+
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_paint(cr);
+    render_axis(cr);
+
+    // Show whatever the sweep engine has measured so far.
+    for(index = 0; index < bandScope.lastPointCount; index++)
+    {
+        render_column(cr, index, bandScope.lastPointCount);
+    }
+
+    cairo_destroy(cr);
+}
+
+static void render_new_columns(uint16_t firstIndex, uint16_t endIndex)
+{
+    cairo_t *cr;
+    uint16_t index;
+    int startX, endX;
+
+    if(firstIndex >= endIndex)
+    {
+        return;
+    }
+
+    cr = cairo_create(bandScope.backingSurface);
+    for(index = firstIndex; index < endIndex; index++)
+    {
+        render_column(cr, index, bandScope.lastPointCount);
+    }
+    cairo_destroy(cr);
+
+    startX = scope_column_x(firstIndex, bandScope.lastPointCount);
+    endX = MAX(scope_column_x(endIndex, bandScope.lastPointCount), startX + 1);
+    gtk_widget_queue_draw_area(bandScope.plot, startX, 0, endX - startX, scope_plot_height());
+}
+
+static void update_scope_info(gint64 frameTime)
+{
+    char infoText[48];
+
+    if(bandScope.sweepStartTime > 0)
+    {
+        sprintf(infoText, "Settle %d ms, sweep %.1lf s", sweep_get_settle_time(), (frameTime - bandScope.sweepStartTime) / (double)G_USEC_PER_SEC);
+        gtk_label_set_text(bandScope.infoLabel, infoText);
+    }
+
+    bandScope.sweepStartTime = frameTime;
+}
+
+static gboolean on_band_scope_tick(GtkWidget *widget, GdkFrameClock *frameClock, gpointer userData)
+{
+    uint16_t sequence, position;
+    gint pointCount;
+
+    // Tune or seek command took the tuner over, the sweep has ended without returning to the old station.
+    if(sweep_get_abort_count() != bandScope.abortCount)
+    {
+        bandScope.tickId = 0;
+        gtk_toggle_button_set_active(bandScope.runButton, FALSE);
+        gtk_label_set_text(bandScope.infoLabel, "Sweep stopped by tuning");
+
+        return G_SOURCE_REMOVE;
+    }
+
+    pointCount = sweep_get_progress(&sequence, &position);
+    if((bandScope.backingSurface == NULL) || (pointCount == 0))
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    // Channel count has changed (new step size), start a clean plot.
+    if(pointCount != bandScope.lastPointCount)
+    {
+        bandScope.lastPointCount = pointCount;
+        bandScope.lastSequence = sequence;
+        bandScope.lastPosition = 0;
+        bandScope.sweepStartTime = 0;
+
+        render_band_scope();
+        gtk_widget_queue_draw(bandScope.plot);
+    }
+
+    if(sequence != bandScope.lastSequence)
+    {
+        // Finish the columns of the previous sweep before starting the new one.
+        render_new_columns(bandScope.lastPosition, pointCount);
+        update_scope_info(gdk_frame_clock_get_frame_time(frameClock));
+
+        bandScope.lastSequence = sequence;
+        bandScope.lastPosition = 0;
+    }
+
+    render_new_columns(bandScope.lastPosition, position);
+    bandScope.lastPosition = position;
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_band_scope_configure(GtkWidget *widget, GdkEventConfigure *event, gpointer userData)
+{
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+
+    if((bandScope.backingSurface != NULL) && (width == bandScope.width) && (height == bandScope.height))
+    {
+        return TRUE;
+    }
+
+    if(bandScope.backingSurface != NULL)
+    {
+        cairo_surface_destroy(bandScope.backingSurface);
+    }
+
+    bandScope.width = width;
+    bandScope.height = height;
+    bandScope.backingSurface = gdk_window_create_similar_surface(gtk_widget_get_window(widget), CAIRO_CONTENT_COLOR, width, height);
+
+    render_band_scope();
+    return TRUE;
+}
+
+static gboolean on_band_scope_draw(GtkWidget *widget, cairo_t *cr, gpointer userData)
+{
+    if(bandScope.backingSurface != NULL)
+    {
+        cairo_set_source_surface(cr, bandScope.backingSurface, 0, 0);
+        cairo_paint(cr);
+    }
+
+    return FALSE;
+}
+
+static void set_band_scope_running(gboolean running)
+{
+    if(running)
+    {
+        bandScope.abortCount = sweep_get_abort_count();
+        sweep_start(bandScope.stepKHz);
+
+        if(bandScope.tickId == 0)
+        {
+            bandScope.tickId = gtk_widget_add_tick_callback(bandScope.plot, on_band_scope_tick, NULL, NULL);
+        }
+    }
+    else
+    {
+        sweep_stop();
+
+        if(bandScope.tickId != 0)
+        {
+            gtk_widget_remove_tick_callback(bandScope.plot, bandScope.tickId);
+            bandScope.tickId = 0;
+        }
+    }
+}
+
+static uint8_t create_band_scope_window()
+{
+    GtkBuilder *builder;
+    gchar *objectIds[] = {"band-scope", NULL};
+
+    // Load only the band scope window from the UI resource.
+    builder = gtk_builder_new();
+    if(gtk_builder_add_objects_from_resource(builder, UI_RESOURCE_PATH, objectIds, NULL) == 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to load band scope from UI resource");
+#endif
+        g_object_unref(builder);
+        return RESULT_FAIL;
+    }
+
+    bandScope.window = GTK_WIDGET(gtk_builder_get_object(builder, "band-scope"));
+    bandScope.plot = GTK_WIDGET(gtk_builder_get_object(builder, "drwBandScope"));
+    bandScope.stepSelect = GTK_COMBO_BOX_TEXT(gtk_builder_get_object(builder, "cmbScopeStep"));
+    bandScope.runButton = GTK_TOGGLE_BUTTON(gtk_builder_get_object(builder, "btnScopeRun"));
+    bandScope.infoLabel = GTK_LABEL(gtk_builder_get_object(builder, "lblScopeInfo"));
+
+    bandScope.backingSurface = NULL;
+    bandScope.tickId = 0;
+    bandScope.stepKHz = (uint16_t)atoi(gtk_combo_box_get_active_id(GTK_COMBO_BOX(bandScope.stepSelect)));
+    bandScope.lastPointCount = 0;
+
+    // Setup events and release builder.
+    gtk_builder_connect_signals(builder, NULL);
+    g_object_unref(builder);
+
+    g_signal_connect(bandScope.plot, "configure-event", G_CALLBACK(on_band_scope_configure), NULL);
+    g_signal_connect(bandScope.plot, "draw", G_CALLBACK(on_band_scope_draw), NULL);
+
+    gtk_window_set_title(GTK_WINDOW(bandScope.window), "Band Scope");
+
+    return RESULT_SUCCESS;
+}
+
+void show_band_scope_window(GtkWidget *parent)
+{
+    // Band scope window is created on first use and reused afterwards.
+    if((bandScope.window == NULL) && (create_band_scope_window() == RESULT_FAIL))
+    {
+        return;
+    }
+
+    gtk_window_set_transient_for(GTK_WINDOW(bandScope.window), GTK_WINDOW(parent));
+    gtk_window_present(GTK_WINDOW(bandScope.window));
+}
+
+void on_btnScopeRun_toggled(GtkToggleButton *button, gpointer userData)
+{
+    set_band_scope_running(gtk_toggle_button_get_active(button));
+}
+
+void on_cmbScopeStep_changed(GtkComboBox *comboBox, gpointer userData)
+{
+    bandScope.stepKHz = (uint16_t)atoi(gtk_combo_box_get_active_id(comboBox));
+
+    // Running sweep restarts with the new step.
+    if(bandScope.tickId != 0)
+    {
+        sweep_start(bandScope.stepKHz);
+    }
+}
+
+gboolean on_band_scope_delete_event(GtkWidget *widget, GdkEvent *event, gpointer userData)
+{
+    // Closing the window stops the sweep and returns to the previous station.
+    gtk_toggle_button_set_active(bandScope.runButton, FALSE);
+    gtk_widget_hide(widget);
+
+    return TRUE;
+}
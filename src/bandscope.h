@@ -0,0 +1,66 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Band scope window, live RSSI/SNR plot of the whole FM band.                   *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_BANDSCOPE_HEADER_
+#define _GTK_FM_TUNER_BANDSCOPE_HEADER_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+#include "defmain.h"
+#include "defconfig.h"
+
+// Height of the frequency axis below the plot in pixels.
+#define BAND_SCOPE_AXIS_HEIGHT  14
+
+// Full scale RSSI value (dBuV) of the plot.
+#define BAND_SCOPE_RSSI_SCALE   90
+
+typedef struct BandScopeWindow
+{
+    GtkWidget *window;
+    GtkWidget *plot;
+    GtkComboBoxText *stepSelect;
+    GtkToggleButton *runButton;
+    GtkLabel *infoLabel;
+
+    cairo_surface_t *backingSurface;
+    int width;
+    int height;
+    guint tickId;
+    uint16_t stepKHz;
+    gint abortCount;                // Sweep abort count when the sweep was started.
+
+    uint16_t lastSequence;
+    uint16_t lastPosition;
+    gint lastPointCount;
+    gint64 sweepStartTime;
+} BandScopeWindow;
+
+void show_band_scope_window(GtkWidget *parent);
+
+#endif /* _GTK_FM_TUNER_BANDSCOPE_HEADER_ */
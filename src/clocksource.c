@@ -0,0 +1,376 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Time source of the tuner: real monotonic clock or a deterministic virtual     *
+ * clock for simulations.                                                        *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <unistd.h>
+
+#include "defconfig.h"
+#include "clocksource.h"
+
+volatile gint clockSourceVirtual = 0;
+
+static VirtualClock virtualClock;
+static __thread ClockWaiter threadWaiter;
+static __thread ClockWaiter *boundWaiter;
+
+static void clock_source_set_state(ClockWaiter *waiter, ClockWaiterState state)
+{
+    // Caller must hold the clock lock, only attached participants count towards the quorum.
+    if(waiter->attached && ((waiter->state == CW_RUNNING) != (state == CW_RUNNING)))
+    {
+        if(state == CW_RUNNING)
+        {
+            virtualClock.blockedCount--;
+        }
+        else
+        {
+            virtualClock.blockedCount++;
+        }
+    }
+
+    waiter->state = state;
+}
+
+static void clock_source_post_locked(ClockWaiter *waiter, guint64 count)
+{
+    waiter->pending += count;
+
+    // Participant runs from now on, even before it receives the event.
+    if(waiter->state == CW_WAITING)
+    {
+        clock_source_set_state(waiter, CW_RUNNING);
+    }
+}
+
+static void clock_source_insert_alarm(ClockAlarm *alarm)
+{
+    ClockAlarm **insertPos = &virtualClock.alarms;
+
+    // Alarms with the same expiry time fire in the order they were armed.
+    while((*insertPos != NULL) && ((*insertPos)->wakeupTime <= alarm->wakeupTime))
+    {
+        insertPos = &(*insertPos)->next;
+    }
+
+    alarm->next = *insertPos;
+    *insertPos = alarm;
+}
+
+static void clock_source_remove_alarm(ClockAlarm *alarm)
+{
+    ClockAlarm **alarmPos = &virtualClock.alarms;
+
+    while(*alarmPos != NULL)
+    {
+        if(*alarmPos == alarm)
+        {
+            *alarmPos = alarm->next;
+            break;
+        }
+
+        alarmPos = &(*alarmPos)->next;
+    }
+
+    alarm->next = NULL;
+}
+
+static void clock_source_fire_alarm(ClockAlarm *alarm)
+{
+    guint64 expirations;
+
+    // Same count a timerfd read returns, periods missed by clock_source_advance are included.
+    expirations = 1 + (guint64)((virtualClock.currentTime - alarm->wakeupTime) / alarm->interval);
+
+    clock_source_remove_alarm(alarm);
+    alarm->wakeupTime += (gint64)expirations * alarm->interval;
+    clock_source_insert_alarm(alarm);
+
+    clock_source_post_locked(alarm->waiter, expirations);
+    if(write(alarm->handle, &expirations, sizeof(expirations)) != sizeof(expirations))
+    {
+        // Counter is saturated, the event loop is already scheduled to wake up.
+    }
+}
+
+static void clock_source_wake_due(gboolean wakeAll)
+{
+    ClockSleeper *sleeper;
+
+    // Caller must hold the clock lock.
+    while((virtualClock.sleepers != NULL) && (wakeAll || (virtualClock.sleepers->wakeupTime <= virtualClock.currentTime)))
+    {
+        sleeper = virtualClock.sleepers;
+        virtualClock.sleepers = sleeper->next;
+        sleeper->woken = TRUE;
+
+        // Woken thread is running from now on, even before it gets the lock back.
+        if(sleeper->waiter != NULL)
+        {
+            clock_source_set_state(sleeper->waiter, CW_RUNNING);
+        }
+    }
+
+    while((!wakeAll) && (virtualClock.alarms != NULL) && (virtualClock.alarms->wakeupTime <= virtualClock.currentTime))
+    {
+        clock_source_fire_alarm(virtualClock.alarms);
+    }
+
+    g_cond_broadcast(&virtualClock.clockSignal);
+}
+
+static gboolean clock_source_next_wakeup(gint64 *wakeupTime)
+{
+    if((virtualClock.sleepers == NULL) && (virtualClock.alarms == NULL))
+    {
+        return FALSE;
+    }
+
+    if(virtualClock.sleepers == NULL)
+    {
+        *wakeupTime = virtualClock.alarms->wakeupTime;
+    }
+    else if(virtualClock.alarms == NULL)
+    {
+        *wakeupTime = virtualClock.sleepers->wakeupTime;
+    }
+    else
+    {
+        *wakeupTime = MIN(virtualClock.sleepers->wakeupTime, virtualClock.alarms->wakeupTime);
+    }
+
+    return TRUE;
+}
+
+static void clock_source_try_jump()
+{
+    gint64 wakeupTime;
+
+    // No participant can run, so nothing can happen before the earliest wakeup. Threads which are not
+    // attached do not hold the clock, jumps go on until an attached participant is woken.
+    while((virtualClock.blockedCount >= virtualClock.attachedCount) && clock_source_next_wakeup(&wakeupTime))
+    {
+        virtualClock.currentTime = MAX(virtualClock.currentTime, wakeupTime);
+        virtualClock.jumpCount++;
+        clock_source_wake_due(FALSE);
+    }
+}
+
+void clock_source_set_virtual(gboolean isVirtual)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    // Virtual time continues from the real clock, so time stamps keep their usual range.
+    if(isVirtual && (!g_atomic_int_get(&clockSourceVirtual)))
+    {
+        virtualClock.currentTime = g_get_monotonic_time();
+    }
+
+    g_atomic_int_set(&clockSourceVirtual, (isVirtual ? 1 : 0));
+
+    // Threads still waiting on the virtual clock are released when it is turned off.
+    if(!isVirtual)
+    {
+        clock_source_wake_due(TRUE);
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+gint64 clock_source_virtual_now()
+{
+    gint64 currentTime;
+
+    g_mutex_lock(&virtualClock.clockLock);
+    currentTime = virtualClock.currentTime;
+    g_mutex_unlock(&virtualClock.clockLock);
+
+    return currentTime;
+}
+
+void clock_source_virtual_sleep(guint64 intervalUs)
+{
+    ClockSleeper sleeper, **insertPos;
+
+    g_mutex_lock(&virtualClock.clockLock);
+
+    sleeper.wakeupTime = virtualClock.currentTime + (gint64)intervalUs;
+    sleeper.waiter = ((boundWaiter != NULL) && boundWaiter->attached) ? boundWaiter : NULL;
+    sleeper.woken = FALSE;
+
+    // Sleepers with the same wakeup time are woken in the order they went to sleep.
+    insertPos = &virtualClock.sleepers;
+    while((*insertPos != NULL) && ((*insertPos)->wakeupTime <= sleeper.wakeupTime))
+    {
+        insertPos = &(*insertPos)->next;
+    }
+
+    sleeper.next = *insertPos;
+    *insertPos = &sleeper;
+
+    if(sleeper.waiter != NULL)
+    {
+        clock_source_set_state(sleeper.waiter, CW_SLEEPING);
+    }
+
+    clock_source_try_jump();
+
+    while(!sleeper.woken)
+    {
+        g_cond_wait(&virtualClock.clockSignal, &virtualClock.clockLock);
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_attach(ClockWaiter *waiter)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    if(!waiter->attached)
+    {
+        waiter->attached = TRUE;
+        waiter->state = CW_RUNNING;
+        waiter->pending = 0;
+        virtualClock.attachedCount++;
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_detach(ClockWaiter *waiter)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    if(waiter->attached)
+    {
+        clock_source_set_state(waiter, CW_RUNNING);
+        waiter->attached = FALSE;
+        virtualClock.attachedCount--;
+
+        // Remaining participants may all be blocked already.
+        clock_source_try_jump();
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_attach_thread()
+{
+    boundWaiter = &threadWaiter;
+    clock_source_attach(&threadWaiter);
+}
+
+void clock_source_detach_thread()
+{
+    clock_source_detach(&threadWaiter);
+    boundWaiter = NULL;
+}
+
+void clock_source_bind_thread(ClockWaiter *waiter)
+{
+    boundWaiter = waiter;
+}
+
+void clock_source_block(ClockWaiter *waiter)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    // Events posted before the participant got here are still to be handled.
+    if(waiter->attached && (waiter->state == CW_RUNNING) && (waiter->pending == 0))
+    {
+        clock_source_set_state(waiter, CW_WAITING);
+        clock_source_try_jump();
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_unblock(ClockWaiter *waiter)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    if(waiter->state == CW_WAITING)
+    {
+        clock_source_set_state(waiter, CW_RUNNING);
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_post(ClockWaiter *waiter, guint64 count)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+    clock_source_post_locked(waiter, count);
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_consume(ClockWaiter *waiter, guint64 count)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+    waiter->pending -= MIN(count, waiter->pending);
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_set_alarm(ClockAlarm *alarm, guint64 intervalUs)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+
+    // Re-arming starts a new period from now, like timerfd_settime.
+    clock_source_remove_alarm(alarm);
+    alarm->interval = (gint64)intervalUs;
+
+    if(alarm->interval > 0)
+    {
+        alarm->wakeupTime = virtualClock.currentTime + alarm->interval;
+        clock_source_insert_alarm(alarm);
+
+        // Alarm may be armed from a thread which is not attached while all participants wait.
+        clock_source_try_jump();
+    }
+
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+void clock_source_advance(guint64 intervalUs)
+{
+    g_mutex_lock(&virtualClock.clockLock);
+    virtualClock.currentTime += (gint64)intervalUs;
+    clock_source_wake_due(FALSE);
+    g_mutex_unlock(&virtualClock.clockLock);
+}
+
+guint64 clock_source_get_jump_count()
+{
+    guint64 jumpCount;
+
+    g_mutex_lock(&virtualClock.clockLock);
+    jumpCount = virtualClock.jumpCount;
+    g_mutex_unlock(&virtualClock.clockLock);
+
+    return jumpCount;
+}
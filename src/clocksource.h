@@ -0,0 +1,143 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Time source of the tuner: real monotonic clock or a deterministic virtual     *
+ * clock for simulations.                                                        *
+ *                                                                               *
+ * Driver, worker threads and event loop timers get their time from here. The    *
+ * virtual clock only moves forward when none of its participants (attached      *
+ * threads and event loops) can run, it then jumps straight to the earliest      *
+ * wakeup or timer expiry. Simulated sessions run as fast as the code allows     *
+ * and give the same timing on every run.                                        *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_CLOCKSOURCE_HEADER_
+#define _GTK_FM_TUNER_CLOCKSOURCE_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+typedef enum
+{
+    CW_RUNNING,     // Participant can run, virtual time stands still.
+    CW_SLEEPING,    // Participant thread sleeps until a virtual wakeup time.
+    CW_WAITING      // Participant waits for a posted event (e.g. idle event loop).
+} ClockWaiterState;
+
+// Participant of the virtual clock, a thread or an event loop.
+typedef struct ClockWaiter
+{
+    gboolean attached;
+    ClockWaiterState state;
+    guint64 pending;            // Events posted to the participant and not consumed yet.
+} ClockWaiter;
+
+// Thread waiting for its wakeup time, queued in the order of the wakeup time.
+typedef struct ClockSleeper
+{
+    gint64 wakeupTime;
+    ClockWaiter *waiter;        // Participant blocked by the sleep, NULL for threads which are not attached.
+    gboolean woken;
+    struct ClockSleeper *next;
+} ClockSleeper;
+
+// Periodic virtual timer, it adds the number of elapsed periods to an eventfd like a timerfd read returns them.
+typedef struct ClockAlarm
+{
+    gint64 wakeupTime;
+    gint64 interval;            // Timer period in us, 0 while disarmed.
+    int handle;
+    ClockWaiter *waiter;        // Participant which consumes the expirations.
+    struct ClockAlarm *next;
+} ClockAlarm;
+
+typedef struct VirtualClock
+{
+    GMutex clockLock;
+    GCond clockSignal;
+    gint64 currentTime;         // Virtual CLOCK_MONOTONIC time in us.
+    guint attachedCount;
+    guint blockedCount;         // Attached participants which are sleeping or waiting.
+    ClockSleeper *sleepers;
+    ClockAlarm *alarms;         // Armed alarms in the order of the expiry time.
+    guint64 jumpCount;
+} VirtualClock;
+
+extern volatile gint clockSourceVirtual;
+
+gint64 clock_source_virtual_now(void);
+void clock_source_virtual_sleep(guint64 intervalUs);
+
+static inline gboolean clock_source_is_virtual(void)
+{
+    return G_UNLIKELY(g_atomic_int_get(&clockSourceVirtual));
+}
+
+// Current monotonic time in us.
+static inline gint64 clock_source_now(void)
+{
+    return clock_source_is_virtual() ? clock_source_virtual_now() : g_get_monotonic_time();
+}
+
+// Suspend the calling thread for the given time in us.
+static inline void clock_source_sleep(guint64 intervalUs)
+{
+    if(clock_source_is_virtual())
+    {
+        clock_source_virtual_sleep(intervalUs);
+    }
+    else
+    {
+        g_usleep(intervalUs);
+    }
+}
+
+// Switch to the virtual clock, must be called before any other thread uses the clock.
+void clock_source_set_virtual(gboolean isVirtual);
+
+// Participants are counted from attach to detach. The calling thread attaches itself before it starts
+// other participants, so time can not run ahead while they are being set up.
+void clock_source_attach(ClockWaiter *waiter);
+void clock_source_detach(ClockWaiter *waiter);
+void clock_source_attach_thread(void);
+void clock_source_detach_thread(void);
+
+// Sleeps of the calling thread block the given participant (e.g. event loop handlers which sleep).
+void clock_source_bind_thread(ClockWaiter *waiter);
+
+// Event accounting of waiting participants. A participant only waits while no posted event is pending,
+// posting wakes it before the event is signalled, so time can not move past an undelivered event.
+void clock_source_block(ClockWaiter *waiter);
+void clock_source_unblock(ClockWaiter *waiter);
+void clock_source_post(ClockWaiter *waiter, guint64 count);
+void clock_source_consume(ClockWaiter *waiter, guint64 count);
+
+// Virtual timers of the event loop, zero interval disarms the alarm.
+void clock_source_set_alarm(ClockAlarm *alarm, guint64 intervalUs);
+
+// Move the virtual clock forward by hand, wakes all sleepers and alarms which became due.
+void clock_source_advance(guint64 intervalUs);
+guint64 clock_source_get_jump_count(void);
+
+#endif /* _GTK_FM_TUNER_CLOCKSOURCE_HEADER_ */
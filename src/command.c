@@ -0,0 +1,405 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Coalescing tuner command layer.                                               *
+ *                                                                               *
+ * UI commands are stored in one slot per command kind and executed on the       *
+ * tuner event loop. A command submitted while an older command of the same      *
+ * kind is still pending replaces it (last writer wins), so bursts of clicks     *
+ * result in a single I2C transaction sequence. Seeks poll the scanner for up    *
+ * to seconds, the loop hands them to a seek worker and keeps its timers and     *
+ * other commands running.                                                       *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "command.h"
+#include "sweep.h"
+#include "rdsstats.h"
+
+static CommandContext commandContext;
+
+// Runs on the tuner event loop whenever new commands are posted.
+static void on_command_notify(gpointer userData)
+{
+    CommandContext *context = (CommandContext *)userData;
+    uint8_t pending;
+    double frequency;
+    uint16_t volume, channel;
+    ScanDirection scanDirection;
+    uint32_t scanId;
+
+    // Take snapshot of pending commands and release the slots for new requests.
+    g_mutex_lock(&context->commandLock);
+
+    pending = context->pending;
+    frequency = context->frequency;
+    channel = context->channel;
+    volume = context->volume;
+    scanDirection = context->scanDirection;
+    scanId = context->scanId;
+    context->pending = 0;
+
+    g_mutex_unlock(&context->commandLock);
+
+    // Tuning or seeking takes the tuner over from a running band sweep.
+    if(pending & (CMD_FREQUENCY | CMD_CHANNEL | CMD_SCAN))
+    {
+        sweep_abort();
+    }
+
+    // Seek preempted by the submitting thread has returned, stop its hardware scan here on the event loop.
+    if(g_atomic_int_compare_and_exchange(&context->scanPreempted, 1, 0) && (context->tunerRef->cancel_scan != NULL))
+    {
+        context->tunerRef->cancel_scan();
+    }
+
+    if(pending & CMD_FREQUENCY)
+    {
+        context->tunerRef->set_frequency(frequency);
+        rds_stats_set_station(frequency);
+    }
+
+    if(pending & CMD_CHANNEL)
+    {
+        context->tunerRef->set_channel(channel);
+        rds_stats_set_station(band_plan_get()->frequencies[channel]);
+    }
+
+    if(pending & CMD_VOLUME)
+    {
+        context->tunerRef->set_volume(volume);
+    }
+
+    // Seek polls the scanner for up to seconds, the worker runs it so timers and other commands go on meanwhile.
+    if(pending & CMD_SCAN)
+    {
+        g_mutex_lock(&context->commandLock);
+
+        g_atomic_int_set(&context->scanActive, 1);
+        context->scanJob = TRUE;
+        context->scanJobDirection = scanDirection;
+        context->scanJobId = scanId;
+
+        if(context->loopRef->isVirtual)
+        {
+            clock_source_post(&context->scanWaiter, 1);
+        }
+
+        g_cond_signal(&context->scanSignal);
+        g_mutex_unlock(&context->commandLock);
+    }
+}
+
+// Runs on the tuner event loop after each seek of the worker.
+static void on_scan_done_notify(gpointer userData)
+{
+    CommandContext *context = (CommandContext *)userData;
+    uint32_t seekId;
+    uint8_t result;
+
+    g_mutex_lock(&context->commandLock);
+    seekId = context->scanResultId;
+    result = context->scanResult;
+    g_mutex_unlock(&context->commandLock);
+
+    rds_stats_set_station(context->tunerRef->get_frequency());
+
+    if(context->scanHandler != NULL)
+    {
+        context->scanHandler(seekId, result);
+    }
+}
+
+static void *command_scan_thread(void *threadStruct)
+{
+    CommandContext *context = (CommandContext *)threadStruct;
+    gboolean isVirtual = context->loopRef->isVirtual;
+    gboolean isCurrent;
+    ScanDirection direction;
+    uint32_t seekId;
+    uint8_t result;
+
+    // Seek sleeps hold the virtual clock like event loop handlers do.
+    if(isVirtual)
+    {
+        clock_source_bind_thread(&context->scanWaiter);
+    }
+
+    g_mutex_lock(&context->commandLock);
+
+    while(TRUE)
+    {
+        while((!context->scanJob) && (!context->scanEnd))
+        {
+            // Idle worker does not hold the virtual clock.
+            if(isVirtual)
+            {
+                clock_source_block(&context->scanWaiter);
+            }
+
+            g_cond_wait(&context->scanSignal, &context->commandLock);
+        }
+
+        if(context->scanEnd)
+        {
+            break;
+        }
+
+        direction = context->scanJobDirection;
+        seekId = context->scanJobId;
+        context->scanJob = FALSE;
+
+        // Tune or cancel submitted after the seek was handed over supersedes it.
+        isCurrent = (seekId == context->scanGeneration);
+
+        if(isVirtual)
+        {
+            clock_source_consume(&context->scanWaiter, 1);
+        }
+
+        g_mutex_unlock(&context->commandLock);
+
+        // Tuner mutex is released between the scanner polls, the event loop keeps using the tuner.
+        result = isCurrent ? context->tunerRef->scan_channel(direction) : RESULT_FAIL;
+
+        g_mutex_lock(&context->commandLock);
+
+        // Seek requested meanwhile keeps the worker active, so it can still be preempted.
+        if(!context->scanJob)
+        {
+            g_atomic_int_set(&context->scanActive, 0);
+        }
+
+        if(isCurrent)
+        {
+            context->scanResultId = seekId;
+            context->scanResult = result;
+            event_loop_notify(context->loopRef, context->scanDoneId);
+        }
+    }
+
+    g_mutex_unlock(&context->commandLock);
+
+    return NULL;
+}
+
+static void command_submit(CommandType command)
+{
+    // Caller must hold the command lock.
+    commandContext.submitCount++;
+
+    if(commandContext.pending & command)
+    {
+        // Older command of the same kind is not executed yet, it is replaced by this one.
+        commandContext.mergedCount++;
+    }
+
+    commandContext.pending |= command;
+    event_loop_notify(commandContext.loopRef, commandContext.notifierId);
+}
+
+static void command_drop_pending(uint8_t commands)
+{
+    // Caller must hold the command lock.
+    if(commandContext.pending & commands)
+    {
+        commandContext.pending &= ~commands;
+        commandContext.mergedCount++;
+    }
+}
+
+static void command_preempt_scan()
+{
+    // Running seek would keep the scanner going, ask it to return so the new command takes over the tuner.
+    // Caller may be the UI thread, preempting only touches the seek sequence.
+    if(g_atomic_int_get(&commandContext.scanActive) && (commandContext.tunerRef->preempt_scan != NULL))
+    {
+        commandContext.tunerRef->preempt_scan();
+        g_atomic_int_set(&commandContext.scanPreempted, 1);
+    }
+}
+
+void command_init(Tuner *tuner, EventLoop *loop)
+{
+    commandContext.tunerRef = tuner;
+    commandContext.loopRef = loop;
+    commandContext.pending = 0;
+    commandContext.frequency = band_plan_get()->frequencies[0];
+    commandContext.channel = 0;
+    commandContext.volume = tuner->get_volume();
+    commandContext.scanDirection = SCAN_UP;
+    commandContext.scanActive = 0;
+    commandContext.scanPreempted = 0;
+    commandContext.submitCount = 0;
+    commandContext.mergedCount = 0;
+
+    commandContext.scanGeneration = 0;
+    commandContext.scanId = 0;
+    commandContext.scanJob = FALSE;
+    commandContext.scanEnd = FALSE;
+    commandContext.scanJobDirection = SCAN_UP;
+    commandContext.scanJobId = 0;
+    commandContext.scanResultId = 0;
+    commandContext.scanResult = RESULT_FAIL;
+    commandContext.scanHandler = NULL;
+
+    commandContext.notifierId = event_loop_add_notifier(loop, on_command_notify, &commandContext);
+    commandContext.scanDoneId = event_loop_add_notifier(loop, on_scan_done_notify, &commandContext);
+
+    // Worker takes part in the virtual clock before it starts, so time can not run ahead of it.
+    memset(&commandContext.scanWaiter, 0, sizeof(ClockWaiter));
+    if(loop->isVirtual)
+    {
+        clock_source_attach(&commandContext.scanWaiter);
+    }
+
+    pthread_create(&commandContext.scanThread, NULL, command_scan_thread, (void*)(&commandContext));
+}
+
+void command_shutdown()
+{
+    // Running seek is preempted, so the worker exits without waiting for the scanner.
+    command_preempt_scan();
+
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.scanEnd = TRUE;
+    g_cond_signal(&commandContext.scanSignal);
+    g_mutex_unlock(&commandContext.commandLock);
+
+    pthread_join(commandContext.scanThread, NULL);
+
+    if(commandContext.loopRef->isVirtual)
+    {
+        clock_source_detach(&commandContext.scanWaiter);
+    }
+
+#ifdef DEBUG_LOGS
+    g_message("Command layer executed %d of %d commands, %d merged", (commandContext.submitCount - commandContext.mergedCount), commandContext.submitCount, commandContext.mergedCount);
+#endif
+}
+
+void command_set_frequency(double frequency)
+{
+    command_preempt_scan();
+
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.frequency = frequency;
+    commandContext.scanGeneration++;
+
+    // Tuning makes any pending seek or tune obsolete.
+    command_drop_pending(CMD_SCAN | CMD_CHANNEL);
+    command_submit(CMD_FREQUENCY);
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+void command_set_channel(uint16_t channel)
+{
+    const BandPlan *plan = band_plan_get();
+
+    command_preempt_scan();
+
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.channel = MIN(channel, band_plan_last_channel(plan));
+    commandContext.scanGeneration++;
+
+    command_drop_pending(CMD_SCAN | CMD_FREQUENCY);
+    command_submit(CMD_CHANNEL);
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+uint32_t command_scan(ScanDirection direction)
+{
+    uint32_t seekId;
+
+    command_preempt_scan();
+
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.scanDirection = direction;
+    commandContext.scanId = ++commandContext.scanGeneration;
+    seekId = commandContext.scanId;
+    command_submit(CMD_SCAN);
+    g_mutex_unlock(&commandContext.commandLock);
+
+    return seekId;
+}
+
+void command_cancel_scan()
+{
+    command_preempt_scan();
+
+    // Pending seek is dropped, the event loop stops the hardware scan of a preempted one.
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.scanGeneration++;
+    command_drop_pending(CMD_SCAN);
+    event_loop_notify(commandContext.loopRef, commandContext.notifierId);
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+void command_set_scan_handler(command_scan_handler handler)
+{
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.scanHandler = handler;
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+void command_set_volume(uint16_t level)
+{
+    g_mutex_lock(&commandContext.commandLock);
+    commandContext.volume = MIN(level, commandContext.tunerRef->maxVolume);
+    command_submit(CMD_VOLUME);
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+void command_change_volume(VolumeDirection direction)
+{
+    g_mutex_lock(&commandContext.commandLock);
+
+    // Relative changes are converted into an absolute level, so they can be merged.
+    if(direction == VOLUME_UP)
+    {
+        commandContext.volume += (commandContext.volume >= commandContext.tunerRef->maxVolume) ? 0 : 1;
+    }
+    else
+    {
+        commandContext.volume -= (commandContext.volume == 0) ? 0 : 1;
+    }
+
+    command_submit(CMD_VOLUME);
+    g_mutex_unlock(&commandContext.commandLock);
+}
+
+uint32_t command_get_merged_count()
+{
+    uint32_t mergedCount;
+
+    g_mutex_lock(&commandContext.commandLock);
+    mergedCount = commandContext.mergedCount;
+    g_mutex_unlock(&commandContext.commandLock);
+
+    return mergedCount;
+}
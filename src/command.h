@@ -0,0 +1,95 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Coalescing tuner command layer.                                               *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_COMMAND_HEADER_
+#define _GTK_FM_TUNER_COMMAND_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "tuner.h"
+#include "evloop.h"
+#include "clocksource.h"
+
+typedef enum
+{
+    CMD_FREQUENCY = 0x01,   // Tune to the pending frequency.
+    CMD_VOLUME = 0x02,      // Apply the pending volume level.
+    CMD_SCAN = 0x04,        // Seek next station in the pending direction.
+    CMD_CHANNEL = 0x08      // Tune to the pending channel of the band plan.
+} CommandType;
+
+// Receives the result of each seek on the tuner event loop, seekId is the value returned by command_scan.
+typedef void (*command_scan_handler)(uint32_t seekId, uint8_t result);
+
+typedef struct CommandContext
+{
+    Tuner *tunerRef;
+    EventLoop *loopRef;
+    int notifierId;
+    GMutex commandLock;
+    uint8_t pending;            // Bit mask of pending CommandType values.
+    double frequency;           // Last requested frequency.
+    uint16_t channel;           // Last requested channel index.
+    uint16_t volume;            // Last requested volume level.
+    ScanDirection scanDirection;
+    uint32_t scanGeneration;    // Incremented by every seek, tune and cancel, a seek only starts while it is the latest.
+    uint32_t scanId;            // Generation of the pending seek.
+    volatile gint scanActive;   // Non zero from handing a seek to the seek worker until it returns.
+    volatile gint scanPreempted; // Non zero if a seek was preempted and its hardware scan is not stopped yet.
+    uint32_t submitCount;       // Number of submitted commands.
+    uint32_t mergedCount;       // Number of commands replaced by a newer command of the same kind.
+
+    // Seek worker, signalled by the event loop (protected by the command lock).
+    pthread_t scanThread;
+    GCond scanSignal;
+    gboolean scanJob;           // Seek handed to the worker and not started yet.
+    gboolean scanEnd;
+    ScanDirection scanJobDirection;
+    uint32_t scanJobId;
+    uint32_t scanResultId;      // Last finished seek and its result.
+    uint8_t scanResult;
+    int scanDoneId;             // Notifier, the worker reports the end of each seek to the event loop.
+    command_scan_handler scanHandler;
+    ClockWaiter scanWaiter;     // Worker is a participant of the virtual clock.
+} CommandContext;
+
+void command_init(Tuner *tuner, EventLoop *loop);
+void command_shutdown(void);
+
+void command_set_frequency(double frequency);
+void command_set_channel(uint16_t channel);
+void command_set_volume(uint16_t level);
+void command_change_volume(VolumeDirection direction);
+uint32_t command_scan(ScanDirection direction);
+void command_cancel_scan(void);
+void command_set_scan_handler(command_scan_handler handler);
+
+uint32_t command_get_merged_count(void);
+
+#endif /* _GTK_FM_TUNER_COMMAND_HEADER_ */
@@ -0,0 +1,993 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Headless tuner daemon with Unix domain socket control interface.              *
+ *                                                                               *
+ * Protocol is line based ASCII, one command per line:                           *
+ *   PING                  -> OK PONG                                            *
+ *   TUNE <MHz>            -> OK TUNE <MHz>                                      *
+ *   SEEK UP|DOWN          -> OK SEEK, later EVT SEEK <MHz>|FAIL|ABORTED         *
+ *   BAND [name]           -> OK BAND <name> <start kHz> <end kHz> <step kHz>    *
+ *                            <channels>, name selects eu, jp, oirt or wide.     *
+ *   STEP [50|100|200]     -> OK STEP <kHz>, seek step of the band plan.         *
+ *   CCA                   -> OK CCA <calibrated> <RSSI th> <SNR th> <noise      *
+ *                            RSSI> <noise SNR> <stops> <false stops>.           *
+ *   VOL <0-7>|UP|DOWN     -> OK VOL <level>                                     *
+ *   SURVEY                -> OK SURVEY, later EVT STATION <MHz> ...             *
+ *                            and EVT SURVEY <station count>                     *
+ *   STATUS                -> OK STATUS <MHz> <RSSI> <SNR> <MPX> <VOL> <RDS>     *
+ *   TMC [location|STATS]  -> OK TMC <count>, followed by one line per stored    *
+ *                            traffic message: TMC <location> <event> <+|->      *
+ *                            <extent> <duration> <expiry s> <repeats>           *
+ *   CLOCK                 -> OK CLOCK <UTC s> <offset min> <quality> <locked>   *
+ *                            <avg latency us> <max latency us>                  *
+ *   TRACE [levels]        -> OK TRACE <written> <lost> <levels>, levels is a    *
+ *                            list of subsystem=level items (all=debug).         *
+ *   TRACE FLUSH|DUMP      -> Flush the trace file or dump all trace rings.      *
+ *   I2C                   -> OK I2C <transactions> <errors> <busy us>,          *
+ *                            followed by I2C SUBSYSTEM <name> <count> <errors>  *
+ *                            <avg us> <p50 us> <p99 us> lines and I2C REGISTER  *
+ *                            <reg> <reads> <writes> <errors> <avg us> <p99 us>  *
+ *                            lines for every accessed register.                 *
+ *                            I2C DEVICE <name> <address> <state> <transfers>    *
+ *                            <retries> <recovered> <failures> <consecutive      *
+ *                            failures> <state age s> lines report bus health.   *
+ *   LINK                  -> OK LINK <connected|reconnecting> <losses>          *
+ *                            <recoveries> <attempts> <last/max recovery ms>.    *
+ *   LOCKS                 -> OK LOCKS <polls> <skipped polls> <skipped meter    *
+ *                            samples> <age ms: freq RSSI SNR stereo>, followed  *
+ *                            by LOCK <caller> <locks> <trylocks> <failures>     *
+ *                            <avg/p99/max wait us> <avg/p99/max hold us> lines. *
+ *   SUB / UNSUB           -> OK SUB / OK UNSUB, subscribed clients receive      *
+ *                            EVT STATUS ... whenever tuner status changes and   *
+ *                            EVT PROGRESS <MHz> while a seek is running.        *
+ * A new SEEK, SURVEY or TUNE preempts any running seek or survey.               *
+ * Errors are reported as ERR <reason>.                                          *
+ *                                                                               *
+ *********************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <glib.h>
+#include <glib-unix.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "daemon.h"
+#include "tunercore.h"
+#include "command.h"
+#include "tmc.h"
+#include "rdsclock.h"
+#include "trace.h"
+#include "i2cstats.h"
+#include "i2chealth.h"
+#include "supervisor.h"
+#include "clocksource.h"
+#include "scancal.h"
+
+static Tuner *daemonTuner;
+static GMainLoop *daemonLoop;
+static DaemonClient *daemonClients[DAEMON_MAX_CLIENTS];
+static DaemonJobContext daemonJob;
+static TunerStatus lastStatus;
+static guint subscriberCount;
+static TMCMessage tmcMessages[TMC_MAX_MESSAGES];
+
+static void daemon_send(DaemonClient *client, const char *message)
+{
+    size_t messageLen = strlen(message);
+
+    // Sockets are non-blocking, slow clients lose the message instead of stalling the daemon.
+    if(send(client->socketHandle, message, messageLen, MSG_NOSIGNAL | MSG_DONTWAIT) < 0)
+    {
+        if((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+            // Connection is broken, client is released by its owner.
+            client->disconnected = TRUE;
+        }
+    }
+}
+
+static void daemon_close_client(DaemonClient *client, gboolean removeSource)
+{
+    uint8_t pos;
+
+    for(pos = 0; pos < DAEMON_MAX_CLIENTS; pos++)
+    {
+        if(daemonClients[pos] == client)
+        {
+            daemonClients[pos] = NULL;
+        }
+    }
+
+    if(client->subscribed)
+    {
+        subscriberCount--;
+    }
+
+    if(removeSource)
+    {
+        g_source_remove(client->sourceId);
+    }
+
+    close(client->socketHandle);
+    g_free(client);
+}
+
+static void daemon_broadcast(const char *message, gboolean subscribersOnly)
+{
+    uint8_t pos;
+
+    for(pos = 0; pos < DAEMON_MAX_CLIENTS; pos++)
+    {
+        if((daemonClients[pos] != NULL) && ((!subscribersOnly) || daemonClients[pos]->subscribed))
+        {
+            daemon_send(daemonClients[pos], message);
+
+            if(daemonClients[pos]->disconnected)
+            {
+                daemon_close_client(daemonClients[pos], TRUE);
+            }
+        }
+    }
+}
+
+static double daemon_read_frequency()
+{
+    double freq;
+    uint8_t tryCount = 0;
+
+    // Frequency getter returns -1 while another thread holds the tuner.
+    do
+    {
+        freq = daemonTuner->get_frequency();
+        if(freq < 0)
+        {
+            clock_source_sleep(1000);
+        }
+    }
+    while((freq < 0) && ((++tryCount) < 20));
+
+    return freq;
+}
+
+static int32_t daemon_read_channel()
+{
+    int32_t channel;
+    uint8_t tryCount = 0;
+
+    // Channel getter reports no channel while another thread holds the tuner, as it does outside the band plan.
+    do
+    {
+        channel = daemonTuner->get_channel();
+        if(channel == BAND_PLAN_NO_CHANNEL)
+        {
+            clock_source_sleep(1000);
+        }
+    }
+    while((channel == BAND_PLAN_NO_CHANNEL) && ((++tryCount) < 20));
+
+    return channel;
+}
+
+static void daemon_format_status(const char *prefix, TunerStatus *status, char *buffer, size_t bufferSize)
+{
+    const char *mpxText;
+
+    mpxText = (status->mpxState == MPXS_STEREO) ? "STEREO" : ((status->mpxState == MPXS_MONO) ? "MONO" : "UNKNOWN");
+    g_snprintf(buffer, bufferSize, "%s %.2lf %d %d %s %d %s\n", prefix, status->frequency, status->rssi, status->snr, mpxText, status->volume, status->rdsText);
+}
+
+// Called by the tuner core (on the daemon main loop) whenever tuner status has changed.
+static void on_daemon_status_changed(TunerStatus *status)
+{
+    char message[96];
+
+    lastStatus = *status;
+
+    if(subscriberCount > 0)
+    {
+        daemon_format_status("EVT STATUS", status, message, sizeof(message));
+        daemon_broadcast(message, TRUE);
+    }
+}
+
+// Preempted job is reported right away, the result of its seek is ignored.
+static void daemon_end_job()
+{
+    char message[32];
+
+    if(daemonJob.state == DJ_SEEK)
+    {
+        daemon_broadcast("EVT SEEK ABORTED\n", FALSE);
+    }
+    else if(daemonJob.state == DJ_SURVEY)
+    {
+        g_snprintf(message, sizeof(message), "EVT SURVEY %u\n", daemonJob.stationCount);
+        daemon_broadcast(message, FALSE);
+    }
+
+    daemonJob.state = DJ_IDLE;
+}
+
+static void daemon_cancel_job()
+{
+    if(daemonJob.state != DJ_IDLE)
+    {
+        daemon_end_job();
+
+        // Seek already running on the hardware is stopped as well, not only the job.
+        command_cancel_scan();
+    }
+}
+
+static void daemon_queue_job(DaemonJobState job, ScanDirection direction)
+{
+    // New job preempts the running one.
+    daemon_cancel_job();
+    daemonJob.state = job;
+
+    if(job == DJ_SURVEY)
+    {
+        // Survey starts from the first channel and returns to the last published station.
+        daemonJob.surveyFrequency = lastStatus.frequency;
+        daemonJob.surveyChannel = 0;
+        daemonJob.stationCount = 0;
+        daemonTuner->set_channel(0);
+    }
+
+    // Seek runs on the seek worker of the command layer, its result arrives on this loop.
+    daemonJob.seekId = command_scan(direction);
+}
+
+// Called by the command layer on the daemon main loop whenever one of its seeks has finished.
+static void on_daemon_seek_done(uint32_t seekId, uint8_t result)
+{
+    const BandPlan *plan = band_plan_get();
+    int32_t channel;
+    char message[48];
+
+    if((daemonJob.state == DJ_IDLE) || (seekId != daemonJob.seekId))
+    {
+        return;
+    }
+
+    if(daemonJob.state == DJ_SEEK)
+    {
+        daemonJob.state = DJ_IDLE;
+
+        if(result == RESULT_SUCCESS)
+        {
+            g_snprintf(message, sizeof(message), "EVT SEEK %.2lf\n", daemon_read_frequency());
+            daemon_broadcast(message, FALSE);
+        }
+        else
+        {
+            daemon_broadcast("EVT SEEK FAIL\n", FALSE);
+        }
+
+        return;
+    }
+
+    // Survey steps through the band with hardware seek until it wraps or reaches the upper limit.
+    channel = (result == RESULT_SUCCESS) ? daemon_read_channel() : BAND_PLAN_NO_CHANNEL;
+    if((channel != BAND_PLAN_NO_CHANNEL) && (channel > daemonJob.surveyChannel) && (channel < band_plan_last_channel(plan)))
+    {
+        daemonJob.stationCount++;
+        daemonJob.surveyChannel = channel;
+        g_snprintf(message, sizeof(message), "EVT STATION %.2lf\n", plan->frequencies[channel]);
+        daemon_broadcast(message, FALSE);
+
+        if(daemonJob.stationCount < DAEMON_SURVEY_MAX_STATIONS)
+        {
+            daemonJob.seekId = command_scan(SCAN_UP);
+            return;
+        }
+    }
+
+    // Restore original station.
+    if(daemonJob.surveyFrequency > 0)
+    {
+        daemonTuner->set_frequency(daemonJob.surveyFrequency);
+    }
+
+    daemon_end_job();
+}
+
+static void daemon_send_band_plan(DaemonClient *client, const BandPlan *plan)
+{
+    char response[96];
+
+    g_snprintf(response, sizeof(response), "OK BAND %s %u %u %u %u\n", plan->name, plan->startKHz, plan->endKHz, plan->stepKHz, plan->channelCount);
+    daemon_send(client, response);
+}
+
+static void daemon_select_band_plan(DaemonClient *client, const char *name)
+{
+    const BandPlan *plan;
+
+    plan = band_plan_find(name);
+    if((plan == NULL) || (daemonTuner->set_band_plan == NULL))
+    {
+        daemon_send(client, "ERR INVALID BAND\n");
+        return;
+    }
+
+    // Seeks and surveys of the old plan are stopped before the tuner tables change.
+    daemon_cancel_job();
+    band_plan_select(plan->id);
+    daemonTuner->set_band_plan(plan);
+
+    // Station outside of the new band moves to the first channel.
+    if(daemon_read_channel() == BAND_PLAN_NO_CHANNEL)
+    {
+        daemonTuner->set_channel(0);
+    }
+
+    daemon_send_band_plan(client, plan);
+}
+
+// Invoked on the daemon main loop to deliver scan progress to subscribed clients.
+static gboolean daemon_post_progress(gpointer message)
+{
+    daemon_broadcast((const char *)message, TRUE);
+    g_free(message);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void on_daemon_scan_progress(double frequency)
+{
+    if(subscriberCount > 0)
+    {
+        g_idle_add(daemon_post_progress, g_strdup_printf("EVT PROGRESS %.2lf\n", frequency));
+    }
+}
+
+static void daemon_send_tmc(DaemonClient *client, const char *argument)
+{
+    char response[96];
+    char *endPtr;
+    long location;
+    uint32_t count, pos;
+    gint64 now;
+    TMCStats stats;
+
+    if((argument != NULL) && (g_ascii_strcasecmp(argument, "STATS") == 0))
+    {
+        tmc_get_stats(&stats);
+        g_snprintf(response, sizeof(response), "OK TMC STATS %u %u %u %u %u %u %u %u\n", stats.groups, stats.errorGroups, stats.singleMessages,
+            stats.multiMessages, stats.assemblyErrors, stats.duplicates, stats.expired, stats.messageCount);
+        daemon_send(client, response);
+        return;
+    }
+
+    if(argument != NULL)
+    {
+        location = strtol(argument, &endPtr, 10);
+        if((endPtr == argument) || (location < 0) || (location > 0xFFFF))
+        {
+            daemon_send(client, "ERR INVALID LOCATION\n");
+            return;
+        }
+
+        count = tmc_find_location((uint16_t)location, tmcMessages, TMC_MAX_MESSAGES);
+    }
+    else
+    {
+        count = tmc_get_messages(tmcMessages, TMC_MAX_MESSAGES);
+    }
+
+    g_snprintf(response, sizeof(response), "OK TMC %u\n", count);
+    daemon_send(client, response);
+
+    now = clock_source_now();
+    for(pos = 0; pos < count; pos++)
+    {
+        g_snprintf(response, sizeof(response), "TMC %u %u %c %u %u %ld %u\n", tmcMessages[pos].location, tmcMessages[pos].event,
+            (tmcMessages[pos].direction ? '-' : '+'), tmcMessages[pos].extent, tmcMessages[pos].duration,
+            (long)((tmcMessages[pos].expiryTime - now) / G_USEC_PER_SEC), tmcMessages[pos].repeatCount);
+        daemon_send(client, response);
+    }
+}
+
+static void daemon_send_clock(DaemonClient *client)
+{
+    char response[96];
+    FMStatusClock clockState;
+    uint32_t averageLatency, maxLatency;
+
+    rds_clock_get_quality(&clockState);
+    rds_clock_get_latency(&averageLatency, &maxLatency);
+
+    if(clockState.utcTime == 0)
+    {
+        daemon_send(client, "ERR NO CLOCK\n");
+        return;
+    }
+
+    // Clock time is extrapolated from the minute edge to the current time.
+    g_snprintf(response, sizeof(response), "OK CLOCK %" G_GINT64_FORMAT " %d %u %u %u %u\n",
+        (gint64)((clockState.utcTime + (clock_source_now() - (gint64)clockState.edgeTime)) / G_USEC_PER_SEC),
+        clockState.localOffset, clockState.quality, clockState.locked, averageLatency, maxLatency);
+    daemon_send(client, response);
+}
+
+static void daemon_send_trace(DaemonClient *client, const char *argument)
+{
+    char response[160];
+    char levelText[96];
+    uint32_t writtenRecords, lostRecords;
+
+    if((argument != NULL) && (g_ascii_strcasecmp(argument, "DUMP") == 0))
+    {
+        if(trace_dump() == RESULT_FAIL)
+        {
+            daemon_send(client, "ERR DUMP FAILED\n");
+            return;
+        }
+
+        g_snprintf(response, sizeof(response), "OK TRACE DUMP %s\n", trace_get_dump_path());
+        daemon_send(client, response);
+        return;
+    }
+
+    if((argument != NULL) && (g_ascii_strcasecmp(argument, "FLUSH") == 0))
+    {
+        trace_flush();
+    }
+    else if((argument != NULL) && (trace_set_levels(argument) == RESULT_FAIL))
+    {
+        daemon_send(client, "ERR INVALID LEVEL\n");
+        return;
+    }
+
+    trace_get_stats(&writtenRecords, &lostRecords);
+    trace_get_levels(levelText, sizeof(levelText));
+    g_snprintf(response, sizeof(response), "OK TRACE %u %u %s\n", writtenRecords, lostRecords, levelText);
+    daemon_send(client, response);
+}
+
+static void daemon_send_i2c_stats(DaemonClient *client)
+{
+    char response[128];
+    I2CThreadStats *totalStats;
+    I2CSubsystemStats *subsystemStats;
+    I2CRegisterStats *regStats;
+    I2CHealthStats health;
+    uint64_t busyTime = 0;
+    uint32_t transactions = 0, errors = 0, count;
+    uint16_t pos;
+
+    totalStats = g_new(I2CThreadStats, 1);
+    i2c_stats_read(totalStats);
+
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        transactions += totalStats->subsystems[pos].transactions;
+        errors += totalStats->subsystems[pos].errors;
+        busyTime += totalStats->subsystems[pos].busyTime;
+    }
+
+    g_snprintf(response, sizeof(response), "OK I2C %u %u %" G_GUINT64_FORMAT "\n", transactions, errors, (busyTime / 1000));
+    daemon_send(client, response);
+
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        subsystemStats = &totalStats->subsystems[pos];
+        if(subsystemStats->transactions > 0)
+        {
+            g_snprintf(response, sizeof(response), "I2C SUBSYSTEM %s %u %u %" G_GUINT64_FORMAT " %u %u\n", i2c_stats_subsystem_name(pos),
+                subsystemStats->transactions, subsystemStats->errors, (subsystemStats->busyTime / 1000 / subsystemStats->transactions),
+                i2c_stats_percentile(subsystemStats->histogram, subsystemStats->transactions, 50),
+                i2c_stats_percentile(subsystemStats->histogram, subsystemStats->transactions, 99));
+            daemon_send(client, response);
+        }
+    }
+
+    for(pos = 0; pos < I2C_STATS_REGISTERS; pos++)
+    {
+        regStats = &totalStats->registers[pos];
+        count = regStats->reads + regStats->writes;
+        if(count > 0)
+        {
+            g_snprintf(response, sizeof(response), "I2C REGISTER 0x%02X %u %u %u %" G_GUINT64_FORMAT " %u\n", pos, regStats->reads,
+                regStats->writes, regStats->errors, (regStats->busyTime / 1000 / count), i2c_stats_percentile(regStats->histogram, count, 99));
+            daemon_send(client, response);
+        }
+    }
+
+    for(pos = 0; pos < i2c_health_device_count(); pos++)
+    {
+        i2c_health_read((uint8_t)pos, &health);
+        g_snprintf(response, sizeof(response), "I2C DEVICE %s 0x%02X %s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %u %" G_GINT64_FORMAT "\n",
+            health.name, health.address, i2c_health_state_name(health.state), health.transactions, health.retries, health.recovered,
+            health.failures, health.consecutiveFailures, ((g_get_monotonic_time() - health.stateTime) / G_USEC_PER_SEC));
+        daemon_send(client, response);
+    }
+
+    g_free(totalStats);
+}
+
+static void daemon_set_scan_step(DaemonClient *client, const char *argument)
+{
+    char response[32];
+    const BandPlan *plan = band_plan_get();
+    long stepKHz;
+    char *endPtr;
+
+    if(argument != NULL)
+    {
+        stepKHz = strtol(argument, &endPtr, 10);
+        if((endPtr == argument) || (stepKHz <= 0) || (stepKHz > BAND_PLAN_MAX_SCAN_STEP) ||
+            (band_plan_set_scan_step(plan, (uint16_t)stepKHz) != RESULT_SUCCESS))
+        {
+            daemon_send(client, "ERR INVALID STEP\n");
+            return;
+        }
+    }
+
+    g_snprintf(response, sizeof(response), "OK STEP %u\n", band_plan_get_scan_step(plan));
+    daemon_send(client, response);
+}
+
+static void daemon_send_scan_calibration(DaemonClient *client)
+{
+    char response[96];
+    ScanCalibrationStats calibration;
+
+    scan_cal_read(&calibration);
+    g_snprintf(response, sizeof(response), "OK CCA %d %u %u %d %d %u %u\n", (calibration.calibrated ? 1 : 0),
+        calibration.rssiThreshold, calibration.snrThreshold, (calibration.calibrated ? calibration.noiseRSSI : -1),
+        (calibration.calibrated ? calibration.noiseSNR : -1), calibration.stops, calibration.falseStops);
+    daemon_send(client, response);
+}
+
+static void daemon_send_link(DaemonClient *client)
+{
+    char response[128];
+    SupervisorStats stats;
+
+    if(supervisor_read(&stats) == RESULT_FAIL)
+    {
+        daemon_send(client, "ERR NOT SUPERVISED\n");
+        return;
+    }
+
+    g_snprintf(response, sizeof(response), "OK LINK %s %u %u %u %" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n", supervisor_state_name(stats.state),
+        stats.losses, stats.recoveries, stats.attempts, (stats.lastRecoveryTime / 1000), (stats.maxRecoveryTime / 1000));
+    daemon_send(client, response);
+}
+
+static void daemon_send_lock_stats(DaemonClient *client)
+{
+    char response[160];
+    LockCallerStats callerStats[LOCK_STATS_CALLERS];
+    LockCallerStats *stats;
+    TunerStatusAge statusAge;
+    uint32_t acquisitions;
+    uint8_t pos;
+
+    tuner_core_get_status_age(&statusAge);
+    g_snprintf(response, sizeof(response), "OK LOCKS %u %u %u %d %d %d %d\n", statusAge.telemetryPolls, statusAge.telemetrySkips,
+        statusAge.meterSkips, ((statusAge.frequencyAge != TUNER_STATUS_AGE_NONE) ? (int)statusAge.frequencyAge : -1),
+        ((statusAge.rssiAge != TUNER_STATUS_AGE_NONE) ? (int)statusAge.rssiAge : -1),
+        ((statusAge.snrAge != TUNER_STATUS_AGE_NONE) ? (int)statusAge.snrAge : -1),
+        ((statusAge.stereoAge != TUNER_STATUS_AGE_NONE) ? (int)statusAge.stereoAge : -1));
+    daemon_send(client, response);
+
+    if(daemonTuner->get_lock_stats == NULL)
+    {
+        return;
+    }
+
+    daemonTuner->get_lock_stats(callerStats);
+    for(pos = 0; pos < LOCK_STATS_CALLERS; pos++)
+    {
+        stats = &callerStats[pos];
+        acquisitions = stats->locks + (stats->trylocks - stats->trylockFailures);
+        if((stats->locks + stats->trylocks) == 0)
+        {
+            continue;
+        }
+
+        g_snprintf(response, sizeof(response), "LOCK %s %u %u %u %" G_GUINT64_FORMAT " %u %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %u %" G_GUINT64_FORMAT "\n",
+            i2c_stats_subsystem_name(pos), stats->locks, stats->trylocks, stats->trylockFailures,
+            ((stats->locks > 0) ? (stats->waitTime / 1000 / stats->locks) : 0), lock_stats_percentile(stats->waitHistogram, 99),
+            (stats->maxWaitTime / 1000), ((acquisitions > 0) ? (stats->holdTime / 1000 / acquisitions) : 0),
+            lock_stats_percentile(stats->holdHistogram, 99), (stats->maxHoldTime / 1000));
+        daemon_send(client, response);
+    }
+}
+
+static void daemon_process_command(DaemonClient *client, char *command)
+{
+    char response[96];
+    char *argument, *endPtr;
+    double freq;
+    int32_t channel;
+    long level;
+    TunerStatus status;
+
+    // Split command and optional argument.
+    argument = strchr(command, ' ');
+    if(argument != NULL)
+    {
+        *argument = 0x00;
+        argument = g_strstrip(argument + 1);
+    }
+
+    if(g_ascii_strcasecmp(command, "PING") == 0)
+    {
+        daemon_send(client, "OK PONG\n");
+    }
+    else if(g_ascii_strcasecmp(command, "TUNE") == 0)
+    {
+        freq = (argument != NULL) ? g_ascii_strtod(argument, &endPtr) : 0;
+        channel = ((argument != NULL) && (endPtr != argument)) ? band_plan_mhz_to_channel(band_plan_get(), freq) : BAND_PLAN_NO_CHANNEL;
+        if(channel == BAND_PLAN_NO_CHANNEL)
+        {
+            daemon_send(client, "ERR INVALID FREQUENCY\n");
+            return;
+        }
+
+        // Tuning takes over the tuner from any running seek or survey.
+        daemon_cancel_job();
+        daemonTuner->set_channel((uint16_t)channel);
+        g_snprintf(response, sizeof(response), "OK TUNE %.2lf\n", band_plan_get()->frequencies[channel]);
+        daemon_send(client, response);
+    }
+    else if(g_ascii_strcasecmp(command, "SEEK") == 0)
+    {
+        if((argument == NULL) || ((g_ascii_strcasecmp(argument, "UP") != 0) && (g_ascii_strcasecmp(argument, "DOWN") != 0)))
+        {
+            daemon_send(client, "ERR INVALID DIRECTION\n");
+            return;
+        }
+
+        daemon_queue_job(DJ_SEEK, (g_ascii_strcasecmp(argument, "UP") == 0) ? SCAN_UP : SCAN_DOWN);
+        daemon_send(client, "OK SEEK\n");
+    }
+    else if(g_ascii_strcasecmp(command, "VOL") == 0)
+    {
+        if(argument == NULL)
+        {
+            daemon_send(client, "ERR INVALID VOLUME\n");
+            return;
+        }
+
+        if(g_ascii_strcasecmp(argument, "UP") == 0)
+        {
+            level = daemonTuner->change_volume(VOLUME_UP);
+        }
+        else if(g_ascii_strcasecmp(argument, "DOWN") == 0)
+        {
+            level = daemonTuner->change_volume(VOLUME_DOWN);
+        }
+        else
+        {
+            level = strtol(argument, &endPtr, 10);
+            if((endPtr == argument) || (level < 0) || (daemonTuner->set_volume((uint16_t)level) != RESULT_SUCCESS))
+            {
+                daemon_send(client, "ERR INVALID VOLUME\n");
+                return;
+            }
+        }
+
+        g_snprintf(response, sizeof(response), "OK VOL %ld\n", level);
+        daemon_send(client, response);
+    }
+    else if(g_ascii_strcasecmp(command, "BAND") == 0)
+    {
+        if(argument == NULL)
+        {
+            daemon_send_band_plan(client, band_plan_get());
+        }
+        else
+        {
+            daemon_select_band_plan(client, argument);
+        }
+    }
+    else if(g_ascii_strcasecmp(command, "STEP") == 0)
+    {
+        daemon_set_scan_step(client, argument);
+    }
+    else if(g_ascii_strcasecmp(command, "CCA") == 0)
+    {
+        daemon_send_scan_calibration(client);
+    }
+    else if(g_ascii_strcasecmp(command, "SURVEY") == 0)
+    {
+        daemon_queue_job(DJ_SURVEY, SCAN_UP);
+        daemon_send(client, "OK SURVEY\n");
+    }
+    else if(g_ascii_strcasecmp(command, "STATUS") == 0)
+    {
+        tuner_core_read_status(daemonTuner, &status);
+        daemon_format_status("OK STATUS", &status, response, sizeof(response));
+        daemon_send(client, response);
+    }
+    else if(g_ascii_strcasecmp(command, "TMC") == 0)
+    {
+        daemon_send_tmc(client, argument);
+    }
+    else if(g_ascii_strcasecmp(command, "CLOCK") == 0)
+    {
+        daemon_send_clock(client);
+    }
+    else if(g_ascii_strcasecmp(command, "TRACE") == 0)
+    {
+        daemon_send_trace(client, argument);
+    }
+    else if(g_ascii_strcasecmp(command, "I2C") == 0)
+    {
+        daemon_send_i2c_stats(client);
+    }
+    else if(g_ascii_strcasecmp(command, "LOCKS") == 0)
+    {
+        daemon_send_lock_stats(client);
+    }
+    else if(g_ascii_strcasecmp(command, "LINK") == 0)
+    {
+        daemon_send_link(client);
+    }
+    else if(g_ascii_strcasecmp(command, "SUB") == 0)
+    {
+        if(!client->subscribed)
+        {
+            client->subscribed = TRUE;
+            subscriberCount++;
+        }
+
+        daemon_send(client, "OK SUB\n");
+
+        // Status events are sent only on change, give the new subscriber the current one.
+        if(lastStatus.frequency >= 0)
+        {
+            daemon_format_status("EVT STATUS", &lastStatus, response, sizeof(response));
+            daemon_send(client, response);
+        }
+    }
+    else if(g_ascii_strcasecmp(command, "UNSUB") == 0)
+    {
+        if(client->subscribed)
+        {
+            client->subscribed = FALSE;
+            subscriberCount--;
+        }
+
+        daemon_send(client, "OK UNSUB\n");
+    }
+    else
+    {
+        daemon_send(client, "ERR UNKNOWN COMMAND\n");
+    }
+}
+
+static gboolean on_daemon_client_data(gint fd, GIOCondition condition, gpointer userData)
+{
+    DaemonClient *client = (DaemonClient *)userData;
+    char readBuffer[DAEMON_LINE_MAX_SIZE];
+    ssize_t readLen, pos;
+
+    readLen = recv(fd, readBuffer, sizeof(readBuffer), MSG_DONTWAIT);
+    if((readLen == 0) || ((readLen < 0) && (errno != EAGAIN) && (errno != EINTR)))
+    {
+        // Client closed the connection.
+        daemon_close_client(client, FALSE);
+        return G_SOURCE_REMOVE;
+    }
+
+    for(pos = 0; pos < readLen; pos++)
+    {
+        if((readBuffer[pos] == '\n') || (readBuffer[pos] == '\r'))
+        {
+            if(client->lineLength > 0)
+            {
+                client->lineBuffer[client->lineLength] = 0x00;
+                client->lineLength = 0;
+                daemon_process_command(client, client->lineBuffer);
+
+                if(client->disconnected)
+                {
+                    daemon_close_client(client, FALSE);
+                    return G_SOURCE_REMOVE;
+                }
+            }
+        }
+        else if(client->lineLength < (DAEMON_LINE_MAX_SIZE - 1))
+        {
+            client->lineBuffer[client->lineLength++] = readBuffer[pos];
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_daemon_client_connect(gint fd, GIOCondition condition, gpointer userData)
+{
+    int clientHandle;
+    uint8_t pos;
+    DaemonClient *client;
+
+    clientHandle = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(clientHandle < 0)
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    // Find free client slot.
+    for(pos = 0; pos < DAEMON_MAX_CLIENTS; pos++)
+    {
+        if(daemonClients[pos] == NULL)
+        {
+            break;
+        }
+    }
+
+    if(pos == DAEMON_MAX_CLIENTS)
+    {
+        // Client limit is reached.
+        send(clientHandle, "ERR TOO MANY CLIENTS\n", 21, MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(clientHandle);
+        return G_SOURCE_CONTINUE;
+    }
+
+    client = g_new0(DaemonClient, 1);
+    client->socketHandle = clientHandle;
+    client->sourceId = g_unix_fd_add(clientHandle, G_IO_IN | G_IO_HUP | G_IO_ERR, on_daemon_client_data, client);
+    daemonClients[pos] = client;
+
+    TRACE_LOG(TE_DAEMON_CLIENT, pos);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_daemon_terminate(gpointer userData)
+{
+    g_main_loop_quit(daemonLoop);
+    return G_SOURCE_REMOVE;
+}
+
+static int daemon_create_socket(const char *socketPath)
+{
+    int socketHandle;
+    struct sockaddr_un address;
+    struct stat socketStat;
+
+    if(strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        g_printerr("Socket path is too long: %s\n", socketPath);
+        return -1;
+    }
+
+    socketHandle = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(socketHandle < 0)
+    {
+        g_printerr("Unable to create control socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+
+    // Remove stale socket from previous session, any other kind of file is left in place.
+    if(lstat(socketPath, &socketStat) == 0)
+    {
+        if(!S_ISSOCK(socketStat.st_mode))
+        {
+            g_printerr("Control socket path %s exists and is not a socket\n", socketPath);
+            close(socketHandle);
+            return -1;
+        }
+
+        unlink(socketPath);
+    }
+
+    if((bind(socketHandle, (struct sockaddr *)&address, sizeof(address)) < 0) || (listen(socketHandle, DAEMON_MAX_CLIENTS) < 0))
+    {
+        g_printerr("Unable to bind control socket %s: %s\n", socketPath, strerror(errno));
+        close(socketHandle);
+        return -1;
+    }
+
+    return socketHandle;
+}
+
+int run_tuner_daemon(Tuner *tuner, const char *socketPath)
+{
+    int listenHandle;
+    uint8_t pos;
+
+    daemonTuner = tuner;
+
+    listenHandle = daemon_create_socket(socketPath);
+    if(listenHandle < 0)
+    {
+        return RESULT_FAIL;
+    }
+
+#ifdef DEBUG_LOGS
+    g_message("Tuner daemon is listening on %s", socketPath);
+#endif
+
+    daemonJob.tunerRef = tuner;
+    daemonJob.state = DJ_IDLE;
+    daemonJob.seekId = 0;
+    daemonJob.stationCount = 0;
+
+    if(tuner->set_scan_progress != NULL)
+    {
+        tuner->set_scan_progress(on_daemon_scan_progress);
+    }
+
+    daemonLoop = g_main_loop_new(NULL, FALSE);
+
+    // Telemetry, RDS capture and status publishing share the daemon main loop.
+    lastStatus.frequency = -1;
+    lastStatus.channel = BAND_PLAN_NO_CHANNEL;
+    if(tuner_core_init(tuner, g_main_context_default(), on_daemon_status_changed) == RESULT_FAIL)
+    {
+        close(listenHandle);
+        unlink(socketPath);
+        g_main_loop_unref(daemonLoop);
+        return RESULT_FAIL;
+    }
+
+    // Seek and survey jobs run on the seek worker of the command layer and advance on this loop.
+    command_set_scan_handler(on_daemon_seek_done);
+
+    g_unix_fd_add(listenHandle, G_IO_IN, on_daemon_client_connect, NULL);
+    g_unix_signal_add(SIGINT, on_daemon_terminate, NULL);
+    g_unix_signal_add(SIGTERM, on_daemon_terminate, NULL);
+
+    g_main_loop_run(daemonLoop);
+
+    // Tuner core shutdown stops the seek worker and waits for any running seek to finish.
+    daemonJob.state = DJ_IDLE;
+    tuner_core_shutdown();
+
+    // Release all clients and control socket.
+    for(pos = 0; pos < DAEMON_MAX_CLIENTS; pos++)
+    {
+        if(daemonClients[pos] != NULL)
+        {
+            daemon_close_client(daemonClients[pos], TRUE);
+        }
+    }
+
+    close(listenHandle);
+    unlink(socketPath);
+    g_main_loop_unref(daemonLoop);
+
+    return RESULT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Headless tuner daemon with Unix domain socket control interface.              *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_DAEMON_HEADER_
+#define _GTK_FM_TUNER_DAEMON_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "tuner.h"
+
+// Maximum number of simultaneous control clients.
+#define DAEMON_MAX_CLIENTS      16
+
+// Maximum length of a single command line (including line terminator).
+#define DAEMON_LINE_MAX_SIZE    128
+
+// Maximum number of stations reported by a single band survey.
+#define DAEMON_SURVEY_MAX_STATIONS  64
+
+typedef enum
+{
+    DJ_IDLE,    // No seek or survey is running.
+    DJ_SEEK,    // Seek next station in configured direction.
+    DJ_SURVEY   // Scan whole band and report all stations.
+} DaemonJobState;
+
+typedef struct DaemonClient
+{
+    int socketHandle;
+    guint sourceId;
+    gboolean subscribed;
+    gboolean disconnected;
+    uint16_t lineLength;
+    char lineBuffer[DAEMON_LINE_MAX_SIZE];
+} DaemonClient;
+
+// Jobs run one command layer seek at a time and advance on the daemon main loop as each seek finishes.
+typedef struct DaemonJobContext
+{
+    Tuner *tunerRef;
+    DaemonJobState state;
+    uint32_t seekId;            // Seek of the running job, results of other seeks are ignored.
+    double surveyFrequency;     // Station restored at the end of the survey.
+    int32_t surveyChannel;
+    uint16_t stationCount;
+} DaemonJobContext;
+
+int run_tuner_daemon(Tuner *tuner, const char *socketPath);
+
+#endif /* _GTK_FM_TUNER_DAEMON_HEADER_ */
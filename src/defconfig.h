@@ -31,12 +31,17 @@
 // Name of the application.
 #define APPLICATION_TITLE   "GTK FM Tuner"
 
-// Default FM band limits.
-#define LOW_FREQ    88.0
-#define HIGH_FREQ   108.0
+// Location of the UI definition inside the compiled resource bundle.
+#define UI_RESOURCE_PATH    "/com/jayakody2000lk/gtkfmtuner/gtkfmtuner.glade"
 
-// Minimum default frequency of the tuner.
-#define TUNER_MIN_FREQUENCY     LOW_FREQ
+// Default control socket of the headless tuner daemon.
+#define DAEMON_SOCKET_PATH  "/tmp/gtk-fm-tuner.sock"
+
+// Band plan used unless another one is selected with --band (see bandplan.h).
+#define DEFAULT_BAND_PLAN   BP_EUROPE_US
+
+// Time (us) a seek waits for RDS on a weak mono stop before rejecting it, 0 disables the RDS check.
+#define SCAN_VERIFY_RDS_TIME    120000
 
 // Switch to generate runtime logs (for development versions only).
 #define DEBUG_LOGS
@@ -47,4 +52,9 @@
 // Tuner used by the GTK FM Radio.
 #define TUNER   TUNER_QN8035
 
+// Tuner name stored in capture files.
+#if TUNER == TUNER_QN8035
+#define TUNER_NAME  "QN8035"
+#endif
+
 #endif /* _GTK_FM_TUNER_DEFCONFIG_HEADER_ */
\ No newline at end of file
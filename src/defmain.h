@@ -34,20 +34,12 @@
 #define RESULT_SUCCESS  0
 #define RESULT_FAIL     1
 
-typedef enum 
-{
-    ST_IDLE,    // Scanner is in idle state.
-    ST_START,   // Start scanning on configured frequency range.
-    ST_BUSY,    // Scanner is busy with finding the next station.
-    ST_END      // Terminate scan thread.
-} ScanThreadState;
-
 typedef enum
 {
     RD_IDLE,    // RDS processing thread is in idle state.
     RD_CAPTURE, // Capture and decode RDS data.
     RD_CLEAR,   // Clear RDS result and capture buffers.
-    RD_END      // Terminate RDS processing thread.
+    RD_END      // RDS capture is stopped.
 } RDSProcessState;
 
 typedef struct MainWindow
@@ -58,6 +50,8 @@ typedef struct MainWindow
     GtkLabel *SNR;
     GtkLabel *RSSI;
     GtkLabel *RDSText;
+    GtkWidget *signalMeter;
+    GtkLabel *lockOverlay;
 } MainWindow;
 
 typedef struct FreqWindow 
@@ -74,13 +68,32 @@ typedef struct StatusControls
     GtkLabel *SNR;
     GtkLabel *RSSI;
     GtkLabel *RDSText;
+
+    // Text currently shown in each label, used to skip redundant label updates.
+    char frequencyText[16];
+    char stereoText[8];
+    char snrText[16];
+    char rssiText[16];
+    char rdsText[32];
+
+    uint32_t labelUpdates;
+    uint32_t labelSkips;
 } StatusControls;
 
-typedef struct ScanContext
+// RSSI and SNR reading packed into one word, so it can be shared between threads with a single atomic access.
+#define SIGNAL_SAMPLE_PACK(rssi, snr)   ((gint)(((uint32_t)(rssi) << 16) | (uint16_t)(snr)))
+#define SIGNAL_SAMPLE_RSSI(sample)      ((int16_t)(((uint32_t)(sample)) >> 16))
+#define SIGNAL_SAMPLE_SNR(sample)       ((int16_t)((sample) & 0xFFFF))
+
+typedef struct TunerStatus
 {
-    Tuner *tunerRef;
-    ScanDirection scanDirection;
-    ScanThreadState state;
-} ScanContext;
+    double frequency;
+    int32_t channel;        // Channel index of the active band plan, BAND_PLAN_NO_CHANNEL if unknown.
+    int16_t rssi;
+    int16_t snr;
+    StereoMPXState mpxState;
+    uint16_t volume;
+    char rdsText[32];
+} TunerStatus;
 
 #endif /* _GTK_FM_TUNER_DEFMAIN_HEADER_ */
\ No newline at end of file
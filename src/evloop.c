@@ -0,0 +1,326 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Event loop core based on epoll, timerfd and eventfd.                          *
+ *                                                                               *
+ * All timers and notifications of the tuner are multiplexed into one epoll      *
+ * descriptor, which is attached to a GMainContext as a single GSource. The      *
+ * owning thread wakes up only when a timer expires or an event is posted.       *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "defconfig.h"
+#include "evloop.h"
+#include "metrics.h"
+
+static gboolean event_loop_prepare(GSource *source, gint *timeout)
+{
+    EventLoop *loop = (EventLoop *)source;
+
+    *timeout = -1;
+
+    // Loop thread is about to poll, on the virtual clock time may now jump to the next timer expiry.
+    if(loop->isVirtual)
+    {
+        clock_source_bind_thread(&loop->clockWaiter);
+        clock_source_block(&loop->clockWaiter);
+    }
+
+    return FALSE;
+}
+
+static gboolean event_loop_dispatch(GSource *source, GSourceFunc callback, gpointer userData)
+{
+    EventLoop *loop = (EventLoop *)source;
+    struct epoll_event events[EVENT_LOOP_MAX_SOURCES];
+    EventSource *eventSource;
+    uint64_t counter;
+    int eventCount, pos;
+
+    // External handles wake the loop without a post, it holds the virtual clock from here on.
+    if(loop->isVirtual)
+    {
+        clock_source_unblock(&loop->clockWaiter);
+    }
+
+    eventCount = epoll_wait(loop->epollHandle, events, EVENT_LOOP_MAX_SOURCES, 0);
+    if(eventCount <= 0)
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    loop->wakeups++;
+    metrics_count(MC_EVENT_LOOP_WAKEUPS, 1);
+
+    for(pos = 0; pos < eventCount; pos++)
+    {
+        eventSource = &loop->sources[events[pos].data.u32];
+
+        // Timer and notifier descriptors must be drained to clear their readiness.
+        if(eventSource->type != ES_HANDLE)
+        {
+            if(read(eventSource->handle, &counter, sizeof(counter)) != sizeof(counter))
+            {
+                continue;
+            }
+
+            eventSource->expirations = counter;
+            if(loop->isVirtual)
+            {
+                clock_source_consume(&loop->clockWaiter, counter);
+            }
+        }
+
+        eventSource->handler(eventSource->userData);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void event_loop_finalize(GSource *source)
+{
+    EventLoop *loop = (EventLoop *)source;
+    uint8_t pos;
+
+    for(pos = 0; pos < loop->sourceCount; pos++)
+    {
+        if(loop->isVirtual && (loop->sources[pos].type == ES_TIMER))
+        {
+            clock_source_set_alarm(&loop->sources[pos].alarm, 0);
+        }
+
+        if(loop->sources[pos].type != ES_HANDLE)
+        {
+            close(loop->sources[pos].handle);
+        }
+    }
+
+    close(loop->epollHandle);
+
+    if(loop->isVirtual)
+    {
+        clock_source_detach(&loop->clockWaiter);
+    }
+}
+
+static GSourceFuncs eventLoopFuncs =
+{
+    event_loop_prepare,
+    NULL,
+    event_loop_dispatch,
+    event_loop_finalize
+};
+
+EventLoop *event_loop_new(GMainContext *context)
+{
+    EventLoop *loop;
+    int epollHandle;
+
+    epollHandle = epoll_create1(EPOLL_CLOEXEC);
+    if(epollHandle < 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to create event loop: %s", strerror(errno));
+#endif
+        return NULL;
+    }
+
+    loop = (EventLoop *)g_source_new(&eventLoopFuncs, sizeof(EventLoop));
+    loop->epollHandle = epollHandle;
+    loop->sourceCount = 0;
+    loop->wakeups = 0;
+    loop->startTime = clock_source_now();
+
+    // Loop takes part in the virtual clock from its creation, time can not move until it first goes idle.
+    loop->isVirtual = clock_source_is_virtual();
+    memset(&loop->clockWaiter, 0, sizeof(ClockWaiter));
+    if(loop->isVirtual)
+    {
+        clock_source_attach(&loop->clockWaiter);
+    }
+
+    // GLib polls only the epoll descriptor, which becomes readable when any source is ready.
+    loop->epollTag = g_source_add_unix_fd((GSource *)loop, epollHandle, G_IO_IN);
+    g_source_set_name((GSource *)loop, "tuner-event-loop");
+    g_source_attach((GSource *)loop, context);
+
+    return loop;
+}
+
+void event_loop_destroy(EventLoop *loop)
+{
+    g_source_destroy((GSource *)loop);
+    g_source_unref((GSource *)loop);
+}
+
+static int event_loop_register(EventLoop *loop, int handle, uint32_t events, EventSourceType type, event_handler handler, gpointer userData)
+{
+    struct epoll_event event;
+    int sourceId;
+
+    if((handle < 0) || (loop->sourceCount >= EVENT_LOOP_MAX_SOURCES))
+    {
+        return -1;
+    }
+
+    sourceId = loop->sourceCount;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u32 = (uint32_t)sourceId;
+
+    if(epoll_ctl(loop->epollHandle, EPOLL_CTL_ADD, handle, &event) < 0)
+    {
+        return -1;
+    }
+
+    loop->sources[sourceId].handle = handle;
+    loop->sources[sourceId].type = type;
+    loop->sources[sourceId].handler = handler;
+    loop->sources[sourceId].userData = userData;
+    loop->sources[sourceId].expirations = 0;
+    loop->sourceCount++;
+
+    return sourceId;
+}
+
+int event_loop_add_timer(EventLoop *loop, event_handler handler, gpointer userData)
+{
+    int timerHandle, sourceId;
+
+    // Timer is created in disarmed state, use event_loop_set_timer to start it. On the virtual clock an alarm
+    // adds the expirations to an eventfd, so the handler reads the same count as from a timerfd.
+    if(loop->isVirtual)
+    {
+        timerHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    else
+    {
+        timerHandle = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+
+    sourceId = event_loop_register(loop, timerHandle, EPOLLIN, ES_TIMER, handler, userData);
+
+    if((sourceId < 0) && (timerHandle >= 0))
+    {
+        close(timerHandle);
+    }
+
+    if(sourceId >= 0)
+    {
+        memset(&loop->sources[sourceId].alarm, 0, sizeof(ClockAlarm));
+        loop->sources[sourceId].alarm.handle = timerHandle;
+        loop->sources[sourceId].alarm.waiter = &loop->clockWaiter;
+    }
+
+    return sourceId;
+}
+
+void event_loop_set_timer(EventLoop *loop, int sourceId, guint intervalMs)
+{
+    struct itimerspec timerSpec;
+
+    if((sourceId < 0) || (sourceId >= loop->sourceCount) || (loop->sources[sourceId].type != ES_TIMER))
+    {
+        return;
+    }
+
+    // Zero interval disarms the timer.
+    if(loop->isVirtual)
+    {
+        clock_source_set_alarm(&loop->sources[sourceId].alarm, (guint64)intervalMs * 1000);
+        return;
+    }
+
+    timerSpec.it_interval.tv_sec = intervalMs / 1000;
+    timerSpec.it_interval.tv_nsec = (intervalMs % 1000) * 1000000;
+    timerSpec.it_value = timerSpec.it_interval;
+
+    timerfd_settime(loop->sources[sourceId].handle, 0, &timerSpec, NULL);
+}
+
+guint64 event_loop_get_expirations(EventLoop *loop, int sourceId)
+{
+    // Valid inside the timer handler, a count above one means periods were missed.
+    if((sourceId < 0) || (sourceId >= loop->sourceCount) || (loop->sources[sourceId].type != ES_TIMER))
+    {
+        return 0;
+    }
+
+    return loop->sources[sourceId].expirations;
+}
+
+int event_loop_add_notifier(EventLoop *loop, event_handler handler, gpointer userData)
+{
+    int eventHandle, sourceId;
+
+    eventHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sourceId = event_loop_register(loop, eventHandle, EPOLLIN, ES_NOTIFIER, handler, userData);
+
+    if((sourceId < 0) && (eventHandle >= 0))
+    {
+        close(eventHandle);
+    }
+
+    return sourceId;
+}
+
+void event_loop_notify(EventLoop *loop, int sourceId)
+{
+    uint64_t counter = 1;
+
+    // Safe to call from any thread, multiple notifications collapse into one wakeup.
+    if((sourceId >= 0) && (sourceId < loop->sourceCount))
+    {
+        // Loop is woken on the virtual clock before the event is signalled, so time waits for the handler.
+        if(loop->isVirtual)
+        {
+            clock_source_post(&loop->clockWaiter, 1);
+        }
+
+        if(write(loop->sources[sourceId].handle, &counter, sizeof(counter)) != sizeof(counter))
+        {
+            // Counter is saturated, the loop is already scheduled to wake up.
+        }
+    }
+}
+
+int event_loop_add_handle(EventLoop *loop, int handle, uint32_t events, event_handler handler, gpointer userData)
+{
+    return event_loop_register(loop, handle, events, ES_HANDLE, handler, userData);
+}
+
+double event_loop_get_wakeup_rate(EventLoop *loop)
+{
+    gint64 elapsedTime = clock_source_now() - loop->startTime;
+
+    return (elapsedTime > 0) ? ((double)loop->wakeups * G_USEC_PER_SEC) / elapsedTime : 0;
+}
@@ -0,0 +1,86 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Event loop core based on epoll, timerfd and eventfd.                          *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_EVLOOP_HEADER_
+#define _GTK_FM_TUNER_EVLOOP_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "clocksource.h"
+
+// Maximum number of event sources handled by a single event loop.
+#define EVENT_LOOP_MAX_SOURCES  16
+
+typedef enum
+{
+    ES_TIMER,       // Periodic timer backed by timerfd (eventfd signalled by a clock alarm on the virtual clock).
+    ES_NOTIFIER,    // Cross thread notification backed by eventfd.
+    ES_HANDLE       // External file descriptor (GPIO, I2C readiness, sockets).
+} EventSourceType;
+
+// Event handler, invoked on the thread which runs the attached GMainContext.
+typedef void (*event_handler)(gpointer userData);
+
+typedef struct EventSource
+{
+    int handle;
+    EventSourceType type;
+    event_handler handler;
+    gpointer userData;
+    uint64_t expirations;   // Timer periods elapsed up to the current dispatch (1 unless the loop was late).
+    ClockAlarm alarm;       // Virtual timer, used instead of the timerfd on the virtual clock.
+} EventSource;
+
+typedef struct EventLoop
+{
+    GSource source;         // Must be the first member (GSource subclass).
+    int epollHandle;
+    gpointer epollTag;
+    uint8_t sourceCount;
+    EventSource sources[EVENT_LOOP_MAX_SOURCES];
+    volatile guint64 wakeups;
+    gint64 startTime;
+    gboolean isVirtual;     // Timers run on the virtual clock, the loop is a participant of it.
+    ClockWaiter clockWaiter;
+} EventLoop;
+
+EventLoop *event_loop_new(GMainContext *context);
+void event_loop_destroy(EventLoop *loop);
+
+int event_loop_add_timer(EventLoop *loop, event_handler handler, gpointer userData);
+void event_loop_set_timer(EventLoop *loop, int sourceId, guint intervalMs);
+guint64 event_loop_get_expirations(EventLoop *loop, int sourceId);
+
+int event_loop_add_notifier(EventLoop *loop, event_handler handler, gpointer userData);
+void event_loop_notify(EventLoop *loop, int sourceId);
+
+int event_loop_add_handle(EventLoop *loop, int handle, uint32_t events, event_handler handler, gpointer userData);
+
+double event_loop_get_wakeup_rate(EventLoop *loop);
+
+#endif /* _GTK_FM_TUNER_EVLOOP_HEADER_ */
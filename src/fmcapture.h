@@ -0,0 +1,120 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Binary RDS/telemetry capture file format (public reader interface).           *
+ *                                                                               *
+ * This header has no dependencies other than the C library, so external         *
+ * programs can include it directly. File is a FMCaptureHeader followed by       *
+ * blocks of FMCAPTURE_BLOCK_RECORDS fixed size records. Every block starts      *
+ * with a FMCaptureBlock index entry, only the last block may be incomplete.     *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_FMCAPTURE_HEADER_
+#define _GTK_FM_TUNER_FMCAPTURE_HEADER_
+
+#include <stdint.h>
+
+#define FMCAPTURE_MAGIC             0x43524D46  // "FMRC"
+#define FMCAPTURE_BLOCK_MAGIC       0x58494D46  // "FMIX"
+#define FMCAPTURE_VERSION           1
+
+// Number of records in every block (except the last one).
+#define FMCAPTURE_BLOCK_RECORDS     256
+
+// Record types.
+#define FMCAPTURE_RECORD_NONE       0   // Padding, used to close a block early.
+#define FMCAPTURE_RECORD_RDS        1   // Raw RDS group.
+#define FMCAPTURE_RECORD_TELEMETRY  2   // Tuner status sample.
+
+typedef struct FMCaptureHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;        // sizeof(FMCaptureRecord).
+    uint16_t blockSize;         // sizeof(FMCaptureBlock).
+    uint16_t blockRecords;      // FMCAPTURE_BLOCK_RECORDS.
+    uint32_t alignment;         // Keeps the 64-bit fields aligned without compiler padding, always 0.
+    uint64_t startRealTime;     // Wall clock time of the capture start in us since the epoch.
+    uint64_t startTime;         // CLOCK_MONOTONIC time of the capture start in us.
+    char tunerName[16];
+    uint8_t reserved[24];
+} FMCaptureHeader;
+
+typedef struct FMCaptureBlock
+{
+    uint32_t magic;
+    uint32_t blockNumber;
+    uint64_t baseTime;          // Time of the block in us since the capture start.
+    uint64_t realTime;          // Wall clock time of the block in us since the epoch.
+    uint32_t firstRecord;       // Index of the first record of the block in the whole capture.
+    uint32_t reserved;
+} FMCaptureBlock;
+
+typedef struct FMCaptureRecord
+{
+    uint32_t timeOffset;        // Time of the record in us since the block base time.
+    uint8_t type;               // FMCAPTURE_RECORD_* value.
+    uint8_t status;             // RDS: tuner RDS status, telemetry: FMSTATUS_MPX_* stereo state.
+    uint16_t data[5];           // RDS: blocks A, B, C, D; telemetry: frequency (10 kHz), RSSI, SNR, volume.
+} FMCaptureRecord;
+
+// On-disk layout has no implicit padding, the sizes are part of the file format.
+_Static_assert(sizeof(FMCaptureHeader) == 72, "FMCaptureHeader must be 72 bytes");
+_Static_assert(sizeof(FMCaptureBlock) == 32, "FMCaptureBlock must be 32 bytes");
+_Static_assert(sizeof(FMCaptureRecord) == 16, "FMCaptureRecord must be 16 bytes");
+
+// Size of a complete block including its index entry.
+#define FMCAPTURE_BLOCK_BYTES       (sizeof(FMCaptureBlock) + (FMCAPTURE_BLOCK_RECORDS * sizeof(FMCaptureRecord)))
+
+// Number of complete records in a capture file of the specified size.
+static inline uint32_t fmcapture_record_count(uint64_t fileSize)
+{
+    uint64_t dataSize, fullBlocks, lastBlock;
+
+    if(fileSize <= sizeof(FMCaptureHeader))
+    {
+        return 0;
+    }
+
+    dataSize = fileSize - sizeof(FMCaptureHeader);
+    fullBlocks = dataSize / FMCAPTURE_BLOCK_BYTES;
+    lastBlock = dataSize % FMCAPTURE_BLOCK_BYTES;
+    lastBlock = (lastBlock > sizeof(FMCaptureBlock)) ? ((lastBlock - sizeof(FMCaptureBlock)) / sizeof(FMCaptureRecord)) : 0;
+
+    return (uint32_t)((fullBlocks * FMCAPTURE_BLOCK_RECORDS) + lastBlock);
+}
+
+// File offset of the block which contains the specified record.
+static inline uint64_t fmcapture_block_offset(uint32_t recordIndex)
+{
+    return sizeof(FMCaptureHeader) + ((uint64_t)(recordIndex / FMCAPTURE_BLOCK_RECORDS) * FMCAPTURE_BLOCK_BYTES);
+}
+
+// File offset of the specified record.
+static inline uint64_t fmcapture_record_offset(uint32_t recordIndex)
+{
+    return fmcapture_block_offset(recordIndex) + sizeof(FMCaptureBlock) + ((recordIndex % FMCAPTURE_BLOCK_RECORDS) * sizeof(FMCaptureRecord));
+}
+
+#endif /* _GTK_FM_TUNER_FMCAPTURE_HEADER_ */
@@ -0,0 +1,145 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Shared memory tuner status segment (public reader interface).                 *
+ *                                                                               *
+ * This header has no dependencies other than the C library, so external         *
+ * programs can include it directly. Map FMSTATUS_SHM_NAME read-only with        *
+ * shm_open/mmap and call fmstatus_read to get a consistent snapshot.            *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_FMSTATUS_HEADER_
+#define _GTK_FM_TUNER_FMSTATUS_HEADER_
+
+#include <stdint.h>
+#include <string.h>
+
+// POSIX shared memory object name of the status segment.
+#define FMSTATUS_SHM_NAME       "/gtk-fm-tuner-status"
+
+#define FMSTATUS_MAGIC          0x464D5354  // "FMST"
+#define FMSTATUS_VERSION        3
+
+#define FMSTATUS_RDS_SIZE       16
+
+// Number of RDS group types in the group histogram (0A, 0B, 1A ... 15B).
+#define FMSTATUS_RDS_GROUP_TYPES    32
+
+// Value of the RDS acquisition times until the item is received.
+#define FMSTATUS_RDS_TIME_NONE      0xFFFFFFFF
+
+// Values of FMStatusSnapshot.stereo.
+#define FMSTATUS_MPX_STEREO     0
+#define FMSTATUS_MPX_MONO       1
+#define FMSTATUS_MPX_UNKNOWN    2
+
+// RDS reception statistics of the tuned station.
+typedef struct FMStatusRDSStats
+{
+    uint32_t groups;                    // Groups received on the station.
+    uint32_t validGroups;               // Groups without any block error.
+    uint32_t blocks;                    // Received blocks (4 per group).
+    uint32_t blockErrors;               // Uncorrectable blocks, block error rate = blockErrors / blocks.
+    uint32_t missedGroups;              // Estimated number of groups lost between received groups.
+    uint32_t groupRate;                 // Valid groups per second * 100.
+    uint32_t timeToPI;                  // Time from tuning to the first valid PI code in ms.
+    uint32_t timeToPS;                  // Time from tuning to the complete PS name in ms.
+    uint16_t pi;                        // Last valid program identification code.
+    uint16_t reserved;
+    uint32_t groupTypes[FMSTATUS_RDS_GROUP_TYPES];  // Group type histogram, index = (type * 2) + version.
+} FMStatusRDSStats;
+
+// Clock time received in RDS group 4A.
+typedef struct FMStatusClock
+{
+    int64_t utcTime;                    // UTC time of the last received minute edge in us since the epoch, 0 if none.
+    uint64_t edgeTime;                  // CLOCK_MONOTONIC time of that minute edge in us.
+    int16_t localOffset;                // Local time offset in minutes.
+    uint8_t quality;                    // Quality score 0-100 at the time of the update.
+    uint8_t locked;                     // 1 if enough consecutive consistent clock groups were received.
+    uint32_t latency;                   // Capture to publish latency of the update in us.
+} FMStatusClock;
+
+typedef struct FMStatusSnapshot
+{
+    uint32_t frequency;                 // Tuned frequency in kHz.
+    int16_t rssi;                       // Received signal strength indicator.
+    int16_t snr;                        // Signal to noise ratio.
+    uint8_t stereo;                     // FMSTATUS_MPX_* value.
+    uint8_t volume;                     // Tuner volume level.
+    uint16_t reserved;
+    uint64_t updateTime;                // CLOCK_MONOTONIC time of last update in us.
+    char rdsText[FMSTATUS_RDS_SIZE];    // Decoded RDS PS text (null terminated).
+    FMStatusRDSStats rdsStats;
+    FMStatusClock rdsClock;
+} FMStatusSnapshot;
+
+typedef struct FMStatusSegment
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sequence;                  // Odd while the writer is updating the snapshot.
+    uint32_t writerPid;
+    FMStatusSnapshot snapshot;
+} FMStatusSegment;
+
+// Copy consistent snapshot from the segment without any system calls, returns 0 on success.
+static inline int fmstatus_read(const FMStatusSegment *segment, FMStatusSnapshot *snapshot)
+{
+    uint32_t startSeq;
+    uint16_t tryCount;
+
+    if((segment->magic != FMSTATUS_MAGIC) || (segment->version != FMSTATUS_VERSION))
+    {
+        return -1;
+    }
+
+    for(tryCount = 0; tryCount < 1000; tryCount++)
+    {
+        startSeq = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if(startSeq & 1)
+        {
+            // Writer is in the middle of an update.
+            continue;
+        }
+
+        memcpy(snapshot, (const void *)&segment->snapshot, sizeof(FMStatusSnapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if(__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == startSeq)
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+// Generation counter, changes every time the writer publishes a new snapshot.
+static inline uint32_t fmstatus_generation(const FMStatusSegment *segment)
+{
+    return __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE) >> 1;
+}
+
+#endif /* _GTK_FM_TUNER_FMSTATUS_HEADER_ */
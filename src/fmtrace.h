@@ -0,0 +1,125 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Binary trace file format and trace event definitions (public reader           *
+ * interface).                                                                   *
+ *                                                                               *
+ * This header has no dependencies other than the C library, so external         *
+ * programs can include it directly. File is a FMTraceHeader followed by         *
+ * fixed size FMTraceRecord entries in flush order, readers sort them by the     *
+ * timestamp. Event text is kept here, records only carry the event number.      *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_FMTRACE_HEADER_
+#define _GTK_FM_TUNER_FMTRACE_HEADER_
+
+#include <stdint.h>
+
+#define FMTRACE_MAGIC           0x52544D46  // "FMTR"
+#define FMTRACE_VERSION         1
+
+// Number of integer arguments carried by every record.
+#define FMTRACE_MAX_ARGS        4
+
+// Trace subsystems, verbosity is set separately for each of them.
+typedef enum
+{
+    TS_TUNER,
+    TS_SCAN,
+    TS_CORE,
+    TS_RDS,
+    TS_SWEEP,
+    TS_DAEMON,
+    TS_UI,
+    TS_COUNT
+} FMTraceSubsystem;
+
+typedef enum
+{
+    TL_OFF,
+    TL_ERROR,
+    TL_INFO,
+    TL_DEBUG
+} FMTraceLevel;
+
+// Trace events: identifier, subsystem, level and printf format of the arguments.
+#define FMTRACE_EVENTS(EVENT) \
+    EVENT(TE_TUNER_SET_FREQUENCY,   TS_TUNER,   TL_INFO,    "Set tuner frequency = %d") \
+    EVENT(TE_TUNER_SET_VOLUME,      TS_TUNER,   TL_INFO,    "Set tuner volume = %d") \
+    EVENT(TE_TUNER_CHANGE_VOLUME,   TS_TUNER,   TL_INFO,    "Change tuner volume in direction = %d") \
+    EVENT(TE_SCAN_START,            TS_SCAN,    TL_INFO,    "Scan tuner in direction = %d") \
+    EVENT(TE_SCAN_POLL,             TS_SCAN,    TL_DEBUG,   "Scanner is checking frequency = %d") \
+    EVENT(TE_SCAN_PREEMPTED,        TS_SCAN,    TL_INFO,    "Scan preempted") \
+    EVENT(TE_SCAN_COMPLETED,        TS_SCAN,    TL_INFO,    "Scanner stopped in frequency = %d") \
+    EVENT(TE_CORE_RDS_RATE,         TS_CORE,    TL_DEBUG,   "RDS capture period changed to %d ms") \
+    EVENT(TE_RDS_CLOCK,             TS_RDS,     TL_INFO,    "RDS clock minute %d (since epoch) consistent %d, residual %d us, latency %d us") \
+    EVENT(TE_SWEEP_START,           TS_SWEEP,   TL_INFO,    "Sweep started with %d kHz step, %d channels") \
+    EVENT(TE_SWEEP_STOP,            TS_SWEEP,   TL_INFO,    "Sweep stopped") \
+    EVENT(TE_DAEMON_CLIENT,         TS_DAEMON,  TL_INFO,    "Daemon client connected on slot %d") \
+    EVENT(TE_UI_VISIBILITY,         TS_UI,      TL_INFO,    "Main window visibility = %d") \
+    EVENT(TE_SCAN_REJECTED,         TS_SCAN,    TL_INFO,    "False stop rejected in frequency = %d") \
+    EVENT(TE_I2C_HEALTH,            TS_TUNER,   TL_ERROR,   "I2C device 0x%02X health changed to %d") \
+    EVENT(TE_TUNER_LOST,            TS_TUNER,   TL_ERROR,   "Tuner lost, loss count = %d") \
+    EVENT(TE_TUNER_RECONNECTED,     TS_TUNER,   TL_ERROR,   "Tuner reconnected after %d ms, %d attempts")
+
+#define FMTRACE_EVENT_ID(id, subsystem, level, text)        id,
+#define FMTRACE_EVENT_SUBSYSTEM(id, subsystem, level, text) subsystem,
+#define FMTRACE_EVENT_LEVEL(id, subsystem, level, text)     level,
+#define FMTRACE_EVENT_TEXT(id, subsystem, level, text)      text,
+
+typedef enum
+{
+    FMTRACE_EVENTS(FMTRACE_EVENT_ID)
+    TE_COUNT
+} FMTraceEvent;
+
+static const uint8_t fmtraceEventSubsystem[] = { FMTRACE_EVENTS(FMTRACE_EVENT_SUBSYSTEM) };
+static const uint8_t fmtraceEventLevel[] = { FMTRACE_EVENTS(FMTRACE_EVENT_LEVEL) };
+static const char *const fmtraceEventText[] = { FMTRACE_EVENTS(FMTRACE_EVENT_TEXT) };
+
+static const char *const fmtraceSubsystemName[] = {"tuner", "scan", "core", "rds", "sweep", "daemon", "ui"};
+static const char *const fmtraceLevelName[] = {"off", "error", "info", "debug"};
+
+typedef struct FMTraceHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;        // sizeof(FMTraceRecord).
+    uint16_t eventCount;        // TE_COUNT of the writer.
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint64_t startRealTime;     // Wall clock time of the trace start in ns since the epoch.
+    uint64_t startTime;         // CLOCK_MONOTONIC time of the trace start in ns.
+} FMTraceHeader;
+
+typedef struct FMTraceRecord
+{
+    uint64_t timestamp;         // CLOCK_MONOTONIC time in ns.
+    uint16_t eventId;           // FMTraceEvent value.
+    uint16_t threadId;          // Trace thread number, assigned in thread start order.
+    uint32_t reserved;
+    int32_t args[FMTRACE_MAX_ARGS];
+} FMTraceRecord;
+
+#endif /* _GTK_FM_TUNER_FMTRACE_HEADER_ */
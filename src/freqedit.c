@@ -35,15 +35,21 @@
 
 FreqWindow freqEditor;
 
-uint8_t show_frequency_edit_window(GtkWidget *parent, double *freq)
+static uint8_t create_frequency_edit_window()
 {
-    char freqStr[12];
-    char *newFreq, *dummy;
     GtkBuilder *builder;
-    gint result;
+    gchar *objectIds[] = {"freq-edit", NULL};
 
-    // Load frequency editor dialog box from glade file.
-    builder = gtk_builder_new_from_file("glade/gtkfmtuner.glade");
+    // Load only the frequency editor dialog box from the UI resource.
+    builder = gtk_builder_new();
+    if(gtk_builder_add_objects_from_resource(builder, UI_RESOURCE_PATH, objectIds, NULL) == 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to load frequency editor from UI resource");
+#endif
+        g_object_unref(builder);
+        return RESULT_FAIL;
+    }
 
     freqEditor.window = GTK_WIDGET(gtk_builder_get_object(builder, "freq-edit"));
     freqEditor.freqEntry = GTK_ENTRY(gtk_builder_get_object(builder, "txtFreqEditInput"));
@@ -52,6 +58,27 @@ uint8_t show_frequency_edit_window(GtkWidget *parent, double *freq)
     // Setup events and release builder.
     gtk_builder_connect_signals(builder, NULL);
     g_object_unref(builder);
+
+    // Keep dialog box alive after closing it from the title bar, so it can be reused.
+    g_signal_connect(freqEditor.window, "delete-event", G_CALLBACK(gtk_widget_hide_on_delete), NULL);
+
+    gtk_widget_set_can_default(GTK_WIDGET(freqEditor.defaultButton), TRUE);
+    gtk_window_set_title(GTK_WINDOW(freqEditor.window), "Change Frequency");
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t show_frequency_edit_window(GtkWidget *parent, double *freq)
+{
+    char freqStr[12];
+    char *newFreq, *dummy;
+    gint result;
+
+    // Frequency editor dialog box is created on first use and reused afterwards.
+    if((freqEditor.window == NULL) && (create_frequency_edit_window() == RESULT_FAIL))
+    {
+        return RESULT_FAIL;
+    }
     
     // Set specified frequency to the edit field.
 #ifdef DEBUG_LOGS
@@ -62,11 +89,10 @@ uint8_t show_frequency_edit_window(GtkWidget *parent, double *freq)
     gtk_entry_set_text(freqEditor.freqEntry, freqStr);
 
     // Show frequency editor dialog box.
-    gtk_widget_set_can_default(GTK_WIDGET(freqEditor.defaultButton), TRUE);
     gtk_widget_grab_default(GTK_WIDGET(freqEditor.defaultButton));
+    gtk_widget_grab_focus(GTK_WIDGET(freqEditor.freqEntry));
 
     gtk_window_set_transient_for(GTK_WINDOW(freqEditor.window), GTK_WINDOW(parent));
-    gtk_window_set_title(GTK_WINDOW(freqEditor.window), "Change Frequency");
 
     result = gtk_dialog_run(GTK_DIALOG(freqEditor.window));
 
@@ -80,9 +106,8 @@ uint8_t show_frequency_edit_window(GtkWidget *parent, double *freq)
 #endif
     }
 
-    // Release frequency editor window.
-    gtk_widget_destroy(freqEditor.window);
-    freqEditor.window = NULL;
+    // Hide frequency editor window and keep it for the next request.
+    gtk_widget_hide(freqEditor.window);
 
     return (result == GTK_RESPONSE_OK) ? RESULT_SUCCESS : RESULT_FAIL;
 }
@@ -110,7 +135,7 @@ void on_btnFreqEditOK_clicked()
         else
         {
             // Perform range check!
-            if((userDoubleResult >= LOW_FREQ) && (userDoubleResult <= HIGH_FREQ))
+            if(band_plan_mhz_to_channel(band_plan_get(), userDoubleResult) != BAND_PLAN_NO_CHANNEL)
             {
                 // Specified value is a valid number.
                 validationStatus = RESULT_SUCCESS;
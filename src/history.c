@@ -0,0 +1,194 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Bounded multi-resolution history of the received signal quality.              *
+ * Every level is a fixed ring of 4 byte samples. Coarser levels are built       *
+ * incrementally while samples are inserted, so reading any time range at any    *
+ * zoom level never needs a rescan of the finer data.                            *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "history.h"
+
+static volatile gint levelSamples0[HISTORY_DURATION / HISTORY_L0_PERIOD];
+static volatile gint levelSamples1[HISTORY_DURATION / HISTORY_L1_PERIOD];
+static volatile gint levelSamples2[HISTORY_DURATION / HISTORY_L2_PERIOD];
+
+static HistoryLevel historyLevels[HISTORY_LEVELS] =
+{
+    {HISTORY_L0_PERIOD, (HISTORY_DURATION / HISTORY_L0_PERIOD), 0, levelSamples0},
+    {HISTORY_L1_PERIOD, (HISTORY_DURATION / HISTORY_L1_PERIOD), 0, levelSamples1},
+    {HISTORY_L2_PERIOD, (HISTORY_DURATION / HISTORY_L2_PERIOD), 0, levelSamples2}
+};
+
+static gint64 historyStartTime;
+
+static void history_reset_accumulator(HistoryAccumulator *accumulator)
+{
+    memset(accumulator, 0, sizeof(HistoryAccumulator));
+    accumulator->rssiMin = 0xFF;
+}
+
+static void history_accumulate(HistoryAccumulator *accumulator, HistorySample sample)
+{
+    accumulator->count++;
+    accumulator->flags |= (sample.value.flags & HISTORY_FLAG_RETUNED);
+
+    if(sample.value.flags & HISTORY_FLAG_VALID)
+    {
+        accumulator->rssiSum += sample.value.rssi;
+        accumulator->snrSum += sample.value.snr;
+        accumulator->stereoSum += (sample.value.flags & HISTORY_STEREO_MASK);
+        accumulator->rssiMin = MIN(accumulator->rssiMin, sample.value.rssiMin);
+        accumulator->validCount++;
+    }
+}
+
+static HistorySample history_accumulated_sample(HistoryAccumulator *accumulator)
+{
+    HistorySample sample;
+
+    sample.raw = 0;
+    sample.value.flags = accumulator->flags;
+
+    if(accumulator->validCount > 0)
+    {
+        sample.value.rssi = (uint8_t)(accumulator->rssiSum / accumulator->validCount);
+        sample.value.snr = (uint8_t)(accumulator->snrSum / accumulator->validCount);
+        sample.value.rssiMin = accumulator->rssiMin;
+        sample.value.flags |= HISTORY_FLAG_VALID | (uint8_t)((accumulator->stereoSum + (accumulator->validCount / 2)) / accumulator->validCount);
+    }
+
+    return sample;
+}
+
+static void history_push(uint8_t level, HistorySample sample)
+{
+    HistoryLevel *historyLevel = &historyLevels[level];
+    HistoryLevel *nextLevel;
+
+    // Only the tuner core writes, so the write counter itself can be read without atomics here.
+    g_atomic_int_set(&historyLevel->samples[historyLevel->writeCount % historyLevel->capacity], sample.raw);
+    g_atomic_int_set(&historyLevel->writeCount, historyLevel->writeCount + 1);
+
+    if((level + 1) >= HISTORY_LEVELS)
+    {
+        return;
+    }
+
+    // Feed the next level, it receives one sample after each of its periods.
+    nextLevel = &historyLevels[level + 1];
+    history_accumulate(&historyLevel->accumulator, sample);
+
+    if(historyLevel->accumulator.count >= (nextLevel->period / historyLevel->period))
+    {
+        history_push(level + 1, history_accumulated_sample(&historyLevel->accumulator));
+        history_reset_accumulator(&historyLevel->accumulator);
+    }
+}
+
+void signal_history_init()
+{
+    uint8_t level;
+
+    for(level = 0; level < HISTORY_LEVELS; level++)
+    {
+        historyLevels[level].writeCount = 0;
+        history_reset_accumulator(&historyLevels[level].accumulator);
+    }
+
+    historyStartTime = g_get_real_time();
+}
+
+void signal_history_add(int16_t rssi, int16_t snr, StereoMPXState mpxState, gboolean retuned)
+{
+    HistorySample sample;
+
+    sample.raw = 0;
+    sample.value.flags = retuned ? HISTORY_FLAG_RETUNED : 0;
+
+    // Readings are not available while the tuner is busy (e.g. seeking).
+    if((rssi >= 0) && (snr >= 0))
+    {
+        sample.value.rssi = (uint8_t)MIN(rssi, 0xFF);
+        sample.value.snr = (uint8_t)MIN(snr, 0xFF);
+        sample.value.rssiMin = sample.value.rssi;
+        sample.value.flags |= HISTORY_FLAG_VALID | ((mpxState == MPXS_STEREO) ? HISTORY_STEREO_MASK : 0);
+    }
+
+    history_push(0, sample);
+}
+
+void signal_history_add_gap(guint64 count)
+{
+    HistorySample sample;
+
+    // Periods without a reading (e.g. a stalled loop) still take a slot, sample index stays tied to time.
+    sample.raw = 0;
+    while(count > 0)
+    {
+        history_push(0, sample);
+        count--;
+    }
+}
+
+uint32_t signal_history_get_period(uint8_t level)
+{
+    return historyLevels[level].period;
+}
+
+gint signal_history_get_range(uint8_t level, gint *firstIndex)
+{
+    HistoryLevel *historyLevel = &historyLevels[level];
+    gint writeCount = g_atomic_int_get(&historyLevel->writeCount);
+
+    // Oldest slot is kept out of the range, the writer may be overwriting it right now.
+    *firstIndex = (writeCount >= (gint)historyLevel->capacity) ? (writeCount - historyLevel->capacity + 1) : 0;
+    return writeCount;
+}
+
+gboolean signal_history_read(uint8_t level, gint index, HistorySample *sample)
+{
+    HistoryLevel *historyLevel = &historyLevels[level];
+    gint firstIndex, endIndex;
+
+    endIndex = signal_history_get_range(level, &firstIndex);
+    if((index < firstIndex) || (index >= endIndex))
+    {
+        sample->raw = 0;
+        return FALSE;
+    }
+
+    sample->raw = g_atomic_int_get(&historyLevel->samples[index % historyLevel->capacity]);
+    return TRUE;
+}
+
+gint64 signal_history_get_start_time()
+{
+    // Sample N of a level covers the time from start time + (N * period) seconds, missed periods are stored as gaps.
+    return historyStartTime;
+}
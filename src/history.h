@@ -0,0 +1,93 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Bounded multi-resolution history of the received signal quality.              *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_HISTORY_HEADER_
+#define _GTK_FM_TUNER_HISTORY_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "tuner.h"
+
+// Number of resolution levels and time covered by each of them (in seconds).
+#define HISTORY_LEVELS          3
+#define HISTORY_DURATION        (24 * 60 * 60)
+
+// Sample period of the levels in seconds.
+#define HISTORY_L0_PERIOD       1
+#define HISTORY_L1_PERIOD       10
+#define HISTORY_L2_PERIOD       60
+
+// Sample flags.
+#define HISTORY_FLAG_VALID      0x80    // Sample has at least one valid reading.
+#define HISTORY_FLAG_RETUNED    0x40    // Tuner frequency has changed within the sample period.
+#define HISTORY_STEREO_MASK     0x0F    // Ratio of stereo readings (0 - 15).
+
+// Compact 4 byte sample, stored as one word so it can be read without locks.
+typedef union HistorySample
+{
+    struct
+    {
+        uint8_t rssi;       // Average RSSI.
+        uint8_t snr;        // Average SNR.
+        uint8_t rssiMin;    // Lowest RSSI, keeps short dropouts visible in the coarse levels.
+        uint8_t flags;
+    } value;
+    gint raw;
+} HistorySample;
+
+// Running totals for the sample of the next (coarser) level.
+typedef struct HistoryAccumulator
+{
+    uint32_t rssiSum;
+    uint32_t snrSum;
+    uint32_t stereoSum;
+    uint8_t rssiMin;
+    uint8_t flags;
+    uint16_t validCount;
+    uint16_t count;
+} HistoryAccumulator;
+
+typedef struct HistoryLevel
+{
+    uint32_t period;            // Sample period in seconds.
+    uint32_t capacity;          // Number of samples in the ring.
+    volatile gint writeCount;   // Total number of samples written into this level.
+    volatile gint *samples;
+    HistoryAccumulator accumulator;
+} HistoryLevel;
+
+void signal_history_init(void);
+void signal_history_add(int16_t rssi, int16_t snr, StereoMPXState mpxState, gboolean retuned);
+void signal_history_add_gap(guint64 count);
+
+uint32_t signal_history_get_period(uint8_t level);
+gint signal_history_get_range(uint8_t level, gint *firstIndex);
+gboolean signal_history_read(uint8_t level, gint index, HistorySample *sample);
+gint64 signal_history_get_start_time(void);
+
+#endif /* _GTK_FM_TUNER_HISTORY_HEADER_ */
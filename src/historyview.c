@@ -0,0 +1,364 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Signal history window, strip chart of RSSI/SNR/stereo over time.              *
+ * Chart reads only the samples of the visible window from the selected          *
+ * history level, so zoom and scroll cost the same for any history length.       *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <gtk/gtk.h>
+#include <stdlib.h>
+
+#include "historyview.h"
+#include "history.h"
+
+// Chart colors (0xRRGGBB).
+#define COLOR_BACKGROUND    0x2E3436
+#define COLOR_GRID          0x555753
+#define COLOR_TEXT          0xD3D7CF
+#define COLOR_NO_DATA       0x3C4042
+#define COLOR_RSSI_MIN      0x3D6B0F
+#define COLOR_RSSI          0x73D216
+#define COLOR_SNR           0x729FCF
+#define COLOR_STEREO        0xFCE94F
+#define COLOR_RETUNED       0xEF2929
+
+// RSSI/SNR grid line interval.
+#define HISTORY_GRID_STEP   20
+
+HistoryWindow historyWindow;
+
+static void set_color(cairo_t *cr, uint32_t color)
+{
+    cairo_set_source_rgb(cr, ((color >> 16) & 0xFF) / 255.0, ((color >> 8) & 0xFF) / 255.0, (color & 0xFF) / 255.0);
+}
+
+static int history_chart_height()
+{
+    return historyWindow.height - HISTORY_VIEW_AXIS_HEIGHT - HISTORY_VIEW_STEREO_HEIGHT;
+}
+
+static int history_value_y(uint8_t value, int chartHeight)
+{
+    return chartHeight - 1 - ((MIN(value, HISTORY_VIEW_SCALE) * (chartHeight - 1)) / HISTORY_VIEW_SCALE);
+}
+
+static void render_history_column(cairo_t *cr, int column, gint index)
+{
+    HistorySample sample;
+    int chartHeight = history_chart_height();
+    int rssiMinY, gridValue;
+
+    if((!signal_history_read(historyWindow.level, index, &sample)) || (!(sample.value.flags & HISTORY_FLAG_VALID)))
+    {
+        // No readings for this period (before start of history or tuner was busy).
+        set_color(cr, COLOR_NO_DATA);
+        cairo_rectangle(cr, column, 0, 1, chartHeight + HISTORY_VIEW_STEREO_HEIGHT);
+        cairo_fill(cr);
+        return;
+    }
+
+    set_color(cr, COLOR_GRID);
+    for(gridValue = HISTORY_GRID_STEP; gridValue < HISTORY_VIEW_SCALE; gridValue += HISTORY_GRID_STEP)
+    {
+        cairo_rectangle(cr, column, history_value_y(gridValue, chartHeight), 1, 1);
+    }
+    cairo_fill(cr);
+
+    // Lowest RSSI as an area, dropouts show up as notches even in the coarse levels.
+    rssiMinY = history_value_y(sample.value.rssiMin, chartHeight);
+    set_color(cr, COLOR_RSSI_MIN);
+    cairo_rectangle(cr, column, rssiMinY, 1, chartHeight - rssiMinY);
+    cairo_fill(cr);
+
+    set_color(cr, COLOR_RSSI);
+    cairo_rectangle(cr, column, history_value_y(sample.value.rssi, chartHeight), 1, 2);
+    cairo_fill(cr);
+
+    set_color(cr, COLOR_SNR);
+    cairo_rectangle(cr, column, history_value_y(sample.value.snr, chartHeight), 1, 2);
+    cairo_fill(cr);
+
+    if(sample.value.flags & HISTORY_FLAG_RETUNED)
+    {
+        set_color(cr, COLOR_RETUNED);
+        cairo_rectangle(cr, column, 0, 1, chartHeight);
+        cairo_fill(cr);
+    }
+
+    // Stereo band brightness follows the ratio of stereo readings in the period.
+    cairo_set_source_rgb(cr, (0xFC / 255.0) * (sample.value.flags & HISTORY_STEREO_MASK) / HISTORY_STEREO_MASK,
+        (0xE9 / 255.0) * (sample.value.flags & HISTORY_STEREO_MASK) / HISTORY_STEREO_MASK, (0x4F / 255.0) * (sample.value.flags & HISTORY_STEREO_MASK) / HISTORY_STEREO_MASK);
+    cairo_rectangle(cr, column, chartHeight, 1, HISTORY_VIEW_STEREO_HEIGHT);
+    cairo_fill(cr);
+}
+
+static void render_time_axis(cairo_t *cr, gint firstIndex)
+{
+    GDateTime *labelTime;
+    gchar *labelText;
+    uint32_t period = signal_history_get_period(historyWindow.level);
+    gint64 startTime = signal_history_get_start_time() / G_USEC_PER_SEC;
+    int column;
+
+    set_color(cr, COLOR_TEXT);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 9);
+
+    for(column = 0; column < (historyWindow.width - (HISTORY_VIEW_LABEL_SPACING / 2)); column += HISTORY_VIEW_LABEL_SPACING)
+    {
+        labelTime = g_date_time_new_from_unix_local(startTime + ((gint64)(firstIndex + column) * period));
+        labelText = g_date_time_format(labelTime, (historyWindow.level == 0) ? "%H:%M:%S" : "%H:%M");
+
+        set_color(cr, COLOR_GRID);
+        cairo_rectangle(cr, column, history_chart_height() + HISTORY_VIEW_STEREO_HEIGHT, 1, 3);
+        cairo_fill(cr);
+
+        set_color(cr, COLOR_TEXT);
+        cairo_move_to(cr, column + 2, historyWindow.height - 3);
+        cairo_show_text(cr, labelText);
+
+        g_free(labelText);
+        g_date_time_unref(labelTime);
+    }
+}
+
+static void render_signal_history()
+{
+    cairo_t *cr;
+    gint firstIndex;
+    int column;
+
+    if(historyWindow.backingSurface == NULL)
+    {
+        return;
+    }
+
+    firstIndex = (gint)gtk_adjustment_get_value(historyWindow.scrollPosition);
+
+    cr = cairo_create(historyWindow.backingSurface);
+
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_paint(cr);
+
+    // Cost depends only on the chart width, not on the amount of recorded history.
+    for(column = 0; column < historyWindow.width; column++)
+    {
+        render_history_column(cr, column, firstIndex + column);
+    }
+
+    render_time_axis(cr, firstIndex);
+    cairo_destroy(cr);
+
+    gtk_widget_queue_draw(historyWindow.plot);
+}
+
+static void update_history_range()
+{
+    gint firstIndex, endIndex;
+    double pageSize = historyWindow.width;
+    double position;
+
+    endIndex = signal_history_get_range(historyWindow.level, &firstIndex);
+
+    // Chart always spans a full page, even if there is less history than that.
+    position = historyWindow.followLive ? (endIndex - pageSize) : gtk_adjustment_get_value(historyWindow.scrollPosition);
+    position = CLAMP(position, MIN(firstIndex, endIndex - pageSize), endIndex - pageSize);
+
+    historyWindow.updatingRange = TRUE;
+    gtk_adjustment_configure(historyWindow.scrollPosition, position, MIN(firstIndex, endIndex - pageSize), endIndex, 1, pageSize / 4, pageSize);
+    historyWindow.updatingRange = FALSE;
+}
+
+static void update_history_info()
+{
+    char infoText[48];
+    gint firstIndex, endIndex;
+    uint32_t period = signal_history_get_period(historyWindow.level);
+
+    endIndex = signal_history_get_range(historyWindow.level, &firstIndex);
+    sprintf(infoText, "%d min recorded, %d min shown", (int)(((gint64)(endIndex - firstIndex) * period) / 60), (int)(((gint64)historyWindow.width * period) / 60));
+    gtk_label_set_text(historyWindow.infoLabel, infoText);
+}
+
+static gboolean on_signal_history_refresh(gpointer userData)
+{
+    gint firstIndex;
+    static gint lastEndIndex = -1;
+    gint endIndex = signal_history_get_range(historyWindow.level, &firstIndex);
+
+    // Redraw only if the selected level has received new samples.
+    if(endIndex != lastEndIndex)
+    {
+        lastEndIndex = endIndex;
+        update_history_range();
+        update_history_info();
+
+        if(historyWindow.followLive)
+        {
+            render_signal_history();
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_signal_history_configure(GtkWidget *widget, GdkEventConfigure *event, gpointer userData)
+{
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+
+    if((historyWindow.backingSurface != NULL) && (width == historyWindow.width) && (height == historyWindow.height))
+    {
+        return TRUE;
+    }
+
+    if(historyWindow.backingSurface != NULL)
+    {
+        cairo_surface_destroy(historyWindow.backingSurface);
+    }
+
+    historyWindow.width = width;
+    historyWindow.height = height;
+    historyWindow.backingSurface = gdk_window_create_similar_surface(gtk_widget_get_window(widget), CAIRO_CONTENT_COLOR, width, height);
+
+    update_history_range();
+    render_signal_history();
+    return TRUE;
+}
+
+static gboolean on_signal_history_draw(GtkWidget *widget, cairo_t *cr, gpointer userData)
+{
+    if(historyWindow.backingSurface != NULL)
+    {
+        cairo_set_source_surface(cr, historyWindow.backingSurface, 0, 0);
+        cairo_paint(cr);
+    }
+
+    return FALSE;
+}
+
+static uint8_t create_signal_history_window()
+{
+    GtkBuilder *builder;
+    gchar *objectIds[] = {"adjHistory", "signal-history", NULL};
+
+    // Load only the signal history window from the UI resource.
+    builder = gtk_builder_new();
+    if(gtk_builder_add_objects_from_resource(builder, UI_RESOURCE_PATH, objectIds, NULL) == 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to load signal history from UI resource");
+#endif
+        g_object_unref(builder);
+        return RESULT_FAIL;
+    }
+
+    historyWindow.window = GTK_WIDGET(gtk_builder_get_object(builder, "signal-history"));
+    historyWindow.plot = GTK_WIDGET(gtk_builder_get_object(builder, "drwHistory"));
+    historyWindow.zoomSelect = GTK_COMBO_BOX(gtk_builder_get_object(builder, "cmbHistoryZoom"));
+    historyWindow.scrollPosition = GTK_ADJUSTMENT(gtk_builder_get_object(builder, "adjHistory"));
+    historyWindow.infoLabel = GTK_LABEL(gtk_builder_get_object(builder, "lblHistoryInfo"));
+
+    historyWindow.backingSurface = NULL;
+    historyWindow.refreshId = 0;
+    historyWindow.level = (uint8_t)atoi(gtk_combo_box_get_active_id(historyWindow.zoomSelect));
+    historyWindow.followLive = TRUE;
+    historyWindow.updatingRange = FALSE;
+
+    // Setup events and release builder.
+    gtk_builder_connect_signals(builder, NULL);
+    g_object_unref(builder);
+
+    g_signal_connect(historyWindow.plot, "configure-event", G_CALLBACK(on_signal_history_configure), NULL);
+    g_signal_connect(historyWindow.plot, "draw", G_CALLBACK(on_signal_history_draw), NULL);
+
+    gtk_window_set_title(GTK_WINDOW(historyWindow.window), "Signal History");
+
+    return RESULT_SUCCESS;
+}
+
+void show_signal_history_window(GtkWidget *parent)
+{
+    // Signal history window is created on first use and reused afterwards.
+    if((historyWindow.window == NULL) && (create_signal_history_window() == RESULT_FAIL))
+    {
+        return;
+    }
+
+    // Chart is refreshed only while the window is open, history is recorded all the time.
+    if(historyWindow.refreshId == 0)
+    {
+        historyWindow.refreshId = g_timeout_add_seconds(HISTORY_L0_PERIOD, on_signal_history_refresh, NULL);
+    }
+
+    gtk_window_set_transient_for(GTK_WINDOW(historyWindow.window), GTK_WINDOW(parent));
+    gtk_window_present(GTK_WINDOW(historyWindow.window));
+
+    update_history_range();
+    update_history_info();
+    render_signal_history();
+}
+
+void on_adjHistory_value_changed(GtkAdjustment *adjustment, gpointer userData)
+{
+    if(historyWindow.updatingRange)
+    {
+        return;
+    }
+
+    // Scrolling back in time stops following the newest samples, scrolling to the end resumes it.
+    historyWindow.followLive = (gtk_adjustment_get_value(adjustment) + gtk_adjustment_get_page_size(adjustment)) >= (gtk_adjustment_get_upper(adjustment) - 0.5);
+    render_signal_history();
+}
+
+void on_cmbHistoryZoom_changed(GtkComboBox *comboBox, gpointer userData)
+{
+    uint8_t newLevel = (uint8_t)atoi(gtk_combo_box_get_active_id(comboBox));
+    double rightEdgeTime;
+
+    // Keep the time at the right edge of the chart in place while zooming.
+    rightEdgeTime = (gtk_adjustment_get_value(historyWindow.scrollPosition) + historyWindow.width) * signal_history_get_period(historyWindow.level);
+    historyWindow.level = newLevel;
+
+    historyWindow.updatingRange = TRUE;
+    gtk_adjustment_set_value(historyWindow.scrollPosition, (rightEdgeTime / signal_history_get_period(newLevel)) - historyWindow.width);
+    historyWindow.updatingRange = FALSE;
+
+    update_history_range();
+    update_history_info();
+    render_signal_history();
+}
+
+gboolean on_signal_history_delete_event(GtkWidget *widget, GdkEvent *event, gpointer userData)
+{
+    if(historyWindow.refreshId != 0)
+    {
+        g_source_remove(historyWindow.refreshId);
+        historyWindow.refreshId = 0;
+    }
+
+    gtk_widget_hide(widget);
+    return TRUE;
+}
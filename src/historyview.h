@@ -0,0 +1,66 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Signal history window, strip chart of RSSI/SNR/stereo over time.              *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_HISTORYVIEW_HEADER_
+#define _GTK_FM_TUNER_HISTORYVIEW_HEADER_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+#include "defmain.h"
+#include "defconfig.h"
+
+// Height of the time axis and stereo band below the chart in pixels.
+#define HISTORY_VIEW_AXIS_HEIGHT    14
+#define HISTORY_VIEW_STEREO_HEIGHT  4
+
+// Full scale RSSI/SNR value of the chart.
+#define HISTORY_VIEW_SCALE          90
+
+// Distance between time labels in pixels.
+#define HISTORY_VIEW_LABEL_SPACING  80
+
+typedef struct HistoryWindow
+{
+    GtkWidget *window;
+    GtkWidget *plot;
+    GtkComboBox *zoomSelect;
+    GtkAdjustment *scrollPosition;
+    GtkLabel *infoLabel;
+
+    cairo_surface_t *backingSurface;
+    int width;
+    int height;
+    guint refreshId;
+    uint8_t level;
+    gboolean followLive;        // Keep the newest sample at the right edge of the chart.
+    gboolean updatingRange;     // Scroll range is being updated by the code, not by the user.
+} HistoryWindow;
+
+void show_signal_history_window(GtkWidget *parent);
+
+#endif /* _GTK_FM_TUNER_HISTORYVIEW_HEADER_ */
@@ -0,0 +1,184 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * I2C retry policy and bus health tracking of the tuner devices.                *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "i2chealth.h"
+#include "trace.h"
+
+// Transactions of a device are serialized by its driver, readers on other threads only load the counters.
+#define I2C_HEALTH_ADD(field, value)    __atomic_add_fetch(&(field), (value), __ATOMIC_RELAXED)
+#define I2C_HEALTH_SET(field, value)    __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#define I2C_HEALTH_GET(field)           __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static GMutex registerLock;
+static I2CHealthStats devices[I2C_HEALTH_MAX_DEVICES];
+static uint32_t cleanTransactions[I2C_HEALTH_MAX_DEVICES];
+static volatile gint deviceCount;
+
+static const char *healthStateNames[I2CH_COUNT] = {"healthy", "degraded", "lost"};
+
+uint8_t i2c_health_register(const char *name, uint8_t address)
+{
+    uint8_t device;
+
+    g_mutex_lock(&registerLock);
+
+    // Reinitialized driver keeps the counters of its device.
+    for(device = 0; device < deviceCount; device++)
+    {
+        if((devices[device].address == address) && (strcmp(devices[device].name, name) == 0))
+        {
+            g_mutex_unlock(&registerLock);
+            return device;
+        }
+    }
+
+    // Devices beyond the limit share the last entry.
+    if(deviceCount >= I2C_HEALTH_MAX_DEVICES)
+    {
+        g_mutex_unlock(&registerLock);
+        return (I2C_HEALTH_MAX_DEVICES - 1);
+    }
+
+    device = (uint8_t)deviceCount;
+    memset(&devices[device], 0, sizeof(I2CHealthStats));
+    devices[device].name = name;
+    devices[device].address = address;
+    devices[device].state = I2CH_HEALTHY;
+    devices[device].stateTime = g_get_monotonic_time();
+    cleanTransactions[device] = 0;
+    g_atomic_int_set(&deviceCount, device + 1);
+
+    g_mutex_unlock(&registerLock);
+
+    return device;
+}
+
+uint8_t i2c_health_device_count()
+{
+    return (uint8_t)g_atomic_int_get(&deviceCount);
+}
+
+uint8_t i2c_health_retry_limit(uint8_t device)
+{
+    // Lost device fails fast, every access would otherwise stall for the whole backoff sequence.
+    return (I2C_HEALTH_GET(devices[device].state) == I2CH_LOST) ? 0 : I2C_RETRY_LIMIT;
+}
+
+uint32_t i2c_health_backoff(uint8_t attempt)
+{
+    return MIN((uint32_t)I2C_RETRY_BASE_DELAY << attempt, I2C_RETRY_MAX_DELAY);
+}
+
+static void i2c_health_set_state(uint8_t device, I2CHealthState state)
+{
+    I2CHealthStats *health = &devices[device];
+
+    if(I2C_HEALTH_GET(health->state) == state)
+    {
+        return;
+    }
+
+    TRACE_LOG(TE_I2C_HEALTH, health->address, state);
+
+#ifdef DEBUG_LOGS
+    g_message("I2C device %s (0x%02X) is %s", health->name, health->address, healthStateNames[state]);
+#endif
+
+    I2C_HEALTH_SET(health->state, state);
+    I2C_HEALTH_SET(health->stateTime, g_get_monotonic_time());
+    I2C_HEALTH_ADD(health->stateChanges, 1);
+}
+
+void i2c_health_record(uint8_t device, gboolean isFailed, uint8_t retries)
+{
+    I2CHealthStats *health = &devices[device];
+    uint32_t failures;
+
+    I2C_HEALTH_ADD(health->transactions, 1);
+    I2C_HEALTH_ADD(health->retries, retries);
+
+    if(isFailed)
+    {
+        I2C_HEALTH_ADD(health->failures, 1);
+        failures = I2C_HEALTH_ADD(health->consecutiveFailures, 1);
+        cleanTransactions[device] = 0;
+
+        i2c_health_set_state(device, ((failures >= I2C_HEALTH_LOST_LIMIT) ? I2CH_LOST : I2CH_DEGRADED));
+        return;
+    }
+
+    I2C_HEALTH_SET(health->consecutiveFailures, 0);
+
+    if(retries > 0)
+    {
+        // Transaction went through, but the bus is flaky.
+        I2C_HEALTH_ADD(health->recovered, 1);
+        cleanTransactions[device] = 0;
+        i2c_health_set_state(device, I2CH_DEGRADED);
+    }
+    else if(I2C_HEALTH_GET(health->state) == I2CH_LOST)
+    {
+        // Device answers again, it has to prove itself before it is healthy.
+        cleanTransactions[device] = 0;
+        i2c_health_set_state(device, I2CH_DEGRADED);
+    }
+    else if((I2C_HEALTH_GET(health->state) == I2CH_DEGRADED) && ((++cleanTransactions[device]) >= I2C_HEALTH_RECOVER_LIMIT))
+    {
+        i2c_health_set_state(device, I2CH_HEALTHY);
+    }
+}
+
+I2CHealthState i2c_health_get_state(uint8_t device)
+{
+    return (I2CHealthState)I2C_HEALTH_GET(devices[device].state);
+}
+
+void i2c_health_read(uint8_t device, I2CHealthStats *stats)
+{
+    I2CHealthStats *health = &devices[device];
+
+    stats->name = health->name;
+    stats->address = health->address;
+    stats->state = (I2CHealthState)I2C_HEALTH_GET(health->state);
+    stats->consecutiveFailures = I2C_HEALTH_GET(health->consecutiveFailures);
+    stats->transactions = I2C_HEALTH_GET(health->transactions);
+    stats->retries = I2C_HEALTH_GET(health->retries);
+    stats->recovered = I2C_HEALTH_GET(health->recovered);
+    stats->failures = I2C_HEALTH_GET(health->failures);
+    stats->stateChanges = I2C_HEALTH_GET(health->stateChanges);
+    stats->stateTime = I2C_HEALTH_GET(health->stateTime);
+}
+
+const char *i2c_health_state_name(I2CHealthState state)
+{
+    return (state < I2CH_COUNT) ? healthStateNames[state] : "unknown";
+}
@@ -0,0 +1,82 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * I2C retry policy and bus health tracking of the tuner devices.                *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_I2CHEALTH_HEADER_
+#define _GTK_FM_TUNER_I2CHEALTH_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+// Maximum number of registered bus devices.
+#define I2C_HEALTH_MAX_DEVICES      4
+
+// Retries of a failed transaction, the delay doubles from the base delay up to the limit (us).
+#define I2C_RETRY_LIMIT             3
+#define I2C_RETRY_BASE_DELAY        100
+#define I2C_RETRY_MAX_DELAY         2000
+
+// Consecutive failed transactions which mark the device as lost.
+#define I2C_HEALTH_LOST_LIMIT       8
+
+// Consecutive clean transactions which return a degraded device to healthy.
+#define I2C_HEALTH_RECOVER_LIMIT    256
+
+typedef enum
+{
+    I2CH_HEALTHY,   // No recent errors.
+    I2CH_DEGRADED,  // Transactions needed retries or failed recently.
+    I2CH_LOST,      // Device stopped responding, transactions are not retried.
+    I2CH_COUNT
+} I2CHealthState;
+
+typedef struct I2CHealthStats
+{
+    const char *name;
+    uint8_t address;
+    I2CHealthState state;
+    uint32_t consecutiveFailures;
+    uint64_t transactions;
+    uint64_t retries;           // Repeated attempts of failed transactions.
+    uint64_t recovered;         // Transactions which succeeded after a retry.
+    uint64_t failures;          // Transactions which failed after all retries.
+    uint32_t stateChanges;
+    gint64 stateTime;           // Monotonic time (us) of the last state change.
+} I2CHealthStats;
+
+uint8_t i2c_health_register(const char *name, uint8_t address);
+uint8_t i2c_health_device_count(void);
+
+// Number of retries allowed for the next transaction (none while the device is lost).
+uint8_t i2c_health_retry_limit(uint8_t device);
+uint32_t i2c_health_backoff(uint8_t attempt);
+void i2c_health_record(uint8_t device, gboolean isFailed, uint8_t retries);
+
+I2CHealthState i2c_health_get_state(uint8_t device);
+void i2c_health_read(uint8_t device, I2CHealthStats *stats);
+const char *i2c_health_state_name(I2CHealthState state);
+
+#endif /* _GTK_FM_TUNER_I2CHEALTH_HEADER_ */
@@ -0,0 +1,303 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * I2C transaction counters and latency histograms.                              *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <time.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "i2cstats.h"
+
+static I2CStatsContext statsContext;
+static __thread I2CThreadStats *threadStats;
+static __thread I2CSubsystem threadSubsystem;
+static volatile gint statsInitialized;
+
+static const char *subsystemNames[I2CS_COUNT] = {"other", "init", "tune", "scan", "rds", "status"};
+
+// Counters of a thread block have a single writer, the atomic store only prevents torn reads.
+#define STATS_ADD(field, value, shared) \
+    do \
+    { \
+        if(shared) \
+        { \
+            __atomic_fetch_add(&(field), (value), __ATOMIC_RELAXED); \
+        } \
+        else \
+        { \
+            __atomic_store_n(&(field), (field) + (value), __ATOMIC_RELAXED); \
+        } \
+    } \
+    while(0)
+
+static inline uint64_t i2c_stats_time()
+{
+    struct timespec timeValue;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeValue);
+    return ((uint64_t)timeValue.tv_sec * 1000000000ULL) + (uint64_t)timeValue.tv_nsec;
+}
+
+static void on_stats_thread_exit(void *slot)
+{
+    // Counters of the finished thread are kept, the block is handed to the next new thread.
+    g_atomic_int_set(&statsContext.threadActive[GPOINTER_TO_INT(slot) - 1], 0);
+}
+
+void i2c_stats_init()
+{
+    if(g_atomic_int_get(&statsInitialized))
+    {
+        return;
+    }
+
+    g_mutex_init(&statsContext.registerLock);
+    pthread_key_create(&statsContext.threadKey, on_stats_thread_exit);
+    statsContext.startTime = i2c_stats_time();
+    g_atomic_int_set(&statsInitialized, 1);
+}
+
+static I2CThreadStats *i2c_stats_register_thread()
+{
+    gint pos, threadCount;
+    I2CThreadStats *stats = NULL;
+
+    g_mutex_lock(&statsContext.registerLock);
+
+    threadCount = g_atomic_int_get(&statsContext.threadCount);
+    for(pos = 0; pos < threadCount; pos++)
+    {
+        if(g_atomic_int_get(&statsContext.threadActive[pos]) == 0)
+        {
+            stats = statsContext.threadStats[pos];
+            break;
+        }
+    }
+
+    if((stats == NULL) && (threadCount < I2C_STATS_MAX_THREADS))
+    {
+        stats = g_new0(I2CThreadStats, 1);
+        pos = threadCount;
+        statsContext.threadStats[pos] = stats;
+        g_atomic_int_set(&statsContext.threadCount, threadCount + 1);
+    }
+
+    if(stats != NULL)
+    {
+        g_atomic_int_set(&statsContext.threadActive[pos], 1);
+        pthread_setspecific(statsContext.threadKey, GINT_TO_POINTER(pos + 1));
+        threadStats = stats;
+    }
+
+    g_mutex_unlock(&statsContext.registerLock);
+    return stats;
+}
+
+void i2c_stats_set_subsystem(I2CSubsystem subsystem)
+{
+    threadSubsystem = subsystem;
+}
+
+I2CSubsystem i2c_stats_get_subsystem()
+{
+    return threadSubsystem;
+}
+
+uint64_t i2c_stats_begin()
+{
+    return i2c_stats_time();
+}
+
+void i2c_stats_end(uint8_t reg, gboolean isWrite, uint64_t startTime, gboolean isError)
+{
+    I2CThreadStats *stats = threadStats;
+    I2CRegisterStats *regStats;
+    I2CSubsystemStats *subsystemStats;
+    uint64_t elapsedTime;
+    uint32_t elapsedUs;
+    uint8_t bucket;
+    gboolean shared;
+
+    elapsedTime = i2c_stats_time() - startTime;
+
+    if(G_UNLIKELY(stats == NULL))
+    {
+        stats = i2c_stats_register_thread();
+    }
+
+    shared = (stats == NULL);
+    if(shared)
+    {
+        stats = &statsContext.sharedStats;
+    }
+
+    // Bucket n holds transactions shorter than 2^n us.
+    elapsedUs = (uint32_t)MIN(elapsedTime / 1000, G_MAXUINT32);
+    bucket = (elapsedUs == 0) ? 0 : (uint8_t)MIN(32 - __builtin_clz(elapsedUs), I2C_STATS_BUCKETS - 1);
+
+    regStats = &stats->registers[MIN(reg, I2C_STATS_REGISTERS - 1)];
+    subsystemStats = &stats->subsystems[threadSubsystem];
+
+    if(isWrite)
+    {
+        STATS_ADD(regStats->writes, 1, shared);
+    }
+    else
+    {
+        STATS_ADD(regStats->reads, 1, shared);
+    }
+
+    STATS_ADD(regStats->busyTime, elapsedTime, shared);
+    STATS_ADD(regStats->histogram[bucket], 1, shared);
+    STATS_ADD(subsystemStats->transactions, 1, shared);
+    STATS_ADD(subsystemStats->busyTime, elapsedTime, shared);
+    STATS_ADD(subsystemStats->histogram[bucket], 1, shared);
+
+    if(isError)
+    {
+        STATS_ADD(regStats->errors, 1, shared);
+        STATS_ADD(subsystemStats->errors, 1, shared);
+    }
+}
+
+static void i2c_stats_merge(I2CThreadStats *totalStats, I2CThreadStats *stats)
+{
+    uint16_t pos, bucket;
+
+    for(pos = 0; pos < I2C_STATS_REGISTERS; pos++)
+    {
+        totalStats->registers[pos].reads += __atomic_load_n(&stats->registers[pos].reads, __ATOMIC_RELAXED);
+        totalStats->registers[pos].writes += __atomic_load_n(&stats->registers[pos].writes, __ATOMIC_RELAXED);
+        totalStats->registers[pos].errors += __atomic_load_n(&stats->registers[pos].errors, __ATOMIC_RELAXED);
+        totalStats->registers[pos].busyTime += __atomic_load_n(&stats->registers[pos].busyTime, __ATOMIC_RELAXED);
+
+        for(bucket = 0; bucket < I2C_STATS_BUCKETS; bucket++)
+        {
+            totalStats->registers[pos].histogram[bucket] += __atomic_load_n(&stats->registers[pos].histogram[bucket], __ATOMIC_RELAXED);
+        }
+    }
+
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        totalStats->subsystems[pos].transactions += __atomic_load_n(&stats->subsystems[pos].transactions, __ATOMIC_RELAXED);
+        totalStats->subsystems[pos].errors += __atomic_load_n(&stats->subsystems[pos].errors, __ATOMIC_RELAXED);
+        totalStats->subsystems[pos].busyTime += __atomic_load_n(&stats->subsystems[pos].busyTime, __ATOMIC_RELAXED);
+
+        for(bucket = 0; bucket < I2C_STATS_BUCKETS; bucket++)
+        {
+            totalStats->subsystems[pos].histogram[bucket] += __atomic_load_n(&stats->subsystems[pos].histogram[bucket], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void i2c_stats_read(I2CThreadStats *totalStats)
+{
+    gint pos, threadCount;
+
+    memset(totalStats, 0, sizeof(I2CThreadStats));
+
+    threadCount = g_atomic_int_get(&statsContext.threadCount);
+    for(pos = 0; pos < threadCount; pos++)
+    {
+        i2c_stats_merge(totalStats, statsContext.threadStats[pos]);
+    }
+
+    i2c_stats_merge(totalStats, &statsContext.sharedStats);
+}
+
+uint32_t i2c_stats_percentile(const uint32_t *histogram, uint32_t count, uint8_t percent)
+{
+    uint64_t target, total = 0;
+    uint8_t bucket;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    // Upper bound (us) of the bucket which contains the requested percentile.
+    target = (((uint64_t)count * percent) + 99) / 100;
+    for(bucket = 0; bucket < I2C_STATS_BUCKETS; bucket++)
+    {
+        total += histogram[bucket];
+        if(total >= target)
+        {
+            break;
+        }
+    }
+
+    return (uint32_t)1 << MIN(bucket, I2C_STATS_BUCKETS - 1);
+}
+
+const char *i2c_stats_subsystem_name(I2CSubsystem subsystem)
+{
+    return (subsystem < I2CS_COUNT) ? subsystemNames[subsystem] : "?";
+}
+
+void i2c_stats_log_summary()
+{
+#ifdef DEBUG_LOGS
+    I2CThreadStats *totalStats;
+    I2CSubsystemStats *subsystemStats;
+    GString *summaryText;
+    uint64_t totalTime = 0, elapsedTime;
+    uint32_t transactions = 0, errors = 0;
+    uint8_t pos;
+
+    if(!g_atomic_int_get(&statsInitialized))
+    {
+        return;
+    }
+
+    totalStats = g_new(I2CThreadStats, 1);
+    i2c_stats_read(totalStats);
+    summaryText = g_string_new(NULL);
+
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        subsystemStats = &totalStats->subsystems[pos];
+        transactions += subsystemStats->transactions;
+        errors += subsystemStats->errors;
+        totalTime += subsystemStats->busyTime;
+
+        if(subsystemStats->transactions > 0)
+        {
+            g_string_append_printf(summaryText, " %s: %u (%.1lf ms, p99 < %u us)", subsystemNames[pos], subsystemStats->transactions,
+                subsystemStats->busyTime / 1000000.0, i2c_stats_percentile(subsystemStats->histogram, subsystemStats->transactions, 99));
+        }
+    }
+
+    // Share of the wall time the bus was busy with tuner transactions.
+    elapsedTime = i2c_stats_time() - statsContext.startTime;
+    g_message("I2C bus: %u transactions, %u errors, busy %.2lf%%;%s", transactions, errors,
+        ((elapsedTime > 0) ? ((totalTime * 100.0) / elapsedTime) : 0), summaryText->str);
+
+    g_string_free(summaryText, TRUE);
+    g_free(totalStats);
+#endif
+}
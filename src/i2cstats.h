@@ -0,0 +1,108 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * I2C transaction counters and latency histograms.                              *
+ *                                                                               *
+ * Transactions are counted per register and per calling subsystem into          *
+ * per-thread blocks without locks, the blocks are merged on read.               *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_I2CSTATS_HEADER_
+#define _GTK_FM_TUNER_I2CSTATS_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// Number of tracked registers, addresses above the range share the last entry.
+#define I2C_STATS_REGISTERS         80
+
+// Latency histogram buckets, bucket n holds transactions shorter than 2^n us.
+#define I2C_STATS_BUCKETS           24
+
+// Maximum number of threads with own counters, further threads share an atomic block.
+#define I2C_STATS_MAX_THREADS       16
+
+// Period of the bus summary log in ms.
+#define I2C_STATS_SUMMARY_PERIOD    60000
+
+typedef enum
+{
+    I2CS_OTHER,     // Caller did not set a subsystem.
+    I2CS_INIT,      // Tuner initialization and shutdown.
+    I2CS_TUNE,      // Tune and volume commands.
+    I2CS_SCAN,      // Seek polling.
+    I2CS_RDS,       // RDS group capture.
+    I2CS_STATUS,    // Frequency, signal and stereo readings for the UI and telemetry.
+    I2CS_COUNT
+} I2CSubsystem;
+
+typedef struct I2CRegisterStats
+{
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t errors;
+    uint64_t busyTime;      // Total transaction time in ns.
+    uint32_t histogram[I2C_STATS_BUCKETS];
+} I2CRegisterStats;
+
+typedef struct I2CSubsystemStats
+{
+    uint32_t transactions;
+    uint32_t errors;
+    uint64_t busyTime;      // Total transaction time in ns.
+    uint32_t histogram[I2C_STATS_BUCKETS];
+} I2CSubsystemStats;
+
+typedef struct I2CThreadStats
+{
+    I2CRegisterStats registers[I2C_STATS_REGISTERS];
+    I2CSubsystemStats subsystems[I2CS_COUNT];
+} I2CThreadStats;
+
+typedef struct I2CStatsContext
+{
+    GMutex registerLock;
+    pthread_key_t threadKey;
+    I2CThreadStats *threadStats[I2C_STATS_MAX_THREADS];
+    volatile gint threadCount;
+    volatile gint threadActive[I2C_STATS_MAX_THREADS];
+    I2CThreadStats sharedStats;     // Updated with atomic adds by threads without own block.
+    uint64_t startTime;
+} I2CStatsContext;
+
+void i2c_stats_init(void);
+void i2c_stats_set_subsystem(I2CSubsystem subsystem);
+I2CSubsystem i2c_stats_get_subsystem(void);
+
+// Time stamp for i2c_stats_end, taken just before the transaction.
+uint64_t i2c_stats_begin(void);
+void i2c_stats_end(uint8_t reg, gboolean isWrite, uint64_t startTime, gboolean isError);
+
+void i2c_stats_read(I2CThreadStats *totalStats);
+uint32_t i2c_stats_percentile(const uint32_t *histogram, uint32_t count, uint8_t percent);
+const char *i2c_stats_subsystem_name(I2CSubsystem subsystem);
+void i2c_stats_log_summary(void);
+
+#endif /* _GTK_FM_TUNER_I2CSTATS_HEADER_ */
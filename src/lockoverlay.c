@@ -0,0 +1,115 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner lock statistics overlay on the main window.                             *
+ *                                                                               *
+ * Shows how often the status getters found the tuner busy, the worst wait       *
+ * for the tuner mutex and the age of the displayed signal values.               *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <gtk/gtk.h>
+
+#include "lockoverlay.h"
+#include "tunercore.h"
+
+static LockOverlay lockOverlay;
+
+static void update_lock_overlay()
+{
+    LockCallerStats callerStats[LOCK_STATS_CALLERS];
+    TunerStatusAge statusAge;
+    uint32_t trylocks = 0, failures = 0, periodTrylocks, periodPolls;
+    uint64_t maxWaitTime = 0;
+    uint32_t valueAge;
+    char overlayText[96], ageText[16];
+    uint8_t pos;
+
+    if(lockOverlay.tunerRef->get_lock_stats != NULL)
+    {
+        lockOverlay.tunerRef->get_lock_stats(callerStats);
+        for(pos = 0; pos < LOCK_STATS_CALLERS; pos++)
+        {
+            trylocks += callerStats[pos].trylocks;
+            failures += callerStats[pos].trylockFailures;
+            maxWaitTime = MAX(maxWaitTime, callerStats[pos].maxWaitTime);
+        }
+    }
+
+    // Oldest of the values shown in the status bar.
+    tuner_core_get_status_age(&statusAge);
+    valueAge = MAX(MAX(statusAge.frequencyAge, statusAge.rssiAge), MAX(statusAge.snrAge, statusAge.stereoAge));
+
+    periodTrylocks = trylocks - lockOverlay.lastTrylocks;
+    periodPolls = statusAge.telemetryPolls - lockOverlay.lastPolls;
+
+    if(valueAge != TUNER_STATUS_AGE_NONE)
+    {
+        g_snprintf(ageText, sizeof(ageText), "%u ms", valueAge);
+    }
+    else
+    {
+        g_strlcpy(ageText, "-", sizeof(ageText));
+    }
+
+    g_snprintf(overlayText, sizeof(overlayText), "busy %4.1f%%  skip %u/%u  wait max %.1f ms  age %s",
+        ((periodTrylocks > 0) ? (((failures - lockOverlay.lastFailures) * 100.0) / periodTrylocks) : 0),
+        (statusAge.telemetrySkips - lockOverlay.lastSkips), periodPolls, (maxWaitTime / 1000000.0), ageText);
+
+    gtk_label_set_text(lockOverlay.label, overlayText);
+
+    lockOverlay.lastTrylocks = trylocks;
+    lockOverlay.lastFailures = failures;
+    lockOverlay.lastPolls = statusAge.telemetryPolls;
+    lockOverlay.lastSkips = statusAge.telemetrySkips;
+}
+
+static gboolean on_lock_overlay_refresh(gpointer userData)
+{
+    update_lock_overlay();
+    return G_SOURCE_CONTINUE;
+}
+
+void lock_overlay_init(GtkLabel *label, Tuner *tuner)
+{
+    lockOverlay.label = label;
+    lockOverlay.tunerRef = tuner;
+    lockOverlay.refreshId = 0;
+}
+
+void lock_overlay_set_active(gboolean active)
+{
+    // Statistics are collected all the time, the overlay is refreshed only while it is shown.
+    if(active && (lockOverlay.refreshId == 0))
+    {
+        update_lock_overlay();
+        lockOverlay.refreshId = g_timeout_add(LOCK_OVERLAY_REFRESH, on_lock_overlay_refresh, NULL);
+    }
+    else if((!active) && (lockOverlay.refreshId != 0))
+    {
+        g_source_remove(lockOverlay.refreshId);
+        lockOverlay.refreshId = 0;
+    }
+
+    gtk_widget_set_visible(GTK_WIDGET(lockOverlay.label), active);
+}
@@ -0,0 +1,56 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner lock statistics overlay on the main window.                             *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_LOCKOVERLAY_HEADER_
+#define _GTK_FM_TUNER_LOCKOVERLAY_HEADER_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+#include "tuner.h"
+#include "lockstats.h"
+
+// Overlay refresh period in ms.
+#define LOCK_OVERLAY_REFRESH    1000
+
+typedef struct LockOverlay
+{
+    GtkLabel *label;
+    Tuner *tunerRef;
+    guint refreshId;
+
+    // Counters at the previous refresh, the overlay shows the rates of the last period.
+    uint32_t lastTrylocks;
+    uint32_t lastFailures;
+    uint32_t lastPolls;
+    uint32_t lastSkips;
+} LockOverlay;
+
+void lock_overlay_init(GtkLabel *label, Tuner *tuner);
+void lock_overlay_set_active(gboolean active);
+
+#endif /* _GTK_FM_TUNER_LOCKOVERLAY_HEADER_ */
@@ -0,0 +1,158 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Mutex with hold time, wait time and trylock failure metrics.                  *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <time.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "lockstats.h"
+
+// Readers never take the mutex, stores are atomic to keep 64 bit counters intact on 32 bit targets.
+#define LOCK_STATS_SET(field, value)    __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#define LOCK_STATS_GET(field)           __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static inline uint64_t lock_stats_time()
+{
+    struct timespec timeValue;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeValue);
+    return ((uint64_t)timeValue.tv_sec * 1000000000ULL) + (uint64_t)timeValue.tv_nsec;
+}
+
+static inline uint8_t lock_stats_bucket(uint64_t timeNs)
+{
+    uint64_t timeUs = timeNs / 1000;
+
+    return (timeUs == 0) ? 0 : (uint8_t)MIN(64 - __builtin_clzll(timeUs), LOCK_STATS_BUCKETS - 1);
+}
+
+static void tracked_mutex_acquired(TrackedMutex *lock, uint8_t caller)
+{
+    lock->acquireTime = lock_stats_time();
+    lock->holder = MIN(caller, LOCK_STATS_CALLERS - 1);
+}
+
+void tracked_mutex_lock(TrackedMutex *lock, uint8_t caller)
+{
+    LockCallerStats *stats;
+    uint64_t startTime, waitTime;
+
+    startTime = lock_stats_time();
+    g_mutex_lock(&lock->mutex);
+    tracked_mutex_acquired(lock, caller);
+
+    // Mutex is held, this caller is the only writer now.
+    stats = &lock->callers[lock->holder];
+    waitTime = lock->acquireTime - startTime;
+    LOCK_STATS_SET(stats->locks, stats->locks + 1);
+    LOCK_STATS_SET(stats->waitTime, stats->waitTime + waitTime);
+    LOCK_STATS_SET(stats->maxWaitTime, MAX(stats->maxWaitTime, waitTime));
+    LOCK_STATS_SET(stats->waitHistogram[lock_stats_bucket(waitTime)], stats->waitHistogram[lock_stats_bucket(waitTime)] + 1);
+}
+
+gboolean tracked_mutex_trylock(TrackedMutex *lock, uint8_t caller)
+{
+    LockCallerStats *stats = &lock->callers[MIN(caller, LOCK_STATS_CALLERS - 1)];
+
+    if(!g_mutex_trylock(&lock->mutex))
+    {
+        // Caller falls back to a stale value, count it without owning the mutex.
+        __atomic_fetch_add(&stats->trylockFailures, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stats->trylocks, 1, __ATOMIC_RELAXED);
+        return FALSE;
+    }
+
+    tracked_mutex_acquired(lock, caller);
+    __atomic_fetch_add(&stats->trylocks, 1, __ATOMIC_RELAXED);
+    return TRUE;
+}
+
+void tracked_mutex_unlock(TrackedMutex *lock)
+{
+    LockCallerStats *stats = &lock->callers[lock->holder];
+    uint64_t holdTime;
+
+    holdTime = lock_stats_time() - lock->acquireTime;
+    LOCK_STATS_SET(stats->holdTime, stats->holdTime + holdTime);
+    LOCK_STATS_SET(stats->maxHoldTime, MAX(stats->maxHoldTime, holdTime));
+    LOCK_STATS_SET(stats->holdHistogram[lock_stats_bucket(holdTime)], stats->holdHistogram[lock_stats_bucket(holdTime)] + 1);
+
+    g_mutex_unlock(&lock->mutex);
+}
+
+void tracked_mutex_read(TrackedMutex *lock, LockCallerStats *callerStats)
+{
+    uint8_t pos, bucket;
+
+    for(pos = 0; pos < LOCK_STATS_CALLERS; pos++)
+    {
+        callerStats[pos].locks = LOCK_STATS_GET(lock->callers[pos].locks);
+        callerStats[pos].trylocks = LOCK_STATS_GET(lock->callers[pos].trylocks);
+        callerStats[pos].trylockFailures = LOCK_STATS_GET(lock->callers[pos].trylockFailures);
+        callerStats[pos].waitTime = LOCK_STATS_GET(lock->callers[pos].waitTime);
+        callerStats[pos].maxWaitTime = LOCK_STATS_GET(lock->callers[pos].maxWaitTime);
+        callerStats[pos].holdTime = LOCK_STATS_GET(lock->callers[pos].holdTime);
+        callerStats[pos].maxHoldTime = LOCK_STATS_GET(lock->callers[pos].maxHoldTime);
+
+        for(bucket = 0; bucket < LOCK_STATS_BUCKETS; bucket++)
+        {
+            callerStats[pos].waitHistogram[bucket] = LOCK_STATS_GET(lock->callers[pos].waitHistogram[bucket]);
+            callerStats[pos].holdHistogram[bucket] = LOCK_STATS_GET(lock->callers[pos].holdHistogram[bucket]);
+        }
+    }
+}
+
+uint32_t lock_stats_percentile(const uint32_t *histogram, uint8_t percent)
+{
+    uint64_t count = 0, target, total = 0;
+    uint8_t bucket;
+
+    for(bucket = 0; bucket < LOCK_STATS_BUCKETS; bucket++)
+    {
+        count += histogram[bucket];
+    }
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    // Upper bound (us) of the bucket which contains the requested percentile.
+    target = ((count * percent) + 99) / 100;
+    for(bucket = 0; bucket < LOCK_STATS_BUCKETS; bucket++)
+    {
+        total += histogram[bucket];
+        if(total >= target)
+        {
+            break;
+        }
+    }
+
+    return (uint32_t)1 << MIN(bucket, LOCK_STATS_BUCKETS - 1);
+}
@@ -0,0 +1,71 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Mutex with hold time, wait time and trylock failure metrics.                  *
+ *                                                                               *
+ * Counters of a caller are updated while the mutex is held, so the mutex        *
+ * itself serializes the writers. Only failed trylocks use atomic adds.          *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_LOCKSTATS_HEADER_
+#define _GTK_FM_TUNER_LOCKSTATS_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+// Number of callers tracked by a mutex (callers are I2CSubsystem values).
+#define LOCK_STATS_CALLERS      6
+
+// Wait and hold histogram buckets, bucket n holds times shorter than 2^n us.
+#define LOCK_STATS_BUCKETS      24
+
+typedef struct LockCallerStats
+{
+    uint32_t locks;             // Blocking acquisitions.
+    uint32_t trylocks;          // Trylock attempts.
+    uint32_t trylockFailures;   // Trylock attempts which found the mutex busy.
+    uint64_t waitTime;          // Total wait time of blocking acquisitions in ns.
+    uint64_t maxWaitTime;
+    uint64_t holdTime;          // Total hold time in ns.
+    uint64_t maxHoldTime;
+    uint32_t waitHistogram[LOCK_STATS_BUCKETS];
+    uint32_t holdHistogram[LOCK_STATS_BUCKETS];
+} LockCallerStats;
+
+typedef struct TrackedMutex
+{
+    GMutex mutex;
+    uint64_t acquireTime;       // Written by the current holder only.
+    uint8_t holder;
+    LockCallerStats callers[LOCK_STATS_CALLERS];
+} TrackedMutex;
+
+void tracked_mutex_lock(TrackedMutex *lock, uint8_t caller);
+gboolean tracked_mutex_trylock(TrackedMutex *lock, uint8_t caller);
+void tracked_mutex_unlock(TrackedMutex *lock);
+
+void tracked_mutex_read(TrackedMutex *lock, LockCallerStats *callerStats);
+uint32_t lock_stats_percentile(const uint32_t *histogram, uint8_t percent);
+
+#endif /* _GTK_FM_TUNER_LOCKSTATS_HEADER_ */
@@ -27,10 +27,27 @@
 
 #include <gtk/gtk.h>
 #include <glib.h>
-#include <pthread.h>
+#include <string.h>
 
 #include "main.h"
 #include "freqedit.h"
+#include "bandscope.h"
+#include "historyview.h"
+#include "rdsstatsview.h"
+#include "lockoverlay.h"
+#include "daemon.h"
+#include "simulation.h"
+#include "clocksource.h"
+#include "shmstatus.h"
+#include "command.h"
+#include "tunercore.h"
+#include "signalmeter.h"
+#include "recorder.h"
+#include "replay.h"
+#include "rdsclock.h"
+#include "trace.h"
+#include "metrics.h"
+#include "supervisor.h"
 #include "defmain.h"
 #include "defconfig.h"
 
@@ -45,18 +62,200 @@ MainWindow mainWindow;
 GdkPixbuf *appLogo;
 static Tuner fmtuner;
 
-// Resources for station scanner thread.
-static ScanContext channelScanParam;
-pthread_t scanThread;
+// Latest tuner status received from the tuner core.
+static TunerStatus uiStatus;
+static StatusControls indControls;
+static SignalMeter signalMeter;
+
+// Status posted by the tuner core, applied to the UI only while the window is visible.
+static GMutex pendingStatusLock;
+static TunerStatus pendingStatus;
+static volatile gint statusUpdatePending;
+static volatile gint windowVisible;
+static gint64 uiStartTime;
 
 double appFrequency;
 
+// Latest scan progress (frequency * 100) waiting to be shown on the UI thread.
+static volatile gint scanProgressFreq;
+static volatile gint scanProgressPending;
+
+// Command line options.
+static gboolean daemonMode;
+static const char *daemonSocketPath;
+static const char *recordPath;
+static const char *replayPath;
+static double replaySpeed;
+static guint simulateDuration;
+static RDSClockOutput ctClockOutput;
+static uint8_t ctClockUnit;
+static const char *tracePath;
+static const char *traceLevelSpec;
+static const char *traceDumpDir;
+static const char *metricsEndpoint;
+static const char *bandPlanName;
+static long scanStepKHz;
+
+static uint8_t parse_arguments(int argc, char *argv[])
+{
+    int argPos;
+
+    daemonMode = FALSE;
+    daemonSocketPath = DAEMON_SOCKET_PATH;
+    recordPath = NULL;
+    replayPath = NULL;
+    replaySpeed = 1;
+    simulateDuration = 0;
+    ctClockOutput = RCO_NONE;
+    ctClockUnit = 0;
+    tracePath = NULL;
+    traceLevelSpec = NULL;
+    traceDumpDir = NULL;
+    metricsEndpoint = NULL;
+    bandPlanName = NULL;
+    scanStepKHz = 0;
+
+    for(argPos = 1; argPos < argc; argPos++)
+    {
+        if(strcmp(argv[argPos], "--daemon") == 0)
+        {
+            daemonMode = TRUE;
+
+            // Socket path is optional.
+            if(((argPos + 1) < argc) && (strncmp(argv[argPos + 1], "--", 2) != 0))
+            {
+                daemonSocketPath = argv[++argPos];
+            }
+        }
+        else if((strcmp(argv[argPos], "--record") == 0) && ((argPos + 1) < argc))
+        {
+            recordPath = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--replay") == 0) && ((argPos + 1) < argc))
+        {
+            replayPath = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--speed") == 0) && ((argPos + 1) < argc))
+        {
+            argPos++;
+            replaySpeed = (strcmp(argv[argPos], "max") == 0) ? REPLAY_SPEED_MAX : g_ascii_strtod(argv[argPos], NULL);
+            if((replaySpeed < 0) || ((replaySpeed == 0) && (strcmp(argv[argPos], "max") != 0)))
+            {
+                g_printerr("Invalid replay speed %s\n", argv[argPos]);
+                return RESULT_FAIL;
+            }
+        }
+        else if((strcmp(argv[argPos], "--simulate") == 0) && ((argPos + 1) < argc))
+        {
+            // Simulated session length in seconds, the capture is replayed on the virtual clock.
+            argPos++;
+            simulateDuration = (guint)g_ascii_strtoull(argv[argPos], NULL, 10);
+            if(simulateDuration == 0)
+            {
+                g_printerr("Invalid simulation time %s\n", argv[argPos]);
+                return RESULT_FAIL;
+            }
+        }
+        else if((strcmp(argv[argPos], "--trace") == 0) && ((argPos + 1) < argc))
+        {
+            tracePath = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--trace-level") == 0) && ((argPos + 1) < argc))
+        {
+            traceLevelSpec = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--trace-dir") == 0) && ((argPos + 1) < argc))
+        {
+            // Directory of the on demand and crash trace dumps.
+            traceDumpDir = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--band") == 0) && ((argPos + 1) < argc))
+        {
+            // Band plan: eu, jp, oirt or wide.
+            bandPlanName = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--scan-step") == 0) && ((argPos + 1) < argc))
+        {
+            // Seek step of the band plan in kHz: 50, 100 or 200.
+            scanStepKHz = (long)g_ascii_strtoll(argv[++argPos], NULL, 10);
+        }
+        else if((strcmp(argv[argPos], "--metrics") == 0) && ((argPos + 1) < argc))
+        {
+            // Prometheus endpoint: loopback TCP port or Unix socket path.
+            metricsEndpoint = argv[++argPos];
+        }
+        else if((strcmp(argv[argPos], "--ct-clock") == 0) && ((argPos + 1) < argc))
+        {
+            // RDS clock time output: system or shm[:unit].
+            argPos++;
+            if(strcmp(argv[argPos], "system") == 0)
+            {
+                ctClockOutput = RCO_SYSTEM;
+            }
+            else if(strncmp(argv[argPos], "shm", 3) == 0)
+            {
+                ctClockOutput = RCO_NTP_SHM;
+                ctClockUnit = (argv[argPos][3] == ':') ? (uint8_t)g_ascii_strtoull(argv[argPos] + 4, NULL, 10) : 0;
+            }
+            else
+            {
+                g_printerr("Invalid clock output %s\n", argv[argPos]);
+                return RESULT_FAIL;
+            }
+        }
+    }
+
+    if((simulateDuration > 0) && (replayPath == NULL))
+    {
+        g_printerr("Simulation needs a capture file (--replay)\n");
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
-    GtkBuilder *builder;     
-    StatusControls indControls;
+    GtkBuilder *builder;
+    GError *uiError = NULL;
+    gchar *mainObjectIds[] = {"gtk-fm-tuner-app", "menu1", "image1", "image2", "image3", "image4", "image5", "image6", "image7", NULL};
+
+    const BandPlan *bandPlan;
+
+    if(parse_arguments(argc, argv) == RESULT_FAIL)
+    {
+        return 1;
+    }
+
+    // Channel tables of all band plans are built once, before any tuner thread starts.
+    band_plan_init();
+    if(bandPlanName != NULL)
+    {
+        bandPlan = band_plan_find(bandPlanName);
+        if(bandPlan == NULL)
+        {
+            g_printerr("Invalid band plan %s\n", bandPlanName);
+            return 1;
+        }
+
+        band_plan_select(bandPlan->id);
+    }
+
+    if((scanStepKHz != 0) && ((scanStepKHz < 0) || (scanStepKHz > BAND_PLAN_MAX_SCAN_STEP) || (band_plan_set_scan_step(band_plan_get(), (uint16_t)scanStepKHz) != RESULT_SUCCESS)))
+    {
+        g_printerr("Invalid scan step %ld for band plan %s\n", scanStepKHz, band_plan_get()->name);
+        return 1;
+    }
 
-    appFrequency = TUNER_MIN_FREQUENCY;
+    appFrequency = band_plan_get()->frequencies[0];
+
+    // Trace file is optional, the rings are still kept for dumps without it.
+    trace_init(tracePath, traceDumpDir);
+    if((traceLevelSpec != NULL) && (trace_set_levels(traceLevelSpec) == RESULT_FAIL))
+    {
+        g_printerr("Invalid trace level %s\n", traceLevelSpec);
+        return 1;
+    }
 
 #if TUNER == TUNER_QN8035
     // Assign QN8035 functions into the tuner.
@@ -65,7 +264,13 @@ int main(int argc, char *argv[])
 
     fmtuner.set_frequency = qn8035_tuner_set_frequency;
     fmtuner.get_frequency = qn8035_tuner_get_frequency;
+    fmtuner.set_channel = qn8035_tuner_set_channel;
+    fmtuner.get_channel = qn8035_tuner_get_channel;
+    fmtuner.set_band_plan = qn8035_set_band_plan;
     fmtuner.scan_channel = qn8035_tuner_scan;
+    fmtuner.cancel_scan = qn8035_cancel_scan;
+    fmtuner.preempt_scan = qn8035_preempt_scan;
+    fmtuner.set_scan_progress = qn8035_set_scan_progress_handler;
 
     fmtuner.set_volume = qn8035_set_volume;
     fmtuner.get_volume = qn8035_get_volume;
@@ -74,11 +279,102 @@ int main(int argc, char *argv[])
     fmtuner.stereo_mpx = qn8035_get_stereo_mpx_status;
     fmtuner.snr = qn8035_get_snr;
     fmtuner.rssi = qn8035_get_rssi;
+    fmtuner.rds_read_group = qn8035_rds_read_group;
+    fmtuner.rds_decode_group = qn8035_rds_decode_group;
+    fmtuner.get_lock_stats = qn8035_get_lock_stats;
+    fmtuner.check_device = qn8035_check_device;
+    fmtuner.reconnect = qn8035_reconnect;
+
+    fmtuner.maxVolume = QN8035_MAX_VOLUME;
 #endif    
 
-    // Initialize GTK and loading main window from glade file.
+    // Replay mode feeds a capture file through the same RDS decoder, telemetry and UI.
+    if(replayPath != NULL)
+    {
+        if(replay_open(replayPath, replaySpeed) == RESULT_FAIL)
+        {
+            return 1;
+        }
+
+        fmtuner.init = replay_tuner_init;
+        fmtuner.shutdown = replay_tuner_shutdown;
+
+        fmtuner.set_frequency = replay_tuner_set_frequency;
+        fmtuner.get_frequency = replay_tuner_get_frequency;
+        fmtuner.set_channel = replay_tuner_set_channel;
+        fmtuner.get_channel = replay_tuner_get_channel;
+        fmtuner.set_band_plan = NULL;
+        fmtuner.scan_channel = replay_tuner_scan;
+        fmtuner.cancel_scan = replay_cancel_scan;
+        fmtuner.preempt_scan = NULL;
+        fmtuner.set_scan_progress = NULL;
+
+        fmtuner.set_volume = replay_set_volume;
+        fmtuner.get_volume = replay_get_volume;
+        fmtuner.change_volume = replay_change_volume;
+
+        fmtuner.stereo_mpx = replay_get_stereo_mpx_status;
+        fmtuner.snr = replay_get_snr;
+        fmtuner.rssi = replay_get_rssi;
+        fmtuner.rds_read_group = replay_rds_read_group;
+        fmtuner.get_lock_stats = NULL;
+        fmtuner.check_device = NULL;
+        fmtuner.reconnect = NULL;
+
+#if TUNER == TUNER_QN8035
+        // Tuner is not initialized, so the decoder buffers are created here.
+        qn8035_init_rds_decoder();
+        qn8035_rds_reset();
+        replay_set_rds_reset_handler(qn8035_rds_reset);
+#endif
+    }
+
+    // Simulation replays the capture headless on the virtual clock, the clock must be switched before the tuner starts.
+    if(simulateDuration > 0)
+    {
+        clock_source_set_virtual(TRUE);
+        if(start_tuner() == RESULT_FAIL)
+        {
+            g_printerr("Unable to initialize the FM tuner\n");
+            return 1;
+        }
+
+        run_tuner_simulation(&fmtuner, simulateDuration);
+        metrics_server_stop();
+        shm_status_close();
+        fmtuner.shutdown();
+        trace_shutdown();
+        return 0;
+    }
+
+    // Headless mode runs the tuner through the control socket without initializing GTK.
+    if(daemonMode)
+    {
+        if(start_tuner() == RESULT_FAIL)
+        {
+            g_printerr("Unable to initialize the FM tuner\n");
+            return 1;
+        }
+
+        run_tuner_daemon(&fmtuner, daemonSocketPath);
+        supervisor_stop();
+        metrics_server_stop();
+        shm_status_close();
+        fmtuner.shutdown();
+        trace_shutdown();
+        return 0;
+    }
+
+    // Initialize GTK and loading main window from the compiled UI resource.
     gtk_init(&argc, &argv);
-    builder = gtk_builder_new_from_file("glade/gtkfmtuner.glade");
+    builder = gtk_builder_new();
+    if(gtk_builder_add_objects_from_resource(builder, UI_RESOURCE_PATH, mainObjectIds, &uiError) == 0)
+    {
+        g_printerr("Unable to load the main window from %s: %s\n", UI_RESOURCE_PATH, uiError->message);
+        g_error_free(uiError);
+        g_object_unref(builder);
+        return 1;
+    }
 
     mainWindow.window = GTK_WIDGET(gtk_builder_get_object(builder, "gtk-fm-tuner-app"));
     mainWindow.frequencyDisplay = GTK_LABEL(gtk_builder_get_object(builder, "lblFreq"));
@@ -86,6 +382,8 @@ int main(int argc, char *argv[])
     mainWindow.SNR = GTK_LABEL(gtk_builder_get_object(builder, "lblSNR"));
     mainWindow.RSSI = GTK_LABEL(gtk_builder_get_object(builder, "lblRSSI"));
     mainWindow.RDSText = GTK_LABEL(gtk_builder_get_object(builder, "lblRDS"));
+    mainWindow.signalMeter = GTK_WIDGET(gtk_builder_get_object(builder, "drwSignalMeter"));
+    mainWindow.lockOverlay = GTK_LABEL(gtk_builder_get_object(builder, "lblLockOverlay"));
 
     // Setup events and release builder.
     gtk_builder_connect_signals(builder, NULL);
@@ -96,7 +394,7 @@ int main(int argc, char *argv[])
     g_message("Initializing FM tuner..."); 
 #endif   
 
-    if(fmtuner.init() == RESULT_FAIL)
+    if(start_tuner() == RESULT_FAIL)
     {
         // Tuner initialization fail.
         GtkWidget *dlgError;
@@ -116,6 +414,8 @@ int main(int argc, char *argv[])
     indControls.SNR = mainWindow.SNR;
     indControls.RSSI = mainWindow.RSSI;
     indControls.RDSText = mainWindow.RDSText;
+    indControls.labelUpdates = 0;
+    indControls.labelSkips = 0;
 
     // Clear text values in unsupported fields.
     if(fmtuner.stereo_mpx == NULL)
@@ -132,6 +432,16 @@ int main(int argc, char *argv[])
     {
         gtk_label_set_text(indControls.RSSI, "");
     }
+
+    // Signal meter needs both RSSI and SNR readings.
+    signal_meter_init(&signalMeter, mainWindow.signalMeter);
+    if((fmtuner.rssi == NULL) || (fmtuner.snr == NULL))
+    {
+        gtk_widget_hide(mainWindow.signalMeter);
+    }
+
+    // Lock statistics overlay stays hidden until it is selected in the menu.
+    lock_overlay_init(mainWindow.lockOverlay, &fmtuner);
     
     // Display main application window.
     appLogo = gdk_pixbuf_new_from_resource("/com/jayakody2000lk/gtkfmtunericon/icon.png", NULL);
@@ -139,197 +449,338 @@ int main(int argc, char *argv[])
     gtk_window_set_title(GTK_WINDOW(mainWindow.window), APPLICATION_TITLE);
     gtk_widget_show(mainWindow.window); 
 
+    // Show channels checked by the scanner as a moving dial.
+    if(fmtuner.set_scan_progress != NULL)
+    {
+        fmtuner.set_scan_progress(on_tuner_scan_progress);
+    }
+
+    // Tuner I/O, telemetry and UI commands run on the tuner core thread.
+    uiStatus.frequency = -1;
+    uiStatus.channel = BAND_PLAN_NO_CHANNEL;
+    uiStartTime = g_get_monotonic_time();
+    g_atomic_int_set(&windowVisible, 1);
+    tuner_core_start_thread(&fmtuner, on_tuner_status_changed);
+
+    if(gtk_widget_get_visible(mainWindow.signalMeter))
+    {
+        signal_meter_set_active(&signalMeter, TRUE);
+    }
+    
+    gtk_main();
+    return 0;
+}
+
+uint8_t start_tuner()
+{
+    gboolean isConnected;
+
+    // Supervised tuner is reconnected in the background, so a missing device does not stop the application.
+    isConnected = (fmtuner.init() == RESULT_SUCCESS);
+    if((!isConnected) && ((fmtuner.check_device == NULL) || (fmtuner.reconnect == NULL)))
+    {
+        return RESULT_FAIL;
+    }
+
+    if(!isConnected)
+    {
+        g_warning("FM tuner is not connected, waiting for the device");
+    }
+
+    supervisor_start(&fmtuner, isConnected);
+
     // Assign RDS buffer into the tuner.
 #if TUNER == TUNER_QN8035
     fmtuner.rdsData = qn8035RDSInfo;
 #endif
 
-    // Get tuner information to display on application window.
-    update_tuner_information(&indControls);
-    g_timeout_add_full(G_PRIORITY_DEFAULT, DISPLAY_INFO_UPDATE_RATE, (GSourceFunc)on_display_refresh_handler, &indControls, NULL);
+    // Status segment is optional, tuner works without it.
+    if(shm_status_init() == RESULT_FAIL)
+    {
+        g_warning("Shared memory status segment is not available");
+    }
 
-    // Create station scan worker.
-    create_scan_worker();
-    
-    gtk_main();
-    return 0;
+    // Metrics are served from the status segment and lock free counters, a failure only disables the endpoint.
+    if((metricsEndpoint != NULL) && (metrics_server_start(metricsEndpoint) == RESULT_FAIL))
+    {
+        g_warning("Unable to start the metrics endpoint");
+    }
+
+    // Capture is optional as well, a failure only disables the recording.
+    if((recordPath != NULL) && (recorder_open(recordPath, ((replayPath != NULL) ? "REPLAY" : TUNER_NAME)) == RESULT_FAIL))
+    {
+        g_warning("Unable to start the capture recording");
+    }
+
+    // Replayed clock groups are old, so they never drive the clock outputs.
+    rds_clock_init(((replayPath != NULL) ? RCO_NONE : ctClockOutput), ctClockUnit);
+
+    return RESULT_SUCCESS;
 }
 
-void update_tuner_information(StatusControls *indicatorControls)
+// Change label text only if it differs from the text already shown, to avoid needless relayout and redraw.
+static void set_status_label(StatusControls *indicatorControls, GtkLabel *label, char *shownText, size_t shownSize, const char *text)
+{
+    if(strncmp(shownText, text, shownSize) == 0)
+    {
+        indicatorControls->labelSkips++;
+        return;
+    }
+
+    g_strlcpy(shownText, text, shownSize);
+    gtk_label_set_text(label, shownText);
+    indicatorControls->labelUpdates++;
+}
+
+void update_tuner_information(StatusControls *indicatorControls, TunerStatus *status)
 {
-    char currentFreq[15];
     char infoBuffer[25];
-    double tempFreq;
-    uint8_t mpxState;
-    int16_t snr, rssi;
 
-    // Update current frequency.
-    tempFreq = fmtuner.get_frequency();
-    if(tempFreq > 0)
+    // Update current frequency, channels of the band plan have a precomputed label.
+    if(status->channel != BAND_PLAN_NO_CHANNEL)
+    {
+        set_status_label(indicatorControls, indicatorControls->frequencyDisplay, indicatorControls->frequencyText, sizeof(indicatorControls->frequencyText), band_plan_get()->labels[status->channel]);
+    }
+    else if(status->frequency > 0)
     {
         // Display only the valid frequency readings from the tuner.
-        sprintf(currentFreq, "%.2lf MHz", tempFreq);
-        gtk_label_set_text(indicatorControls->frequencyDisplay, currentFreq);
+        sprintf(infoBuffer, "%.2lf MHz", status->frequency);
+        set_status_label(indicatorControls, indicatorControls->frequencyDisplay, indicatorControls->frequencyText, sizeof(indicatorControls->frequencyText), infoBuffer);
     }
 
     // Update current FM stereo multiplexing status.
-    if(fmtuner.stereo_mpx != NULL)
+    if((fmtuner.stereo_mpx != NULL) && (status->mpxState != MPXS_UNKNOWN))
     {
-        mpxState = fmtuner.stereo_mpx();
-        if(mpxState != MPXS_UNKNOWN)
-        {
-            gtk_label_set_text(indicatorControls->stereoStatus, ((mpxState == MPXS_MONO) ? "MONO" : "STEREO"));
-        }
+        set_status_label(indicatorControls, indicatorControls->stereoStatus, indicatorControls->stereoText, sizeof(indicatorControls->stereoText), ((status->mpxState == MPXS_MONO) ? "MONO" : "STEREO"));
     }
 
     // Update current SNR reading from the tuner.
-    if(fmtuner.snr != NULL)
+    if((fmtuner.snr != NULL) && (status->snr >= 0))
     {
-        snr = fmtuner.snr();
-        if(snr >= 0)
-        {
-            sprintf(infoBuffer, "SNR: %d", snr);
-            gtk_label_set_text(indicatorControls->SNR, infoBuffer);
-        }
+        sprintf(infoBuffer, "SNR: %d", status->snr);
+        set_status_label(indicatorControls, indicatorControls->SNR, indicatorControls->snrText, sizeof(indicatorControls->snrText), infoBuffer);
     }
 
     // Update current received signal strength indicator value.
-    if(fmtuner.rssi != NULL)
+    if((fmtuner.rssi != NULL) && (status->rssi >= 0))
     {
-        rssi = fmtuner.rssi();
-        if(rssi >= 0)
-        {
-            sprintf(infoBuffer, "RSSI: %d", rssi);
-            gtk_label_set_text(indicatorControls->RSSI, infoBuffer);
-        }
+        sprintf(infoBuffer, "RSSI: %d", status->rssi);
+        set_status_label(indicatorControls, indicatorControls->RSSI, indicatorControls->rssiText, sizeof(indicatorControls->rssiText), infoBuffer);
     }
 
     if(fmtuner.rdsData != NULL)
     {
-        gtk_label_set_text(indicatorControls->RDSText, fmtuner.rdsData);
+        set_status_label(indicatorControls, indicatorControls->RDSText, indicatorControls->rdsText, sizeof(indicatorControls->rdsText), status->rdsText);
+    }
+}
+
+static void schedule_status_update()
+{
+    // Only one UI update is queued at a time, it always applies the latest posted status.
+    if(g_atomic_int_get(&windowVisible) && g_atomic_int_compare_and_exchange(&statusUpdatePending, 0, 1))
+    {
+        g_idle_add(on_status_update, NULL);
     }
 }
 
+// Called from the tuner core thread whenever tuner status has changed.
+void on_tuner_status_changed(TunerStatus *status)
+{
+    g_mutex_lock(&pendingStatusLock);
+    pendingStatus = *status;
+    g_mutex_unlock(&pendingStatusLock);
+
+    schedule_status_update();
+}
+
+gboolean on_status_update(gpointer userData)
+{
+    g_atomic_int_set(&statusUpdatePending, 0);
+
+    g_mutex_lock(&pendingStatusLock);
+    uiStatus = pendingStatus;
+    g_mutex_unlock(&pendingStatusLock);
+
+    update_tuner_information(&indControls, &uiStatus);
+    return G_SOURCE_REMOVE;
+}
+
+// Raise when main window is minimized, restored, hidden or shown.
+gboolean on_window_main_state_event(GtkWidget *widget, GdkEventWindowState *event, gpointer userData)
+{
+    gboolean isVisible;
+
+    if(!(event->changed_mask & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)))
+    {
+        return FALSE;
+    }
+
+    isVisible = !(event->new_window_state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN));
+    g_atomic_int_set(&windowVisible, isVisible ? 1 : 0);
+
+    TRACE_LOG(TE_UI_VISIBILITY, isVisible);
+
+    // Nobody is watching the labels, poll the tuner only to keep the shared status segment alive.
+    tuner_core_set_telemetry_rate(isVisible ? TELEMETRY_UPDATE_RATE : TELEMETRY_IDLE_RATE);
+
+    if(gtk_widget_get_visible(mainWindow.signalMeter))
+    {
+        signal_meter_set_active(&signalMeter, isVisible);
+    }
+
+    if(isVisible)
+    {
+        // Bring the labels up to date with the status received while hidden.
+        schedule_status_update();
+    }
+
+    return FALSE;
+}
+
 // Raise when window is closed.
 void on_window_main_destroy()
 {
-    // Shutdown station scanner thread.
-    channelScanParam.state = ST_END;
+#ifdef DEBUG_LOGS
+    double elapsedMinutes;
+#endif
+
+    // Stop tuner core thread, running seek is aborted first (the tuner shutdown stops the hardware scan).
+    if(fmtuner.preempt_scan != NULL)
+    {
+        fmtuner.preempt_scan();
+    }
+
+    signal_meter_set_active(&signalMeter, FALSE);
+    tuner_core_shutdown();
+
+#ifdef DEBUG_LOGS
+    elapsedMinutes = (double)(g_get_monotonic_time() - uiStartTime) / (60 * G_USEC_PER_SEC);
+    if(elapsedMinutes > 0)
+    {
+        g_message("Status labels updated %.1lf/min, %.1lf/min unchanged updates skipped", (indControls.labelUpdates / elapsedMinutes), (indControls.labelSkips / elapsedMinutes));
+    }
+#endif
 
     // Shutdown FM tuner.
+    supervisor_stop();
+    metrics_server_stop();
+    shm_status_close();
     fmtuner.shutdown();
+    trace_shutdown();
 
     // Terminate application.
     gtk_main_quit();
 }
 
+// Activate event handler for band scope menu item.
+void on_mnuBandScope_activate()
+{
+    show_band_scope_window(mainWindow.window);
+}
+
+// Activate event handler for signal history menu item.
+void on_mnuSignalHistory_activate()
+{
+    show_signal_history_window(mainWindow.window);
+}
+
+// Activate event handler for RDS statistics menu item.
+void on_mnuRDSStatistics_activate()
+{
+    show_rds_statistics_window(mainWindow.window);
+}
+
+void on_mnuLockOverlay_toggled(GtkCheckMenuItem *menuItem)
+{
+    lock_overlay_set_active(gtk_check_menu_item_get_active(menuItem));
+}
+
 // Click event handler for minimum frequency button.
 void on_btnMinFreq_clicked()
 {
-    fmtuner.set_frequency(LOW_FREQ);
+    command_set_channel(0);
 }
 
 // Click event handler for scan down button.
 void on_btnScanDown_clicked()
 {
-    channelScanParam.scanDirection = SCAN_DOWN;
-    channelScanParam.state = ST_START;
+    restart_channel_scan(SCAN_DOWN);
 }
 
 // Click event handler to frequency edit button.
 void on_btnEditFreq_clicked()
 {
-    uint8_t tryCount = 0;
-    
-    // Get current frequency from the tuner.
-    do
-    {
-        appFrequency = fmtuner.get_frequency();
-        gtk_main_iteration();
+    // Start from the last frequency reported by the tuner core.
+    appFrequency = uiStatus.frequency;
 
-    } while (((++tryCount) < 10) && (appFrequency < 0) && gtk_events_pending());
-    
     // Check for valid frequency range.
-    if((appFrequency < LOW_FREQ) || (appFrequency > HIGH_FREQ))
+    if(band_plan_mhz_to_channel(band_plan_get(), appFrequency) == BAND_PLAN_NO_CHANNEL)
     {
         // Invalid frequency range. Reset app frequency to lower frequency limit.
-        appFrequency = LOW_FREQ;
+        appFrequency = band_plan_get()->frequencies[0];
     }
     
     if(show_frequency_edit_window(mainWindow.window, &appFrequency) == RESULT_SUCCESS)
     {
-        fmtuner.set_frequency(appFrequency);
+        // Entered frequency snaps to the nearest channel of the band plan.
+        command_set_channel((uint16_t)band_plan_mhz_to_channel(band_plan_get(), appFrequency));
     }
 }
 
 // Click event handler for scan up button.
 void on_btnScanUp_clicked()
 {
-    channelScanParam.scanDirection = SCAN_UP;
-    channelScanParam.state = ST_START;
+    restart_channel_scan(SCAN_UP);
 }
 
 // Click event handler for maximum frequency button. 
 void on_btnMaxFreq_clicked()
 {
-    fmtuner.set_frequency(HIGH_FREQ);
+    command_set_channel(band_plan_last_channel(band_plan_get()));
 }
 
 // Click event handler for volume up button. 
 void on_btnVolUp_clicked()
 {
-    fmtuner.change_volume(VOLUME_UP);
+    command_change_volume(VOLUME_UP);
 }
 
 // Click event handler for volume down button. 
 void on_btnVolDown_clicked()
 {
-    fmtuner.change_volume(VOLUME_DOWN);
+    command_change_volume(VOLUME_DOWN);
 }
 
-gboolean on_display_refresh_handler(StatusControls *indicatorControls)
+void restart_channel_scan(ScanDirection direction)
 {
-    update_tuner_information(indicatorControls);
-    return TRUE;
+    // New scan request aborts the running scan instead of waiting for it.
+    command_scan(direction);
 }
 
-void create_scan_worker()
+// Called from the tuner core thread for every channel checked by the tuner.
+void on_tuner_scan_progress(double frequency)
 {
-    // Create scanner thread and switch it to IDLE state.
-    channelScanParam.tunerRef = &fmtuner;
-    channelScanParam.scanDirection = SCAN_DOWN;
-    channelScanParam.state = ST_IDLE;
+    g_atomic_int_set(&scanProgressFreq, (gint)((frequency * 100) + 0.5));
 
-    // Station scanner thread.
-    pthread_create(&scanThread, NULL, tuner_channel_scan_thread, (void*)(&channelScanParam));
+    // Schedule only one UI update at a time, intermediate readings are dropped.
+    if(g_atomic_int_get(&windowVisible) && g_atomic_int_compare_and_exchange(&scanProgressPending, 0, 1))
+    {
+        g_idle_add(on_scan_progress_update, NULL);
+    }
 }
 
-void *tuner_channel_scan_thread(void *threadStruct)
+gboolean on_scan_progress_update(gpointer userData)
 {
-    ScanContext *channelScanParam = (ScanContext*)threadStruct;
+    char currentFreq[15];
+    gint freq;
 
-    // Sleep time structure to keep CPU happy.
-    struct timespec threadSleeper;
-    threadSleeper.tv_sec = 0;
-    threadSleeper.tv_nsec = 7500000;
+    g_atomic_int_set(&scanProgressPending, 0);
+    freq = g_atomic_int_get(&scanProgressFreq);
 
-    // Thread service loop.
-    while (channelScanParam->state != ST_END)
-    {
-        if(channelScanParam->state == ST_START)
-        {
-            // Start new scan job!
-            channelScanParam->state = ST_BUSY;
-            channelScanParam->tunerRef->scan_channel(channelScanParam->scanDirection); 
-            channelScanParam->state = ST_IDLE;
-        }
+    sprintf(currentFreq, "%d.%02d MHz", (freq / 100), (freq % 100));
+    set_status_label(&indControls, indControls.frequencyDisplay, indControls.frequencyText, sizeof(indControls.frequencyText), currentFreq);
 
-        // Allow CPU to release from this task!
-        nanosleep(&threadSleeper, NULL);
-    }
-    
-    // End of scanner thread.
-    return NULL;
+    return G_SOURCE_REMOVE;
 }
 
 void on_mnuClose_activate()
@@ -364,4 +815,4 @@ void on_mnuAbout_activate()
     "title", "About",
     "screen", gtk_widget_get_screen(mainWindow.window),
     NULL);
-}
\ No newline at end of file
+}
@@ -30,10 +30,11 @@
 
 #include "defmain.h"
 
-// Refresh rate of frequency and other channel/tuner information in ms.
-#define DISPLAY_INFO_UPDATE_RATE 500
-
 void on_window_main_destroy(void);
+void on_mnuBandScope_activate(void);
+void on_mnuSignalHistory_activate(void);
+void on_mnuRDSStatistics_activate(void);
+void on_mnuLockOverlay_toggled(GtkCheckMenuItem *menuItem);
 void on_btnMinFreq_clicked(void);
 void on_btnScanDown_clicked(void);
 void on_btnEditFreq_clicked(void);
@@ -42,10 +43,13 @@ void on_btnMaxFreq_clicked(void);
 void on_btnVolUp_clicked(void);
 void on_btnVolDown_clicked(void);
 
-void update_tuner_information(StatusControls *indicatorControls);
-gboolean on_display_refresh_handler(StatusControls *indicatorControls);
-
-void *tuner_channel_scan_thread(void *threadStruct);
-void create_scan_worker(void);
+uint8_t start_tuner(void);
+void update_tuner_information(StatusControls *indicatorControls, TunerStatus *status);
+void on_tuner_status_changed(TunerStatus *status);
+gboolean on_status_update(gpointer userData);
+gboolean on_window_main_state_event(GtkWidget *widget, GdkEventWindowState *event, gpointer userData);
+void restart_channel_scan(ScanDirection direction);
+void on_tuner_scan_progress(double frequency);
+gboolean on_scan_progress_update(gpointer userData);
 
 #endif /* _GTK_FM_TUNER_MAIN_HEADER_ */
\ No newline at end of file
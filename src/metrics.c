@@ -0,0 +1,637 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Local metrics endpoint in Prometheus text exposition format.                  *
+ *                                                                               *
+ * Tuner threads keep pre-aggregated counters with relaxed atomic adds, the      *
+ * exporter thread builds every scrape from those counters, the I2C statistics   *
+ * blocks and the shared memory status snapshot. A scrape never touches the I2C  *
+ * bus and never takes a lock shared with the tuner threads.                     *
+ *                                                                               *
+ *********************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "metrics.h"
+#include "i2cstats.h"
+#include "i2chealth.h"
+#include "supervisor.h"
+#include "shmstatus.h"
+#include "tunercore.h"
+#include "scancal.h"
+
+static MetricsServer metricsServer = {-1, -1};
+static uint64_t metricsCounters[MC_COUNT];
+static uint64_t scanCounts[MSR_COUNT];
+static uint64_t scanDurationBuckets[METRICS_SCAN_BUCKETS + 1];
+static uint64_t scanDurationSum;
+static uint64_t scrapeCount;
+
+// Upper bounds of the scan duration buckets in ms, the last bucket is +Inf.
+static const uint32_t scanBucketLimits[METRICS_SCAN_BUCKETS] = {10, 25, 50, 75, 100, 150, 250, 500};
+
+static const char *scanResultNames[MSR_COUNT] = {"found", "not_found", "preempted"};
+
+void metrics_count(MetricsCounter counter, uint64_t value)
+{
+    __atomic_fetch_add(&metricsCounters[counter], value, __ATOMIC_RELAXED);
+}
+
+void metrics_add_scan(MetricsScanResult result, uint64_t durationUs)
+{
+    uint8_t bucket;
+
+    __atomic_fetch_add(&scanCounts[result], 1, __ATOMIC_RELAXED);
+
+    // Preempted seeks end at an arbitrary point, only finished seeks are timed.
+    if(result == MSR_PREEMPTED)
+    {
+        return;
+    }
+
+    for(bucket = 0; bucket < METRICS_SCAN_BUCKETS; bucket++)
+    {
+        if(durationUs <= ((uint64_t)scanBucketLimits[bucket] * 1000))
+        {
+            break;
+        }
+    }
+
+    __atomic_fetch_add(&scanDurationBuckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&scanDurationSum, durationUs, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t metrics_load(uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void metrics_write_header(GString *output, const char *name, const char *type, const char *help)
+{
+    g_string_append_printf(output, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void metrics_write_status(GString *output)
+{
+    FMStatusSnapshot snapshot;
+    struct timespec timeNow;
+    uint64_t currentTime;
+
+    // Status values are written by the telemetry timer, the exporter only copies the last snapshot.
+    if(shm_status_read(&snapshot) == RESULT_FAIL)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &timeNow);
+    currentTime = ((uint64_t)timeNow.tv_sec * 1000000) + (timeNow.tv_nsec / 1000);
+
+    metrics_write_header(output, "fmtuner_frequency_hertz", "gauge", "Tuned frequency.");
+    g_string_append_printf(output, "fmtuner_frequency_hertz %" G_GUINT64_FORMAT "\n", (guint64)snapshot.frequency * 1000);
+
+    metrics_write_header(output, "fmtuner_rssi", "gauge", "Received signal strength indicator reported by the tuner.");
+    g_string_append_printf(output, "fmtuner_rssi %d\n", snapshot.rssi);
+
+    metrics_write_header(output, "fmtuner_snr", "gauge", "Signal to noise ratio reported by the tuner.");
+    g_string_append_printf(output, "fmtuner_snr %d\n", snapshot.snr);
+
+    // Stereo flag is left out until the tuner reported the MPX state.
+    if(snapshot.stereo != FMSTATUS_MPX_UNKNOWN)
+    {
+        metrics_write_header(output, "fmtuner_stereo", "gauge", "1 if the station is received in stereo.");
+        g_string_append_printf(output, "fmtuner_stereo %d\n", (snapshot.stereo == FMSTATUS_MPX_STEREO) ? 1 : 0);
+    }
+
+    metrics_write_header(output, "fmtuner_volume", "gauge", "Tuner volume level.");
+    g_string_append_printf(output, "fmtuner_volume %u\n", snapshot.volume);
+
+    metrics_write_header(output, "fmtuner_status_age_seconds", "gauge", "Time since the last status update.");
+    g_string_append_printf(output, "fmtuner_status_age_seconds %.3lf\n", (currentTime > snapshot.updateTime) ? (currentTime - snapshot.updateTime) / 1000000.0 : 0);
+
+    // RDS counters belong to the tuned station and restart on every station change.
+    metrics_write_header(output, "fmtuner_rds_station_groups", "gauge", "RDS groups received on the tuned station.");
+    g_string_append_printf(output, "fmtuner_rds_station_groups %u\n", snapshot.rdsStats.groups);
+
+    metrics_write_header(output, "fmtuner_rds_station_valid_groups", "gauge", "RDS groups without block errors received on the tuned station.");
+    g_string_append_printf(output, "fmtuner_rds_station_valid_groups %u\n", snapshot.rdsStats.validGroups);
+
+    metrics_write_header(output, "fmtuner_rds_station_missed_groups", "gauge", "Estimated RDS groups lost on the tuned station.");
+    g_string_append_printf(output, "fmtuner_rds_station_missed_groups %u\n", snapshot.rdsStats.missedGroups);
+
+    metrics_write_header(output, "fmtuner_rds_block_error_ratio", "gauge", "Share of uncorrectable RDS blocks on the tuned station.");
+    g_string_append_printf(output, "fmtuner_rds_block_error_ratio %.4lf\n", (snapshot.rdsStats.blocks > 0) ? (double)snapshot.rdsStats.blockErrors / snapshot.rdsStats.blocks : 0);
+
+    metrics_write_header(output, "fmtuner_rds_group_rate", "gauge", "Valid RDS groups per second on the tuned station.");
+    g_string_append_printf(output, "fmtuner_rds_group_rate %.2lf\n", snapshot.rdsStats.groupRate / 100.0);
+
+    metrics_write_header(output, "fmtuner_rds_clock_locked", "gauge", "1 if the clock time from RDS group 4A is locked.");
+    g_string_append_printf(output, "fmtuner_rds_clock_locked %u\n", snapshot.rdsClock.locked);
+
+    metrics_write_header(output, "fmtuner_rds_clock_quality", "gauge", "Quality score (0-100) of the RDS clock time.");
+    g_string_append_printf(output, "fmtuner_rds_clock_quality %u\n", snapshot.rdsClock.quality);
+}
+
+static void metrics_write_histogram_buckets(GString *output, const char *name, const char *labels, const uint32_t *histogram, uint8_t bucketCount)
+{
+    uint64_t total = 0;
+    uint8_t bucket;
+
+    // I2C histogram bucket n holds transactions shorter than 2^n us.
+    for(bucket = 0; bucket < bucketCount; bucket++)
+    {
+        total += histogram[bucket];
+        g_string_append_printf(output, "%s_bucket{%sle=\"%.6lf\"} %" G_GUINT64_FORMAT "\n", name, labels, ((uint64_t)1 << bucket) / 1000000.0, total);
+    }
+
+    g_string_append_printf(output, "%s_bucket{%sle=\"+Inf\"} %" G_GUINT64_FORMAT "\n", name, labels, total);
+}
+
+static void metrics_write_i2c_health(GString *output)
+{
+    I2CHealthStats health[I2C_HEALTH_MAX_DEVICES];
+    uint8_t deviceCount, pos, state;
+
+    deviceCount = i2c_health_device_count();
+    for(pos = 0; pos < deviceCount; pos++)
+    {
+        i2c_health_read(pos, &health[pos]);
+    }
+
+    metrics_write_header(output, "fmtuner_i2c_device_state", "gauge", "Health state of the I2C devices, 1 for the current state.");
+    for(pos = 0; pos < deviceCount; pos++)
+    {
+        for(state = 0; state < I2CH_COUNT; state++)
+        {
+            g_string_append_printf(output, "fmtuner_i2c_device_state{device=\"%s\",state=\"%s\"} %d\n", health[pos].name, i2c_health_state_name(state), ((health[pos].state == state) ? 1 : 0));
+        }
+    }
+
+    metrics_write_header(output, "fmtuner_i2c_retries_total", "counter", "Repeated attempts of failed I2C transactions.");
+    for(pos = 0; pos < deviceCount; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_i2c_retries_total{device=\"%s\"} %" G_GUINT64_FORMAT "\n", health[pos].name, health[pos].retries);
+    }
+
+    metrics_write_header(output, "fmtuner_i2c_recovered_total", "counter", "I2C transactions which succeeded after a retry.");
+    for(pos = 0; pos < deviceCount; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_i2c_recovered_total{device=\"%s\"} %" G_GUINT64_FORMAT "\n", health[pos].name, health[pos].recovered);
+    }
+
+    metrics_write_header(output, "fmtuner_i2c_failures_total", "counter", "I2C transactions which failed after all retries.");
+    for(pos = 0; pos < deviceCount; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_i2c_failures_total{device=\"%s\"} %" G_GUINT64_FORMAT "\n", health[pos].name, health[pos].failures);
+    }
+}
+
+static void metrics_write_supervisor(GString *output)
+{
+    SupervisorStats stats;
+
+    if(supervisor_read(&stats) == RESULT_FAIL)
+    {
+        return;
+    }
+
+    metrics_write_header(output, "fmtuner_tuner_connected", "gauge", "Tuner passed the last device check of the supervisor.");
+    g_string_append_printf(output, "fmtuner_tuner_connected %d\n", ((stats.state == SV_CONNECTED) ? 1 : 0));
+
+    metrics_write_header(output, "fmtuner_tuner_losses_total", "counter", "Tuner losses detected by the supervisor.");
+    g_string_append_printf(output, "fmtuner_tuner_losses_total %u\n", stats.losses);
+
+    metrics_write_header(output, "fmtuner_tuner_reconnect_attempts_total", "counter", "Reconnect attempts of the supervisor.");
+    g_string_append_printf(output, "fmtuner_tuner_reconnect_attempts_total %u\n", stats.attempts);
+
+    metrics_write_header(output, "fmtuner_tuner_recoveries_total", "counter", "Successful reconnects of the tuner.");
+    g_string_append_printf(output, "fmtuner_tuner_recoveries_total %u\n", stats.recoveries);
+
+    metrics_write_header(output, "fmtuner_tuner_recovery_seconds", "gauge", "Time from a tuner loss until it was reconnected.");
+    g_string_append_printf(output, "fmtuner_tuner_recovery_seconds{recovery=\"last\"} %.3lf\n", stats.lastRecoveryTime / 1000000.0);
+    g_string_append_printf(output, "fmtuner_tuner_recovery_seconds{recovery=\"max\"} %.3lf\n", stats.maxRecoveryTime / 1000000.0);
+}
+
+static void metrics_write_i2c(GString *output)
+{
+    I2CThreadStats *totalStats;
+    I2CSubsystemStats *subsystemStats;
+    char labels[32];
+    uint8_t pos;
+
+    totalStats = g_new(I2CThreadStats, 1);
+    i2c_stats_read(totalStats);
+
+    metrics_write_header(output, "fmtuner_i2c_transactions_total", "counter", "I2C register transactions of the tuner driver.");
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_i2c_transactions_total{subsystem=\"%s\"} %u\n", i2c_stats_subsystem_name(pos), totalStats->subsystems[pos].transactions);
+    }
+
+    metrics_write_header(output, "fmtuner_i2c_errors_total", "counter", "Failed I2C register transactions.");
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_i2c_errors_total{subsystem=\"%s\"} %u\n", i2c_stats_subsystem_name(pos), totalStats->subsystems[pos].errors);
+    }
+
+    metrics_write_i2c_health(output);
+    metrics_write_supervisor(output);
+
+    metrics_write_header(output, "fmtuner_i2c_latency_seconds", "histogram", "I2C register transaction latency.");
+    for(pos = 0; pos < I2CS_COUNT; pos++)
+    {
+        subsystemStats = &totalStats->subsystems[pos];
+        g_snprintf(labels, sizeof(labels), "subsystem=\"%s\",", i2c_stats_subsystem_name(pos));
+
+        metrics_write_histogram_buckets(output, "fmtuner_i2c_latency_seconds", labels, subsystemStats->histogram, I2C_STATS_BUCKETS);
+        g_string_append_printf(output, "fmtuner_i2c_latency_seconds_sum{subsystem=\"%s\"} %.6lf\n", i2c_stats_subsystem_name(pos), subsystemStats->busyTime / 1000000000.0);
+        g_string_append_printf(output, "fmtuner_i2c_latency_seconds_count{subsystem=\"%s\"} %u\n", i2c_stats_subsystem_name(pos), subsystemStats->transactions);
+    }
+
+    g_free(totalStats);
+}
+
+static void metrics_write_counters(GString *output)
+{
+    TunerStatusAge statusAge;
+    ScanCalibrationStats calibration;
+    uint64_t total = 0;
+    uint8_t pos;
+
+    metrics_write_header(output, "fmtuner_rds_groups_total", "counter", "RDS groups captured from the tuner.");
+    g_string_append_printf(output, "fmtuner_rds_groups_total %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_RDS_GROUPS]));
+
+    metrics_write_header(output, "fmtuner_rds_groups_discarded_total", "counter", "RDS groups captured during band sweeps and left out of the station statistics.");
+    g_string_append_printf(output, "fmtuner_rds_groups_discarded_total %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_RDS_GROUPS_DISCARDED]));
+
+    metrics_write_header(output, "fmtuner_rds_poll_limit_total", "counter", "RDS capture polls which reached the per poll group limit.");
+    g_string_append_printf(output, "fmtuner_rds_poll_limit_total %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_RDS_POLL_LIMIT]));
+
+    metrics_write_header(output, "fmtuner_scans_total", "counter", "Seek operations by result.");
+    for(pos = 0; pos < MSR_COUNT; pos++)
+    {
+        g_string_append_printf(output, "fmtuner_scans_total{result=\"%s\"} %" G_GUINT64_FORMAT "\n", scanResultNames[pos], metrics_load(&scanCounts[pos]));
+    }
+
+    metrics_write_header(output, "fmtuner_scan_duration_seconds", "histogram", "Duration of finished seek operations.");
+    for(pos = 0; pos < METRICS_SCAN_BUCKETS; pos++)
+    {
+        total += metrics_load(&scanDurationBuckets[pos]);
+        g_string_append_printf(output, "fmtuner_scan_duration_seconds_bucket{le=\"%.3lf\"} %" G_GUINT64_FORMAT "\n", scanBucketLimits[pos] / 1000.0, total);
+    }
+
+    total += metrics_load(&scanDurationBuckets[METRICS_SCAN_BUCKETS]);
+    g_string_append_printf(output, "fmtuner_scan_duration_seconds_bucket{le=\"+Inf\"} %" G_GUINT64_FORMAT "\n", total);
+    g_string_append_printf(output, "fmtuner_scan_duration_seconds_sum %.6lf\n", metrics_load(&scanDurationSum) / 1000000.0);
+    g_string_append_printf(output, "fmtuner_scan_duration_seconds_count %" G_GUINT64_FORMAT "\n", total);
+
+    scan_cal_read(&calibration);
+
+    metrics_write_header(output, "fmtuner_scan_false_stops_total", "counter", "Seek stops rejected by the post stop verification.");
+    g_string_append_printf(output, "fmtuner_scan_false_stops_total %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_SCAN_FALSE_STOPS]));
+
+    metrics_write_header(output, "fmtuner_scan_verify_seconds_total", "counter", "Time spent verifying seek stops.");
+    g_string_append_printf(output, "fmtuner_scan_verify_seconds_total %.6lf\n", metrics_load(&metricsCounters[MC_SCAN_VERIFY_TIME]) / 1000000.0);
+
+    metrics_write_header(output, "fmtuner_scan_threshold", "gauge", "CCA thresholds loaded into the tuner for seeks.");
+    g_string_append_printf(output, "fmtuner_scan_threshold{kind=\"rssi\"} %u\n", calibration.rssiThreshold);
+    g_string_append_printf(output, "fmtuner_scan_threshold{kind=\"snr\"} %u\n", calibration.snrThreshold);
+
+    if(calibration.calibrated)
+    {
+        metrics_write_header(output, "fmtuner_noise_floor", "gauge", "Noise floor of the band measured by the seek calibration.");
+        g_string_append_printf(output, "fmtuner_noise_floor{kind=\"rssi\"} %d\n", calibration.noiseRSSI);
+        g_string_append_printf(output, "fmtuner_noise_floor{kind=\"snr\"} %d\n", calibration.noiseSNR);
+    }
+
+    metrics_write_header(output, "fmtuner_wakeups_total", "counter", "Wakeups of the tuner threads.");
+    g_string_append_printf(output, "fmtuner_wakeups_total{thread=\"core\"} %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_EVENT_LOOP_WAKEUPS]));
+    g_string_append_printf(output, "fmtuner_wakeups_total{thread=\"seek\"} %" G_GUINT64_FORMAT "\n", metrics_load(&metricsCounters[MC_SCAN_POLLS]));
+
+    tuner_core_get_status_age(&statusAge);
+
+    metrics_write_header(output, "fmtuner_telemetry_polls_total", "counter", "Telemetry polls of the tuner core.");
+    g_string_append_printf(output, "fmtuner_telemetry_polls_total %u\n", statusAge.telemetryPolls);
+
+    metrics_write_header(output, "fmtuner_telemetry_skips_total", "counter", "Status readings dropped because the tuner was busy.");
+    g_string_append_printf(output, "fmtuner_telemetry_skips_total{reader=\"telemetry\"} %u\n", statusAge.telemetrySkips);
+    g_string_append_printf(output, "fmtuner_telemetry_skips_total{reader=\"meter\"} %u\n", statusAge.meterSkips);
+
+    metrics_write_header(output, "fmtuner_metrics_scrapes_total", "counter", "Scrapes served by the metrics endpoint.");
+    g_string_append_printf(output, "fmtuner_metrics_scrapes_total %" G_GUINT64_FORMAT "\n", metrics_load(&scrapeCount));
+}
+
+static gboolean metrics_send(int clientHandle, const char *data, size_t dataLen)
+{
+    ssize_t sentLen;
+
+    while(dataLen > 0)
+    {
+        sentLen = send(clientHandle, data, dataLen, MSG_NOSIGNAL);
+        if(sentLen <= 0)
+        {
+            return FALSE;
+        }
+
+        data += sentLen;
+        dataLen -= (size_t)sentLen;
+    }
+
+    return TRUE;
+}
+
+static void metrics_send_response(int clientHandle, const char *status, const char *contentType, GString *body)
+{
+    char headerBuffer[192];
+    int headerLen;
+
+    headerLen = g_snprintf(headerBuffer, sizeof(headerBuffer), "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %" G_GSIZE_FORMAT "\r\nConnection: close\r\n\r\n",
+        status, contentType, body->len);
+
+    if(metrics_send(clientHandle, headerBuffer, (size_t)headerLen))
+    {
+        metrics_send(clientHandle, body->str, body->len);
+    }
+}
+
+static void metrics_serve_client(int clientHandle)
+{
+    char requestBuffer[METRICS_REQUEST_MAX_SIZE + 1];
+    struct timeval ioTimeout;
+    GString *body;
+    size_t requestLen = 0;
+    ssize_t readLen;
+
+    // Scrapers which stall are dropped after the timeout, so they can not hold the exporter.
+    ioTimeout.tv_sec = METRICS_IO_TIMEOUT / 1000;
+    ioTimeout.tv_usec = (METRICS_IO_TIMEOUT % 1000) * 1000;
+    setsockopt(clientHandle, SOL_SOCKET, SO_RCVTIMEO, &ioTimeout, sizeof(ioTimeout));
+    setsockopt(clientHandle, SOL_SOCKET, SO_SNDTIMEO, &ioTimeout, sizeof(ioTimeout));
+
+    // Only the request line is used, the rest of the header is read to its end and ignored.
+    do
+    {
+        readLen = recv(clientHandle, requestBuffer + requestLen, METRICS_REQUEST_MAX_SIZE - requestLen, 0);
+        if(readLen <= 0)
+        {
+            return;
+        }
+
+        requestLen += (size_t)readLen;
+        requestBuffer[requestLen] = 0x00;
+    }
+    while((strstr(requestBuffer, "\r\n\r\n") == NULL) && (strstr(requestBuffer, "\n\n") == NULL) && (requestLen < METRICS_REQUEST_MAX_SIZE));
+
+    body = g_string_sized_new(16384);
+
+    if(strncmp(requestBuffer, "GET ", 4) != 0)
+    {
+        g_string_append(body, "Method not allowed\n");
+        metrics_send_response(clientHandle, "405 Method Not Allowed", "text/plain", body);
+    }
+    else if((strncmp(requestBuffer + 4, "/metrics ", 9) != 0) && (strncmp(requestBuffer + 4, "/ ", 2) != 0))
+    {
+        g_string_append(body, "Not found\n");
+        metrics_send_response(clientHandle, "404 Not Found", "text/plain", body);
+    }
+    else
+    {
+        __atomic_fetch_add(&scrapeCount, 1, __ATOMIC_RELAXED);
+
+        metrics_write_status(body);
+        metrics_write_counters(body);
+        metrics_write_i2c(body);
+        metrics_send_response(clientHandle, "200 OK", "text/plain; version=0.0.4; charset=utf-8", body);
+    }
+
+    g_string_free(body, TRUE);
+}
+
+static void *metrics_server_thread(void *threadStruct)
+{
+    MetricsServer *server = (MetricsServer *)threadStruct;
+    struct pollfd pollHandles[2];
+    int clientHandle;
+
+    pollHandles[0].fd = server->listenHandle;
+    pollHandles[0].events = POLLIN;
+    pollHandles[1].fd = server->stopHandle;
+    pollHandles[1].events = POLLIN;
+
+    // Scrapes are rare, clients are served one at a time.
+    while(TRUE)
+    {
+        if(poll(pollHandles, 2, -1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        if(pollHandles[1].revents != 0)
+        {
+            break;
+        }
+
+        if(pollHandles[0].revents & POLLIN)
+        {
+            clientHandle = accept4(server->listenHandle, NULL, NULL, SOCK_CLOEXEC);
+            if(clientHandle >= 0)
+            {
+                metrics_serve_client(clientHandle);
+                close(clientHandle);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static int metrics_create_socket(const char *endpoint)
+{
+    struct sockaddr_un unixAddress;
+    struct sockaddr_in inetAddress;
+    struct stat endpointStat;
+    guint64 port;
+    char *endPtr;
+    int socketHandle, reuseAddress = 1;
+
+    if(endpoint[0] == '/')
+    {
+        if(strlen(endpoint) >= sizeof(unixAddress.sun_path))
+        {
+            g_printerr("Metrics socket path is too long: %s\n", endpoint);
+            return -1;
+        }
+
+        socketHandle = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(socketHandle < 0)
+        {
+            return -1;
+        }
+
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        strcpy(unixAddress.sun_path, endpoint);
+
+        // Remove stale socket from previous session, any other kind of file is left in place.
+        if(lstat(endpoint, &endpointStat) == 0)
+        {
+            if(!S_ISSOCK(endpointStat.st_mode))
+            {
+                g_printerr("Metrics socket path %s exists and is not a socket\n", endpoint);
+                close(socketHandle);
+                return -1;
+            }
+
+            unlink(endpoint);
+        }
+
+        if(bind(socketHandle, (struct sockaddr *)&unixAddress, sizeof(unixAddress)) < 0)
+        {
+            g_printerr("Unable to bind metrics socket %s: %s\n", endpoint, strerror(errno));
+            close(socketHandle);
+            return -1;
+        }
+
+        metricsServer.socketPath = g_strdup(endpoint);
+    }
+    else
+    {
+        port = g_ascii_strtoull(endpoint, &endPtr, 10);
+        if((*endPtr != 0x00) || (port == 0) || (port > 65535))
+        {
+            g_printerr("Invalid metrics endpoint %s\n", endpoint);
+            return -1;
+        }
+
+        socketHandle = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(socketHandle < 0)
+        {
+            return -1;
+        }
+
+        setsockopt(socketHandle, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+        // Listener is bound to the loopback interface only.
+        memset(&inetAddress, 0, sizeof(inetAddress));
+        inetAddress.sin_family = AF_INET;
+        inetAddress.sin_port = htons((uint16_t)port);
+        inetAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if(bind(socketHandle, (struct sockaddr *)&inetAddress, sizeof(inetAddress)) < 0)
+        {
+            g_printerr("Unable to bind metrics port %s: %s\n", endpoint, strerror(errno));
+            close(socketHandle);
+            return -1;
+        }
+    }
+
+    if(listen(socketHandle, 4) < 0)
+    {
+        close(socketHandle);
+        return -1;
+    }
+
+    return socketHandle;
+}
+
+uint8_t metrics_server_start(const char *endpoint)
+{
+    if(metricsServer.running)
+    {
+        return RESULT_FAIL;
+    }
+
+    metricsServer.listenHandle = metrics_create_socket(endpoint);
+    if(metricsServer.listenHandle < 0)
+    {
+        return RESULT_FAIL;
+    }
+
+    metricsServer.stopHandle = eventfd(0, EFD_CLOEXEC);
+    if(metricsServer.stopHandle < 0)
+    {
+        metrics_server_stop();
+        return RESULT_FAIL;
+    }
+
+    metricsServer.running = TRUE;
+    pthread_create(&metricsServer.serverThread, NULL, metrics_server_thread, (void*)(&metricsServer));
+
+#ifdef DEBUG_LOGS
+    g_message("Metrics endpoint is listening on %s", endpoint);
+#endif
+
+    return RESULT_SUCCESS;
+}
+
+void metrics_server_stop()
+{
+    uint64_t stopSignal = 1;
+
+    if(metricsServer.running)
+    {
+        if(write(metricsServer.stopHandle, &stopSignal, sizeof(stopSignal)) == sizeof(stopSignal))
+        {
+            pthread_join(metricsServer.serverThread, NULL);
+        }
+
+        metricsServer.running = FALSE;
+    }
+
+    if(metricsServer.stopHandle >= 0)
+    {
+        close(metricsServer.stopHandle);
+        metricsServer.stopHandle = -1;
+    }
+
+    if(metricsServer.listenHandle >= 0)
+    {
+        close(metricsServer.listenHandle);
+        metricsServer.listenHandle = -1;
+    }
+
+    if(metricsServer.socketPath != NULL)
+    {
+        unlink(metricsServer.socketPath);
+        g_free(metricsServer.socketPath);
+        metricsServer.socketPath = NULL;
+    }
+}
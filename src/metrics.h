@@ -0,0 +1,81 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Local metrics endpoint in Prometheus text exposition format.                  *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_METRICS_HEADER_
+#define _GTK_FM_TUNER_METRICS_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// Maximum size of an HTTP request header accepted by the exporter.
+#define METRICS_REQUEST_MAX_SIZE    1024
+
+// Send and receive timeout of a scrape connection in ms.
+#define METRICS_IO_TIMEOUT          1000
+
+// Number of finite buckets of the scan duration histogram.
+#define METRICS_SCAN_BUCKETS        8
+
+// Counters maintained by the tuner threads, they are updated with relaxed atomic adds.
+typedef enum
+{
+    MC_RDS_GROUPS,              // RDS groups captured from the tuner.
+    MC_RDS_GROUPS_DISCARDED,    // Groups captured during band sweeps, they are not decoded into the station statistics.
+    MC_RDS_POLL_LIMIT,          // Capture polls which left groups in the tuner for the next poll.
+    MC_SCAN_POLLS,              // Wakeups of the seek loop to check the scanner.
+    MC_SCAN_FALSE_STOPS,        // Seek stops rejected by the post stop verification.
+    MC_SCAN_VERIFY_TIME,        // Time spent verifying seek stops in us.
+    MC_EVENT_LOOP_WAKEUPS,      // Wakeups of the tuner core event loop.
+    MC_COUNT
+} MetricsCounter;
+
+typedef enum
+{
+    MSR_FOUND,      // Scanner stopped on a station.
+    MSR_NOT_FOUND,  // Scanner did not stop before the seek timeout.
+    MSR_PREEMPTED,  // Another tune or seek request took over the tuner.
+    MSR_COUNT
+} MetricsScanResult;
+
+typedef struct MetricsServer
+{
+    int listenHandle;
+    int stopHandle;             // eventfd, signaled to terminate the server thread.
+    pthread_t serverThread;
+    gboolean running;
+    char *socketPath;           // Path of the Unix socket endpoint, NULL for TCP.
+} MetricsServer;
+
+void metrics_count(MetricsCounter counter, uint64_t value);
+void metrics_add_scan(MetricsScanResult result, uint64_t durationUs);
+
+// Endpoint is a TCP port on the loopback interface or an absolute Unix socket path.
+uint8_t metrics_server_start(const char *endpoint);
+void metrics_server_stop(void);
+
+#endif /* _GTK_FM_TUNER_METRICS_HEADER_ */
@@ -30,37 +30,188 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <ctype.h>
+#include <unistd.h>
 
 #include "defconfig.h"
 #include "defmain.h"
 #include "qn8035.h"
 #include "qn8035intf.h"
+#include "trace.h"
+#include "i2cstats.h"
+#include "lockstats.h"
+#include "metrics.h"
+#include "clocksource.h"
+#include "scancal.h"
+#include "i2chealth.h"
 
 // https://github.com/WiringPi/WiringPi
 #include <wiringPiI2C.h>
 
-#define SET_REG(r,v)    wiringPiI2CWriteReg8(fd,r,v)
-#define GET_REG(r)      wiringPiI2CReadReg8(fd,r)
+#define SET_REG(r,v)    qn8035_set_reg(r,v)
+#define GET_REG(r)      qn8035_get_reg(r)
 
-#define FREQ_TO_WORD(f) ((uint16_t)((f - 60) / 0.05))
-#define WORD_TO_FREQ(w) (((double)w * 0.05) + 60)
+// CH register holds the channel as 60 MHz + (word * 50 kHz), values are rounded to the nearest word.
+#define FREQ_TO_WORD(f) ((uint16_t)((((f) - 60) * 20) + 0.5))
+#define WORD_TO_FREQ(w) (((double)(w) * 0.05) + 60)
+#define KHZ_TO_WORD(f)  ((uint16_t)(((f) - 60000) / 50))
 
-static GMutex tunerMutex;
+// Number of CH register values (10 bits).
+#define QN8035_CHANNEL_WORDS    1024
+
+// Tuner mutex keeps wait, hold and trylock failure statistics for every calling subsystem.
+#define TUNER_LOCK()        tracked_mutex_lock(&tunerMutex, i2c_stats_get_subsystem())
+#define TUNER_TRYLOCK()     tracked_mutex_trylock(&tunerMutex, i2c_stats_get_subsystem())
+#define TUNER_UNLOCK()      tracked_mutex_unlock(&tunerMutex)
+
+static TrackedMutex tunerMutex;
+
+// Incremented by every tune/seek request, a running seek stops when it changes.
+static volatile gint scanSequence;
+
+// Receiver is reset and usable, cleared under the tuner mutex while a (re)connect resets it without holding the mutex.
+static volatile gint deviceReady;
+static tuner_scan_progress_handler scanProgressHandler;
+
+// Channel tables of the active band plan, rebuilt under the tuner mutex when the plan changes.
+static const BandPlan *tunerPlan;
+static uint16_t channelWords[BAND_PLAN_MAX_CHANNELS];
+static int16_t wordChannels[QN8035_CHANNEL_WORDS];
+static uint16_t bandStartWord;
+static uint16_t bandEndWord;
 
 int fd;
+static uint8_t busDevice;
 uint16_t currentFreq;
 uint8_t volumeLevel;
 
-pthread_t rdsDecoderThread;
 char *qn8035RDSInfo;
 RDSProcessContext rdsContext;
+static char rdsCaptureBufferTemp[RDS_INFO_MAX_SIZE];
+static uint8_t rdsUpdateToggle;
 
-uint8_t qn8035_tuner_init()
+// Every register access is timed and counted for the calling subsystem, failed accesses are retried
+// with exponential backoff and still failing ones return -1 to the caller.
+static int qn8035_transfer(uint8_t reg, gboolean isWrite, uint8_t value)
 {
-#ifdef DEBUG_LOGS    
-    g_message("Init QN8035 tuner");
-#endif
+    uint64_t startTime;
+    uint8_t attempt, retryLimit;
+    int result;
+
+    retryLimit = i2c_health_retry_limit(busDevice);
+
+    for(attempt = 0; ; attempt++)
+    {
+        startTime = i2c_stats_begin();
+        result = isWrite ? wiringPiI2CWriteReg8(fd, reg, value) : wiringPiI2CReadReg8(fd, reg);
+        i2c_stats_end(reg, isWrite, startTime, (result < 0));
+
+        if((result >= 0) || (attempt >= retryLimit))
+        {
+            break;
+        }
+
+        // Backoff sleeps with the tuner mutex held, the retry limit keeps it short.
+        g_usleep(i2c_health_backoff(attempt));
+    }
+
+    i2c_health_record(busDevice, (result < 0), attempt);
+    return result;
+}
+
+static inline int qn8035_get_reg(uint8_t reg)
+{
+    return qn8035_transfer(reg, FALSE, 0);
+}
+
+static inline int qn8035_set_reg(uint8_t reg, uint8_t value)
+{
+    return qn8035_transfer(reg, TRUE, value);
+}
+
+// 10-bit channel word of the CH registers, -1 if the bus failed.
+static int qn8035_get_channel_word()
+{
+    int lowBits = GET_REG(REG_CH);
+    int highBits = GET_REG(REG_CH_STEP);
+
+    return ((lowBits < 0) || (highBits < 0)) ? -1 : (lowBits | ((highBits & 0x03) << 8));
+}
+
+// Take the tuner mutex without waiting, FALSE (without the mutex) if it is busy or the receiver is being reset.
+static gboolean qn8035_trylock_ready()
+{
+    if(!TUNER_TRYLOCK())
+    {
+        return FALSE;
+    }
+
+    if(!g_atomic_int_get(&deviceReady))
+    {
+        TUNER_UNLOCK();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+// Take the tuner mutex, FALSE (without the mutex) if the receiver is being reset.
+static gboolean qn8035_lock_ready()
+{
+    TUNER_LOCK();
+
+    if(!g_atomic_int_get(&deviceReady))
+    {
+        TUNER_UNLOCK();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static uint8_t qn8035_tune_word(uint16_t tuneFreq)
+{
+    gboolean isFailed;
+
+    i2c_stats_set_subsystem(I2CS_TUNE);
+
+    rdsContext.state = RD_IDLE;
+
+    // Preempt any running seek, writing REG_SYSTEM1 below also clears CHSC.
+    g_atomic_int_inc(&scanSequence);
+
+    TRACE_LOG(TE_TUNER_SET_FREQUENCY, tuneFreq);
+
+    if(!qn8035_lock_ready())
+    {
+        // Receiver is in reset, the reconnect restores the last tuned channel.
+        rdsContext.state = RD_CLEAR;
+        return RESULT_FAIL;
+    }
 
+    isFailed = (SET_REG(REG_CH, (tuneFreq & 0xFF)) < 0);                    // Lo
+    isFailed |= (SET_REG(REG_CH_STEP, ((tuneFreq >> 8) & 0x03)) < 0);      // Hi
+
+    clock_source_sleep(100);
+    isFailed |= (SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN) < 0);
+
+    TUNER_UNLOCK();
+
+    rdsContext.state = RD_CLEAR;
+
+    if(isFailed)
+    {
+        // Receiver state is unknown, the last tuned channel is kept.
+        return RESULT_FAIL;
+    }
+
+    currentFreq = tuneFreq;
+    return RESULT_SUCCESS;
+}
+
+// Open the I2C bus, verify the chip ID and start the reset of the receiver. Called with the tuner mutex held,
+// the caller waits QN8035_RESET_TIME without the mutex before the receiver is used.
+static uint8_t qn8035_connect()
+{
     fd = wiringPiI2CSetup(QN8035_ADDRESS);
     if(fd < 0)
     {
@@ -86,16 +237,115 @@ uint8_t qn8035_tuner_init()
 #endif
 
     // Reset all registers of QN8035 tuner.
-    SET_REG(REG_SYSTEM1, REG_SYSTEM1_SWRST);
-    usleep(1500000);
+    if(SET_REG(REG_SYSTEM1, REG_SYSTEM1_SWRST) < 0)
+    {
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t qn8035_tuner_init()
+{
+#ifdef DEBUG_LOGS    
+    g_message("Init QN8035 tuner");
+#endif
 
-    // Set tuner frequency and volume to the defaults.
-    qn8035_tuner_set_frequency(TUNER_MIN_FREQUENCY);
-    qn8035_set_volume(REG_VOL_CTL_MAX_ANALOG_GAIN);
+    i2c_stats_init();
+    i2c_stats_set_subsystem(I2CS_INIT);
+    busDevice = i2c_health_register("qn8035", QN8035_ADDRESS);
 
-    // Start RDS decoder thread.
+    // Seek thresholds start from the defaults and follow the noise floor after the first seek.
+    scan_cal_init(CCA_LEVEL, CCA_SNR_LEVEL);
+
+    // Channel tables and RDS buffers do not depend on the receiver, they are ready even if it is not connected yet.
+    qn8035_set_band_plan(band_plan_get());
     qn8035_init_rds_decoder();
 
+    // Every connect restores the cached channel and volume, they start from the first channel and full volume.
+    fd = -1;
+    currentFreq = channelWords[0];
+    volumeLevel = REG_VOL_CTL_MAX_ANALOG_GAIN;
+
+    return qn8035_reconnect();
+}
+
+uint8_t qn8035_reconnect()
+{
+    uint16_t savedFreq = currentFreq;
+    uint8_t savedVolume = volumeLevel;
+    uint8_t result;
+
+    i2c_stats_set_subsystem(I2CS_INIT);
+
+    // Running seek on the lost receiver is aborted and RDS capture waits for the new tune.
+    g_atomic_int_inc(&scanSequence);
+    rdsContext.state = RD_IDLE;
+
+    TUNER_LOCK();
+
+    // Other threads leave the receiver alone from here until its reset is over.
+    g_atomic_int_set(&deviceReady, 0);
+
+    if(fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    result = qn8035_connect();
+
+    TUNER_UNLOCK();
+
+    if(result == RESULT_FAIL)
+    {
+        return RESULT_FAIL;
+    }
+
+    // Reset runs without the tuner mutex, status reads and requests fail fast meanwhile instead of blocking for it.
+    clock_source_sleep(QN8035_RESET_TIME);
+    g_atomic_int_set(&deviceReady, 1);
+
+    // Bring back the channel and volume the receiver had before it was lost.
+    if((qn8035_tune_word(savedFreq) == RESULT_FAIL) || (qn8035_set_volume(savedVolume) == RESULT_FAIL))
+    {
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t qn8035_check_device()
+{
+    int chipId, systemReg;
+
+    if((fd < 0) || (i2c_health_get_state(busDevice) == I2CH_LOST))
+    {
+        return RESULT_FAIL;
+    }
+
+    i2c_stats_set_subsystem(I2CS_STATUS);
+
+    // Busy or resetting tuner is reachable, it is checked again on the next period.
+    if(!qn8035_trylock_ready())
+    {
+        return RESULT_SUCCESS;
+    }
+
+    chipId = GET_REG(REG_CID2);
+    systemReg = GET_REG(REG_SYSTEM1);
+
+    TUNER_UNLOCK();
+
+    // Brown out resets the registers, the receiver then drops out of RX mode.
+    if((chipId != QN8035_ID) || (systemReg < 0) || ((systemReg & REG_SYSTEM1_RXREQ) == 0))
+    {
+#ifdef DEBUG_LOGS
+        g_message("QN8035 check failed: chip ID %d, SYSTEM1 %d", chipId, systemReg);
+#endif
+        return RESULT_FAIL;
+    }
+
     return RESULT_SUCCESS;
 }
 
@@ -105,19 +355,20 @@ uint8_t qn8035_tuner_shutdown()
     g_message("Shutdown QN8035 tuner");
 #endif    
 
-    // Stop RDS capture and process thread.
+    // Stop RDS capture.
     rdsContext.state = RD_END;
+    i2c_stats_set_subsystem(I2CS_INIT);
 
-    g_mutex_lock(&tunerMutex);
+    TUNER_LOCK();
 
     // Reset and recalibrate the receiver.
     SET_REG(REG_SYSTEM1, REG_SYSTEM1_RECAL | REG_SYSTEM1_SWRST);
-    usleep(100);
+    clock_source_sleep(100);
 
     // Enter tuner into the standby mode.
     SET_REG(REG_SYSTEM1, REG_SYSTEM1_STNBY);
 
-    g_mutex_unlock(&tunerMutex);
+    TUNER_UNLOCK();
 
     // Release RDS output buffer.
     if(qn8035RDSInfo != NULL)
@@ -131,40 +382,87 @@ uint8_t qn8035_tuner_shutdown()
 
 uint8_t qn8035_tuner_set_frequency(double frequency)
 {
-    uint16_t tuneFreq;
+    if((frequency < WORD_TO_FREQ(0)) || (frequency > WORD_TO_FREQ(QN8035_CHANNEL_WORDS - 1)))
+    {
+        return RESULT_FAIL;
+    }
 
-    tuneFreq = FREQ_TO_WORD(frequency);
-    rdsContext.state = RD_IDLE;
+    return qn8035_tune_word(FREQ_TO_WORD(frequency));
+}
 
-#ifdef DEBUG_LOGS    
-    g_message("Set QN8035 tuner frequency = %d", tuneFreq);    
-#endif     
+uint8_t qn8035_tuner_set_channel(uint16_t channel)
+{
+    if(channel >= tunerPlan->channelCount)
+    {
+        return RESULT_FAIL;
+    }
 
-    g_mutex_lock(&tunerMutex);
+    return qn8035_tune_word(channelWords[channel]);
+}
 
-    SET_REG(REG_CH, (tuneFreq & 0xFF));                // Lo
-    SET_REG(REG_CH_STEP, ((tuneFreq >> 8) & 0x03));    // Hi
+int32_t qn8035_tuner_get_channel()
+{
+    int channelWord;
 
-    usleep(100);
-    SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN);
+    i2c_stats_set_subsystem(I2CS_STATUS);
 
-    g_mutex_unlock(&tunerMutex);
+    if(qn8035_trylock_ready())
+    {
+        channelWord = qn8035_get_channel_word();
+        TUNER_UNLOCK();
 
-    currentFreq = tuneFreq;
-    rdsContext.state = RD_CLEAR;
+        return (channelWord >= 0) ? wordChannels[channelWord] : BAND_PLAN_NO_CHANNEL;
+    }
+
+    // QN8035 tuner is in use by another thread!
+    return BAND_PLAN_NO_CHANNEL;
+}
+
+uint8_t qn8035_set_band_plan(const BandPlan *plan)
+{
+    uint16_t channel, channelWord;
+
+    i2c_stats_set_subsystem(I2CS_TUNE);
+
+    // Running seek scans between the band edges of the old plan, it is preempted before the tables change.
+    g_atomic_int_inc(&scanSequence);
+
+    TUNER_LOCK();
+
+    for(channel = 0; channel < plan->channelCount; channel++)
+    {
+        channelWords[channel] = KHZ_TO_WORD(band_plan_channel_khz(plan, channel));
+    }
+
+    // Only register words on the raster of the plan map to a channel, off raster tunes are read back through get_frequency().
+    for(channelWord = 0; channelWord < QN8035_CHANNEL_WORDS; channelWord++)
+    {
+        wordChannels[channelWord] = (int16_t)band_plan_khz_to_exact_channel(plan, 60000 + ((uint32_t)channelWord * 50));
+    }
+
+    bandStartWord = channelWords[0];
+    bandEndWord = channelWords[band_plan_last_channel(plan)];
+    tunerPlan = plan;
+
+    TUNER_UNLOCK();
+
+    // Noise floor of the old band does not apply, it is measured again on the next seek.
+    scan_cal_invalidate();
 
     return RESULT_SUCCESS;
 }
 
 double qn8035_tuner_get_frequency()
 {
-    if(g_mutex_trylock(&tunerMutex))
+    i2c_stats_set_subsystem(I2CS_STATUS);
+
+    if(qn8035_trylock_ready())
     {
-        double result = WORD_TO_FREQ((uint16_t)(GET_REG(REG_CH) | ((GET_REG(REG_CH_STEP) & 0x03) << 8)));
+        int channelWord = qn8035_get_channel_word();
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
 
-        return result;
+        return (channelWord >= 0) ? WORD_TO_FREQ(channelWord) : -1;
     }
     else
     {
@@ -173,66 +471,357 @@ double qn8035_tuner_get_frequency()
     }
 }
 
+// Take the tuner mutex for the seek owning sequence, FALSE (without the mutex) if another request took over meanwhile.
+static gboolean qn8035_scan_lock(gint sequence)
+{
+    // Reconnect also changes the sequence, a seek started during the reset ends as preempted.
+    if(!qn8035_lock_ready())
+    {
+        return FALSE;
+    }
+
+    // Tune or seek started before the lock was taken, its register writes must not be overwritten or read as a stop.
+    if(g_atomic_int_get(&scanSequence) != sequence)
+    {
+        TUNER_UNLOCK();
+        return FALSE;
+    }
+
+    // Exit of an older preempted seek re-enables RDS capture, it stays idle while this seek owns the receiver.
+    rdsContext.state = RD_IDLE;
+    return TRUE;
+}
+
+// Exit of a seek preempted by another tune or seek request.
+static uint8_t qn8035_scan_preempted()
+{
+    TRACE_LOG(TE_SCAN_PREEMPTED);
+    metrics_add_scan(MSR_PREEMPTED, 0);
+
+    rdsContext.state = RD_CLEAR;
+    return RESULT_FAIL;
+}
+
+// Exit of a seek which could not program the scanner.
+static uint8_t qn8035_scan_failed(gint64 scanStartTime)
+{
+    rdsContext.state = RD_CLEAR;
+    metrics_add_scan(MSR_NOT_FOUND, (uint64_t)(clock_source_now() - scanStartTime));
+    return RESULT_FAIL;
+}
+
+// Stop the scanner and return to the last tuned channel. Called with the tuner mutex held.
+static uint8_t qn8035_restore_channel()
+{
+    gboolean isFailed;
+
+    isFailed = (SET_REG(REG_CH, (currentFreq & 0xFF)) < 0);                   // Lo
+    isFailed |= (SET_REG(REG_CH_STEP, ((currentFreq >> 8) & 0x03)) < 0);     // Hi
+    isFailed |= (SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN) < 0);
+
+    return isFailed ? RESULT_FAIL : RESULT_SUCCESS;
+}
+
+// Sample RSSI and SNR on channels spread over the band, the seek thresholds are derived from their noise floor.
+static uint8_t qn8035_measure_noise_floor(gint sequence)
+{
+    int16_t rssiValues[SCAN_CAL_NOISE_POINTS], snrValues[SCAN_CAL_NOISE_POINTS];
+    int rssi, snr, volReg;
+    uint16_t channelWord;
+    uint8_t pointPos, count = 0;
+    gboolean isFailed = FALSE;
+
+    // Preemption is not a failure, the caller checks the sequence.
+    if(!qn8035_scan_lock(sequence))
+    {
+        return RESULT_SUCCESS;
+    }
+
+    // Retuning over the band is audible, the output stays muted until the measurement is over.
+    volReg = GET_REG(REG_VOL_CTL);
+    if((volReg < 0) || (SET_REG(REG_VOL_CTL, (uint8_t)(volReg | REG_VOL_CTL_MUTE_EN)) < 0))
+    {
+        TUNER_UNLOCK();
+        return RESULT_FAIL;
+    }
+
+    TUNER_UNLOCK();
+
+    for(pointPos = 0; pointPos < SCAN_CAL_NOISE_POINTS; pointPos++)
+    {
+        // Preempted, the new request tunes the receiver.
+        if(!qn8035_scan_lock(sequence))
+        {
+            break;
+        }
+
+        channelWord = channelWords[(band_plan_last_channel(tunerPlan) * ((2 * pointPos) + 1)) / (2 * SCAN_CAL_NOISE_POINTS)];
+        isFailed = (SET_REG(REG_CH, (channelWord & 0xFF)) < 0);                   // Lo
+        isFailed |= (SET_REG(REG_CH_STEP, ((channelWord >> 8) & 0x03)) < 0);     // Hi
+        isFailed |= (SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN) < 0);
+
+        TUNER_UNLOCK();
+
+        if(isFailed)
+        {
+            break;
+        }
+
+        clock_source_sleep(SCAN_CAL_SETTLE_TIME);
+
+        if(!qn8035_scan_lock(sequence))
+        {
+            break;
+        }
+
+        rssi = GET_REG(REG_RSSISIG);
+        snr = GET_REG(REG_SNR);
+        TUNER_UNLOCK();
+
+        if((rssi >= 0) && (snr >= 0))
+        {
+            rssiValues[count] = (int16_t)rssi;
+            snrValues[count] = (int16_t)snr;
+            count++;
+        }
+    }
+
+    // Reconnect restores the channel and volume after its reset.
+    if(!qn8035_lock_ready())
+    {
+        return RESULT_SUCCESS;
+    }
+
+    // Return to the channel the seek starts from, unless a new request has tuned the receiver already.
+    if(g_atomic_int_get(&scanSequence) == sequence)
+    {
+        isFailed |= (qn8035_restore_channel() == RESULT_FAIL);
+    }
+
+    // Volume may have been changed meanwhile, only the mute bit set above is cleared.
+    if((volReg & REG_VOL_CTL_MUTE_EN) == 0)
+    {
+        volReg = GET_REG(REG_VOL_CTL);
+        isFailed |= ((volReg < 0) || (SET_REG(REG_VOL_CTL, (uint8_t)(volReg & ~REG_VOL_CTL_MUTE_EN)) < 0));
+    }
+
+    TUNER_UNLOCK();
+
+    if(isFailed)
+    {
+        return RESULT_FAIL;
+    }
+
+    // Preempted before all points were sampled.
+    if(pointPos == SCAN_CAL_NOISE_POINTS)
+    {
+        scan_cal_set_noise_floor(rssiValues, snrValues, count);
+    }
+
+    return RESULT_SUCCESS;
+}
+
+// Check the channel the scanner stopped on, returns FALSE for a false stop. Called without the tuner mutex.
+static gboolean qn8035_verify_stop(gint sequence)
+{
+    int rssi, snr, status;
+    gint64 rdsWaitEnd;
+    uint8_t readPos;
+
+    // Signal readings settle shortly after the stop, strong stations pass on the first reading.
+    for(readPos = 0; readPos < SCAN_VERIFY_READINGS; readPos++)
+    {
+        clock_source_sleep(SCAN_VERIFY_SETTLE_TIME);
+        if(g_atomic_int_get(&scanSequence) != sequence)
+        {
+            return FALSE;
+        }
+
+        if(!qn8035_lock_ready())
+        {
+            return FALSE;
+        }
+
+        rssi = GET_REG(REG_RSSISIG);
+        snr = GET_REG(REG_SNR);
+        status = GET_REG(REG_STATUS1);
+        TUNER_UNLOCK();
+
+        // Only real stations transmit a stereo pilot.
+        if(scan_cal_check_stop(rssi, snr) || ((status >= 0) && ((status & REG_STATUS1_ST_MO_RX) == 0)))
+        {
+            return TRUE;
+        }
+    }
+
+    // Weak mono station may still carry RDS, give the decoder a short time to synchronize on its PI.
+    rdsWaitEnd = clock_source_now() + SCAN_VERIFY_RDS_TIME;
+    while(clock_source_now() < rdsWaitEnd)
+    {
+        clock_source_sleep(SCAN_VERIFY_RDS_POLL);
+        if(g_atomic_int_get(&scanSequence) != sequence)
+        {
+            return FALSE;
+        }
+
+        if(!qn8035_lock_ready())
+        {
+            return FALSE;
+        }
+
+        status = GET_REG(REG_STATUS2);
+        TUNER_UNLOCK();
+
+        if((status >= 0) && (status & REG_STATUS2_RDS_SYNC))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 uint8_t qn8035_tuner_scan(ScanDirection direction)
 {
-    uint8_t timeout, isFound, freqFix;
-    uint16_t newFreq;
+    uint8_t timeout, isFound, freqFix, rejectCount;
+    uint16_t newFreq, lastScanFreq, stepWords, scanFrom;
+    int scanFreq, systemReg;
+    gboolean isStation, isFailed, isBandEdge;
+    gint sequence;
+    gint64 scanStartTime = clock_source_now();
+    gint64 verifyStartTime;
     
-#ifdef DEBUG_LOGS      
-    g_message("Scan QN8035 tuner in direction = %d", direction);
-#endif    
+    TRACE_LOG(TE_SCAN_START, direction);
+    i2c_stats_set_subsystem(I2CS_SCAN);
 
+    // Preempt any running seek and take ownership of the scanner.
+    sequence = g_atomic_int_add(&scanSequence, 1) + 1;
     rdsContext.state = RD_IDLE;
 
-    g_mutex_lock(&tunerMutex);
+    // First seek of the band (and periodically after it) measures the noise floor for the CCA thresholds.
+    if(scan_cal_is_due())
+    {
+        isFailed = (qn8035_measure_noise_floor(sequence) == RESULT_FAIL);
+
+        if(g_atomic_int_get(&scanSequence) != sequence)
+        {
+            return qn8035_scan_preempted();
+        }
+
+        if(isFailed)
+        {
+            return qn8035_scan_failed(scanStartTime);
+        }
+    }
 
-    if((direction == SCAN_UP) && (currentFreq < FREQ_TO_WORD(HIGH_FREQ)))
+    if(!qn8035_scan_lock(sequence))
     {
-        qn8035_scan_frequency_up();
+        return qn8035_scan_preempted();
     }
-    else if((direction == SCAN_DOWN) && (currentFreq > FREQ_TO_WORD(LOW_FREQ)))
+
+    // Stop previous hardware scan (if any) before loading new scan parameters.
+    isFailed = (SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN) < 0);
+
+    stepWords = band_plan_get_scan_step(tunerPlan) / 50;
+    scanFrom = currentFreq;
+
+    if((direction == SCAN_UP) && (currentFreq < bandEndWord))
     {
-        qn8035_scan_frequency_down();
+        isFailed |= (qn8035_scan_frequency_up(scanFrom, stepWords) == RESULT_FAIL);
+    }
+    else if((direction == SCAN_DOWN) && (currentFreq > bandStartWord))
+    {
+        isFailed |= (qn8035_scan_frequency_down(scanFrom, stepWords) == RESULT_FAIL);
     }
 
-    // Wait for end of scanning.
-    timeout = 25;
-    isFound = 0;
+    if(isFailed)
+    {
+        // Scanner is not programmed, a partial setup must not run on and be polled as a stop.
+        qn8035_restore_channel();
+        TUNER_UNLOCK();
 
-    do
+        return qn8035_scan_failed(scanStartTime);
+    }
+
+    TUNER_UNLOCK();
+
+    lastScanFreq = currentFreq;
+    rejectCount = 0;
+
+    // Every false stop resumes the hardware scan from the next channel.
+    while(TRUE)
     {
-        // Check for end of auto scan operation.
-        if((GET_REG(REG_SYSTEM1) & REG_SYSTEM1_CHSC) == 0)
+        // Wait for end of scanning, tuner is released between polls so other threads can use it.
+        timeout = SCAN_POLL_LIMIT * (4 / stepWords);
+        isFound = 0;
+
+        do
+        {
+            clock_source_sleep(5000);
+            metrics_count(MC_SCAN_POLLS, 1);
+
+            // Another tune or seek request took over the tuner, a tune also clears CHSC and is not a stop of this seek.
+            if(!qn8035_scan_lock(sequence))
+            {
+                return qn8035_scan_preempted();
+            }
+
+            // Check for end of auto scan operation, a failed read is retried on the next poll.
+            systemReg = GET_REG(REG_SYSTEM1);
+            if((systemReg >= 0) && ((systemReg & REG_SYSTEM1_CHSC) == 0))
+            {
+                isFound = 1;
+                break;
+            }
+
+            scanFreq = qn8035_get_channel_word();
+            TUNER_UNLOCK();
+            TRACE_LOG(TE_SCAN_POLL, scanFreq);
+
+            // Report the channel currently checked by the scanner.
+            if((scanFreq >= 0) && (scanFreq != lastScanFreq) && (scanProgressHandler != NULL))
+            {
+                scanProgressHandler(WORD_TO_FREQ(scanFreq));
+                lastScanFreq = scanFreq;
+            }
+
+            timeout--;
+        } 
+        while (timeout != 0);
+
+        if(!isFound)
         {
-#ifdef DEBUG_LOGS             
-            g_message("Scan completed");
-#endif
-            isFound = 1;
             break;
         }
-            
-        timeout--;
-        usleep(5000);        
-    } 
-    while (timeout != 0);
 
-    if(isFound)
-    {
+        // Tuner mutex is still held from the last poll.
         // If scan completes, get the new frequency from the QN8035 tuner.
-        newFreq = GET_REG(REG_CH) | ((GET_REG(REG_CH_STEP) & 0x03) << 8);  
+        scanFreq = qn8035_get_channel_word();
+        if(scanFreq < 0)
+        {
+            // Stop channel is unknown, the seek fails instead of jumping to a garbage channel.
+            TUNER_UNLOCK();
+            isFound = 0;
+            break;
+        }
+
+        newFreq = (uint16_t)scanFreq;
         freqFix = 0;
 
-#ifdef DEBUG_LOGS         
-        g_message("Scanner stopped in frequency = %d", newFreq);        
-#endif
+        TRACE_LOG(TE_SCAN_COMPLETED, newFreq);
 
         // Fix: In some cases we notice receiver jump to 85MHz/111MHz if scanner goes beyond 98.25MHz or 98.4MHz.
-        if((newFreq < FREQ_TO_WORD(LOW_FREQ)) && (currentFreq > FREQ_TO_WORD(LOW_FREQ)) && (currentFreq < FREQ_TO_WORD(98.3)))
+        // Only band plans which cover that range are affected.
+        if((bandEndWord < FREQ_TO_WORD(98.4)) || (bandStartWord > FREQ_TO_WORD(98.2)))
+        {
+            freqFix = 0;
+        }
+        else if((newFreq < bandStartWord) && (scanFrom > bandStartWord) && (scanFrom < FREQ_TO_WORD(98.3)))
         {
             newFreq = FREQ_TO_WORD(98.4);
             freqFix = 1;
         }
-        else if((newFreq > FREQ_TO_WORD(HIGH_FREQ)) && (currentFreq > FREQ_TO_WORD(98.3)) && (currentFreq < FREQ_TO_WORD(HIGH_FREQ)))
+        else if((newFreq > bandEndWord) && (scanFrom > FREQ_TO_WORD(98.3)) && (scanFrom < bandEndWord))
         {
             newFreq = FREQ_TO_WORD(98.2);
             freqFix = 1;
@@ -241,44 +830,173 @@ uint8_t qn8035_tuner_scan(ScanDirection direction)
         if(freqFix)
         {
             // Scanner reset occure, set frequency above 98.25MHz!
-            SET_REG(REG_CH, (newFreq & 0xFF));                // Lo
-            SET_REG(REG_CH_STEP, ((newFreq >> 8) & 0x03));    // Hi
+            isFailed = (SET_REG(REG_CH, (newFreq & 0xFF)) < 0);                   // Lo
+            isFailed |= (SET_REG(REG_CH_STEP, ((newFreq >> 8) & 0x03)) < 0);     // Hi
+
+            clock_source_sleep(100);
+            isFailed |= (SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN) < 0);
 
-            usleep(100);
-            SET_REG(REG_SYSTEM1, REG_SYSTEM1_CCA_CH_DIS | REG_SYSTEM1_RXREQ | REG_SYSTEM1_RDSEN);
+            if(isFailed)
+            {
+                // Receiver is not on the fixed channel, return to the channel the seek started from.
+                qn8035_restore_channel();
+                TUNER_UNLOCK();
+
+                isFound = 0;
+                break;
+            }
+        }
+
+        // Band edges change with the plan, they are only read under the tuner mutex.
+        isBandEdge = ((newFreq >= bandEndWord) || (newFreq <= bandStartWord));
+
+        TUNER_UNLOCK();
+
+        // Scanner ran into the band limit, there is no station to verify.
+        if(isBandEdge)
+        {
+            break;
         }
 
-        // Verify limits and set new frequency as a default frequency.
-        if((newFreq < FREQ_TO_WORD(HIGH_FREQ)) && (newFreq > FREQ_TO_WORD(LOW_FREQ)))
+        verifyStartTime = clock_source_now();
+        isStation = qn8035_verify_stop(sequence);
+        metrics_count(MC_SCAN_VERIFY_TIME, (uint64_t)(clock_source_now() - verifyStartTime));
+
+        if(g_atomic_int_get(&scanSequence) != sequence)
+        {
+            return qn8035_scan_preempted();
+        }
+
+        scan_cal_report_stop(!isStation);
+
+        if(isStation)
         {
+            // Set new frequency as a default frequency.
             currentFreq = newFreq;
+            break;
+        }
+
+        TRACE_LOG(TE_SCAN_REJECTED, newFreq);
+        metrics_count(MC_SCAN_FALSE_STOPS, 1);
+
+        if(!qn8035_scan_lock(sequence))
+        {
+            return qn8035_scan_preempted();
+        }
+
+        if((++rejectCount) > SCAN_MAX_REJECTS)
+        {
+            // Too many false stops in a row, give up and return to the channel the seek started from.
+            isFailed = (qn8035_restore_channel() == RESULT_FAIL);
+            TUNER_UNLOCK();
+
+#ifdef DEBUG_LOGS
+            if(isFailed)
+            {
+                g_message("Unable to return to the seek start channel");
+            }
+#endif
+
+            isFound = 0;
+            break;
+        }
+
+        // Resume from the next channel after the false stop within the same seek.
+        scanFrom = newFreq;
+        if(direction == SCAN_UP)
+        {
+            isFailed = (qn8035_scan_frequency_up(scanFrom, stepWords) == RESULT_FAIL);
+        }
+        else
+        {
+            isFailed = (qn8035_scan_frequency_down(scanFrom, stepWords) == RESULT_FAIL);
         }
-    }
 
-    g_mutex_unlock(&tunerMutex);
+        if(isFailed)
+        {
+            // Scanner is not programmed, the seek fails on the channel it started from.
+            qn8035_restore_channel();
+            TUNER_UNLOCK();
+
+            isFound = 0;
+            break;
+        }
+
+        TUNER_UNLOCK();
+    }
 
     rdsContext.state = RD_CLEAR;
+    metrics_add_scan((isFound ? MSR_FOUND : MSR_NOT_FOUND), (uint64_t)(clock_source_now() - scanStartTime));
 
     return isFound ? RESULT_SUCCESS : RESULT_FAIL;
 }
 
+uint8_t qn8035_cancel_scan()
+{
+    uint8_t result;
+
+    i2c_stats_set_subsystem(I2CS_TUNE);
+
+    // Running seek notices the new sequence on its next poll and exits.
+    g_atomic_int_inc(&scanSequence);
+
+    // Reset stops the scanner as well.
+    if(!qn8035_lock_ready())
+    {
+        rdsContext.state = RD_CLEAR;
+        return RESULT_FAIL;
+    }
+
+    // Abort hardware scan by clearing CHSC and return to the last tuned channel.
+    result = qn8035_restore_channel();
+
+    TUNER_UNLOCK();
+
+    rdsContext.state = RD_CLEAR;
+
+    return result;
+}
+
+void qn8035_preempt_scan()
+{
+    // Hardware scan keeps running until the next request writes REG_SYSTEM1.
+    g_atomic_int_inc(&scanSequence);
+}
+
+void qn8035_get_lock_stats(LockCallerStats *callerStats)
+{
+    tracked_mutex_read(&tunerMutex, callerStats);
+}
+
+void qn8035_set_scan_progress_handler(tuner_scan_progress_handler handler)
+{
+    scanProgressHandler = handler;
+}
+
 uint8_t qn8035_set_volume(uint16_t level)
 {
-    uint8_t volReg;
+    int volReg;
     
-#ifdef DEBUG_LOGS     
-    g_message("Set QN8035 volume = %d", level);
-#endif
+    TRACE_LOG(TE_TUNER_SET_VOLUME, level);
+    i2c_stats_set_subsystem(I2CS_TUNE);
 
     // Check for valid volume level.
     if((level >= REG_VOL_CTL_MIN_ANALOG_GAIN) && (level <= REG_VOL_CTL_MAX_ANALOG_GAIN))
     {
-        g_mutex_lock(&tunerMutex);
+        // Receiver in reset keeps the previous level, the reconnect restores it.
+        if(!qn8035_lock_ready())
+        {
+            return RESULT_FAIL;
+        }
 
-        volReg = (GET_REG(REG_VOL_CTL) & 0xF8) | level;
-        SET_REG(REG_VOL_CTL, volReg);
+        volReg = GET_REG(REG_VOL_CTL);
+        if((volReg < 0) || (SET_REG(REG_VOL_CTL, (uint8_t)((volReg & 0xF8) | level)) < 0))
+        {
+            TUNER_UNLOCK();
+            return RESULT_FAIL;
+        }
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
 
         volumeLevel = level;
         return RESULT_SUCCESS;
@@ -290,11 +1008,20 @@ uint8_t qn8035_set_volume(uint16_t level)
 
 uint16_t qn8035_get_volume()
 {
-    if(g_mutex_trylock(&tunerMutex))
+    int volReg;
+
+    i2c_stats_set_subsystem(I2CS_STATUS);
+
+    if(qn8035_trylock_ready())
     {
-        volumeLevel = GET_REG(REG_VOL_CTL) & 0x07;
+        // Cached level is kept if the read fails.
+        volReg = GET_REG(REG_VOL_CTL);
+        if(volReg >= 0)
+        {
+            volumeLevel = volReg & 0x07;
+        }
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
     }
 
     return volumeLevel;
@@ -302,9 +1029,7 @@ uint16_t qn8035_get_volume()
 
 uint16_t qn8035_change_volume(VolumeDirection direction)
 {
-#ifdef DEBUG_LOGS     
-    g_message("Change QN8035 volume in direction = %d", direction);
-#endif
+    TRACE_LOG(TE_TUNER_CHANGE_VOLUME, direction);
 
     if(direction == VOLUME_UP)
     {
@@ -325,12 +1050,19 @@ uint16_t qn8035_change_volume(VolumeDirection direction)
 StereoMPXState qn8035_get_stereo_mpx_status()
 {
     StereoMPXState mpxStatus = MPXS_UNKNOWN;
+    int statusReg;
+
+    i2c_stats_set_subsystem(I2CS_STATUS);
 
-    if(g_mutex_trylock(&tunerMutex))
+    if(qn8035_trylock_ready())
     {        
-        mpxStatus = ((GET_REG(REG_STATUS1) & REG_STATUS1_ST_MO_RX) ? MPXS_MONO : MPXS_STEREO);
+        statusReg = GET_REG(REG_STATUS1);
+        if(statusReg >= 0)
+        {
+            mpxStatus = ((statusReg & REG_STATUS1_ST_MO_RX) ? MPXS_MONO : MPXS_STEREO);
+        }
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
     }
 
     return mpxStatus;
@@ -340,11 +1072,13 @@ int16_t qn8035_get_snr()
 {
     int16_t snrValue = -1;
 
-    if(g_mutex_trylock(&tunerMutex))
+    i2c_stats_set_subsystem(I2CS_STATUS);
+
+    if(qn8035_trylock_ready())
     {
         snrValue = (int16_t)GET_REG(REG_SNR);
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
     }
 
     return snrValue;
@@ -354,158 +1088,190 @@ int16_t qn8035_get_rssi()
 {
     int16_t rssiValue = -1;
 
-    if(g_mutex_trylock(&tunerMutex))
+    i2c_stats_set_subsystem(I2CS_STATUS);
+
+    if(qn8035_trylock_ready())
     {
         rssiValue = (int16_t)GET_REG(REG_RSSISIG);
 
-        g_mutex_unlock(&tunerMutex);
+        TUNER_UNLOCK();
     }
 
     return rssiValue;
 }
 
-void qn8035_scan_frequency_down()
+// Load the scan registers and start the hardware seek between startFreq and endFreq, fromFreq is the tuned channel.
+static uint8_t qn8035_start_hardware_scan(uint16_t fromFreq, uint16_t startFreq, uint16_t endFreq, uint16_t stepWords)
 {
-    uint16_t freqEnd;
-    
-    SET_REG(REG_CCA_SNR_TH_1, 0x00);
-    SET_REG(REG_CCA_SNR_TH_2, 0x05);
-    SET_REG(REG_NCCFIR3, 0x05);
-    
-    freqEnd = FREQ_TO_WORD(LOW_FREQ);
+    uint8_t stepBits, rssiThreshold, snrThreshold;
+    gboolean isFailed;
+
+    stepBits = (stepWords == 1) ? REG_CH_STEP_50KHZ : ((stepWords == 2) ? REG_CH_STEP_100KHZ : REG_CH_STEP_200KHZ);
+    scan_cal_get_thresholds(&rssiThreshold, &snrThreshold);
 
-    // Set start frequency with -200kHz offset with current frequency.
-    SET_REG(REG_CH_START, (currentFreq - 4) & 0xFF);
+    isFailed = (SET_REG(REG_CCA_SNR_TH_1, 0x00) < 0);
+    isFailed |= (SET_REG(REG_CCA_SNR_TH_2, snrThreshold) < 0);
+    isFailed |= (SET_REG(REG_NCCFIR3, 0x05) < 0);
 
-    // Set stop frequency.
-    SET_REG(REG_CH_STOP, freqEnd & 0xFF);
+    isFailed |= (SET_REG(REG_CH_START, startFreq & 0xFF) < 0);
+    isFailed |= (SET_REG(REG_CH_STOP, endFreq & 0xFF) < 0);
     
-    SET_REG(REG_CH_STEP, (REG_CH_STEP_200KHZ | ((currentFreq >> 8) & 0x03) | ((currentFreq >> 6) & 0x0C) | ((freqEnd >> 4) & 0x30)));    
+    // High bits of the start and stop channels share the register with the step.
+    isFailed |= (SET_REG(REG_CH_STEP, (stepBits | ((fromFreq >> 8) & 0x03) | ((startFreq >> 6) & 0x0C) | ((endFreq >> 4) & 0x30))) < 0);
 
-    SET_REG(REG_CCA, CCA_LEVEL);
+    isFailed |= (SET_REG(REG_CCA, rssiThreshold) < 0);
 
-    // Initiate scan down.
-    SET_REG(REG_SYSTEM1, REG_SYSTEM1_RXREQ | REG_SYSTEM1_CHSC | REG_SYSTEM1_RDSEN);
+    // Scan is only started on a complete setup, thresholds or limits left from the last seek would stop it on the wrong channel.
+    if(isFailed || (SET_REG(REG_SYSTEM1, REG_SYSTEM1_RXREQ | REG_SYSTEM1_CHSC | REG_SYSTEM1_RDSEN) < 0))
+    {
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
 }
 
-void qn8035_scan_frequency_up()
+uint8_t qn8035_scan_frequency_down(uint16_t fromFreq, uint16_t stepWords)
 {
-    uint16_t freqEnd;    
-    
-    SET_REG(REG_CCA_SNR_TH_1, 0x00);
-    SET_REG(REG_CCA_SNR_TH_2, 0x05);
-    SET_REG(REG_NCCFIR3, 0x05);
-    
-    freqEnd = FREQ_TO_WORD(HIGH_FREQ);
-
-    // Set start frequency with +200kHz offset with current frequency.
-    SET_REG(REG_CH_START, (currentFreq + 4) & 0xFF);
-
-    // Set stop frequency.
-    SET_REG(REG_CH_STOP, freqEnd & 0xFF);
-    
-    SET_REG(REG_CH_STEP, (REG_CH_STEP_200KHZ | ((currentFreq >> 8) & 0x03) | ((currentFreq >> 6) & 0x0C) | ((freqEnd >> 4) & 0x30)));    
-
-    SET_REG(REG_CCA, CCA_LEVEL);
+    // Start one step below the given frequency and scan down to the band start.
+    return qn8035_start_hardware_scan(fromFreq, MAX(fromFreq - stepWords, bandStartWord), bandStartWord, stepWords);
+}
 
-    // Initiate scan up.
-    SET_REG(REG_SYSTEM1, REG_SYSTEM1_RXREQ | REG_SYSTEM1_CHSC | REG_SYSTEM1_RDSEN);
+uint8_t qn8035_scan_frequency_up(uint16_t fromFreq, uint16_t stepWords)
+{
+    // Start one step above the given frequency and scan up to the band end.
+    return qn8035_start_hardware_scan(fromFreq, MIN(fromFreq + stepWords, bandEndWord), bandEndWord, stepWords);
 }
 
 void qn8035_init_rds_decoder()
 {    
     // Create and reset RDS data buffer.
-    qn8035RDSInfo = (char*)malloc(RDS_INFO_MAX_SIZE);
+    if(qn8035RDSInfo == NULL)
+    {
+        qn8035RDSInfo = (char*)malloc(RDS_INFO_MAX_SIZE);
+    }
 
     memset(qn8035RDSInfo, ' ', (RDS_INFO_MAX_SIZE - 1));
     qn8035RDSInfo[RDS_INFO_MAX_SIZE - 1] = 0x00;
 
-    // Create RDS capture context on CAPTURE state.
+    // Create RDS capture context on IDLE state, capture is driven by the tuner event loop.
     rdsContext.ioHandle = &fd;
     rdsContext.state = RD_IDLE;
     rdsContext.rdsBuffer = &qn8035RDSInfo;
+}
+
+static void qn8035_rds_clear_buffers()
+{
+    char *rdsBufferTemp = *(rdsContext.rdsBuffer);
+
+    memset(rdsBufferTemp, ' ', (RDS_INFO_MAX_SIZE - 1));
+    rdsBufferTemp[RDS_INFO_MAX_SIZE - 1] = 0x00;
+
+    memset(rdsCaptureBufferTemp, ' ', (RDS_INFO_MAX_SIZE - 1));
+    rdsCaptureBufferTemp[RDS_INFO_MAX_SIZE - 1] = 0x00;
+}
+
+void qn8035_rds_reset()
+{
+    // Start decoding from empty buffers without waiting for a new group.
+    qn8035_rds_clear_buffers();
+    rdsContext.state = RD_CAPTURE;
+}
+
+uint8_t qn8035_rds_read_group(RDSGroup *group)
+{
+    int status, dataRegs[8];
+    uint8_t regPos;
+
+    i2c_stats_set_subsystem(I2CS_RDS);
+
+    if(rdsContext.state == RD_CLEAR)
+    {
+        // Channel has changed, drop the text of the previous station.
+        qn8035_rds_reset();
+        return RESULT_FAIL;
+    }
 
-    // Create RDS capture and process thread.
-    pthread_create(&rdsDecoderThread, NULL, qn8035_rds_process_thread, (void*)(&rdsContext));
+    if((rdsContext.state != RD_CAPTURE) || (!qn8035_trylock_ready()))
+    {
+        return RESULT_FAIL;
+    }
+
+    // RXUPD bit toggles when a new group is received, skip the group already read.
+    status = GET_REG(REG_STATUS2);
+    if((status < 0) || ((status & REG_STATUS2_RDS_RXUPD) == rdsUpdateToggle))
+    {
+        TUNER_UNLOCK();
+        return RESULT_FAIL;
+    }
+
+    // Group ended between the previous poll and now, timestamp it before the data registers are read.
+    group->captureTime = clock_source_now();
+
+    for(regPos = 0; regPos < 8; regPos++)
+    {
+        dataRegs[regPos] = GET_REG(REG_RDSD0 + regPos);
+        if(dataRegs[regPos] < 0)
+        {
+            // Partial group is dropped, it is not decoded as garbage.
+            TUNER_UNLOCK();
+            return RESULT_FAIL;
+        }
+    }
+
+    group->blockA = (uint16_t)(dataRegs[1] | (dataRegs[0] << 8));
+    group->blockB = (uint16_t)(dataRegs[3] | (dataRegs[2] << 8));
+    group->blockC = (uint16_t)(dataRegs[5] | (dataRegs[4] << 8));
+    group->blockD = (uint16_t)(dataRegs[7] | (dataRegs[6] << 8));
+    group->status = (uint8_t)status;
+
+    TUNER_UNLOCK();
+
+    rdsUpdateToggle = status & REG_STATUS2_RDS_RXUPD;
+    return RESULT_SUCCESS;
 }
 
-void *qn8035_rds_process_thread(void *threadStruct)
+void qn8035_rds_decode_group(RDSGroup *group)
 {
-    RDSProcessContext *rdsContext = (RDSProcessContext *)threadStruct;
-    char *rdsBufferTemp = *(rdsContext->rdsBuffer);
+    char *rdsBufferTemp = *(rdsContext.rdsBuffer);
     
-    uint16_t rdsB, rdsD;
     uint16_t groupB;
     char char1, char2;
     uint8_t offset;
-    char rdsCaptureBufferTemp[RDS_INFO_MAX_SIZE];
 
-    // Sleep time structure to keep CPU happy.
-    struct timespec threadSleeper;
-    threadSleeper.tv_sec = 0;
-    threadSleeper.tv_nsec = 15000000;
+    if(rdsContext.state != RD_CAPTURE)
+    {
+        return;
+    }
 
-    // Thread service loop.
-    while(rdsContext->state != RD_END)
+    groupB = group->blockB & RDS_GROUP;
+    if((groupB == RDS_GROUP_A0) || (groupB == RDS_GROUP_B0))
     {
-        // Allow CPU to release from this task!
-        nanosleep(&threadSleeper, NULL);
-        
-        if(rdsContext->state == RD_CLEAR)
-        {
-            // Clear RDS data buffers.
-            memset(rdsBufferTemp, ' ', (RDS_INFO_MAX_SIZE - 1));
-            rdsBufferTemp[RDS_INFO_MAX_SIZE - 1] = 0x00;
+        offset = (group->blockB & 0x03) << 1;
+        char1 = (char)(group->blockD >> 8);
+        char2 = (char)(group->blockD & 0xFF);
 
-            memset(rdsCaptureBufferTemp, ' ', (RDS_INFO_MAX_SIZE - 1));
-            rdsCaptureBufferTemp[RDS_INFO_MAX_SIZE - 1] = 0x00;
-        
-            rdsContext->state = RD_CAPTURE;
-        }
-        else if(rdsContext->state == RD_CAPTURE)
+        // Fill extracted characters and buffer offsets into primary and secondary arrays.
+        if(offset < RDS_INFO_MAX_SIZE)
         {
-            // RDS capture and decode.
-            if(g_mutex_trylock(&tunerMutex))
+            if (rdsCaptureBufferTemp[offset] == char1) 
             {
-                rdsB = GET_REG(REG_RDSD3) | GET_REG(REG_RDSD2) << 8;
-                rdsD = GET_REG(REG_RDSD7) | GET_REG(REG_RDSD6) << 8;
-
-                g_mutex_unlock(&tunerMutex);
-
-                groupB = rdsB & RDS_GROUP;
-                if((groupB == RDS_GROUP_A0) || (groupB == RDS_GROUP_B0))
-                {
-                    offset = (rdsB & 0x03) << 1;
-                    char1 = (char)(rdsD >> 8);
-                    char2 = (char)(rdsD & 0xFF);
-
-                    // Fill extracted characters and buffer offsets into primary and secondary arrays.
-                    if(offset < RDS_INFO_MAX_SIZE)
-                    {
-                        if (rdsCaptureBufferTemp[offset] == char1) 
-                        {
-                            // 1st character verification is successful.
-                            rdsBufferTemp[offset] = char1;                          
-                        } 
-                        else if(isprint(char1))
-                        {
-                            rdsCaptureBufferTemp[offset] = char1;
-                        }
-
-                        if (rdsCaptureBufferTemp[offset + 1] == char2) 
-                        {
-                            // 2nd character verification is successful.
-                            rdsBufferTemp[offset + 1] = char2;                                                        
-                        } 
-                        else if(isprint(char2))
-                        {
-                            rdsCaptureBufferTemp[offset + 1] = char2;
-                        }
-                    }       
-                }
+                // 1st character verification is successful.
+                rdsBufferTemp[offset] = char1;                          
+            } 
+            else if(isprint(char1))
+            {
+                rdsCaptureBufferTemp[offset] = char1;
             }
-        }
-    }
 
-    return NULL;
+            if (rdsCaptureBufferTemp[offset + 1] == char2) 
+            {
+                // 2nd character verification is successful.
+                rdsBufferTemp[offset + 1] = char2;                                                        
+            } 
+            else if(isprint(char2))
+            {
+                rdsCaptureBufferTemp[offset + 1] = char2;
+            }
+        }       
+    }
 }
@@ -38,6 +38,9 @@
 // Chip ID related to QN8035 tuner.
 #define QN8035_ID       0x84
 
+// Time (us) the receiver needs to come out of a software reset.
+#define QN8035_RESET_TIME   1500000
+
 #define REG_SYSTEM1     0x00    // Device modes.
 #define REG_CCA         0x01    // CCA parameters.
 #define REG_SNR         0x02    // Estimate RF input CNR value.
@@ -92,22 +95,37 @@
 #define REG_STATUS1_FSM             0x70    // FSM state indicator.
 
 // Volume control settings
+#define REG_VOL_CTL_MUTE_EN         0x80    // Mute the audio output.
 #define REG_VOL_CTL_MAX_ANALOG_GAIN 0x07
 #define REG_VOL_CTL_MIN_ANALOG_GAIN 0x00
 
-// Default auto scan (CCA) level.
-#define CCA_LEVEL   0x10
+// Default auto scan (CCA) level and SNR threshold, used until the noise floor is calibrated.
+#define CCA_LEVEL       0x10
+#define CCA_SNR_LEVEL   0x05
+
+// Seek polls (5ms each) before giving up a 200 kHz step scan, smaller steps get proportionally more.
+#define SCAN_POLL_LIMIT 25
+
+// Post stop verification: signal readings taken after the settle time (us) each, RDS sync poll period (us).
+#define SCAN_VERIFY_READINGS        2
+#define SCAN_VERIFY_SETTLE_TIME     15000
+#define SCAN_VERIFY_RDS_POLL        10000
+
+// False stops skipped by a single seek before it gives up.
+#define SCAN_MAX_REJECTS            16
+
+// REG_STATUS2 bit definitions.
+#define REG_STATUS2_RDS_RXUPD       0x80    // Toggled on every new RDS group.
+#define REG_STATUS2_RDS_SYNC        0x10    // RDS decoder is synchronized.
+#define REG_STATUS2_RDS_ERR_MASK    0x0F    // Block error flags (bit 3 = block A ... bit 0 = block D).
 
 // RDS group definitions.
 #define RDS_GROUP       0xF800
 #define RDS_GROUP_A0    0x0000
 #define RDS_GROUP_B0    0x0080
 
-void qn8035_scan_frequency_down();
-void qn8035_scan_frequency_up();
-
-void qn8035_init_rds_decoder();
-void *qn8035_rds_process_thread(void *threadStruct);
+uint8_t qn8035_scan_frequency_down(uint16_t fromFreq, uint16_t stepWords);
+uint8_t qn8035_scan_frequency_up(uint16_t fromFreq, uint16_t stepWords);
 
 typedef struct RDSProcessContext
 {
@@ -34,12 +34,24 @@
 // Size of the RDS buffer.
 #define RDS_INFO_MAX_SIZE 16
 
+// Highest volume level supported by the QN8035 tuner.
+#define QN8035_MAX_VOLUME 7
+
 uint8_t qn8035_tuner_init(void);
 uint8_t qn8035_tuner_shutdown(void);
+uint8_t qn8035_check_device(void);
+uint8_t qn8035_reconnect(void);
 
 uint8_t qn8035_tuner_set_frequency(double frequency);
 double qn8035_tuner_get_frequency(void);
+uint8_t qn8035_tuner_set_channel(uint16_t channel);
+int32_t qn8035_tuner_get_channel(void);
+uint8_t qn8035_set_band_plan(const BandPlan *plan);
 uint8_t qn8035_tuner_scan(ScanDirection direction);
+uint8_t qn8035_cancel_scan(void);
+void qn8035_preempt_scan(void);
+void qn8035_set_scan_progress_handler(tuner_scan_progress_handler handler);
+void qn8035_get_lock_stats(LockCallerStats *callerStats);
 
 uint8_t qn8035_set_volume(uint16_t level);
 uint16_t qn8035_get_volume(void);
@@ -49,6 +61,11 @@ StereoMPXState qn8035_get_stereo_mpx_status(void);
 int16_t qn8035_get_snr(void);
 int16_t qn8035_get_rssi(void);
 
+uint8_t qn8035_rds_read_group(RDSGroup *group);
+void qn8035_rds_decode_group(RDSGroup *group);
+void qn8035_rds_reset(void);
+void qn8035_init_rds_decoder(void);
+
 extern char *qn8035RDSInfo;
 
 #endif /* _GTK_FM_TUNER_QN8035_INTERFACE_HEADER_ */
\ No newline at end of file
@@ -0,0 +1,330 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * RDS clock time (group 4A) decoder and clock synchronization service.          *
+ *                                                                               *
+ * Clock time is accepted only when consecutive clock groups agree with the      *
+ * elapsed monotonic time. Minute edge is taken from the group capture time,     *
+ * the capture rate is raised around the expected edge to reduce the jitter.     *
+ * Accepted time is published in the status segment and optionally applied       *
+ * to the system clock or to an NTP shared memory refclock segment.              *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "rdsclock.h"
+#include "shmstatus.h"
+#include "trace.h"
+#include "clocksource.h"
+
+// MJD of 1970-01-01.
+#define MJD_UNIX_EPOCH          40587
+
+static RDSClockContext clockContext;
+
+void rds_clock_init(RDSClockOutput output, uint8_t ntpUnit)
+{
+    int shmHandle;
+
+    g_mutex_init(&clockContext.clockLock);
+    clockContext.output = output;
+    clockContext.ntpSegment = NULL;
+    clockContext.lastClockTime = 0;
+    clockContext.lastEdgeTime = 0;
+    clockContext.lastResidual = 0;
+    clockContext.consistentCount = 0;
+    clockContext.captureRate = 0;
+    memset(&clockContext.published, 0, sizeof(FMStatusClock));
+
+    if(output == RCO_NTP_SHM)
+    {
+        // Units 0 and 1 are root only by convention, higher units are world writable.
+        shmHandle = shmget(RDS_CLOCK_NTP_SHM_KEY + ntpUnit, sizeof(NTPShmTime), IPC_CREAT | ((ntpUnit <= 1) ? 0600 : 0666));
+        clockContext.ntpSegment = (shmHandle >= 0) ? (NTPShmTime *)shmat(shmHandle, NULL, 0) : NULL;
+
+        if((clockContext.ntpSegment == NULL) || (clockContext.ntpSegment == (void *)-1))
+        {
+            g_warning("Unable to attach NTP shared memory segment %u: %s", ntpUnit, strerror(errno));
+            clockContext.ntpSegment = NULL;
+            clockContext.output = RCO_NONE;
+        }
+    }
+}
+
+void rds_clock_shutdown()
+{
+    if(clockContext.ntpSegment != NULL)
+    {
+        clockContext.ntpSegment->valid = 0;
+        shmdt(clockContext.ntpSegment);
+        clockContext.ntpSegment = NULL;
+    }
+}
+
+static void rds_clock_set_system(int64_t clockTime, gint64 edgeTime)
+{
+    struct timespec realTime;
+    struct timeval clockDelta;
+    int64_t currentClock, realTimeUs, clockOffset;
+
+    clock_gettime(CLOCK_REALTIME, &realTime);
+    currentClock = clockTime + (clock_source_now() - edgeTime);
+    realTimeUs = ((int64_t)realTime.tv_sec * G_USEC_PER_SEC) + (realTime.tv_nsec / 1000);
+    clockOffset = currentClock - realTimeUs;
+
+    if(ABS(clockOffset) >= RDS_CLOCK_STEP_THRESHOLD)
+    {
+        realTime.tv_sec = (time_t)(currentClock / G_USEC_PER_SEC);
+        realTime.tv_nsec = (long)((currentClock % G_USEC_PER_SEC) * 1000);
+
+        if(clock_settime(CLOCK_REALTIME, &realTime) < 0)
+        {
+            g_warning("Unable to set system clock: %s", strerror(errno));
+            clockContext.output = RCO_NONE;
+        }
+#ifdef DEBUG_LOGS
+        else
+        {
+            g_message("System clock stepped by %.3lf s", clockOffset / (double)G_USEC_PER_SEC);
+        }
+#endif
+    }
+    else
+    {
+        // Small offsets are slewed, so the system time never jumps backwards.
+        clockDelta.tv_sec = (time_t)(clockOffset / G_USEC_PER_SEC);
+        clockDelta.tv_usec = (suseconds_t)(clockOffset % G_USEC_PER_SEC);
+
+        if(adjtime(&clockDelta, NULL) < 0)
+        {
+            g_warning("Unable to adjust system clock: %s", strerror(errno));
+            clockContext.output = RCO_NONE;
+        }
+    }
+}
+
+static void rds_clock_write_ntp_shm(int64_t clockTime, gint64 edgeTime)
+{
+    NTPShmTime *segment = clockContext.ntpSegment;
+    struct timespec realTime;
+    int64_t receiveTime;
+
+    // Local clock reading at the minute edge.
+    clock_gettime(CLOCK_REALTIME, &realTime);
+    receiveTime = ((int64_t)realTime.tv_sec * G_USEC_PER_SEC) + (realTime.tv_nsec / 1000) - (clock_source_now() - edgeTime);
+
+    segment->valid = 0;
+    segment->count++;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    segment->mode = 1;
+    segment->clockTimeStampSec = (time_t)(clockTime / G_USEC_PER_SEC);
+    segment->clockTimeStampUSec = (int)(clockTime % G_USEC_PER_SEC);
+    segment->clockTimeStampNSec = (unsigned)((clockTime % G_USEC_PER_SEC) * 1000);
+    segment->receiveTimeStampSec = (time_t)(receiveTime / G_USEC_PER_SEC);
+    segment->receiveTimeStampUSec = (int)(receiveTime % G_USEC_PER_SEC);
+    segment->receiveTimeStampNSec = (unsigned)((receiveTime % G_USEC_PER_SEC) * 1000);
+    segment->leap = 0;
+    segment->nsamples = 0;
+
+    // Capture jitter is the capture period, 2^-8 s (4 ms) with fast capture, 2^-5 s (31 ms) otherwise.
+    segment->precision = (clockContext.captureRate <= RDS_CLOCK_FAST_CAPTURE_RATE) ? -8 : -5;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    segment->count++;
+    segment->valid = 1;
+}
+
+static uint8_t rds_clock_quality(uint8_t consistentCount, int64_t residual)
+{
+    uint32_t quality;
+
+    // Number of consecutive consistent groups, weighted by the edge timing error.
+    quality = (MIN(consistentCount, RDS_CLOCK_LOCK_COUNT + 2) * 100) / (RDS_CLOCK_LOCK_COUNT + 2);
+    quality = (uint32_t)((quality * (RDS_CLOCK_TOLERANCE - MIN(ABS(residual), RDS_CLOCK_TOLERANCE))) / RDS_CLOCK_TOLERANCE);
+
+    return (uint8_t)quality;
+}
+
+void rds_clock_add_group(RDSGroup *group)
+{
+    uint32_t mjd, latency;
+    uint8_t hour, minute;
+    int64_t clockTime, residual = 0;
+    gint64 edgeTime;
+
+    if((group->blockB & 0xF800) != 0x4000)
+    {
+        return;
+    }
+
+    g_mutex_lock(&clockContext.clockLock);
+
+    mjd = ((uint32_t)(group->blockB & 0x03) << 15) | (group->blockC >> 1);
+    hour = (uint8_t)(((group->blockC & 0x01) << 4) | (group->blockD >> 12));
+    minute = (uint8_t)((group->blockD >> 6) & 0x3F);
+
+    if((group->status & (RDS_STATUS_ERR_B | RDS_STATUS_ERR_C | RDS_STATUS_ERR_D)) || (mjd < MJD_UNIX_EPOCH) || (hour > 23) || (minute > 59))
+    {
+        clockContext.rejectedGroups++;
+        g_mutex_unlock(&clockContext.clockLock);
+        return;
+    }
+
+    clockTime = ((int64_t)(mjd - MJD_UNIX_EPOCH) * 86400) + (hour * 3600) + (minute * 60);
+
+    // Minute edge is the end of the CT group (EN 50067, within 0.1 s), which was on average half a capture period before it was detected.
+    edgeTime = group->captureTime - (clockContext.captureRate * 500);
+
+    // Some stations repeat the clock group within the minute, only the first one marks the edge.
+    if((clockContext.consistentCount > 0) && (clockTime == clockContext.lastClockTime))
+    {
+        g_mutex_unlock(&clockContext.clockLock);
+        return;
+    }
+
+    clockContext.clockGroups++;
+
+    if((clockContext.consistentCount > 0) && ((edgeTime - clockContext.lastEdgeTime) < RDS_CLOCK_HOLDOVER))
+    {
+        residual = (edgeTime - clockContext.lastEdgeTime) - ((clockTime - clockContext.lastClockTime) * G_USEC_PER_SEC);
+        if(ABS(residual) <= RDS_CLOCK_TOLERANCE)
+        {
+            clockContext.consistentCount = MIN(clockContext.consistentCount + 1, 255);
+        }
+        else
+        {
+            // Wrong time or a missed edge, start over from this group.
+            clockContext.inconsistentGroups++;
+            clockContext.consistentCount = 1;
+            residual = 0;
+        }
+    }
+    else
+    {
+        clockContext.consistentCount = 1;
+    }
+
+    clockContext.lastClockTime = clockTime;
+    clockContext.lastEdgeTime = edgeTime;
+    clockContext.lastResidual = residual;
+
+    clockContext.published.utcTime = clockTime * G_USEC_PER_SEC;
+    clockContext.published.edgeTime = (uint64_t)edgeTime;
+    clockContext.published.localOffset = (int16_t)(((group->blockD & 0x20) ? -1 : 1) * (group->blockD & 0x1F) * 30);
+    clockContext.published.locked = (clockContext.consistentCount >= RDS_CLOCK_LOCK_COUNT) ? 1 : 0;
+    clockContext.published.quality = rds_clock_quality(clockContext.consistentCount, residual);
+
+    if(clockContext.published.locked)
+    {
+        if(clockContext.output == RCO_SYSTEM)
+        {
+            rds_clock_set_system(clockContext.published.utcTime, edgeTime);
+        }
+        else if(clockContext.output == RCO_NTP_SHM)
+        {
+            rds_clock_write_ntp_shm(clockContext.published.utcTime, edgeTime);
+        }
+    }
+
+    // Time from the group detection in the driver until the clock is handed to the outputs.
+    latency = (uint32_t)(clock_source_now() - group->captureTime);
+    clockContext.published.latency = latency;
+    clockContext.latencyCount++;
+    clockContext.totalLatency += latency;
+    clockContext.maxLatency = MAX(clockContext.maxLatency, latency);
+
+    shm_status_publish_clock(&clockContext.published);
+
+    // CT always falls on a minute, minutes since the epoch fit the 32 bit trace argument.
+    TRACE_LOG(TE_RDS_CLOCK, (int32_t)(clockTime / 60), clockContext.consistentCount, residual, latency);
+
+    g_mutex_unlock(&clockContext.clockLock);
+}
+
+guint rds_clock_get_capture_rate(guint normalRate)
+{
+    gint64 elapsedTime, edgePhase;
+    guint captureRate = normalRate;
+
+    // Capture faster only around the minute edges following a received clock group.
+    if((clockContext.consistentCount > 0) && (clockContext.output != RCO_NONE))
+    {
+        elapsedTime = clock_source_now() - clockContext.lastEdgeTime;
+        edgePhase = elapsedTime % (60 * G_USEC_PER_SEC);
+
+        if((elapsedTime < RDS_CLOCK_HOLDOVER) && ((edgePhase >= ((60 * G_USEC_PER_SEC) - RDS_CLOCK_EDGE_WINDOW)) ||
+           ((edgePhase <= RDS_CLOCK_EDGE_WINDOW) && (elapsedTime > RDS_CLOCK_EDGE_WINDOW))))
+        {
+            captureRate = RDS_CLOCK_FAST_CAPTURE_RATE;
+        }
+    }
+
+    clockContext.captureRate = captureRate;
+    return captureRate;
+}
+
+uint8_t rds_clock_get_quality(FMStatusClock *clockState)
+{
+    gint64 clockAge;
+
+    g_mutex_lock(&clockContext.clockLock);
+    *clockState = clockContext.published;
+    g_mutex_unlock(&clockContext.clockLock);
+
+    if(clockState->utcTime == 0)
+    {
+        return 0;
+    }
+
+    // Quality decays with the time since the last clock group.
+    clockAge = clock_source_now() - (gint64)clockState->edgeTime;
+    if(clockAge >= RDS_CLOCK_HOLDOVER)
+    {
+        clockState->quality = 0;
+        clockState->locked = 0;
+    }
+    else
+    {
+        clockState->quality = (uint8_t)((clockState->quality * (RDS_CLOCK_HOLDOVER - clockAge)) / RDS_CLOCK_HOLDOVER);
+    }
+
+    return clockState->quality;
+}
+
+void rds_clock_get_latency(uint32_t *averageLatency, uint32_t *maxLatency)
+{
+    g_mutex_lock(&clockContext.clockLock);
+    *averageLatency = (clockContext.latencyCount > 0) ? (uint32_t)(clockContext.totalLatency / clockContext.latencyCount) : 0;
+    *maxLatency = clockContext.maxLatency;
+    g_mutex_unlock(&clockContext.clockLock);
+}
@@ -0,0 +1,113 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * RDS clock time (group 4A) decoder and clock synchronization service.          *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_RDSCLOCK_HEADER_
+#define _GTK_FM_TUNER_RDSCLOCK_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "tuner.h"
+#include "fmstatus.h"
+
+// Number of consecutive consistent clock groups needed to trust the clock time.
+#define RDS_CLOCK_LOCK_COUNT        3
+
+// Consecutive clock groups must match the elapsed monotonic time within this tolerance (us).
+#define RDS_CLOCK_TOLERANCE         500000
+
+// Clock time is not used anymore after this time without a new clock group (us).
+#define RDS_CLOCK_HOLDOVER          (10 * 60 * G_USEC_PER_SEC)
+
+// RDS capture rate in ms around the expected minute edge, and the width of that window (us).
+#define RDS_CLOCK_FAST_CAPTURE_RATE 5
+#define RDS_CLOCK_EDGE_WINDOW       (G_USEC_PER_SEC + (G_USEC_PER_SEC / 2))
+
+// System clock is stepped above this offset, smaller offsets are slewed (us).
+#define RDS_CLOCK_STEP_THRESHOLD    500000
+
+// NTP shared memory refclock segment key (unit number is added), as used by ntpd, chrony and gpsd.
+#define RDS_CLOCK_NTP_SHM_KEY       0x4E545030
+
+typedef enum
+{
+    RCO_NONE,       // Clock time is only published in the status segment.
+    RCO_SYSTEM,     // Set the system clock (needs CAP_SYS_TIME).
+    RCO_NTP_SHM     // Feed the NTP shared memory refclock (chrony: refclock SHM <unit>).
+} RDSClockOutput;
+
+// NTP shared memory segment layout (mode 1).
+typedef struct NTPShmTime
+{
+    int mode;
+    volatile int count;
+    time_t clockTimeStampSec;
+    int clockTimeStampUSec;
+    time_t receiveTimeStampSec;
+    int receiveTimeStampUSec;
+    int leap;
+    int precision;
+    int nsamples;
+    volatile int valid;
+    unsigned clockTimeStampNSec;
+    unsigned receiveTimeStampNSec;
+    int dummy[8];
+} NTPShmTime;
+
+typedef struct RDSClockContext
+{
+    GMutex clockLock;
+    RDSClockOutput output;
+    NTPShmTime *ntpSegment;
+
+    // Last accepted clock group.
+    int64_t lastClockTime;      // Clock time in seconds since the epoch (UTC).
+    gint64 lastEdgeTime;        // CLOCK_MONOTONIC time of its minute edge.
+    int64_t lastResidual;       // Difference between the elapsed clock and monotonic time (us).
+    uint8_t consistentCount;
+    guint captureRate;          // Current RDS capture rate in ms.
+
+    FMStatusClock published;
+
+    uint32_t clockGroups;
+    uint32_t rejectedGroups;
+    uint32_t inconsistentGroups;
+    uint32_t latencyCount;
+    uint32_t maxLatency;
+    uint64_t totalLatency;
+} RDSClockContext;
+
+void rds_clock_init(RDSClockOutput output, uint8_t ntpUnit);
+void rds_clock_shutdown(void);
+void rds_clock_add_group(RDSGroup *group);
+guint rds_clock_get_capture_rate(guint normalRate);
+
+uint8_t rds_clock_get_quality(FMStatusClock *clockState);
+void rds_clock_get_latency(uint32_t *averageLatency, uint32_t *maxLatency);
+
+#endif /* _GTK_FM_TUNER_RDSCLOCK_HEADER_ */
@@ -0,0 +1,246 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Per station RDS reception statistics.                                         *
+ *                                                                               *
+ * Counters are fixed size and updated on the RDS capture path for every         *
+ * group: group type histogram, block error rate from the tuner block error      *
+ * flags, valid groups per second, PI/PS acquisition time and an estimate of     *
+ * groups lost between two received groups.                                      *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "rdsstats.h"
+#include "clocksource.h"
+
+static RDSStatsContext statsContext;
+
+// Number of set bits for every block error flag combination.
+static const uint8_t blockErrorCount[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+static void rds_stats_reset_station(RDSStationStats *station, uint32_t frequency)
+{
+    memset(station, 0, sizeof(RDSStationStats));
+    station->frequency = frequency;
+    station->counters.timeToPI = FMSTATUS_RDS_TIME_NONE;
+    station->counters.timeToPS = FMSTATUS_RDS_TIME_NONE;
+}
+
+void rds_stats_init()
+{
+    uint8_t stationPos;
+
+    g_mutex_init(&statsContext.statsLock);
+
+    for(stationPos = 0; stationPos < RDS_STATS_MAX_STATIONS; stationPos++)
+    {
+        rds_stats_reset_station(&statsContext.stations[stationPos], 0);
+    }
+
+    statsContext.currentStation = NULL;
+}
+
+void rds_stats_set_station(double frequency)
+{
+    uint32_t frequencyKHz;
+    uint8_t stationPos;
+    RDSStationStats *station = NULL;
+
+    if(frequency <= 0)
+    {
+        return;
+    }
+
+    frequencyKHz = (uint32_t)((frequency * 1000) + 0.5);
+
+    g_mutex_lock(&statsContext.statsLock);
+
+    if((statsContext.currentStation != NULL) && (statsContext.currentStation->frequency == frequencyKHz))
+    {
+        g_mutex_unlock(&statsContext.statsLock);
+        return;
+    }
+
+    // Counters are kept per station, revisiting a station continues its statistics.
+    for(stationPos = 0; stationPos < RDS_STATS_MAX_STATIONS; stationPos++)
+    {
+        if(statsContext.stations[stationPos].frequency == frequencyKHz)
+        {
+            station = &statsContext.stations[stationPos];
+            break;
+        }
+
+        if((station == NULL) || (statsContext.stations[stationPos].lastTuneTime < station->lastTuneTime))
+        {
+            station = &statsContext.stations[stationPos];
+        }
+    }
+
+    if(station->frequency != frequencyKHz)
+    {
+        rds_stats_reset_station(station, frequencyKHz);
+    }
+
+    // Acquisition times are measured again on every tune.
+    station->lastTuneTime = clock_source_now();
+    station->lastGroupTime = 0;
+    station->rateWindowStart = station->lastTuneTime;
+    station->rateWindowGroups = 0;
+    station->psSegments = 0;
+    station->counters.groupRate = 0;
+    station->counters.timeToPI = FMSTATUS_RDS_TIME_NONE;
+    station->counters.timeToPS = FMSTATUS_RDS_TIME_NONE;
+
+    statsContext.currentStation = station;
+    g_mutex_unlock(&statsContext.statsLock);
+}
+
+void rds_stats_add_group(RDSGroup *group)
+{
+    RDSStationStats *station;
+    FMStatusRDSStats *counters;
+    gint64 now, groupGap;
+    uint8_t errorFlags;
+
+    now = clock_source_now();
+    errorFlags = group->status & (RDS_STATUS_ERR_A | RDS_STATUS_ERR_B | RDS_STATUS_ERR_C | RDS_STATUS_ERR_D);
+
+    g_mutex_lock(&statsContext.statsLock);
+
+    station = statsContext.currentStation;
+    if(station == NULL)
+    {
+        g_mutex_unlock(&statsContext.statsLock);
+        return;
+    }
+
+    counters = &station->counters;
+    counters->groups++;
+    counters->blocks += 4;
+    counters->blockErrors += blockErrorCount[errorFlags];
+
+    if(errorFlags == 0)
+    {
+        counters->validGroups++;
+        station->rateWindowGroups++;
+    }
+
+    // Group type is known only if block B is correct.
+    if(!(errorFlags & RDS_STATUS_ERR_B))
+    {
+        counters->groupTypes[group->blockB >> 11]++;
+
+        // PS name is complete once all four 0A/0B segments are received.
+        if(((group->blockB >> 12) == 0) && !(errorFlags & RDS_STATUS_ERR_D))
+        {
+            station->psSegments |= (uint8_t)(1 << (group->blockB & 0x03));
+            if((station->psSegments == 0x0F) && (counters->timeToPS == FMSTATUS_RDS_TIME_NONE))
+            {
+                counters->timeToPS = (uint32_t)((now - station->lastTuneTime) / 1000);
+            }
+        }
+    }
+
+    if(!(errorFlags & RDS_STATUS_ERR_A))
+    {
+        counters->pi = group->blockA;
+        if(counters->timeToPI == FMSTATUS_RDS_TIME_NONE)
+        {
+            counters->timeToPI = (uint32_t)((now - station->lastTuneTime) / 1000);
+        }
+    }
+
+    // Groups arrive back to back, a longer gap means groups were lost (not read in time or not decoded).
+    if(station->lastGroupTime != 0)
+    {
+        groupGap = now - station->lastGroupTime;
+        if((groupGap <= RDS_STATS_MAX_GAP) && (groupGap > (RDS_GROUP_PERIOD + (RDS_GROUP_PERIOD / 2))))
+        {
+            counters->missedGroups += (uint32_t)(((groupGap + (RDS_GROUP_PERIOD / 2)) / RDS_GROUP_PERIOD) - 1);
+        }
+    }
+
+    station->lastGroupTime = now;
+
+    if((now - station->rateWindowStart) >= RDS_STATS_RATE_WINDOW)
+    {
+        counters->groupRate = (uint32_t)(((gint64)station->rateWindowGroups * 100 * G_USEC_PER_SEC) / (now - station->rateWindowStart));
+        station->rateWindowStart = now;
+        station->rateWindowGroups = 0;
+    }
+
+    g_mutex_unlock(&statsContext.statsLock);
+}
+
+static void rds_stats_copy(RDSStationStats *station, FMStatusRDSStats *stats)
+{
+    *stats = station->counters;
+
+    // No group in the last rate window, the station is not decodable anymore.
+    if((station->lastGroupTime == 0) || ((clock_source_now() - station->lastGroupTime) > (2 * RDS_STATS_RATE_WINDOW)))
+    {
+        stats->groupRate = 0;
+    }
+}
+
+uint32_t rds_stats_read(FMStatusRDSStats *stats)
+{
+    uint32_t frequency = 0;
+
+    g_mutex_lock(&statsContext.statsLock);
+
+    if(statsContext.currentStation != NULL)
+    {
+        rds_stats_copy(statsContext.currentStation, stats);
+        frequency = statsContext.currentStation->frequency;
+    }
+
+    g_mutex_unlock(&statsContext.statsLock);
+    return frequency;
+}
+
+uint32_t rds_stats_read_station(uint8_t index, FMStatusRDSStats *stats)
+{
+    uint32_t frequency = 0;
+
+    if(index >= RDS_STATS_MAX_STATIONS)
+    {
+        return 0;
+    }
+
+    g_mutex_lock(&statsContext.statsLock);
+
+    if(statsContext.stations[index].frequency != 0)
+    {
+        rds_stats_copy(&statsContext.stations[index], stats);
+        frequency = statsContext.stations[index].frequency;
+    }
+
+    g_mutex_unlock(&statsContext.statsLock);
+    return frequency;
+}
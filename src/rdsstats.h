@@ -0,0 +1,74 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Per station RDS reception statistics.                                         *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_RDSSTATS_HEADER_
+#define _GTK_FM_TUNER_RDSSTATS_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "tuner.h"
+#include "fmstatus.h"
+
+// Number of stations with statistics, least recently tuned station is replaced.
+#define RDS_STATS_MAX_STATIONS  16
+
+// Duration of one RDS group (104 bits at 1187.5 bit/s) in us.
+#define RDS_GROUP_PERIOD        87579
+
+// Longer gaps between groups are treated as reception dropouts, not as missed groups (us).
+#define RDS_STATS_MAX_GAP       G_USEC_PER_SEC
+
+// Valid group rate measurement window (us).
+#define RDS_STATS_RATE_WINDOW   G_USEC_PER_SEC
+
+typedef struct RDSStationStats
+{
+    uint32_t frequency;         // Station frequency in kHz, 0 for an unused entry.
+    gint64 lastTuneTime;
+    gint64 lastGroupTime;
+    gint64 rateWindowStart;
+    uint32_t rateWindowGroups;
+    uint8_t psSegments;         // PS segments received since tuning.
+    FMStatusRDSStats counters;
+} RDSStationStats;
+
+typedef struct RDSStatsContext
+{
+    GMutex statsLock;
+    RDSStationStats stations[RDS_STATS_MAX_STATIONS];
+    RDSStationStats *currentStation;
+} RDSStatsContext;
+
+void rds_stats_init(void);
+void rds_stats_set_station(double frequency);
+void rds_stats_add_group(RDSGroup *group);
+
+uint32_t rds_stats_read(FMStatusRDSStats *stats);
+uint32_t rds_stats_read_station(uint8_t index, FMStatusRDSStats *stats);
+
+#endif /* _GTK_FM_TUNER_RDSSTATS_HEADER_ */
@@ -0,0 +1,181 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * RDS reception statistics window.                                              *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#include "rdsstatsview.h"
+#include "rdsstats.h"
+
+RDSStatsWindow rdsStatsWindow;
+
+static double get_block_error_rate(FMStatusRDSStats *stats)
+{
+    return (stats->blocks > 0) ? ((stats->blockErrors * 100.0) / stats->blocks) : 0;
+}
+
+static void format_rds_time(char *buffer, size_t bufferSize, uint32_t timeMs)
+{
+    if(timeMs == FMSTATUS_RDS_TIME_NONE)
+    {
+        g_strlcpy(buffer, "-", bufferSize);
+    }
+    else
+    {
+        g_snprintf(buffer, bufferSize, "%u ms", timeMs);
+    }
+}
+
+static void update_rds_statistics()
+{
+    GString *statsText;
+    FMStatusRDSStats stats;
+    uint32_t frequency;
+    uint8_t groupType, column = 0, stationPos;
+    char piTime[16], psTime[16];
+
+    statsText = g_string_new("<tt>");
+    frequency = rds_stats_read(&stats);
+
+    if(frequency == 0)
+    {
+        g_string_append(statsText, "No station tuned");
+    }
+    else
+    {
+        format_rds_time(piTime, sizeof(piTime), stats.timeToPI);
+        format_rds_time(psTime, sizeof(psTime), stats.timeToPS);
+
+        g_string_append_printf(statsText, "Station      %u.%02u MHz    PI %04X\n", frequency / 1000, (frequency % 1000) / 10, stats.pi);
+        g_string_append_printf(statsText, "Groups       %u (%u valid), %.1lf groups/s\n", stats.groups, stats.validGroups, stats.groupRate / 100.0);
+        g_string_append_printf(statsText, "Block errors %u of %u, BLER %.2lf %%\n", stats.blockErrors, stats.blocks, get_block_error_rate(&stats));
+        g_string_append_printf(statsText, "Missed       %u groups (estimated)\n", stats.missedGroups);
+        g_string_append_printf(statsText, "Time to PI   %-10s Time to PS %s\n\n", piTime, psTime);
+
+        // Only the group types seen on the station are listed.
+        g_string_append(statsText, "<b>Group types</b>\n");
+        for(groupType = 0; groupType < FMSTATUS_RDS_GROUP_TYPES; groupType++)
+        {
+            if(stats.groupTypes[groupType] > 0)
+            {
+                g_string_append_printf(statsText, "%2u%c %-8u", (groupType >> 1), ((groupType & 0x01) ? 'B' : 'A'), stats.groupTypes[groupType]);
+                if((++column % 4) == 0)
+                {
+                    g_string_append_c(statsText, '\n');
+                }
+            }
+        }
+
+        if((column % 4) != 0)
+        {
+            g_string_append_c(statsText, '\n');
+        }
+    }
+
+    // All stations with statistics, to compare reception of different stations or antennas.
+    g_string_append(statsText, "\n<b>Stations</b>\n");
+    for(stationPos = 0; stationPos < RDS_STATS_MAX_STATIONS; stationPos++)
+    {
+        frequency = rds_stats_read_station(stationPos, &stats);
+        if(frequency != 0)
+        {
+            g_string_append_printf(statsText, "%3u.%02u MHz  %8u groups  BLER %6.2lf %%  missed %u\n", frequency / 1000, (frequency % 1000) / 10,
+                stats.groups, get_block_error_rate(&stats), stats.missedGroups);
+        }
+    }
+
+    g_string_append(statsText, "</tt>");
+    gtk_label_set_markup(rdsStatsWindow.statsLabel, statsText->str);
+    g_string_free(statsText, TRUE);
+}
+
+static gboolean on_rds_statistics_refresh(gpointer userData)
+{
+    update_rds_statistics();
+    return G_SOURCE_CONTINUE;
+}
+
+static uint8_t create_rds_statistics_window()
+{
+    GtkBuilder *builder;
+    gchar *objectIds[] = {"rds-statistics", NULL};
+
+    // Load only the RDS statistics window from the UI resource.
+    builder = gtk_builder_new();
+    if(gtk_builder_add_objects_from_resource(builder, UI_RESOURCE_PATH, objectIds, NULL) == 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to load RDS statistics from UI resource");
+#endif
+        g_object_unref(builder);
+        return RESULT_FAIL;
+    }
+
+    rdsStatsWindow.window = GTK_WIDGET(gtk_builder_get_object(builder, "rds-statistics"));
+    rdsStatsWindow.statsLabel = GTK_LABEL(gtk_builder_get_object(builder, "lblRDSStats"));
+    rdsStatsWindow.refreshId = 0;
+
+    // Setup events and release builder.
+    gtk_builder_connect_signals(builder, NULL);
+    g_object_unref(builder);
+
+    gtk_window_set_title(GTK_WINDOW(rdsStatsWindow.window), "RDS Statistics");
+
+    return RESULT_SUCCESS;
+}
+
+void show_rds_statistics_window(GtkWidget *parent)
+{
+    // Statistics window is created on first use and reused afterwards.
+    if((rdsStatsWindow.window == NULL) && (create_rds_statistics_window() == RESULT_FAIL))
+    {
+        return;
+    }
+
+    // Statistics are collected all the time, the window is refreshed only while it is open.
+    if(rdsStatsWindow.refreshId == 0)
+    {
+        rdsStatsWindow.refreshId = g_timeout_add_seconds(RDS_STATS_VIEW_REFRESH, on_rds_statistics_refresh, NULL);
+    }
+
+    update_rds_statistics();
+
+    gtk_window_set_transient_for(GTK_WINDOW(rdsStatsWindow.window), GTK_WINDOW(parent));
+    gtk_window_present(GTK_WINDOW(rdsStatsWindow.window));
+}
+
+gboolean on_rds_statistics_delete_event(GtkWidget *widget, GdkEvent *event, gpointer userData)
+{
+    if(rdsStatsWindow.refreshId != 0)
+    {
+        g_source_remove(rdsStatsWindow.refreshId);
+        rdsStatsWindow.refreshId = 0;
+    }
+
+    gtk_widget_hide(widget);
+    return TRUE;
+}
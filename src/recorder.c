@@ -0,0 +1,196 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Append-only recorder of raw RDS groups and tuner telemetry.                   *
+ * Records are written by the tuner core thread, the file is flushed at every    *
+ * block boundary so a crash loses at most one block.                            *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "defconfig.h"
+#include "recorder.h"
+#include "fmstatus.h"
+#include "clocksource.h"
+
+static CaptureRecorder captureRecorder;
+
+static gboolean recorder_write(const void *data, size_t dataSize)
+{
+    if(fwrite(data, dataSize, 1, captureRecorder.captureFile) != 1)
+    {
+        // Stop recording on any write error (e.g. disk full), tuner keeps working.
+        g_warning("Unable to write capture file: %s", strerror(errno));
+        recorder_close();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean recorder_begin_block(gint64 captureTime)
+{
+    FMCaptureBlock block;
+
+    // Keep the previous block on the disk before starting a new one.
+    fflush(captureRecorder.captureFile);
+
+    memset(&block, 0, sizeof(block));
+    block.magic = FMCAPTURE_BLOCK_MAGIC;
+    block.blockNumber = captureRecorder.blockNumber++;
+    block.baseTime = (uint64_t)captureTime;
+    block.realTime = (uint64_t)(captureRecorder.startRealTime + captureTime);
+    block.firstRecord = captureRecorder.recordCount;
+
+    captureRecorder.blockBaseTime = captureTime;
+    return recorder_write(&block, sizeof(block));
+}
+
+static void recorder_write_record(FMCaptureRecord *record)
+{
+    FMCaptureRecord padding;
+    gint64 captureTime;
+
+    if(captureRecorder.captureFile == NULL)
+    {
+        return;
+    }
+
+    captureTime = clock_source_now() - captureRecorder.startTime;
+
+    // Record time offset is 32 bit, close the block early with padding records if it would overflow.
+    if(((captureRecorder.recordCount % FMCAPTURE_BLOCK_RECORDS) != 0) && ((captureTime - captureRecorder.blockBaseTime) > UINT32_MAX))
+    {
+        memset(&padding, 0, sizeof(padding));
+        padding.type = FMCAPTURE_RECORD_NONE;
+
+        while((captureRecorder.recordCount % FMCAPTURE_BLOCK_RECORDS) != 0)
+        {
+            if(!recorder_write(&padding, sizeof(padding)))
+            {
+                return;
+            }
+
+            captureRecorder.recordCount++;
+        }
+    }
+
+    if(((captureRecorder.recordCount % FMCAPTURE_BLOCK_RECORDS) == 0) && (!recorder_begin_block(captureTime)))
+    {
+        return;
+    }
+
+    record->timeOffset = (uint32_t)(captureTime - captureRecorder.blockBaseTime);
+    if(recorder_write(record, sizeof(FMCaptureRecord)))
+    {
+        captureRecorder.recordCount++;
+    }
+}
+
+uint8_t recorder_open(const char *path, const char *tunerName)
+{
+    FMCaptureHeader header;
+
+    captureRecorder.captureFile = fopen(path, "wb");
+    if(captureRecorder.captureFile == NULL)
+    {
+        g_warning("Unable to create capture file %s: %s", path, strerror(errno));
+        return RESULT_FAIL;
+    }
+
+    captureRecorder.recordCount = 0;
+    captureRecorder.blockNumber = 0;
+    captureRecorder.startTime = clock_source_now();
+    captureRecorder.startRealTime = g_get_real_time();
+    captureRecorder.blockBaseTime = 0;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = FMCAPTURE_MAGIC;
+    header.version = FMCAPTURE_VERSION;
+    header.recordSize = sizeof(FMCaptureRecord);
+    header.blockSize = sizeof(FMCaptureBlock);
+    header.blockRecords = FMCAPTURE_BLOCK_RECORDS;
+    header.startRealTime = (uint64_t)captureRecorder.startRealTime;
+    header.startTime = (uint64_t)captureRecorder.startTime;
+    g_strlcpy(header.tunerName, tunerName, sizeof(header.tunerName));
+
+    if(!recorder_write(&header, sizeof(header)))
+    {
+        return RESULT_FAIL;
+    }
+
+#ifdef DEBUG_LOGS
+    g_message("Recording RDS groups and telemetry into %s", path);
+#endif
+
+    return RESULT_SUCCESS;
+}
+
+void recorder_close()
+{
+    if(captureRecorder.captureFile == NULL)
+    {
+        return;
+    }
+
+    fclose(captureRecorder.captureFile);
+    captureRecorder.captureFile = NULL;
+
+#ifdef DEBUG_LOGS
+    g_message("Capture file closed with %u records in %u blocks", captureRecorder.recordCount, captureRecorder.blockNumber);
+#endif
+}
+
+void recorder_write_rds(RDSGroup *group)
+{
+    FMCaptureRecord record;
+
+    memset(&record, 0, sizeof(record));
+    record.type = FMCAPTURE_RECORD_RDS;
+    record.status = group->status;
+    record.data[0] = group->blockA;
+    record.data[1] = group->blockB;
+    record.data[2] = group->blockC;
+    record.data[3] = group->blockD;
+
+    recorder_write_record(&record);
+}
+
+void recorder_write_telemetry(TunerStatus *status)
+{
+    FMCaptureRecord record;
+
+    memset(&record, 0, sizeof(record));
+    record.type = FMCAPTURE_RECORD_TELEMETRY;
+    record.status = (status->mpxState == MPXS_STEREO) ? FMSTATUS_MPX_STEREO : ((status->mpxState == MPXS_MONO) ? FMSTATUS_MPX_MONO : FMSTATUS_MPX_UNKNOWN);
+    record.data[0] = (uint16_t)((status->frequency * 100) + 0.5);
+    record.data[1] = (uint16_t)status->rssi;
+    record.data[2] = (uint16_t)status->snr;
+    record.data[3] = status->volume;
+
+    recorder_write_record(&record);
+}
@@ -0,0 +1,55 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Append-only recorder of raw RDS groups and tuner telemetry.                   *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_RECORDER_HEADER_
+#define _GTK_FM_TUNER_RECORDER_HEADER_
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "defmain.h"
+#include "tuner.h"
+#include "fmcapture.h"
+
+typedef struct CaptureRecorder
+{
+    FILE *captureFile;
+    uint32_t recordCount;       // Records written, including block padding.
+    uint32_t blockNumber;
+    gint64 startTime;           // CLOCK_MONOTONIC time of the capture start in us.
+    gint64 startRealTime;
+    gint64 blockBaseTime;       // Base time of the current block in us since the capture start.
+} CaptureRecorder;
+
+uint8_t recorder_open(const char *path, const char *tunerName);
+void recorder_close(void);
+
+void recorder_write_rds(RDSGroup *group);
+void recorder_write_telemetry(TunerStatus *status);
+
+#endif /* _GTK_FM_TUNER_RECORDER_HEADER_ */
@@ -0,0 +1,282 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Replay tuner, plays back a capture file through the normal tuner interface.   *
+ * Capture file is memory mapped and records are released at their recorded      *
+ * time (scaled by the replay speed) whenever the tuner core polls for RDS       *
+ * groups, so RDS decoder, telemetry and UI run the same code as with the radio. *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "defconfig.h"
+#include "replay.h"
+#include "fmstatus.h"
+#include "clocksource.h"
+
+static ReplayContext replayContext;
+
+static const FMCaptureRecord *replay_record(uint32_t index)
+{
+    return (const FMCaptureRecord *)(replayContext.fileData + fmcapture_record_offset(index));
+}
+
+static uint64_t replay_record_time(uint32_t index)
+{
+    const FMCaptureBlock *block = (const FMCaptureBlock *)(replayContext.fileData + fmcapture_block_offset(index));
+
+    return block->baseTime + replay_record(index)->timeOffset;
+}
+
+static void replay_apply_telemetry(const FMCaptureRecord *record)
+{
+    double frequency = record->data[0] / 100.0;
+
+    // Station change in the capture, the RDS decoder starts over like on a real retune.
+    if((frequency != replayContext.frequency) && (replayContext.rdsResetHandler != NULL))
+    {
+        replayContext.rdsResetHandler();
+    }
+
+    replayContext.frequency = frequency;
+    replayContext.rssi = (int16_t)record->data[1];
+    replayContext.snr = (int16_t)record->data[2];
+    replayContext.mpxState = (record->status == FMSTATUS_MPX_STEREO) ? MPXS_STEREO : ((record->status == FMSTATUS_MPX_MONO) ? MPXS_MONO : MPXS_UNKNOWN);
+    replayContext.volume = record->data[3];
+}
+
+static void replay_finish()
+{
+    double elapsedTime;
+
+    replayContext.finished = TRUE;
+    elapsedTime = (clock_source_now() - replayContext.startTime) / (double)G_USEC_PER_SEC;
+
+    g_message("Replay finished, %u RDS groups in %.2lf s (%.0lf groups/s)", replayContext.groupCount, elapsedTime,
+        ((elapsedTime > 0) ? (replayContext.groupCount / elapsedTime) : 0));
+}
+
+uint8_t replay_open(const char *path, double speed)
+{
+    const FMCaptureHeader *header;
+    struct stat fileInfo;
+
+    replayContext.fileHandle = open(path, O_RDONLY);
+    if(replayContext.fileHandle < 0)
+    {
+        g_printerr("Unable to open capture file %s: %s\n", path, strerror(errno));
+        return RESULT_FAIL;
+    }
+
+    if((fstat(replayContext.fileHandle, &fileInfo) < 0) || (fileInfo.st_size < (off_t)sizeof(FMCaptureHeader)))
+    {
+        g_printerr("Invalid capture file %s\n", path);
+        close(replayContext.fileHandle);
+        return RESULT_FAIL;
+    }
+
+    replayContext.fileSize = (size_t)fileInfo.st_size;
+    replayContext.fileData = (const uint8_t *)mmap(NULL, replayContext.fileSize, PROT_READ, MAP_PRIVATE, replayContext.fileHandle, 0);
+    if(replayContext.fileData == MAP_FAILED)
+    {
+        g_printerr("Unable to map capture file %s: %s\n", path, strerror(errno));
+        close(replayContext.fileHandle);
+        return RESULT_FAIL;
+    }
+
+    // Records are read front to back.
+    madvise((void *)replayContext.fileData, replayContext.fileSize, MADV_SEQUENTIAL);
+
+    header = (const FMCaptureHeader *)replayContext.fileData;
+    if((header->magic != FMCAPTURE_MAGIC) || (header->version != FMCAPTURE_VERSION) || (header->recordSize != sizeof(FMCaptureRecord)) ||
+       (header->blockSize != sizeof(FMCaptureBlock)) || (header->blockRecords != FMCAPTURE_BLOCK_RECORDS))
+    {
+        g_printerr("Unsupported capture file format %s\n", path);
+        replay_tuner_shutdown();
+        return RESULT_FAIL;
+    }
+
+    replayContext.recordCount = fmcapture_record_count(replayContext.fileSize);
+    replayContext.position = 0;
+    replayContext.speed = speed;
+    replayContext.groupCount = 0;
+    replayContext.finished = FALSE;
+    replayContext.firstRecordTime = (replayContext.recordCount > 0) ? replay_record_time(0) : 0;
+
+    replayContext.frequency = -1;
+    replayContext.rssi = -1;
+    replayContext.snr = -1;
+    replayContext.mpxState = MPXS_UNKNOWN;
+    replayContext.volume = 0;
+
+#ifdef DEBUG_LOGS
+    g_message("Replaying %u records from %s (tuner %.16s)", replayContext.recordCount, path, header->tunerName);
+#endif
+
+    return RESULT_SUCCESS;
+}
+
+void replay_set_rds_reset_handler(replay_rds_reset_handler handler)
+{
+    replayContext.rdsResetHandler = handler;
+}
+
+uint8_t replay_tuner_init()
+{
+    // Playback clock starts with the tuner.
+    replayContext.startTime = clock_source_now();
+    return (replayContext.fileData != NULL) ? RESULT_SUCCESS : RESULT_FAIL;
+}
+
+uint8_t replay_tuner_shutdown()
+{
+    if((replayContext.fileData != NULL) && (replayContext.fileData != MAP_FAILED))
+    {
+        munmap((void *)replayContext.fileData, replayContext.fileSize);
+    }
+
+    replayContext.fileData = NULL;
+    close(replayContext.fileHandle);
+
+    return RESULT_SUCCESS;
+}
+
+uint8_t replay_tuner_set_frequency(double frequency)
+{
+    // Capture decides the frequency, tuning commands are ignored.
+    return RESULT_FAIL;
+}
+
+double replay_tuner_get_frequency()
+{
+    return replayContext.frequency;
+}
+
+uint8_t replay_tuner_set_channel(uint16_t channel)
+{
+    return RESULT_FAIL;
+}
+
+int32_t replay_tuner_get_channel()
+{
+    // Captures made with another band plan may hold frequencies outside the active plan or off its raster.
+    if(replayContext.frequency <= 0)
+    {
+        return BAND_PLAN_NO_CHANNEL;
+    }
+
+    return band_plan_khz_to_exact_channel(band_plan_get(), (uint32_t)((replayContext.frequency * 1000) + 0.5));
+}
+
+uint8_t replay_tuner_scan(ScanDirection direction)
+{
+    return RESULT_FAIL;
+}
+
+uint8_t replay_cancel_scan()
+{
+    return RESULT_SUCCESS;
+}
+
+uint8_t replay_set_volume(uint16_t level)
+{
+    return RESULT_FAIL;
+}
+
+uint16_t replay_get_volume()
+{
+    return replayContext.volume;
+}
+
+uint16_t replay_change_volume(VolumeDirection direction)
+{
+    return replayContext.volume;
+}
+
+StereoMPXState replay_get_stereo_mpx_status()
+{
+    return replayContext.mpxState;
+}
+
+int16_t replay_get_snr()
+{
+    return replayContext.snr;
+}
+
+int16_t replay_get_rssi()
+{
+    return replayContext.rssi;
+}
+
+uint8_t replay_rds_read_group(RDSGroup *group)
+{
+    const FMCaptureRecord *record;
+    uint64_t playTime = 0;
+
+    if(replayContext.speed != REPLAY_SPEED_MAX)
+    {
+        playTime = (uint64_t)((clock_source_now() - replayContext.startTime) * replayContext.speed);
+    }
+
+    // Play all due telemetry records up to the next due RDS group.
+    while(replayContext.position < replayContext.recordCount)
+    {
+        if((replayContext.speed != REPLAY_SPEED_MAX) && ((replay_record_time(replayContext.position) - replayContext.firstRecordTime) > playTime))
+        {
+            return RESULT_FAIL;
+        }
+
+        record = replay_record(replayContext.position++);
+
+        if(record->type == FMCAPTURE_RECORD_TELEMETRY)
+        {
+            replay_apply_telemetry(record);
+        }
+        else if(record->type == FMCAPTURE_RECORD_RDS)
+        {
+            group->blockA = record->data[0];
+            group->blockB = record->data[1];
+            group->blockC = record->data[2];
+            group->blockD = record->data[3];
+            group->status = record->status;
+            group->captureTime = clock_source_now();
+
+            replayContext.groupCount++;
+            return RESULT_SUCCESS;
+        }
+    }
+
+    if(!replayContext.finished)
+    {
+        replay_finish();
+    }
+
+    return RESULT_FAIL;
+}
@@ -0,0 +1,88 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Replay tuner, plays back a capture file through the normal tuner interface.   *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_REPLAY_HEADER_
+#define _GTK_FM_TUNER_REPLAY_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "defmain.h"
+#include "tuner.h"
+#include "fmcapture.h"
+
+// Replay speed value for playback without any pacing.
+#define REPLAY_SPEED_MAX    0
+
+// Called whenever the replayed frequency changes, to reset the RDS decoder.
+typedef void (*replay_rds_reset_handler)(void);
+
+typedef struct ReplayContext
+{
+    int fileHandle;
+    const uint8_t *fileData;
+    size_t fileSize;
+    uint32_t recordCount;
+    uint32_t position;          // Index of the next record to play.
+    double speed;               // Playback speed factor, REPLAY_SPEED_MAX for maximum speed.
+    gint64 startTime;           // CLOCK_MONOTONIC time of the playback start.
+    uint64_t firstRecordTime;   // Capture time of the first record.
+    uint32_t groupCount;        // Number of RDS groups played.
+    gboolean finished;
+    replay_rds_reset_handler rdsResetHandler;
+
+    // Tuner state restored from the telemetry records.
+    double frequency;
+    int16_t rssi;
+    int16_t snr;
+    StereoMPXState mpxState;
+    uint16_t volume;
+} ReplayContext;
+
+uint8_t replay_open(const char *path, double speed);
+void replay_set_rds_reset_handler(replay_rds_reset_handler handler);
+
+uint8_t replay_tuner_init(void);
+uint8_t replay_tuner_shutdown(void);
+
+uint8_t replay_tuner_set_frequency(double frequency);
+double replay_tuner_get_frequency(void);
+uint8_t replay_tuner_set_channel(uint16_t channel);
+int32_t replay_tuner_get_channel(void);
+uint8_t replay_tuner_scan(ScanDirection direction);
+uint8_t replay_cancel_scan(void);
+
+uint8_t replay_set_volume(uint16_t level);
+uint16_t replay_get_volume(void);
+uint16_t replay_change_volume(VolumeDirection direction);
+
+StereoMPXState replay_get_stereo_mpx_status(void);
+int16_t replay_get_snr(void);
+int16_t replay_get_rssi(void);
+uint8_t replay_rds_read_group(RDSGroup *group);
+
+#endif /* _GTK_FM_TUNER_REPLAY_HEADER_ */
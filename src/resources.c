@@ -1,388 +0,0 @@
-#include <gio/gio.h>
-
-#if defined (__ELF__) && ( __GNUC__ > 2 || (__GNUC__ == 2 && __GNUC_MINOR__ >= 6))
-# define SECTION __attribute__ ((section (".gresource.gtkfmtuner"), aligned (8)))
-#else
-# define SECTION
-#endif
-
-#ifdef _MSC_VER
-static const SECTION union { const guint8 data[1733]; const double alignment; void * const ptr;}  gtkfmtuner_resource_data = { {
-  0107, 0126, 0141, 0162, 0151, 0141, 0156, 0164, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 0000, 
-  0030, 0000, 0000, 0000, 0254, 0000, 0000, 0000, 0000, 0000, 0000, 0050, 0005, 0000, 0000, 0000, 
-  0000, 0000, 0000, 0000, 0002, 0000, 0000, 0000, 0002, 0000, 0000, 0000, 0003, 0000, 0000, 0000, 
-  0005, 0000, 0000, 0000, 0324, 0265, 0002, 0000, 0377, 0377, 0377, 0377, 0254, 0000, 0000, 0000, 
-  0001, 0000, 0114, 0000, 0260, 0000, 0000, 0000, 0264, 0000, 0000, 0000, 0005, 0156, 0205, 0355, 
-  0004, 0000, 0000, 0000, 0264, 0000, 0000, 0000, 0017, 0000, 0114, 0000, 0304, 0000, 0000, 0000, 
-  0310, 0000, 0000, 0000, 0302, 0257, 0211, 0013, 0000, 0000, 0000, 0000, 0310, 0000, 0000, 0000, 
-  0004, 0000, 0114, 0000, 0314, 0000, 0000, 0000, 0320, 0000, 0000, 0000, 0241, 0273, 0025, 0030, 
-  0001, 0000, 0000, 0000, 0320, 0000, 0000, 0000, 0010, 0000, 0166, 0000, 0330, 0000, 0000, 0000, 
-  0260, 0006, 0000, 0000, 0006, 0135, 0006, 0313, 0002, 0000, 0000, 0000, 0260, 0006, 0000, 0000, 
-  0017, 0000, 0114, 0000, 0300, 0006, 0000, 0000, 0304, 0006, 0000, 0000, 0057, 0000, 0000, 0000, 
-  0002, 0000, 0000, 0000, 0147, 0164, 0153, 0146, 0155, 0164, 0165, 0156, 0145, 0162, 0151, 0143, 
-  0157, 0156, 0057, 0000, 0003, 0000, 0000, 0000, 0143, 0157, 0155, 0057, 0004, 0000, 0000, 0000, 
-  0151, 0143, 0157, 0156, 0056, 0160, 0156, 0147, 0310, 0005, 0000, 0000, 0000, 0000, 0000, 0000, 
-  0211, 0120, 0116, 0107, 0015, 0012, 0032, 0012, 0000, 0000, 0000, 0015, 0111, 0110, 0104, 0122, 
-  0000, 0000, 0000, 0060, 0000, 0000, 0000, 0060, 0010, 0006, 0000, 0000, 0000, 0127, 0002, 0371, 
-  0207, 0000, 0000, 0000, 0006, 0142, 0113, 0107, 0104, 0000, 0377, 0000, 0377, 0000, 0377, 0240, 
-  0275, 0247, 0223, 0000, 0000, 0005, 0175, 0111, 0104, 0101, 0124, 0150, 0201, 0355, 0230, 0131, 
-  0150, 0134, 0145, 0024, 0307, 0177, 0347, 0316, 0166, 0247, 0263, 0044, 0323, 0316, 0324, 0164, 
-  0123, 0264, 0315, 0210, 0212, 0042, 0042, 0245, 0246, 0050, 0044, 0156, 0017, 0101, 0250, 0242, 
-  0171, 0162, 0001, 0025, 0055, 0112, 0105, 0101, 0255, 0040, 0324, 0242, 0076, 0270, 0053, 0156, 
-  0130, 0260, 0042, 0126, 0137, 0024, 0327, 0212, 0122, 0261, 0051, 0245, 0142, 0132, 0054, 0012, 
-  0122, 0120, 0143, 0012, 0012, 0265, 0266, 0231, 0044, 0355, 0144, 0146, 0062, 0167, 0356, 0235, 
-  0271, 0307, 0207, 0054, 0246, 0222, 0231, 0271, 0323, 0144, 0032, 0204, 0374, 0237, 0346, 0336, 
-  0357, 0154, 0377, 0071, 0337, 0367, 0235, 0163, 0056, 0054, 0140, 0001, 0013, 0370, 0137, 0103, 
-  0346, 0073, 0000, 0200, 0315, 0057, 0277, 0335, 0055, 0242, 0333, 0100, 0124, 0125, 0356, 0171, 
-  0366, 0241, 0273, 0276, 0366, 0252, 0353, 0157, 0146, 0140, 0136, 0341, 0063, 0344, 0135, 0127, 
-  0111, 0002, 0214, 0023, 0341, 0154, 0257, 0272, 0363, 0112, 0340, 0343, 0157, 0367, 0235, 0147, 
-  0030, 0306, 0113, 0077, 0375, 0062, 0220, 0264, 0035, 0347, 0264, 0154, 0314, 0013, 0201, 0235, 
-  0073, 0017, 0056, 0052, 0057, 0052, 0075, 0052, 0302, 0146, 0300, 0074, 0167, 0145, 0233, 0165, 
-  0370, 0317, 0243, 0166, 0131, 0053, 0243, 0300, 0075, 0215, 0330, 0072, 0343, 0147, 0340, 0263, 
-  0335, 0373, 0156, 0100, 0214, 0327, 0200, 0163, 0000, 0005, 0336, 0017, 0110, 0340, 0321, 0356, 
-  0316, 0265, 0307, 0116, 0307, 0336, 0031, 0043, 0360, 0311, 0336, 0276, 0013, 0214, 0212, 0373, 
-  0012, 0160, 0035, 0200, 0302, 0217, 0242, 0262, 0151, 0303, 0325, 0035, 0337, 0317, 0306, 0156, 
-  0323, 0011, 0174, 0271, 0157, 0137, 0242, 0354, 0030, 0133, 0201, 0373, 0001, 0037, 0060, 0054, 
-  0042, 0117, 0225, 0062, 0107, 0136, 0357, 0351, 0351, 0251, 0314, 0326, 0176, 0323, 0010, 0154, 
-  0335, 0252, 0306, 0245, 0127, 0365, 0335, 0052, 0350, 0013, 0012, 0051, 0240, 0014, 0274, 0151, 
-  0127, 0102, 0133, 0172, 0256, 0275, 0074, 0073, 0127, 0176, 0232, 0102, 0340, 0323, 0335, 0337, 
-  0257, 0025, 0321, 0327, 0200, 0265, 0023, 0136, 0366, 0270, 0360, 0300, 0115, 0235, 0353, 0017, 
-  0315, 0265, 0257, 0071, 0045, 0360, 0371, 0067, 0337, 0055, 0127, 0277, 0074, 0003, 0334, 0072, 
-  0141, 0373, 0010, 0310, 0343, 0033, 0272, 0072, 0336, 0233, 0113, 0077, 0323, 0061, 0047, 0004, 
-  0266, 0035, 0074, 0030, 0150, 0313, 0331, 0367, 0251, 0352, 0123, 0100, 0014, 0050, 0252, 0362, 
-  0234, 0023, 0226, 0147, 0173, 0072, 0072, 0212, 0163, 0341, 0243, 0032, 0146, 0115, 0340, 0263, 
-  0075, 0175, 0327, 0340, 0272, 0257, 0042, 0134, 0000, 0040, 0312, 0227, 0256, 0141, 0154, 0272, 
-  0261, 0363, 0212, 0077, 0146, 0037, 0136, 0175, 0234, 0066, 0201, 0235, 0173, 0367, 0267, 0127, 
-  0052, 0225, 0227, 0201, 0356, 0211, 0127, 0277, 0202, 0074, 0270, 0241, 0253, 0143, 0327, 0334, 
-  0204, 0346, 0015, 0015, 0023, 0330, 0265, 0153, 0127, 0144, 0314, 0037, 0175, 0104, 0204, 0307, 
-  0200, 0020, 0160, 0122, 0104, 0266, 0306, 0051, 0275, 0321, 0331, 0331, 0131, 0236, 0373, 0020, 
-  0153, 0303, 0063, 0001, 0125, 0225, 0057, 0172, 0373, 0156, 0126, 0321, 0027, 0201, 0125, 0200, 
-  0013, 0174, 0340, 0072, 0074, 0174, 0323, 0365, 0353, 0007, 0233, 0026, 0141, 0035, 0170, 0042, 
-  0260, 0163, 0167, 0337, 0145, 0025, 0251, 0274, 0012, 0262, 0036, 0100, 0205, 0037, 0104, 0335, 
-  0115, 0033, 0272, 0256, 0074, 0320, 0334, 0360, 0352, 0243, 0052, 0201, 0133, 0076, 0274, 0045, 
-  0350, 0006, 0345, 0171, 0104, 0356, 0052, 0271, 0245, 0310, 0231, 0014, 0152, 0032, 0216, 0212, 
-  0312, 0016, 0263, 0354, 0337, 0362, 0121, 0317, 0107, 0366, 0114, 0002, 0125, 0273, 0121, 0313, 
-  0137, 0176, 0122, 0125, 0037, 0100, 0233, 0027, 0235, 0007, 0054, 0127, 0321, 0315, 0226, 0277, 
-  0014, 0360, 0330, 0114, 0002, 0325, 0333, 0151, 0321, 0333, 0247, 0077, 0252, 0253, 0144, 0217, 
-  0147, 0031, 0033, 0031, 0243, 0142, 0127, 0360, 0005, 0175, 0104, 0022, 0021, 0342, 0155, 0161, 
-  0304, 0150, 0156, 0113, 0245, 0206, 0173, 0007, 0215, 0022, 0120, 0130, 0066, 0365, 0333, 0125, 
-  0006, 0177, 0037, 0244, 0124, 0050, 0115, 0255, 0227, 0113, 0145, 0262, 0307, 0262, 0130, 0071, 
-  0213, 0245, 0355, 0113, 0075, 0223, 0160, 0212, 0016, 0371, 0241, 0074, 0126, 0336, 0242, 0154, 
-  0217, 0137, 0132, 0376, 0240, 0037, 0063, 0146, 0022, 0115, 0106, 0011, 0230, 0201, 0031, 0202, 
-  0221, 0266, 0152, 0366, 0074, 0015, 0064, 0331, 0343, 0131, 0112, 0205, 0022, 0113, 0042, 0051, 
-  0356, 0136, 0267, 0221, 0325, 0311, 0064, 0003, 0231, 0337, 0330, 0276, 0377, 0055, 0206, 0013, 
-  0103, 0214, 0036, 0037, 0245, 0145, 0131, 0113, 0115, 0033, 0352, 0052, 0047, 0376, 0072, 0101, 
-  0041, 0123, 0100, 0377, 0263, 0057, 0235, 0242, 0063, 0116, 0154, 0060, 0117, 0064, 0025, 0241, 
-  0165, 0145, 0002, 0021, 0157, 0177, 0210, 0341, 0105, 0150, 0154, 0144, 0014, 0200, 0273, 0327, 
-  0155, 0344, 0302, 0266, 0213, 0011, 0371, 0103, 0134, 0264, 0354, 0022, 0356, 0274, 0142, 0343, 
-  0304, 0172, 0241, 0156, 0360, 0203, 0207, 0007, 0311, 0147, 0362, 0140, 0100, 0100, 0115, 0350, 
-  0017, 0123, 0352, 0015, 0121, 0352, 0015, 0101, 0177, 0230, 0240, 0206, 0101, 0040, 0227, 0311, 
-  0223, 0031, 0310, 0240, 0352, 0355, 0360, 0171, 0312, 0300, 0144, 0252, 0317, 0113, 0266, 0237, 
-  0362, 0176, 0365, 0222, 0064, 0000, 0216, 0135, 0273, 0176, 0235, 0070, 0162, 0222, 0122, 0256, 
-  0064, 0105, 0306, 0021, 0013, 0322, 0020, 0112, 0377, 0053, 0143, 0003, 0223, 0211, 0261, 0162, 
-  0026, 0047, 0217, 0234, 0044, 0261, 0052, 0121, 0067, 0066, 0117, 0031, 0230, 0064, 0174, 0070, 
-  0323, 0177, 0312, 0353, 0303, 0303, 0375, 0247, 0254, 0317, 0004, 0247, 0350, 0120, 0030, 0312, 
-  0173, 0162, 0063, 0035, 0271, 0241, 0034, 0116, 0261, 0376, 0240, 0337, 0320, 0120, 0277, 0375, 
-  0300, 0066, 0356, 0134, 0167, 0057, 0153, 0222, 0151, 0006, 0062, 0375, 0274, 0263, 0377, 0255, 
-  0272, 0072, 0371, 0341, 0074, 0212, 0022, 0120, 0223, 0334, 0127, 0256, 0047, 0077, 0361, 0156, 
-  0003, 0133, 0055, 0012, 0043, 0171, 0132, 0127, 0324, 0316, 0102, 0103, 0004, 0206, 0013, 0031, 
-  0236, 0337, 0375, 0164, 0043, 0052, 0130, 0243, 0026, 0000, 0116, 0277, 0367, 0253, 0326, 0351, 
-  0027, 0110, 0103, 0061, 0153, 0321, 0272, 0242, 0266, 0154, 0323, 0077, 0253, 0124, 0354, 0211, 
-  0261, 0367, 0374, 0042, 0346, 0371, 0336, 0164, 0046, 0167, 0144, 0305, 0251, 0337, 0033, 0172, 
-  0073, 0003, 0263, 0201, 0234, 0176, 0051, 0367, 0242, 0331, 0364, 0014, 0370, 0002, 0176, 0334, 
-  0212, 0003, 0277, 0205, 0261, 0006, 0274, 0175, 0204, 0010, 0267, 0373, 0320, 0164, 0021, 0177, 
-  0240, 0176, 0170, 0015, 0021, 0230, 0261, 0220, 0215, 0015, 0325, 0324, 0061, 0343, 0046, 0216, 
-  0345, 0020, 0114, 0203, 0065, 0340, 0315, 0117, 0040, 0255, 0330, 0100, 0270, 0305, 0254, 0053, 
-  0333, 0020, 0201, 0311, 0102, 0006, 0114, 0025, 0262, 0172, 0207, 0072, 0232, 0214, 0222, 0313, 
-  0344, 0260, 0051, 0142, 0166, 0327, 0024, 0235, 0202, 0015, 0040, 0020, 0131, 0022, 0255, 0053, 
-  0353, 0355, 0014, 0114, 0134, 0040, 0325, 0012, 0131, 0255, 0251, 0042, 0140, 0006, 0210, 0045, 
-  0143, 0236, 0334, 0114, 0107, 0064, 0025, 0233, 0271, 0057, 0372, 0017, 0074, 0021, 0360, 0007, 
-  0307, 0023, 0125, 0255, 0220, 0371, 0203, 0265, 0035, 0265, 0256, 0154, 0305, 0214, 0215, 0157, 
-  0007, 0021, 0041, 0250, 0141, 0244, 0077, 0214, 0335, 0033, 0304, 0356, 0015, 0302, 0200, 0111, 
-  0020, 0163, 0252, 0377, 0061, 0343, 0046, 0211, 0025, 0255, 0136, 0102, 0363, 0106, 0040, 0222, 
-  0030, 0237, 0147, 0266, 0037, 0330, 0306, 0241, 0143, 0077, 0143, 0225, 0055, 0016, 0375, 0375, 
-  0063, 0357, 0364, 0215, 0027, 0262, 0310, 0342, 0105, 0065, 0365, 0105, 0204, 0324, 0232, 0024, 
-  0261, 0124, 0014, 0105, 0261, 0245, 0210, 0246, 0213, 0004, 0273, 0154, 0202, 0135, 0066, 0254, 
-  0261, 0260, 0261, 0120, 0224, 0130, 0052, 0106, 0152, 0165, 0312, 0163, 0063, 0347, 0351, 0014, 
-  0304, 0333, 0342, 0130, 0071, 0153, 0306, 0102, 0026, 0212, 0206, 0210, 0237, 0025, 0257, 0153, 
-  0103, 0104, 0110, 0254, 0112, 0020, 0115, 0106, 0051, 0214, 0344, 0051, 0146, 0255, 0251, 0032, 
-  0341, 0013, 0372, 0010, 0267, 0230, 0104, 0026, 0107, 0011, 0204, 0353, 0157, 0033, 0257, 0004, 
-  0216, 0002, 0313, 0001, 0304, 0020, 0226, 0266, 0057, 0145, 0364, 0370, 0050, 0143, 0043, 0005, 
-  0312, 0166, 0005, 0177, 0320, 0307, 0242, 0305, 0021, 0342, 0147, 0065, 0066, 0320, 0004, 0302, 
-  0001, 0132, 0127, 0044, 0352, 0126, 0330, 0123, 0240, 0362, 0127, 0265, 0245, 0252, 0004, 0104, 
-  0145, 0207, 0212, 0156, 0236, 0172, 0066, 0204, 0226, 0145, 0055, 0165, 0373, 0376, 0246, 0300, 
-  0160, 0167, 0124, 0133, 0252, 0112, 0300, 0054, 0373, 0267, 0130, 0376, 0062, 0052, 0172, 0033, 
-  0023, 0231, 0230, 0007, 0214, 0017, 0365, 0116, 0340, 0211, 0171, 0362, 0277, 0200, 0005, 0054, 
-  0240, 0331, 0370, 0007, 0377, 0156, 0007, 0030, 0334, 0232, 0216, 0267, 0000, 0000, 0000, 0000, 
-  0111, 0105, 0116, 0104, 0256, 0102, 0140, 0202, 0000, 0000, 0050, 0165, 0165, 0141, 0171, 0051, 
-  0152, 0141, 0171, 0141, 0153, 0157, 0144, 0171, 0062, 0060, 0060, 0060, 0154, 0153, 0057, 0000, 
-  0001, 0000, 0000, 0000
-} };
-#else /* _MSC_VER */
-static const SECTION union { const guint8 data[1733]; const double alignment; void * const ptr;}  gtkfmtuner_resource_data = {
-  "\107\126\141\162\151\141\156\164\000\000\000\000\000\000\000\000"
-  "\030\000\000\000\254\000\000\000\000\000\000\050\005\000\000\000"
-  "\000\000\000\000\002\000\000\000\002\000\000\000\003\000\000\000"
-  "\005\000\000\000\324\265\002\000\377\377\377\377\254\000\000\000"
-  "\001\000\114\000\260\000\000\000\264\000\000\000\005\156\205\355"
-  "\004\000\000\000\264\000\000\000\017\000\114\000\304\000\000\000"
-  "\310\000\000\000\302\257\211\013\000\000\000\000\310\000\000\000"
-  "\004\000\114\000\314\000\000\000\320\000\000\000\241\273\025\030"
-  "\001\000\000\000\320\000\000\000\010\000\166\000\330\000\000\000"
-  "\260\006\000\000\006\135\006\313\002\000\000\000\260\006\000\000"
-  "\017\000\114\000\300\006\000\000\304\006\000\000\057\000\000\000"
-  "\002\000\000\000\147\164\153\146\155\164\165\156\145\162\151\143"
-  "\157\156\057\000\003\000\000\000\143\157\155\057\004\000\000\000"
-  "\151\143\157\156\056\160\156\147\310\005\000\000\000\000\000\000"
-  "\211\120\116\107\015\012\032\012\000\000\000\015\111\110\104\122"
-  "\000\000\000\060\000\000\000\060\010\006\000\000\000\127\002\371"
-  "\207\000\000\000\006\142\113\107\104\000\377\000\377\000\377\240"
-  "\275\247\223\000\000\005\175\111\104\101\124\150\201\355\230\131"
-  "\150\134\145\024\307\177\347\316\166\247\263\044\323\316\324\164"
-  "\123\264\315\210\212\042\042\245\246\050\044\156\017\101\250\242"
-  "\171\162\001\025\055\112\105\101\255\040\324\242\076\270\053\156"
-  "\130\260\042\126\137\024\327\212\122\261\051\245\142\132\054\012"
-  "\122\120\143\012\012\265\266\231\044\355\144\146\062\167\356\235"
-  "\271\307\207\054\246\222\231\271\323\144\032\204\374\237\346\336"
-  "\357\154\377\071\337\367\235\163\056\054\140\001\013\370\137\103"
-  "\346\073\000\200\315\057\277\335\055\242\333\100\124\125\356\171"
-  "\366\241\273\276\366\252\353\157\146\140\136\341\063\344\135\127"
-  "\111\002\214\023\341\154\257\272\363\112\340\343\157\367\235\147"
-  "\030\306\113\077\375\062\220\264\035\347\264\154\314\013\201\235"
-  "\073\017\056\052\057\052\075\052\302\146\300\074\167\145\233\165"
-  "\370\317\243\166\131\053\243\300\075\215\330\072\343\147\340\263"
-  "\335\373\156\100\214\327\200\163\000\005\336\017\110\340\321\356"
-  "\316\265\307\116\307\336\031\043\360\311\336\276\013\214\212\373"
-  "\012\160\035\200\302\217\242\262\151\303\325\035\337\317\306\156"
-  "\323\011\174\271\157\137\242\354\030\133\201\373\001\037\060\054"
-  "\042\117\225\062\107\136\357\351\351\251\314\326\176\323\010\154"
-  "\335\252\306\245\127\365\335\052\350\013\012\051\240\014\274\151"
-  "\127\102\133\172\256\275\074\073\127\176\232\102\340\323\335\337"
-  "\257\025\321\327\200\265\023\136\366\270\360\300\115\235\353\017"
-  "\315\265\257\071\045\360\371\067\337\055\127\277\074\003\334\072"
-  "\141\373\010\310\343\033\272\072\336\233\113\077\323\061\047\004"
-  "\266\035\074\030\150\313\331\367\251\352\123\100\014\050\252\362"
-  "\234\023\226\147\173\072\072\212\163\341\243\032\146\115\340\263"
-  "\075\175\327\340\272\257\042\134\000\040\312\227\256\141\154\272"
-  "\261\363\212\077\146\037\136\175\234\066\201\235\173\367\267\127"
-  "\052\225\227\201\356\211\127\277\202\074\270\241\253\143\327\334"
-  "\204\346\015\015\023\330\265\153\127\144\314\037\175\104\204\307"
-  "\200\020\160\122\104\266\306\051\275\321\331\331\131\236\373\020"
-  "\153\303\063\001\125\225\057\172\373\156\126\321\027\201\125\200"
-  "\013\174\340\072\074\174\323\365\353\007\233\026\141\035\170\042"
-  "\260\163\167\337\145\025\251\274\012\262\036\100\205\037\104\335"
-  "\115\033\272\256\074\320\334\360\352\243\052\201\133\076\274\045"
-  "\350\006\345\171\104\356\052\271\245\310\231\014\152\032\216\212"
-  "\312\016\263\354\337\362\121\317\107\366\114\002\125\273\121\313"
-  "\137\176\122\125\037\100\233\027\235\007\054\127\321\315\226\277"
-  "\014\360\330\114\002\325\333\151\321\333\247\077\252\253\144\217"
-  "\147\031\033\031\243\142\127\360\005\175\104\022\021\342\155\161"
-  "\304\150\156\113\245\206\173\007\215\022\120\130\066\365\333\125"
-  "\006\177\037\244\124\050\115\255\227\113\145\262\307\262\130\071"
-  "\213\245\355\113\075\223\160\212\016\371\241\074\126\336\242\154"
-  "\217\137\132\376\240\037\063\146\022\115\106\011\230\201\031\202"
-  "\221\266\152\366\074\015\064\331\343\131\112\205\022\113\042\051"
-  "\356\136\267\221\325\311\064\003\231\337\330\276\377\055\206\013"
-  "\103\214\036\037\245\145\131\113\115\033\352\052\047\376\072\101"
-  "\041\123\100\377\263\057\235\242\063\116\154\060\117\064\025\241"
-  "\165\145\002\021\157\177\210\341\105\150\154\144\014\200\273\327"
-  "\155\344\302\266\213\011\371\103\134\264\354\022\356\274\142\343"
-  "\304\172\241\156\360\203\207\007\311\147\362\140\100\100\115\350"
-  "\017\123\352\015\121\352\015\101\177\230\240\206\101\040\227\311"
-  "\223\031\310\240\352\355\360\171\312\300\144\252\317\113\266\237"
-  "\362\176\365\222\064\000\216\135\273\176\235\070\162\222\122\256"
-  "\064\105\306\021\013\322\020\112\377\053\143\003\223\211\261\162"
-  "\026\047\217\234\044\261\052\121\067\066\117\031\230\064\174\070"
-  "\323\177\312\353\303\303\375\247\254\317\004\247\350\120\030\312"
-  "\173\162\063\035\271\241\034\116\261\376\240\337\320\120\277\375"
-  "\300\066\356\134\167\057\153\222\151\006\062\375\274\263\377\255"
-  "\272\072\371\341\074\212\022\120\223\334\127\256\047\077\361\156"
-  "\003\133\055\012\043\171\132\127\324\316\102\103\004\206\013\031"
-  "\236\337\375\164\043\052\130\243\026\000\116\277\367\253\326\351"
-  "\027\110\103\061\153\321\272\242\266\154\323\077\253\124\354\211"
-  "\261\367\374\042\346\371\336\164\046\167\144\305\251\337\033\172"
-  "\073\003\263\201\234\176\051\367\242\331\364\014\370\002\176\334"
-  "\212\003\277\205\261\006\274\175\204\010\267\373\320\164\021\177"
-  "\240\176\170\015\021\230\261\220\215\015\325\324\061\343\046\216"
-  "\345\020\114\203\065\340\315\117\040\255\330\100\270\305\254\053"
-  "\333\020\201\311\102\006\114\025\262\172\207\072\232\214\222\313"
-  "\344\260\051\142\166\327\024\235\202\015\040\020\131\022\255\053"
-  "\353\355\014\114\134\040\325\012\131\255\251\042\140\006\210\045"
-  "\143\236\334\114\107\064\025\233\271\057\372\017\074\021\360\007"
-  "\307\023\125\255\220\371\203\265\035\265\256\154\305\214\215\157"
-  "\007\021\041\250\141\244\077\214\335\033\304\356\015\302\200\111"
-  "\020\163\252\377\061\343\046\211\025\255\136\102\363\106\040\222"
-  "\030\237\147\266\037\330\306\241\143\077\143\225\055\016\375\375"
-  "\063\357\364\215\027\262\310\342\105\065\365\105\204\324\232\024"
-  "\261\124\014\105\261\245\210\246\213\004\273\154\202\135\066\254"
-  "\261\260\261\120\224\130\052\106\152\165\312\163\063\347\351\014"
-  "\304\333\342\130\071\153\306\102\026\212\206\210\237\025\257\153"
-  "\103\104\110\254\112\020\115\106\051\214\344\051\146\255\251\032"
-  "\341\013\372\010\267\230\104\026\107\011\204\353\157\033\257\004"
-  "\216\002\313\001\304\020\226\266\057\145\364\370\050\143\043\005"
-  "\312\166\005\177\320\307\242\305\021\342\147\065\066\320\004\302"
-  "\001\132\127\044\352\126\330\123\240\362\127\265\245\252\004\104"
-  "\145\207\212\156\236\172\066\204\226\145\055\165\373\376\246\300"
-  "\160\167\124\133\252\112\300\054\373\267\130\376\062\052\172\033"
-  "\023\231\230\007\214\017\365\116\340\211\171\362\277\200\005\054"
-  "\240\331\370\007\377\156\007\030\334\232\216\267\000\000\000\000"
-  "\111\105\116\104\256\102\140\202\000\000\050\165\165\141\171\051"
-  "\152\141\171\141\153\157\144\171\062\060\060\060\154\153\057\000"
-  "\001\000\000\000" };
-#endif /* !_MSC_VER */
-
-static GStaticResource static_resource = { gtkfmtuner_resource_data.data, sizeof (gtkfmtuner_resource_data.data) - 1 /* nul terminator */, NULL, NULL, NULL };
-
-G_MODULE_EXPORT
-GResource *gtkfmtuner_get_resource (void);
-GResource *gtkfmtuner_get_resource (void)
-{
-  return g_static_resource_get_resource (&static_resource);
-}
-/*
-  If G_HAS_CONSTRUCTORS is true then the compiler support *both* constructors and
-  destructors, in a usable way, including e.g. on library unload. If not you're on
-  your own.
-
-  Some compilers need #pragma to handle this, which does not work with macros,
-  so the way you need to use this is (for constructors):
-
-  #ifdef G_DEFINE_CONSTRUCTOR_NEEDS_PRAGMA
-  #pragma G_DEFINE_CONSTRUCTOR_PRAGMA_ARGS(my_constructor)
-  #endif
-  G_DEFINE_CONSTRUCTOR(my_constructor)
-  static void my_constructor(void) {
-   ...
-  }
-
-*/
-
-#ifndef __GTK_DOC_IGNORE__
-
-#if  __GNUC__ > 2 || (__GNUC__ == 2 && __GNUC_MINOR__ >= 7)
-
-#define G_HAS_CONSTRUCTORS 1
-
-#define G_DEFINE_CONSTRUCTOR(_func) static void __attribute__((constructor)) _func (void);
-#define G_DEFINE_DESTRUCTOR(_func) static void __attribute__((destructor)) _func (void);
-
-#elif defined (_MSC_VER) && (_MSC_VER >= 1500)
-/* Visual studio 2008 and later has _Pragma */
-
-#include <stdlib.h>
-
-#define G_HAS_CONSTRUCTORS 1
-
-/* We do some weird things to avoid the constructors being optimized
- * away on VS2015 if WholeProgramOptimization is enabled. First we
- * make a reference to the array from the wrapper to make sure its
- * references. Then we use a pragma to make sure the wrapper function
- * symbol is always included at the link stage. Also, the symbols
- * need to be extern (but not dllexport), even though they are not
- * really used from another object file.
- */
-
-/* We need to account for differences between the mangling of symbols
- * for x86 and x64/ARM/ARM64 programs, as symbols on x86 are prefixed
- * with an underscore but symbols on x64/ARM/ARM64 are not.
- */
-#ifdef _M_IX86
-#define G_MSVC_SYMBOL_PREFIX "_"
-#else
-#define G_MSVC_SYMBOL_PREFIX ""
-#endif
-
-#define G_DEFINE_CONSTRUCTOR(_func) G_MSVC_CTOR (_func, G_MSVC_SYMBOL_PREFIX)
-#define G_DEFINE_DESTRUCTOR(_func) G_MSVC_DTOR (_func, G_MSVC_SYMBOL_PREFIX)
-
-#define G_MSVC_CTOR(_func,_sym_prefix) \
-  static void _func(void); \
-  extern int (* _array ## _func)(void);              \
-  int _func ## _wrapper(void) { _func(); g_slist_find (NULL,  _array ## _func); return 0; } \
-  __pragma(comment(linker,"/include:" _sym_prefix # _func "_wrapper")) \
-  __pragma(section(".CRT$XCU",read)) \
-  __declspec(allocate(".CRT$XCU")) int (* _array ## _func)(void) = _func ## _wrapper;
-
-#define G_MSVC_DTOR(_func,_sym_prefix) \
-  static void _func(void); \
-  extern int (* _array ## _func)(void);              \
-  int _func ## _constructor(void) { atexit (_func); g_slist_find (NULL,  _array ## _func); return 0; } \
-   __pragma(comment(linker,"/include:" _sym_prefix # _func "_constructor")) \
-  __pragma(section(".CRT$XCU",read)) \
-  __declspec(allocate(".CRT$XCU")) int (* _array ## _func)(void) = _func ## _constructor;
-
-#elif defined (_MSC_VER)
-
-#define G_HAS_CONSTRUCTORS 1
-
-/* Pre Visual studio 2008 must use #pragma section */
-#define G_DEFINE_CONSTRUCTOR_NEEDS_PRAGMA 1
-#define G_DEFINE_DESTRUCTOR_NEEDS_PRAGMA 1
-
-#define G_DEFINE_CONSTRUCTOR_PRAGMA_ARGS(_func) \
-  section(".CRT$XCU",read)
-#define G_DEFINE_CONSTRUCTOR(_func) \
-  static void _func(void); \
-  static int _func ## _wrapper(void) { _func(); return 0; } \
-  __declspec(allocate(".CRT$XCU")) static int (*p)(void) = _func ## _wrapper;
-
-#define G_DEFINE_DESTRUCTOR_PRAGMA_ARGS(_func) \
-  section(".CRT$XCU",read)
-#define G_DEFINE_DESTRUCTOR(_func) \
-  static void _func(void); \
-  static int _func ## _constructor(void) { atexit (_func); return 0; } \
-  __declspec(allocate(".CRT$XCU")) static int (* _array ## _func)(void) = _func ## _constructor;
-
-#elif defined(__SUNPRO_C)
-
-/* This is not tested, but i believe it should work, based on:
- * http://opensource.apple.com/source/OpenSSL098/OpenSSL098-35/src/fips/fips_premain.c
- */
-
-#define G_HAS_CONSTRUCTORS 1
-
-#define G_DEFINE_CONSTRUCTOR_NEEDS_PRAGMA 1
-#define G_DEFINE_DESTRUCTOR_NEEDS_PRAGMA 1
-
-#define G_DEFINE_CONSTRUCTOR_PRAGMA_ARGS(_func) \
-  init(_func)
-#define G_DEFINE_CONSTRUCTOR(_func) \
-  static void _func(void);
-
-#define G_DEFINE_DESTRUCTOR_PRAGMA_ARGS(_func) \
-  fini(_func)
-#define G_DEFINE_DESTRUCTOR(_func) \
-  static void _func(void);
-
-#else
-
-/* constructors not supported for this compiler */
-
-#endif
-
-#endif /* __GTK_DOC_IGNORE__ */
-
-#ifdef G_HAS_CONSTRUCTORS
-
-#ifdef G_DEFINE_CONSTRUCTOR_NEEDS_PRAGMA
-#pragma G_DEFINE_CONSTRUCTOR_PRAGMA_ARGS(resource_constructor)
-#endif
-G_DEFINE_CONSTRUCTOR(resource_constructor)
-#ifdef G_DEFINE_DESTRUCTOR_NEEDS_PRAGMA
-#pragma G_DEFINE_DESTRUCTOR_PRAGMA_ARGS(resource_destructor)
-#endif
-G_DEFINE_DESTRUCTOR(resource_destructor)
-
-#else
-#warning "Constructor not supported on this compiler, linking in resources will not work"
-#endif
-
-static void resource_constructor (void)
-{
-  g_static_resource_init (&static_resource);
-}
-
-static void resource_destructor (void)
-{
-  g_static_resource_fini (&static_resource);
-}
@@ -0,0 +1,241 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Self-calibrating CCA thresholds of the hardware seek.                         *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "scancal.h"
+#include "clocksource.h"
+#include "seqsnapshot.h"
+
+// State is shared by the seeking threads, readers of the statistics only see the published snapshot.
+static GMutex calibrationLock;
+static ScanCalibrationStats calibration;
+static ScanCalibrationStats publishedCalibration;
+static guint publishedSequence;
+static uint8_t defaultRSSIThreshold;
+static uint8_t defaultSNRThreshold;
+
+// Stops and false stops of the current statistics window.
+static uint8_t windowStops;
+static uint8_t windowFalseStops;
+
+static int scan_cal_compare(const void *value1, const void *value2)
+{
+    return *(const int16_t *)value1 - *(const int16_t *)value2;
+}
+
+static uint8_t scan_cal_threshold(int16_t noiseFloor, uint8_t margin)
+{
+    return (uint8_t)CLAMP(noiseFloor + margin, 0, SCAN_CAL_THRESHOLD_MAX);
+}
+
+// Called with calibrationLock held.
+static void scan_cal_update_thresholds()
+{
+    if(calibration.calibrated)
+    {
+        calibration.rssiThreshold = scan_cal_threshold(calibration.noiseRSSI, calibration.rssiMargin);
+        calibration.snrThreshold = scan_cal_threshold(calibration.noiseSNR, calibration.snrMargin);
+    }
+    else
+    {
+        calibration.rssiThreshold = defaultRSSIThreshold;
+        calibration.snrThreshold = defaultSNRThreshold;
+    }
+}
+
+// Called with calibrationLock held, the lock serializes the snapshot writers.
+static void scan_cal_publish()
+{
+    seq_snapshot_write(&publishedSequence, &publishedCalibration, &calibration, sizeof(ScanCalibrationStats));
+}
+
+void scan_cal_init(uint8_t rssiThreshold, uint8_t snrThreshold)
+{
+    g_mutex_lock(&calibrationLock);
+
+    memset(&calibration, 0, sizeof(ScanCalibrationStats));
+    defaultRSSIThreshold = rssiThreshold;
+    defaultSNRThreshold = snrThreshold;
+    calibration.rssiMargin = SCAN_CAL_DEFAULT_RSSI_MARGIN;
+    calibration.snrMargin = SCAN_CAL_DEFAULT_SNR_MARGIN;
+    windowStops = 0;
+    windowFalseStops = 0;
+    scan_cal_update_thresholds();
+    scan_cal_publish();
+
+    g_mutex_unlock(&calibrationLock);
+}
+
+void scan_cal_invalidate()
+{
+    // Noise floor belongs to the old band, the learned margins are kept.
+    g_mutex_lock(&calibrationLock);
+
+    calibration.calibrated = FALSE;
+    windowStops = 0;
+    windowFalseStops = 0;
+    scan_cal_update_thresholds();
+    scan_cal_publish();
+
+    g_mutex_unlock(&calibrationLock);
+}
+
+gboolean scan_cal_is_due()
+{
+    gboolean result;
+
+    g_mutex_lock(&calibrationLock);
+    result = (!calibration.calibrated) || ((clock_source_now() - calibration.calibrationTime) > SCAN_CAL_MAX_AGE);
+    g_mutex_unlock(&calibrationLock);
+
+    return result;
+}
+
+uint8_t scan_cal_set_noise_floor(const int16_t *rssiValues, const int16_t *snrValues, uint8_t count)
+{
+    int16_t sortedRSSI[SCAN_CAL_NOISE_POINTS], sortedSNR[SCAN_CAL_NOISE_POINTS];
+
+    // Too many failed readings, keep the previous thresholds.
+    if((count < (SCAN_CAL_NOISE_POINTS / 2)) || (count > SCAN_CAL_NOISE_POINTS))
+    {
+        return RESULT_FAIL;
+    }
+
+    memcpy(sortedRSSI, rssiValues, count * sizeof(int16_t));
+    memcpy(sortedSNR, snrValues, count * sizeof(int16_t));
+    qsort(sortedRSSI, count, sizeof(int16_t), scan_cal_compare);
+    qsort(sortedSNR, count, sizeof(int16_t), scan_cal_compare);
+
+    g_mutex_lock(&calibrationLock);
+
+    // Stations are the upper tail of the readings, the lower quartile is taken as the noise floor.
+    calibration.noiseRSSI = sortedRSSI[count / 4];
+    calibration.noiseSNR = sortedSNR[count / 4];
+    calibration.calibrated = TRUE;
+    calibration.calibrationTime = clock_source_now();
+    calibration.calibrations++;
+    scan_cal_update_thresholds();
+    scan_cal_publish();
+
+#ifdef DEBUG_LOGS
+    g_message("Seek noise floor: RSSI %d, SNR %d, thresholds %u/%u", calibration.noiseRSSI, calibration.noiseSNR, calibration.rssiThreshold, calibration.snrThreshold);
+#endif
+
+    g_mutex_unlock(&calibrationLock);
+
+    return RESULT_SUCCESS;
+}
+
+gboolean scan_cal_check_stop(int rssi, int snr)
+{
+    gboolean isStation;
+
+    // Failed readings say nothing about the station.
+    if((rssi < 0) || (snr < 0))
+    {
+        return FALSE;
+    }
+
+    g_mutex_lock(&calibrationLock);
+
+    // Without a noise floor there is nothing to compare with, the stop is accepted.
+    isStation = (!calibration.calibrated) || (snr >= (calibration.noiseSNR + SCAN_CAL_STATION_SNR));
+
+    g_mutex_unlock(&calibrationLock);
+
+    return isStation;
+}
+
+void scan_cal_report_stop(gboolean isFalseStop)
+{
+    g_mutex_lock(&calibrationLock);
+
+    // Margins are relative to the noise floor, stops without it are not counted.
+    if(!calibration.calibrated)
+    {
+        g_mutex_unlock(&calibrationLock);
+        return;
+    }
+
+    calibration.stops++;
+    windowStops++;
+
+    if(isFalseStop)
+    {
+        calibration.falseStops++;
+        windowFalseStops++;
+    }
+
+    // Raise the margins as soon as a window collects too many false stops, lower them after a clean window.
+    if(windowFalseStops >= SCAN_CAL_RAISE_LIMIT)
+    {
+        if((calibration.rssiMargin < SCAN_CAL_MAX_MARGIN) || (calibration.snrMargin < SCAN_CAL_MAX_MARGIN))
+        {
+            calibration.rssiMargin = MIN(calibration.rssiMargin + 1, SCAN_CAL_MAX_MARGIN);
+            calibration.snrMargin = MIN(calibration.snrMargin + 1, SCAN_CAL_MAX_MARGIN);
+            calibration.raises++;
+        }
+
+        windowStops = 0;
+        windowFalseStops = 0;
+    }
+    else if(windowStops >= SCAN_CAL_WINDOW)
+    {
+        if((windowFalseStops == 0) && ((calibration.rssiMargin > SCAN_CAL_MIN_MARGIN) || (calibration.snrMargin > SCAN_CAL_MIN_MARGIN)))
+        {
+            calibration.rssiMargin = MAX(calibration.rssiMargin - 1, SCAN_CAL_MIN_MARGIN);
+            calibration.snrMargin = MAX(calibration.snrMargin - 1, SCAN_CAL_MIN_MARGIN);
+            calibration.drops++;
+        }
+
+        windowStops = 0;
+        windowFalseStops = 0;
+    }
+
+    scan_cal_update_thresholds();
+    scan_cal_publish();
+    g_mutex_unlock(&calibrationLock);
+}
+
+void scan_cal_get_thresholds(uint8_t *rssiThreshold, uint8_t *snrThreshold)
+{
+    g_mutex_lock(&calibrationLock);
+    *rssiThreshold = calibration.rssiThreshold;
+    *snrThreshold = calibration.snrThreshold;
+    g_mutex_unlock(&calibrationLock);
+}
+
+void scan_cal_read(ScanCalibrationStats *stats)
+{
+    // Statistics readers (daemon, metrics exporter) never wait for a seek holding the calibration lock.
+    seq_snapshot_read(&publishedSequence, stats, &publishedCalibration, sizeof(ScanCalibrationStats));
+}
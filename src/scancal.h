@@ -0,0 +1,89 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Self-calibrating CCA thresholds of the hardware seek.                         *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SCANCAL_HEADER_
+#define _GTK_FM_TUNER_SCANCAL_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+// Channels measured across the band to estimate the noise floor.
+#define SCAN_CAL_NOISE_POINTS       16
+
+// Settling time of the receiver on each noise floor channel (us).
+#define SCAN_CAL_SETTLE_TIME        20000
+
+// Noise floor is measured again on the first seek after this time (us).
+#define SCAN_CAL_MAX_AGE            (600 * G_USEC_PER_SEC)
+
+// Seek stops judged before the threshold margins are adjusted.
+#define SCAN_CAL_WINDOW             16
+
+// Margins (dB) of the RSSI and SNR thresholds above the noise floor.
+#define SCAN_CAL_DEFAULT_RSSI_MARGIN    6
+#define SCAN_CAL_DEFAULT_SNR_MARGIN     3
+#define SCAN_CAL_MIN_MARGIN             1
+#define SCAN_CAL_MAX_MARGIN             20
+
+// Stop with SNR less than this many dB above the noise floor is judged a false stop.
+#define SCAN_CAL_STATION_SNR        8
+
+// False stops (out of SCAN_CAL_WINDOW) which raise the margins, windows with none of them lower the margins.
+#define SCAN_CAL_RAISE_LIMIT        4
+
+// Largest value of the 6-bit threshold registers.
+#define SCAN_CAL_THRESHOLD_MAX      63
+
+typedef struct ScanCalibrationStats
+{
+    gboolean calibrated;        // FALSE until the first noise floor measurement, thresholds are the defaults.
+    int16_t noiseRSSI;
+    int16_t noiseSNR;
+    uint8_t rssiThreshold;
+    uint8_t snrThreshold;
+    uint8_t rssiMargin;
+    uint8_t snrMargin;
+    uint32_t calibrations;
+    uint32_t stops;             // Seek stops judged since startup.
+    uint32_t falseStops;
+    uint32_t raises;            // Margin adjustments in each direction.
+    uint32_t drops;
+    gint64 calibrationTime;     // Clock source time of the last noise floor measurement.
+} ScanCalibrationStats;
+
+void scan_cal_init(uint8_t rssiThreshold, uint8_t snrThreshold);
+void scan_cal_invalidate(void);
+gboolean scan_cal_is_due(void);
+
+uint8_t scan_cal_set_noise_floor(const int16_t *rssiValues, const int16_t *snrValues, uint8_t count);
+gboolean scan_cal_check_stop(int rssi, int snr);
+void scan_cal_report_stop(gboolean isFalseStop);
+
+void scan_cal_get_thresholds(uint8_t *rssiThreshold, uint8_t *snrThreshold);
+void scan_cal_read(ScanCalibrationStats *stats);
+
+#endif /* _GTK_FM_TUNER_SCANCAL_HEADER_ */
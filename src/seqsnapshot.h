@@ -0,0 +1,73 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Sequence counted snapshots of statistics blocks.                              *
+ *                                                                               *
+ * A single writer (or writers serialized by their own lock) copies the block    *
+ * between two increments of the sequence, readers retry until they get a copy   *
+ * taken while the sequence was even and unchanged. Readers such as the metrics  *
+ * exporter therefore never take a lock shared with the tuner threads.           *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SEQSNAPSHOT_HEADER_
+#define _GTK_FM_TUNER_SEQSNAPSHOT_HEADER_
+
+#include <glib.h>
+#include <string.h>
+
+static inline void seq_snapshot_write(guint *sequence, void *snapshot, const void *source, size_t size)
+{
+    // Odd sequence number marks the snapshot as being updated.
+    __atomic_add_fetch(sequence, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(snapshot, source, size);
+
+    __atomic_add_fetch(sequence, 1, __ATOMIC_RELEASE);
+}
+
+static inline void seq_snapshot_read(guint *sequence, void *target, const void *snapshot, size_t size)
+{
+    guint startSeq;
+
+    while(TRUE)
+    {
+        startSeq = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+        if((startSeq & 1) == 0)
+        {
+            memcpy(target, snapshot, size);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            if(__atomic_load_n(sequence, __ATOMIC_RELAXED) == startSeq)
+            {
+                return;
+            }
+        }
+
+        // Writer is in the middle of an update, it only copies a small block.
+        g_thread_yield();
+    }
+}
+
+#endif /* _GTK_FM_TUNER_SEQSNAPSHOT_HEADER_ */
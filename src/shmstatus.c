@@ -0,0 +1,228 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Shared memory tuner status publisher.                                         *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "shmstatus.h"
+
+static FMStatusSegment *statusSegment = NULL;
+
+// Check a segment left by another instance, TRUE if its writer is still running or it is not ours to replace.
+static gboolean shm_status_is_owned()
+{
+    const FMStatusSegment *segment;
+    struct stat segmentStat;
+    gboolean isOwned = FALSE;
+    pid_t writerPid;
+    int shmHandle;
+
+    shmHandle = shm_open(FMSTATUS_SHM_NAME, O_RDONLY | O_NOFOLLOW, 0);
+    if(shmHandle < 0)
+    {
+        // Removed meanwhile, the next create decides.
+        return FALSE;
+    }
+
+    if((fstat(shmHandle, &segmentStat) < 0) || (segmentStat.st_uid != geteuid()))
+    {
+        close(shmHandle);
+        return TRUE;
+    }
+
+    if(segmentStat.st_size >= (off_t)sizeof(FMStatusSegment))
+    {
+        segment = (const FMStatusSegment *)mmap(NULL, sizeof(FMStatusSegment), PROT_READ, MAP_SHARED, shmHandle, 0);
+        if(segment != MAP_FAILED)
+        {
+            // Valid header of a live process, signal 0 only checks that the writer exists.
+            writerPid = (pid_t)segment->writerPid;
+            isOwned = (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) == FMSTATUS_MAGIC) && (writerPid > 0) &&
+                ((kill(writerPid, 0) == 0) || (errno == EPERM));
+            munmap((void *)segment, sizeof(FMStatusSegment));
+        }
+    }
+
+    close(shmHandle);
+    return isOwned;
+}
+
+uint8_t shm_status_init()
+{
+    int shmHandle;
+
+    // Only one instance (GUI or daemon) writes the segment, a segment left by a crashed instance is replaced.
+    shmHandle = shm_open(FMSTATUS_SHM_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if((shmHandle < 0) && (errno == EEXIST))
+    {
+        if(shm_status_is_owned())
+        {
+            g_warning("Status segment %s is owned by another running tuner", FMSTATUS_SHM_NAME);
+            return RESULT_FAIL;
+        }
+
+        shm_unlink(FMSTATUS_SHM_NAME);
+        shmHandle = shm_open(FMSTATUS_SHM_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+
+    if(shmHandle < 0)
+    {
+#ifdef DEBUG_LOGS
+        g_message("Unable to create status segment: %s", strerror(errno));
+#endif
+        return RESULT_FAIL;
+    }
+
+    if(ftruncate(shmHandle, sizeof(FMStatusSegment)) < 0)
+    {
+        close(shmHandle);
+        return RESULT_FAIL;
+    }
+
+    statusSegment = (FMStatusSegment *)mmap(NULL, sizeof(FMStatusSegment), PROT_READ | PROT_WRITE, MAP_SHARED, shmHandle, 0);
+    close(shmHandle);
+
+    if(statusSegment == MAP_FAILED)
+    {
+        statusSegment = NULL;
+        return RESULT_FAIL;
+    }
+
+    // Readers validate the header before trusting the snapshot.
+    memset(statusSegment, 0, sizeof(FMStatusSegment));
+    statusSegment->snapshot.stereo = FMSTATUS_MPX_UNKNOWN;
+    statusSegment->snapshot.rdsStats.timeToPI = FMSTATUS_RDS_TIME_NONE;
+    statusSegment->snapshot.rdsStats.timeToPS = FMSTATUS_RDS_TIME_NONE;
+    statusSegment->writerPid = (uint32_t)getpid();
+    statusSegment->version = FMSTATUS_VERSION;
+    __atomic_store_n(&statusSegment->magic, FMSTATUS_MAGIC, __ATOMIC_RELEASE);
+
+    return RESULT_SUCCESS;
+}
+
+void shm_status_close()
+{
+    if(statusSegment != NULL)
+    {
+        // Invalidate the segment so that readers stop using it.
+        __atomic_store_n(&statusSegment->magic, 0, __ATOMIC_RELEASE);
+        munmap(statusSegment, sizeof(FMStatusSegment));
+        statusSegment = NULL;
+
+        shm_unlink(FMSTATUS_SHM_NAME);
+    }
+}
+
+void shm_status_publish(double frequency, int16_t rssi, int16_t snr, StereoMPXState mpxState, uint16_t volume, const char *rdsText, const FMStatusRDSStats *rdsStats)
+{
+    FMStatusSnapshot *snapshot;
+    struct timespec timeNow;
+
+    if(statusSegment == NULL)
+    {
+        return;
+    }
+
+    snapshot = &statusSegment->snapshot;
+    clock_gettime(CLOCK_MONOTONIC, &timeNow);
+
+    // Odd sequence number marks the snapshot as being updated.
+    __atomic_add_fetch(&statusSegment->sequence, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // Readings which failed (tuner busy) keep the previously published value.
+    if(frequency > 0)
+    {
+        snapshot->frequency = (uint32_t)((frequency * 1000) + 0.5);
+    }
+
+    if(rssi >= 0)
+    {
+        snapshot->rssi = rssi;
+    }
+
+    if(snr >= 0)
+    {
+        snapshot->snr = snr;
+    }
+
+    if(mpxState != MPXS_UNKNOWN)
+    {
+        snapshot->stereo = (mpxState == MPXS_MONO) ? FMSTATUS_MPX_MONO : FMSTATUS_MPX_STEREO;
+    }
+
+    snapshot->volume = (uint8_t)volume;
+    snapshot->updateTime = ((uint64_t)timeNow.tv_sec * 1000000) + (timeNow.tv_nsec / 1000);
+
+    if(rdsText != NULL)
+    {
+        g_strlcpy(snapshot->rdsText, rdsText, FMSTATUS_RDS_SIZE);
+    }
+
+    if(rdsStats != NULL)
+    {
+        snapshot->rdsStats = *rdsStats;
+    }
+
+    __atomic_add_fetch(&statusSegment->sequence, 1, __ATOMIC_RELEASE);
+}
+
+void shm_status_publish_clock(const FMStatusClock *clockState)
+{
+    if(statusSegment == NULL)
+    {
+        return;
+    }
+
+    // Written from the tuner core thread like the status, so the sequence lock has a single writer.
+    __atomic_add_fetch(&statusSegment->sequence, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    statusSegment->snapshot.rdsClock = *clockState;
+
+    __atomic_add_fetch(&statusSegment->sequence, 1, __ATOMIC_RELEASE);
+}
+
+uint8_t shm_status_read(FMStatusSnapshot *snapshot)
+{
+    // Local readers (metrics exporter) use the same lock free snapshot as other processes.
+    if((statusSegment == NULL) || (fmstatus_read(statusSegment, snapshot) != 0))
+    {
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Shared memory tuner status publisher.                                         *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SHMSTATUS_HEADER_
+#define _GTK_FM_TUNER_SHMSTATUS_HEADER_
+
+#include <stdint.h>
+
+#include "tuner.h"
+#include "fmstatus.h"
+
+uint8_t shm_status_init(void);
+void shm_status_close(void);
+
+void shm_status_publish(double frequency, int16_t rssi, int16_t snr, StereoMPXState mpxState, uint16_t volume, const char *rdsText, const FMStatusRDSStats *rdsStats);
+
+void shm_status_publish_clock(const FMStatusClock *clockState);
+
+uint8_t shm_status_read(FMStatusSnapshot *snapshot);
+
+#endif /* _GTK_FM_TUNER_SHMSTATUS_HEADER_ */
@@ -0,0 +1,376 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Cairo drawn RSSI/SNR signal meter with peak hold and history sparkline.       *
+ * Samples are taken from the tuner core lock free snapshot on every frame       *
+ * clock tick and rendered into a cached backing surface; only the changed       *
+ * bar and sparkline regions are invalidated.                                    *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <gtk/gtk.h>
+#include <glib.h>
+
+#include "defconfig.h"
+#include "signalmeter.h"
+#include "tunercore.h"
+
+// Meter layout in pixels.
+#define METER_MARGIN        4
+#define METER_LABEL_WIDTH   36
+#define METER_BAR_HEIGHT    14
+#define METER_BAR_SPACING   4
+
+// Meter colors (0xRRGGBB).
+#define COLOR_BACKGROUND    0x2E3436
+#define COLOR_TROUGH        0x555753
+#define COLOR_TEXT          0xD3D7CF
+#define COLOR_RSSI          0x73D216
+#define COLOR_SNR           0x729FCF
+#define COLOR_PEAK          0xFCE94F
+
+static void set_color(cairo_t *cr, uint32_t color)
+{
+    cairo_set_source_rgb(cr, ((color >> 16) & 0xFF) / 255.0, ((color >> 8) & 0xFF) / 255.0, (color & 0xFF) / 255.0);
+}
+
+static int meter_bar_x(SignalMeter *meter)
+{
+    return METER_MARGIN + METER_LABEL_WIDTH;
+}
+
+static int meter_bar_width(SignalMeter *meter)
+{
+    // Narrow widget leaves no room for the bars.
+    return MAX(meter->width - SIGNAL_METER_HISTORY_SIZE - METER_LABEL_WIDTH - (4 * METER_MARGIN), 0);
+}
+
+static int meter_history_x(SignalMeter *meter)
+{
+    return meter->width - SIGNAL_METER_HISTORY_SIZE - METER_MARGIN;
+}
+
+static int meter_bar_y(uint8_t barIndex)
+{
+    return METER_MARGIN + (barIndex * (METER_BAR_HEIGHT + METER_BAR_SPACING));
+}
+
+static int meter_history_height(SignalMeter *meter)
+{
+    return meter->height - (2 * METER_MARGIN);
+}
+
+static int meter_scale(int16_t value, int16_t scale, int size)
+{
+    // Readings below the scale minimum (and missing readings) are drawn as an empty bar.
+    if((value <= 0) || (size <= 0))
+    {
+        return 0;
+    }
+
+    return (value >= scale) ? size : ((value * size) / scale);
+}
+
+static void render_bar(SignalMeter *meter, cairo_t *cr, uint8_t barIndex, int16_t value, int16_t peak, int16_t scale, uint32_t color)
+{
+    int barX = meter_bar_x(meter);
+    int barY = meter_bar_y(barIndex);
+    int barWidth = meter_bar_width(meter);
+    int peakX;
+
+    set_color(cr, COLOR_TROUGH);
+    cairo_rectangle(cr, barX, barY, barWidth, METER_BAR_HEIGHT);
+    cairo_fill(cr);
+
+    set_color(cr, color);
+    cairo_rectangle(cr, barX, barY, meter_scale(value, scale, barWidth), METER_BAR_HEIGHT);
+    cairo_fill(cr);
+
+    // Peak hold marker.
+    peakX = barX + meter_scale(peak, scale, MAX(barWidth - 2, 0));
+    set_color(cr, COLOR_PEAK);
+    cairo_rectangle(cr, peakX, barY, 2, METER_BAR_HEIGHT);
+    cairo_fill(cr);
+}
+
+static void render_history(SignalMeter *meter, cairo_t *cr)
+{
+    int historyX = meter_history_x(meter);
+    int historyY = METER_MARGIN;
+    int historyHeight = meter_history_height(meter);
+    int oldestPos = meter->historyPos;
+    int oldestWidth = SIGNAL_METER_HISTORY_SIZE - oldestPos;
+
+    // History surface is a ring, copy it in two parts so the newest sample is on the right.
+    cairo_set_source_surface(cr, meter->historySurface, historyX - oldestPos, historyY);
+    cairo_rectangle(cr, historyX, historyY, oldestWidth, historyHeight);
+    cairo_fill(cr);
+
+    if(oldestPos > 0)
+    {
+        cairo_set_source_surface(cr, meter->historySurface, historyX + oldestWidth, historyY);
+        cairo_rectangle(cr, historyX + oldestWidth, historyY, oldestPos, historyHeight);
+        cairo_fill(cr);
+    }
+}
+
+static void render_history_trace(cairo_t *cr, int column, int height, int16_t previous, int16_t current, int16_t scale, uint32_t color)
+{
+    int previousY = height - 1 - meter_scale(previous, scale, height - 1);
+    int currentY = height - 1 - meter_scale(current, scale, height - 1);
+
+    // Join with previous sample using a vertical segment to keep the trace continuous.
+    set_color(cr, color);
+    cairo_rectangle(cr, column, MIN(previousY, currentY), 1, ABS(currentY - previousY) + 1);
+    cairo_fill(cr);
+}
+
+static void add_history_sample(SignalMeter *meter, int16_t rssi, int16_t snr)
+{
+    cairo_t *cr;
+    int historyHeight = meter_history_height(meter);
+
+    cr = cairo_create(meter->historySurface);
+
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_rectangle(cr, meter->historyPos, 0, 1, historyHeight);
+    cairo_fill(cr);
+
+    render_history_trace(cr, meter->historyPos, historyHeight, meter->rssi, rssi, SIGNAL_METER_RSSI_SCALE, COLOR_RSSI);
+    render_history_trace(cr, meter->historyPos, historyHeight, meter->snr, snr, SIGNAL_METER_SNR_SCALE, COLOR_SNR);
+
+    cairo_destroy(cr);
+
+    meter->historyPos = (meter->historyPos + 1) % SIGNAL_METER_HISTORY_SIZE;
+}
+
+static void render_meter(SignalMeter *meter, gboolean renderBars, gboolean renderHistory)
+{
+    cairo_t *cr;
+
+    cr = cairo_create(meter->backingSurface);
+
+    if(renderBars)
+    {
+        render_bar(meter, cr, 0, meter->rssi, meter->rssiPeak, SIGNAL_METER_RSSI_SCALE, COLOR_RSSI);
+        render_bar(meter, cr, 1, meter->snr, meter->snrPeak, SIGNAL_METER_SNR_SCALE, COLOR_SNR);
+    }
+
+    if(renderHistory)
+    {
+        render_history(meter, cr);
+    }
+
+    cairo_destroy(cr);
+}
+
+static void render_static_content(SignalMeter *meter)
+{
+    cairo_t *cr;
+
+    cr = cairo_create(meter->historySurface);
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    cr = cairo_create(meter->backingSurface);
+    set_color(cr, COLOR_BACKGROUND);
+    cairo_paint(cr);
+
+    set_color(cr, COLOR_TEXT);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 10);
+
+    cairo_move_to(cr, METER_MARGIN, meter_bar_y(0) + METER_BAR_HEIGHT - 3);
+    cairo_show_text(cr, "RSSI");
+    cairo_move_to(cr, METER_MARGIN, meter_bar_y(1) + METER_BAR_HEIGHT - 3);
+    cairo_show_text(cr, "SNR");
+
+    cairo_destroy(cr);
+
+    meter->historyPos = 0;
+    render_meter(meter, TRUE, TRUE);
+}
+
+static gboolean on_signal_meter_configure(GtkWidget *widget, GdkEventConfigure *event, gpointer userData)
+{
+    SignalMeter *meter = (SignalMeter *)userData;
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+
+    if((meter->backingSurface != NULL) && (width == meter->width) && (height == meter->height))
+    {
+        return TRUE;
+    }
+
+    if(meter->backingSurface != NULL)
+    {
+        cairo_surface_destroy(meter->backingSurface);
+        cairo_surface_destroy(meter->historySurface);
+    }
+
+    meter->width = width;
+    meter->height = height;
+    meter->backingSurface = gdk_window_create_similar_surface(gtk_widget_get_window(widget), CAIRO_CONTENT_COLOR, width, height);
+    meter->historySurface = gdk_window_create_similar_surface(gtk_widget_get_window(widget), CAIRO_CONTENT_COLOR, SIGNAL_METER_HISTORY_SIZE, meter_history_height(meter));
+
+    render_static_content(meter);
+    return TRUE;
+}
+
+static gboolean on_signal_meter_draw(GtkWidget *widget, cairo_t *cr, gpointer userData)
+{
+    SignalMeter *meter = (SignalMeter *)userData;
+
+    // Everything is pre-rendered, GTK clips this to the invalidated region.
+    if(meter->backingSurface != NULL)
+    {
+        cairo_set_source_surface(cr, meter->backingSurface, 0, 0);
+        cairo_paint(cr);
+    }
+
+    return FALSE;
+}
+
+static gboolean update_peak(int16_t value, int16_t *peak, gint64 *peakTime, gint64 frameTime)
+{
+    if(value >= *peak)
+    {
+        *peakTime = frameTime;
+
+        if(value > *peak)
+        {
+            *peak = value;
+            return TRUE;
+        }
+    }
+    else if((frameTime - *peakTime) > SIGNAL_METER_PEAK_HOLD)
+    {
+        // Hold time expired, drop the marker back to the current reading.
+        *peak = value;
+        *peakTime = frameTime;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static gboolean on_signal_meter_tick(GtkWidget *widget, GdkFrameClock *frameClock, gpointer userData)
+{
+    SignalMeter *meter = (SignalMeter *)userData;
+    int16_t rssi, snr;
+    guint32 sampleTime;
+    gint64 frameTime;
+    gboolean barChanged = FALSE;
+    gboolean newSample;
+
+    meter->frameCount++;
+
+    if(meter->backingSurface == NULL)
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    // Sparkline advances only when the sampler has taken a new reading.
+    sampleTime = tuner_core_get_signal_sample(&rssi, &snr);
+    frameTime = gdk_frame_clock_get_frame_time(frameClock);
+    newSample = (sampleTime != meter->lastSampleTime);
+
+    if(newSample)
+    {
+        meter->lastSampleTime = sampleTime;
+        add_history_sample(meter, rssi, snr);
+
+        barChanged = (rssi != meter->rssi) || (snr != meter->snr);
+        meter->rssi = rssi;
+        meter->snr = snr;
+    }
+
+    barChanged |= update_peak(meter->rssi, &meter->rssiPeak, &meter->rssiPeakTime, frameTime);
+    barChanged |= update_peak(meter->snr, &meter->snrPeak, &meter->snrPeakTime, frameTime);
+
+    // Nothing to show in this frame.
+    if(!(barChanged || newSample))
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    render_meter(meter, barChanged, newSample);
+    meter->renderCount++;
+
+    // Invalidate only the regions that have changed.
+    if(barChanged)
+    {
+        gtk_widget_queue_draw_area(widget, meter_bar_x(meter), meter_bar_y(0), meter_bar_width(meter), meter_bar_y(1) + METER_BAR_HEIGHT - meter_bar_y(0));
+    }
+
+    if(newSample)
+    {
+        gtk_widget_queue_draw_area(widget, meter_history_x(meter), METER_MARGIN, SIGNAL_METER_HISTORY_SIZE, meter_history_height(meter));
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+void signal_meter_init(SignalMeter *meter, GtkWidget *drawingArea)
+{
+    meter->drawingArea = drawingArea;
+    meter->backingSurface = NULL;
+    meter->historySurface = NULL;
+    meter->width = 0;
+    meter->height = 0;
+    meter->tickId = 0;
+    meter->lastSampleTime = 0;
+    meter->rssi = 0;
+    meter->snr = 0;
+    meter->rssiPeak = 0;
+    meter->snrPeak = 0;
+    meter->rssiPeakTime = 0;
+    meter->snrPeakTime = 0;
+    meter->historyPos = 0;
+    meter->frameCount = 0;
+    meter->renderCount = 0;
+
+    g_signal_connect(drawingArea, "configure-event", G_CALLBACK(on_signal_meter_configure), meter);
+    g_signal_connect(drawingArea, "draw", G_CALLBACK(on_signal_meter_draw), meter);
+}
+
+void signal_meter_set_active(SignalMeter *meter, gboolean active)
+{
+    if(active && (meter->tickId == 0))
+    {
+        // Sampler and frame clock run only while the meter can be seen.
+        meter->tickId = gtk_widget_add_tick_callback(meter->drawingArea, on_signal_meter_tick, meter, NULL);
+        tuner_core_set_meter_rate(METER_SAMPLE_RATE);
+    }
+    else if((!active) && (meter->tickId != 0))
+    {
+        gtk_widget_remove_tick_callback(meter->drawingArea, meter->tickId);
+        meter->tickId = 0;
+        tuner_core_set_meter_rate(0);
+
+#ifdef DEBUG_LOGS
+        g_message("Signal meter rendered %u of %u frames", meter->renderCount, meter->frameCount);
+#endif
+    }
+}
@@ -0,0 +1,69 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Cairo drawn RSSI/SNR signal meter with peak hold and history sparkline.       *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SIGNALMETER_HEADER_
+#define _GTK_FM_TUNER_SIGNALMETER_HEADER_
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+// Number of samples shown in the history sparkline (one pixel per sample).
+#define SIGNAL_METER_HISTORY_SIZE   128
+
+// Full scale values of the RSSI (dBuV) and SNR (dB) bars.
+#define SIGNAL_METER_RSSI_SCALE     90
+#define SIGNAL_METER_SNR_SCALE      50
+
+// Time to hold the peak marker before it falls back to the current reading (in us).
+#define SIGNAL_METER_PEAK_HOLD      1500000
+
+typedef struct SignalMeter
+{
+    GtkWidget *drawingArea;
+    cairo_surface_t *backingSurface;    // Complete meter image, copied to the window on draw.
+    cairo_surface_t *historySurface;    // Sparkline ring, one column per sample.
+    int width;
+    int height;
+    guint tickId;
+    guint32 lastSampleTime;             // Time (ms) of the last signal sample added to the sparkline.
+
+    int16_t rssi;
+    int16_t snr;
+    int16_t rssiPeak;
+    int16_t snrPeak;
+    gint64 rssiPeakTime;
+    gint64 snrPeakTime;
+    uint16_t historyPos;
+
+    uint32_t frameCount;                // Frame clock ticks seen by the meter.
+    uint32_t renderCount;               // Ticks which changed the meter image.
+} SignalMeter;
+
+void signal_meter_init(SignalMeter *meter, GtkWidget *drawingArea);
+void signal_meter_set_active(SignalMeter *meter, gboolean active);
+
+#endif /* _GTK_FM_TUNER_SIGNALMETER_HEADER_ */
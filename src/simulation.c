@@ -0,0 +1,94 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Headless replay of a capture on the virtual clock.                            *
+ *                                                                               *
+ * The tuner core runs with its usual timers, but time jumps ahead whenever the  *
+ * core is idle, so hour long RDS sessions finish in a fraction of real time.    *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+
+#include "defconfig.h"
+#include "simulation.h"
+#include "tunercore.h"
+#include "history.h"
+#include "rdsstats.h"
+#include "clocksource.h"
+
+int run_tuner_simulation(Tuner *tuner, guint duration)
+{
+    FMStatusRDSStats rdsStats;
+    EventLoop *loop;
+    gint64 realStartTime, realTime;
+    guint elapsed, step;
+    guint64 wakeups;
+    double wakeupRate;
+    gint firstIndex, historySamples;
+
+    // Calling thread holds the virtual clock until the tuner core is set up, then sleeps through the session.
+    clock_source_attach_thread();
+    realStartTime = g_get_monotonic_time();
+
+    if(tuner_core_start_thread(tuner, NULL) == RESULT_FAIL)
+    {
+        clock_source_detach_thread();
+        return RESULT_FAIL;
+    }
+
+    for(elapsed = 0; elapsed < duration; elapsed += step)
+    {
+        step = MIN(SIMULATION_REPORT_PERIOD, duration - elapsed);
+        clock_source_sleep((guint64)step * G_USEC_PER_SEC);
+
+#ifdef DEBUG_LOGS
+        g_message("Simulated %u of %u s", (elapsed + step), duration);
+#endif
+    }
+
+    // Zero sleep returns once the core has handled the timers due at the end time, so every run reports the same.
+    clock_source_sleep(0);
+
+    loop = tuner_core_get_event_loop();
+    wakeups = loop->wakeups;
+    wakeupRate = event_loop_get_wakeup_rate(loop);
+
+    // Clock is released before the core stops, so a handler which sleeps can still finish.
+    clock_source_detach_thread();
+    tuner_core_shutdown();
+    realTime = g_get_monotonic_time() - realStartTime;
+
+    historySamples = signal_history_get_range(0, &firstIndex);
+
+    g_message("Simulated %u s in %.3lf s (%.0lfx real time), %" G_GUINT64_FORMAT " clock jumps", duration, ((double)realTime / G_USEC_PER_SEC),
+        ((realTime > 0) ? (((double)duration * G_USEC_PER_SEC) / realTime) : 0), clock_source_get_jump_count());
+    g_message("Event loop wakeups %" G_GUINT64_FORMAT " (%.2lf/s), %d history samples", wakeups, wakeupRate, historySamples);
+
+    if(rds_stats_read(&rdsStats) != 0)
+    {
+        g_message("RDS groups %u (%u valid), %u missed, PI %04X", rdsStats.groups, rdsStats.validGroups, rdsStats.missedGroups, rdsStats.pi);
+    }
+
+    return RESULT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner supervisor, detects a lost tuner and reconnects it.                     *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "supervisor.h"
+#include "trace.h"
+#include "seqsnapshot.h"
+
+static SupervisorContext supervisor;
+
+static const char *supervisorStateNames[SV_COUNT] = {"connected", "reconnecting"};
+
+// Wait for the given time or until the supervisor is stopped, returns FALSE on stop.
+// The supervisor watches real hardware, so it always runs on the real clock.
+static gboolean supervisor_wait(guint delay)
+{
+    gint64 endTime = g_get_monotonic_time() + ((gint64)delay * 1000);
+    gboolean running;
+
+    g_mutex_lock(&supervisor.lock);
+
+    while(supervisor.running && (g_get_monotonic_time() < endTime))
+    {
+        g_cond_wait_until(&supervisor.signal, &supervisor.lock, endTime);
+    }
+
+    running = supervisor.running;
+    g_mutex_unlock(&supervisor.lock);
+
+    return running;
+}
+
+// Statistics are published after every change, readers (daemon, metrics exporter) never take the supervisor lock.
+static void supervisor_publish()
+{
+    seq_snapshot_write(&supervisor.publishedSequence, &supervisor.publishedStats, &supervisor.stats, sizeof(SupervisorStats));
+}
+
+static void *supervisor_thread(void *threadStruct)
+{
+    Tuner *tuner = supervisor.tunerRef;
+    SupervisorStats *stats = &supervisor.stats;
+    guint delay, retryDelay = SUPERVISOR_RETRY_BASE_DELAY;
+    gint64 recoveryTime;
+
+    delay = (stats->state == SV_CONNECTED) ? SUPERVISOR_CHECK_PERIOD : 0;
+
+    while(supervisor_wait(delay))
+    {
+        if(stats->state == SV_CONNECTED)
+        {
+            delay = SUPERVISOR_CHECK_PERIOD;
+            if(tuner->check_device() == RESULT_SUCCESS)
+            {
+                continue;
+            }
+
+            // First reconnect attempt is made right away, further ones back off.
+            g_mutex_lock(&supervisor.lock);
+            stats->state = SV_RECONNECTING;
+            stats->losses++;
+            stats->lossTime = g_get_monotonic_time();
+            supervisor_publish();
+            g_mutex_unlock(&supervisor.lock);
+
+            TRACE_LOG(TE_TUNER_LOST, stats->losses);
+            g_warning("FM tuner is lost, reconnecting");
+            retryDelay = SUPERVISOR_RETRY_BASE_DELAY;
+        }
+
+        g_mutex_lock(&supervisor.lock);
+        stats->attempts++;
+        supervisor_publish();
+        g_mutex_unlock(&supervisor.lock);
+
+        if(tuner->reconnect() == RESULT_FAIL)
+        {
+            delay = retryDelay;
+            retryDelay = MIN(retryDelay * 2, SUPERVISOR_RETRY_MAX_DELAY);
+            continue;
+        }
+
+        recoveryTime = g_get_monotonic_time() - stats->lossTime;
+
+        g_mutex_lock(&supervisor.lock);
+        stats->state = SV_CONNECTED;
+        stats->recoveries++;
+        stats->lastRecoveryTime = recoveryTime;
+        stats->maxRecoveryTime = MAX(stats->maxRecoveryTime, recoveryTime);
+        supervisor_publish();
+        g_mutex_unlock(&supervisor.lock);
+
+        TRACE_LOG(TE_TUNER_RECONNECTED, (recoveryTime / 1000), stats->attempts);
+        g_message("FM tuner reconnected after %" G_GINT64_FORMAT " ms", (recoveryTime / 1000));
+        delay = SUPERVISOR_CHECK_PERIOD;
+    }
+
+    return NULL;
+}
+
+uint8_t supervisor_start(Tuner *tuner, gboolean isConnected)
+{
+    // Tuners without device checks (e.g. replay) are not supervised.
+    if((tuner->check_device == NULL) || (tuner->reconnect == NULL))
+    {
+        return RESULT_FAIL;
+    }
+
+    memset(&supervisor.stats, 0, sizeof(SupervisorStats));
+    supervisor.tunerRef = tuner;
+
+    // Tuner which failed to initialize is treated as lost since startup.
+    supervisor.stats.state = isConnected ? SV_CONNECTED : SV_RECONNECTING;
+    supervisor.stats.lossTime = g_get_monotonic_time();
+    supervisor_publish();
+
+    g_atomic_int_set(&supervisor.running, TRUE);
+
+    if(pthread_create(&supervisor.thread, NULL, supervisor_thread, NULL) != 0)
+    {
+        g_atomic_int_set(&supervisor.running, FALSE);
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
+
+void supervisor_stop()
+{
+    g_mutex_lock(&supervisor.lock);
+
+    if(!supervisor.running)
+    {
+        g_mutex_unlock(&supervisor.lock);
+        return;
+    }
+
+    g_atomic_int_set(&supervisor.running, FALSE);
+    g_cond_signal(&supervisor.signal);
+    g_mutex_unlock(&supervisor.lock);
+
+    // Running reconnect attempt finishes before the thread exits.
+    pthread_join(supervisor.thread, NULL);
+}
+
+uint8_t supervisor_read(SupervisorStats *stats)
+{
+    seq_snapshot_read(&supervisor.publishedSequence, stats, &supervisor.publishedStats, sizeof(SupervisorStats));
+    return g_atomic_int_get(&supervisor.running) ? RESULT_SUCCESS : RESULT_FAIL;
+}
+
+const char *supervisor_state_name(SupervisorState state)
+{
+    return (state < SV_COUNT) ? supervisorStateNames[state] : "unknown";
+}
@@ -0,0 +1,79 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner supervisor, detects a lost tuner and reconnects it.                     *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SUPERVISOR_HEADER_
+#define _GTK_FM_TUNER_SUPERVISOR_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "tuner.h"
+
+// Period of the device check while the tuner is connected (ms).
+#define SUPERVISOR_CHECK_PERIOD         1000
+
+// Delay between reconnect attempts, doubles from the base delay up to the limit (ms).
+#define SUPERVISOR_RETRY_BASE_DELAY     250
+#define SUPERVISOR_RETRY_MAX_DELAY      8000
+
+typedef enum
+{
+    SV_CONNECTED,       // Tuner passed the last device check.
+    SV_RECONNECTING,    // Tuner is lost, reconnect attempts are running.
+    SV_COUNT
+} SupervisorState;
+
+typedef struct SupervisorStats
+{
+    SupervisorState state;
+    uint32_t losses;            // Detected tuner losses.
+    uint32_t recoveries;        // Successful reconnects.
+    uint32_t attempts;          // Reconnect attempts, including the successful ones.
+    gint64 lastRecoveryTime;    // Time from the loss until the tuner was back (us).
+    gint64 maxRecoveryTime;
+    gint64 lossTime;            // Monotonic time (us) of the current or last loss.
+} SupervisorStats;
+
+typedef struct SupervisorContext
+{
+    Tuner *tunerRef;
+    pthread_t thread;
+    GMutex lock;
+    GCond signal;
+    gboolean running;
+    SupervisorStats stats;          // Owned by the supervisor thread.
+    SupervisorStats publishedStats; // Snapshot of the statistics for the readers.
+    guint publishedSequence;
+} SupervisorContext;
+
+uint8_t supervisor_start(Tuner *tuner, gboolean isConnected);
+void supervisor_stop(void);
+uint8_t supervisor_read(SupervisorStats *stats);
+const char *supervisor_state_name(SupervisorState state);
+
+#endif /* _GTK_FM_TUNER_SUPERVISOR_HEADER_ */
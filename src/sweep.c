@@ -0,0 +1,316 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Band sweep engine, measures RSSI/SNR of every channel in the band.            *
+ * The sweep runs on the tuner event loop, one channel per settle timer period,  *
+ * so other commands are served between the channel measurements.                *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <math.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "sweep.h"
+#include "rdsstats.h"
+#include "trace.h"
+#include "clocksource.h"
+
+static SweepContext sweepContext;
+
+static void sweep_publish_state()
+{
+    g_atomic_int_set(&sweepContext.sweepState, (gint)(((uint32_t)sweepContext.sequence << 16) | sweepContext.position));
+}
+
+static void sweep_calibrate()
+{
+    Tuner *tuner = sweepContext.tunerRef;
+    const BandPlan *plan = band_plan_get();
+    gint64 startTime, readTime, stableTime, maxTime = 0;
+    int16_t rssi, lastRssi;
+    uint8_t channel, stableCount;
+    gint settleTime;
+
+    // Measure how long RSSI takes to settle after a channel change on few channels across the band.
+    for(channel = 0; channel < SWEEP_CALIBRATION_CHANNELS; channel++)
+    {
+        tuner->set_channel((uint16_t)((band_plan_last_channel(plan) * ((2 * channel) + 1)) / (2 * SWEEP_CALIBRATION_CHANNELS)));
+
+        startTime = clock_source_now();
+        lastRssi = -1;
+        stableCount = 0;
+        stableTime = 0;
+
+        // Register may still show the previous channel (or not change at all) right after the tune.
+        clock_source_sleep(SWEEP_CALIBRATION_MIN_DELAY);
+
+        do
+        {
+            clock_source_sleep(500);
+            rssi = tuner->rssi();
+            readTime = clock_source_now() - startTime;
+
+            // Settle time is the first reading of the stable run, busy tuner readings break the run.
+            if((rssi >= 0) && (rssi == lastRssi))
+            {
+                stableCount++;
+            }
+            else
+            {
+                stableCount = (rssi >= 0) ? 1 : 0;
+                stableTime = readTime;
+            }
+
+            lastRssi = rssi;
+        }
+        while((stableCount < SWEEP_CALIBRATION_READINGS) && (readTime < SWEEP_CALIBRATION_TIMEOUT));
+
+        maxTime = MAX(maxTime, ((stableCount < SWEEP_CALIBRATION_READINGS) ? readTime : stableTime));
+    }
+
+    // Keep 50% margin over the slowest channel.
+    settleTime = (gint)(((maxTime * 3) / 2 + 999) / 1000);
+    settleTime = CLAMP(settleTime, SWEEP_MIN_SETTLE_TIME, SWEEP_MAX_SETTLE_TIME);
+    g_atomic_int_set(&sweepContext.settleTime, settleTime);
+
+#ifdef DEBUG_LOGS
+    g_message("Sweep settle time calibrated to %d ms (slowest channel %" G_GINT64_FORMAT " us)", settleTime, maxTime);
+#endif
+}
+
+static void sweep_begin(uint16_t stepKHz)
+{
+    Tuner *tuner = sweepContext.tunerRef;
+    const BandPlan *plan = band_plan_get();
+    gint pointCount;
+    double freq;
+
+    if(!sweepContext.running)
+    {
+        // Remember the station to return to after the sweep.
+        freq = tuner->get_frequency();
+        sweepContext.savedFrequency = (freq > 0) ? freq : plan->frequencies[0];
+    }
+
+    if(g_atomic_int_get(&sweepContext.settleTime) == 0)
+    {
+        sweep_calibrate();
+    }
+
+    // Points are whole channels of the plan, a step finer than the plan raster sweeps every channel.
+    sweepContext.channelStride = MAX(stepKHz / plan->stepKHz, 1);
+    pointCount = (gint)(band_plan_last_channel(plan) / sweepContext.channelStride) + 1;
+    g_atomic_int_set(&sweepContext.pointCount, MIN(pointCount, SWEEP_MAX_POINTS));
+
+    sweepContext.position = 0;
+    sweepContext.sequence++;
+    sweep_publish_state();
+
+    TRACE_LOG(TE_SWEEP_START, sweepContext.channelStride * plan->stepKHz, g_atomic_int_get(&sweepContext.pointCount));
+
+    // Measurement of each channel is taken on the next timer tick.
+    sweepContext.running = TRUE;
+    tuner->set_channel(0);
+    event_loop_set_timer(sweepContext.loopRef, sweepContext.stepTimer, (guint)g_atomic_int_get(&sweepContext.settleTime));
+}
+
+static void sweep_end(gboolean restoreFrequency)
+{
+    if(!sweepContext.running)
+    {
+        return;
+    }
+
+    event_loop_set_timer(sweepContext.loopRef, sweepContext.stepTimer, 0);
+    sweepContext.running = FALSE;
+
+    // UI notices the aborted sweep and resets its run state.
+    if(!restoreFrequency)
+    {
+        g_atomic_int_inc(&sweepContext.abortCount);
+    }
+
+    if(restoreFrequency)
+    {
+        sweepContext.tunerRef->set_frequency(sweepContext.savedFrequency);
+        rds_stats_set_station(sweepContext.savedFrequency);
+    }
+
+    TRACE_LOG(TE_SWEEP_STOP);
+}
+
+static void on_sweep_step_timer(gpointer userData)
+{
+    Tuner *tuner = sweepContext.tunerRef;
+    int16_t rssi, snr;
+
+    if(!sweepContext.running)
+    {
+        return;
+    }
+
+    rssi = tuner->rssi();
+    snr = tuner->snr();
+
+    // Busy tuner has no reading, the point is marked invalid instead of showing a zero floor.
+    if((rssi < 0) || (snr < 0))
+    {
+        rssi = SWEEP_POINT_INVALID;
+        snr = SWEEP_POINT_INVALID;
+    }
+
+    g_atomic_int_set(&sweepContext.points[sweepContext.position], SIGNAL_SAMPLE_PACK(rssi, snr));
+
+    // Wrap around and start next sweep after the last channel.
+    sweepContext.position++;
+    if(sweepContext.position >= g_atomic_int_get(&sweepContext.pointCount))
+    {
+        sweepContext.position = 0;
+        sweepContext.sequence++;
+    }
+
+    sweep_publish_state();
+
+    // Channel index keeps every point on the raster, however long the sweep runs.
+    tuner->set_channel(sweepContext.position * sweepContext.channelStride);
+}
+
+static void on_sweep_request(gpointer userData)
+{
+    gboolean requestRun;
+    uint16_t requestStep;
+
+    g_mutex_lock(&sweepContext.requestLock);
+
+    if(!sweepContext.requestPending)
+    {
+        g_mutex_unlock(&sweepContext.requestLock);
+        return;
+    }
+
+    requestRun = sweepContext.requestRun;
+    requestStep = sweepContext.requestStep;
+    sweepContext.requestPending = FALSE;
+
+    g_mutex_unlock(&sweepContext.requestLock);
+
+    if(requestRun)
+    {
+        sweep_begin(requestStep);
+    }
+    else
+    {
+        sweep_end(TRUE);
+    }
+}
+
+static void sweep_post_request(gboolean run, uint16_t stepKHz)
+{
+    g_mutex_lock(&sweepContext.requestLock);
+    sweepContext.requestRun = run;
+    sweepContext.requestStep = stepKHz;
+    sweepContext.requestPending = TRUE;
+    g_mutex_unlock(&sweepContext.requestLock);
+
+    event_loop_notify(sweepContext.loopRef, sweepContext.notifierId);
+}
+
+void sweep_init(Tuner *tuner, EventLoop *loop)
+{
+    sweepContext.tunerRef = tuner;
+    sweepContext.loopRef = loop;
+    sweepContext.requestPending = FALSE;
+    sweepContext.running = FALSE;
+    sweepContext.sequence = 0;
+    sweepContext.position = 0;
+    sweepContext.settleTime = 0;
+    sweepContext.pointCount = 0;
+    sweepContext.sweepState = 0;
+    sweepContext.abortCount = 0;
+
+    sweepContext.notifierId = -1;
+    sweepContext.stepTimer = -1;
+
+    // Sweep needs signal readings from the tuner.
+    if((tuner->rssi == NULL) || (tuner->snr == NULL))
+    {
+        return;
+    }
+
+    sweepContext.notifierId = event_loop_add_notifier(loop, on_sweep_request, NULL);
+    sweepContext.stepTimer = event_loop_add_timer(loop, on_sweep_step_timer, NULL);
+}
+
+void sweep_start(uint16_t stepKHz)
+{
+    // Starting a running sweep again restarts it with the new step.
+    sweep_post_request(TRUE, stepKHz);
+}
+
+void sweep_stop()
+{
+    // Stop sweep and return to the station tuned before the sweep.
+    sweep_post_request(FALSE, 0);
+}
+
+void sweep_abort()
+{
+    // Called on the event loop when another command takes over the tuner, frequency is not restored.
+    sweep_end(FALSE);
+}
+
+gboolean sweep_is_running()
+{
+    // Sweep state is owned by the event loop, call only from the loop thread.
+    return sweepContext.running;
+}
+
+gint sweep_get_progress(uint16_t *sequence, uint16_t *position)
+{
+    gint state = g_atomic_int_get(&sweepContext.sweepState);
+
+    *sequence = (uint16_t)(((uint32_t)state) >> 16);
+    *position = (uint16_t)(state & 0xFFFF);
+
+    return g_atomic_int_get(&sweepContext.pointCount);
+}
+
+gint sweep_get_settle_time()
+{
+    return g_atomic_int_get(&sweepContext.settleTime);
+}
+
+gint sweep_get_abort_count()
+{
+    return g_atomic_int_get(&sweepContext.abortCount);
+}
+
+void sweep_get_point(uint16_t index, int16_t *rssi, int16_t *snr)
+{
+    gint sample = (index < SWEEP_MAX_POINTS) ? g_atomic_int_get(&sweepContext.points[index]) : 0;
+
+    *rssi = SIGNAL_SAMPLE_RSSI(sample);
+    *snr = SIGNAL_SAMPLE_SNR(sample);
+}
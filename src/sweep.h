@@ -0,0 +1,94 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Band sweep engine, measures RSSI/SNR of every channel in the band.            *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_SWEEP_HEADER_
+#define _GTK_FM_TUNER_SWEEP_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "tuner.h"
+#include "evloop.h"
+
+// Maximum number of channels in a single sweep (60 - 108 MHz in 50 kHz steps).
+#define SWEEP_MAX_POINTS            1024
+
+// Allowed range of the calibrated settle time in ms.
+#define SWEEP_MIN_SETTLE_TIME       2
+#define SWEEP_MAX_SETTLE_TIME       20
+
+// Number of channels used to calibrate the settle time and the time limit for each of them (in us).
+#define SWEEP_CALIBRATION_CHANNELS  4
+#define SWEEP_CALIBRATION_TIMEOUT   30000
+
+// RSSI is settled after this many equal readings in a row, counted only after the minimum delay (in us).
+#define SWEEP_CALIBRATION_READINGS  4
+#define SWEEP_CALIBRATION_MIN_DELAY 1000
+
+// Point value of a channel which could not be measured (tuner busy).
+#define SWEEP_POINT_INVALID         -1
+
+typedef struct SweepContext
+{
+    Tuner *tunerRef;
+    EventLoop *loopRef;
+    int notifierId;
+    int stepTimer;
+
+    // Sweep request posted by the UI thread.
+    GMutex requestLock;
+    gboolean requestPending;
+    gboolean requestRun;
+    uint16_t requestStep;           // Channel step in kHz.
+
+    // Sweep state, owned by the event loop.
+    gboolean running;
+    uint16_t channelStride;         // Band plan channels per sweep point.
+    uint16_t position;
+    uint16_t sequence;
+    double savedFrequency;
+
+    // Results shared with readers without locking.
+    volatile gint settleTime;                   // Calibrated settle time in ms, 0 if not calibrated yet.
+    volatile gint pointCount;                   // Number of channels in the current sweep.
+    volatile gint sweepState;                   // Sweep sequence (high 16 bits) and channels measured (low 16 bits).
+    volatile gint abortCount;                   // Sweeps ended by tune or seek commands.
+    volatile gint points[SWEEP_MAX_POINTS];     // Packed RSSI/SNR of each channel.
+} SweepContext;
+
+void sweep_init(Tuner *tuner, EventLoop *loop);
+void sweep_start(uint16_t stepKHz);
+void sweep_stop(void);
+void sweep_abort(void);
+
+gboolean sweep_is_running(void);
+gint sweep_get_progress(uint16_t *sequence, uint16_t *position);
+gint sweep_get_settle_time(void);
+gint sweep_get_abort_count(void);
+void sweep_get_point(uint16_t index, int16_t *rssi, int16_t *snr);
+
+#endif /* _GTK_FM_TUNER_SWEEP_HEADER_ */
@@ -0,0 +1,450 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * RDS-TMC (group 8A) traffic message decoder and message store.                 *
+ *                                                                               *
+ * Single and multi group messages are assembled without heap allocation,        *
+ * duplicates are found through an open addressing (linear probing) table        *
+ * keyed by location, direction, extent and event, and messages expire           *
+ * according to their duration and persistence code.                             *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "tmc.h"
+#include "clocksource.h"
+
+// Group type 8A in block B.
+#define TMC_GROUP_MASK          0xF800
+#define TMC_GROUP_8A            0x8000
+
+// Block B flags.
+#define TMC_FLAG_TUNING         0x0010  // Tuning and system information group.
+#define TMC_FLAG_SINGLE         0x0008  // Single group message.
+
+// Block C flags of multi group messages.
+#define TMC_FLAG_FIRST_GROUP    0x8000
+#define TMC_FLAG_SECOND_GROUP   0x4000
+
+static TMCDecoder tmcDecoder;
+
+// Message persistence in minutes for each duration and persistence code.
+static const uint16_t tmcPersistence[8] = {15, 15, 30, 60, 120, 180, 240, 1440};
+
+// Field width of each free format label (ISO 14819-1), label 14 is a separator without data.
+static const uint8_t tmcLabelWidth[16] = {3, 3, 5, 5, 5, 8, 8, 8, 8, 11, 16, 16, 16, 16, 0, 0};
+
+static inline uint32_t tmc_make_key(uint16_t location, uint8_t direction, uint8_t extent, uint16_t event)
+{
+    return ((uint32_t)location << 16) | ((uint32_t)(direction & 0x01) << 14) | ((uint32_t)(extent & 0x07) << 11) | (event & 0x07FF);
+}
+
+static inline uint32_t tmc_hash_slot(uint32_t key)
+{
+    // Fibonacci hashing, all key bits affect the slot.
+    return (key * 0x9E3779B1U) >> (32 - TMC_HASH_BITS);
+}
+
+static uint32_t tmc_find_slot(uint32_t key)
+{
+    uint32_t slot = tmc_hash_slot(key);
+    uint16_t index;
+
+    // Table is never more than half full, so the probe always reaches an empty slot.
+    while((index = tmcDecoder.hashTable[slot]) != TMC_HASH_EMPTY)
+    {
+        if(tmcDecoder.messages[index].key == key)
+        {
+            break;
+        }
+
+        slot = (slot + 1) & (TMC_HASH_SIZE - 1);
+    }
+
+    return slot;
+}
+
+static void tmc_remove_slot(uint32_t slot)
+{
+    uint32_t nextSlot = slot, homeSlot;
+
+    // Backward shift deletion keeps probe sequences intact without tombstones.
+    while(1)
+    {
+        nextSlot = (nextSlot + 1) & (TMC_HASH_SIZE - 1);
+        if(tmcDecoder.hashTable[nextSlot] == TMC_HASH_EMPTY)
+        {
+            break;
+        }
+
+        homeSlot = tmc_hash_slot(tmcDecoder.messages[tmcDecoder.hashTable[nextSlot]].key);
+        if((slot <= nextSlot) ? ((slot < homeSlot) && (homeSlot <= nextSlot)) : ((slot < homeSlot) || (homeSlot <= nextSlot)))
+        {
+            continue;
+        }
+
+        tmcDecoder.hashTable[slot] = tmcDecoder.hashTable[nextSlot];
+        slot = nextSlot;
+    }
+
+    tmcDecoder.hashTable[slot] = TMC_HASH_EMPTY;
+}
+
+static void tmc_remove_message(uint32_t index)
+{
+    uint32_t lastIndex = tmcDecoder.messageCount - 1;
+
+    tmc_remove_slot(tmc_find_slot(tmcDecoder.messages[index].key));
+
+    // Store is kept dense, the last message takes the free position.
+    if(index != lastIndex)
+    {
+        tmcDecoder.messages[index] = tmcDecoder.messages[lastIndex];
+        tmcDecoder.hashTable[tmc_find_slot(tmcDecoder.messages[index].key)] = (uint16_t)index;
+    }
+
+    tmcDecoder.messageCount--;
+}
+
+static void tmc_expire_messages(gint64 now)
+{
+    uint32_t index = 0;
+
+    while(index < tmcDecoder.messageCount)
+    {
+        if(tmcDecoder.messages[index].expiryTime <= now)
+        {
+            tmc_remove_message(index);
+            tmcDecoder.stats.expired++;
+        }
+        else
+        {
+            index++;
+        }
+    }
+
+    tmcDecoder.lastExpiryCheck = now;
+}
+
+// Called with the store lock held.
+static void tmc_store_message(TMCMessage *message, gint64 now)
+{
+    uint32_t slot, index, oldestIndex;
+    TMCMessage *storedMessage;
+
+    message->key = tmc_make_key(message->location, message->direction, message->extent, message->event);
+    message->receivedTime = now;
+    message->updateTime = now;
+    message->expiryTime = now + ((gint64)tmcPersistence[message->duration & 0x07] * 60 * G_USEC_PER_SEC);
+    message->repeatCount = 0;
+
+    slot = tmc_find_slot(message->key);
+    if(tmcDecoder.hashTable[slot] != TMC_HASH_EMPTY)
+    {
+        // Same event at the same location, refresh the stored message.
+        storedMessage = &tmcDecoder.messages[tmcDecoder.hashTable[slot]];
+        message->receivedTime = storedMessage->receivedTime;
+        message->repeatCount = storedMessage->repeatCount + 1;
+        *storedMessage = *message;
+        tmcDecoder.stats.duplicates++;
+        return;
+    }
+
+    if(tmcDecoder.messageCount >= TMC_MAX_MESSAGES)
+    {
+        // Store is full, drop the message which expires first.
+        oldestIndex = 0;
+        for(index = 1; index < tmcDecoder.messageCount; index++)
+        {
+            if(tmcDecoder.messages[index].expiryTime < tmcDecoder.messages[oldestIndex].expiryTime)
+            {
+                oldestIndex = index;
+            }
+        }
+
+        tmc_remove_message(oldestIndex);
+        tmcDecoder.stats.evicted++;
+        slot = tmc_find_slot(message->key);
+    }
+
+    index = tmcDecoder.messageCount++;
+    tmcDecoder.messages[index] = *message;
+    tmcDecoder.hashTable[slot] = (uint16_t)index;
+}
+
+static uint8_t tmc_read_duration(TMCAssembly *assembly)
+{
+    uint32_t bitPos = 0, bitCount, fieldWidth;
+    uint8_t label;
+
+    bitCount = (assembly->groupCount - 1) * 28;
+
+    // Duration is the first label 0 field in the free format bit stream.
+    while((bitPos + 4) <= bitCount)
+    {
+        label = 0;
+        for(fieldWidth = 0; fieldWidth < 4; fieldWidth++, bitPos++)
+        {
+            label = (uint8_t)((label << 1) | ((assembly->freeFormat[bitPos / 28] >> (27 - (bitPos % 28))) & 0x01));
+        }
+
+        if((label == 0) && ((bitPos + 3) <= bitCount))
+        {
+            for(fieldWidth = 0; fieldWidth < 3; fieldWidth++, bitPos++)
+            {
+                label = (uint8_t)((label << 1) | ((assembly->freeFormat[bitPos / 28] >> (27 - (bitPos % 28))) & 0x01));
+            }
+
+            return label;
+        }
+
+        // Label 15 is reserved, its field width is unknown.
+        if(label == 15)
+        {
+            break;
+        }
+
+        bitPos += tmcLabelWidth[label];
+    }
+
+    return 0;
+}
+
+static void tmc_decode_single(RDSGroup *group, gint64 now)
+{
+    TMCMessage message;
+
+    memset(&message, 0, sizeof(TMCMessage));
+    message.duration = group->blockB & 0x07;
+    message.diversion = (group->blockC >> 15) & 0x01;
+    message.direction = (group->blockC >> 14) & 0x01;
+    message.extent = (group->blockC >> 11) & 0x07;
+    message.event = group->blockC & 0x07FF;
+    message.location = group->blockD;
+    message.groupCount = 1;
+    message.pi = group->blockA;
+
+    tmcDecoder.stats.singleMessages++;
+    tmc_store_message(&message, now);
+}
+
+static void tmc_complete_multi(TMCAssembly *assembly, gint64 now)
+{
+    TMCMessage message;
+
+    memset(&message, 0, sizeof(TMCMessage));
+    message.duration = tmc_read_duration(assembly);
+    message.direction = assembly->direction;
+    message.extent = assembly->extent;
+    message.event = assembly->event;
+    message.location = assembly->location;
+    message.groupCount = assembly->groupCount;
+    message.pi = assembly->pi;
+    memcpy(message.freeFormat, assembly->freeFormat, sizeof(message.freeFormat));
+
+    assembly->active = FALSE;
+    tmcDecoder.stats.multiMessages++;
+    tmc_store_message(&message, now);
+}
+
+static void tmc_decode_multi(RDSGroup *group, gint64 now)
+{
+    TMCAssembly *assembly = &tmcDecoder.assembly[group->blockB & 0x07];
+    uint8_t sequence;
+
+    if(group->blockC & TMC_FLAG_FIRST_GROUP)
+    {
+        // First group starts a new message, an unfinished one with the same continuity index is lost.
+        if(assembly->active)
+        {
+            tmcDecoder.stats.assemblyErrors++;
+        }
+
+        memset(assembly, 0, sizeof(TMCAssembly));
+        assembly->active = TRUE;
+        assembly->nextSequence = 0xFF;
+        assembly->groupCount = 1;
+        assembly->direction = (group->blockC >> 14) & 0x01;
+        assembly->extent = (group->blockC >> 11) & 0x07;
+        assembly->event = group->blockC & 0x07FF;
+        assembly->location = group->blockD;
+        assembly->pi = group->blockA;
+        assembly->startTime = now;
+        return;
+    }
+
+    if((!assembly->active) || ((now - assembly->startTime) > TMC_ASSEMBLY_TIMEOUT))
+    {
+        assembly->active = FALSE;
+        tmcDecoder.stats.assemblyErrors++;
+        return;
+    }
+
+    // Group sequence identifier counts down to zero on the last group.
+    sequence = (group->blockC >> 12) & 0x03;
+    if(((group->blockC & TMC_FLAG_SECOND_GROUP) != 0) != (assembly->groupCount == 1) ||
+       ((assembly->nextSequence != 0xFF) && (sequence != assembly->nextSequence)) || (assembly->groupCount > TMC_MAX_FREE_GROUPS))
+    {
+        assembly->active = FALSE;
+        tmcDecoder.stats.assemblyErrors++;
+        return;
+    }
+
+    assembly->freeFormat[assembly->groupCount - 1] = ((uint32_t)(group->blockC & 0x0FFF) << 16) | group->blockD;
+    assembly->groupCount++;
+
+    if(sequence == 0)
+    {
+        tmc_complete_multi(assembly, now);
+    }
+    else
+    {
+        assembly->nextSequence = sequence - 1;
+    }
+}
+
+void tmc_init()
+{
+    g_mutex_init(&tmcDecoder.storeLock);
+    memset(tmcDecoder.hashTable, 0xFF, sizeof(tmcDecoder.hashTable));
+    memset(tmcDecoder.assembly, 0, sizeof(tmcDecoder.assembly));
+    memset(&tmcDecoder.stats, 0, sizeof(TMCStats));
+
+    tmcDecoder.messageCount = 0;
+    tmcDecoder.lastBlockB = 0;
+    tmcDecoder.lastBlockC = 0;
+    tmcDecoder.lastBlockD = 0;
+    tmcDecoder.lastExpiryCheck = clock_source_now();
+}
+
+// Called with the store lock held.
+static void tmc_decode_8a_group(RDSGroup *group)
+{
+    gint64 now;
+
+    // Single bit errors in a location or event code would create bogus messages.
+    if(group->status & (RDS_STATUS_ERR_B | RDS_STATUS_ERR_C | RDS_STATUS_ERR_D))
+    {
+        tmcDecoder.stats.errorGroups++;
+        return;
+    }
+
+    tmcDecoder.stats.groups++;
+
+    // Encoders usually send every group twice in a row.
+    if((group->blockB == tmcDecoder.lastBlockB) && (group->blockC == tmcDecoder.lastBlockC) && (group->blockD == tmcDecoder.lastBlockD))
+    {
+        tmcDecoder.stats.repeatGroups++;
+        return;
+    }
+
+    tmcDecoder.lastBlockB = group->blockB;
+    tmcDecoder.lastBlockC = group->blockC;
+    tmcDecoder.lastBlockD = group->blockD;
+
+    if(group->blockB & TMC_FLAG_TUNING)
+    {
+        tmcDecoder.stats.systemGroups++;
+        return;
+    }
+
+    now = clock_source_now();
+
+    if(group->blockB & TMC_FLAG_SINGLE)
+    {
+        tmc_decode_single(group, now);
+    }
+    else
+    {
+        tmc_decode_multi(group, now);
+    }
+
+    if((now - tmcDecoder.lastExpiryCheck) >= TMC_EXPIRY_CHECK_PERIOD)
+    {
+        tmc_expire_messages(now);
+    }
+}
+
+void tmc_decode_group(RDSGroup *group)
+{
+    if((group->blockB & TMC_GROUP_MASK) != TMC_GROUP_8A)
+    {
+        return;
+    }
+
+    // Statistics are read under the store lock, so 8A groups are decoded with it held.
+    g_mutex_lock(&tmcDecoder.storeLock);
+    tmc_decode_8a_group(group);
+    g_mutex_unlock(&tmcDecoder.storeLock);
+}
+
+uint32_t tmc_find_location(uint16_t location, TMCMessage *messages, uint32_t maxMessages)
+{
+    uint32_t index, count = 0;
+    gint64 now = clock_source_now();
+
+    g_mutex_lock(&tmcDecoder.storeLock);
+
+    // Store is small and dense, a linear scan over it is cheaper than a second index.
+    for(index = 0; (index < tmcDecoder.messageCount) && (count < maxMessages); index++)
+    {
+        if((tmcDecoder.messages[index].location == location) && (tmcDecoder.messages[index].expiryTime > now))
+        {
+            messages[count++] = tmcDecoder.messages[index];
+        }
+    }
+
+    g_mutex_unlock(&tmcDecoder.storeLock);
+    return count;
+}
+
+uint32_t tmc_get_messages(TMCMessage *messages, uint32_t maxMessages)
+{
+    uint32_t index, count = 0;
+    gint64 now = clock_source_now();
+
+    g_mutex_lock(&tmcDecoder.storeLock);
+
+    for(index = 0; (index < tmcDecoder.messageCount) && (count < maxMessages); index++)
+    {
+        if(tmcDecoder.messages[index].expiryTime > now)
+        {
+            messages[count++] = tmcDecoder.messages[index];
+        }
+    }
+
+    g_mutex_unlock(&tmcDecoder.storeLock);
+    return count;
+}
+
+void tmc_get_stats(TMCStats *stats)
+{
+    g_mutex_lock(&tmcDecoder.storeLock);
+    *stats = tmcDecoder.stats;
+    stats->messageCount = tmcDecoder.messageCount;
+    g_mutex_unlock(&tmcDecoder.storeLock);
+}
@@ -0,0 +1,125 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * RDS-TMC (group 8A) traffic message decoder and message store.                 *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_TMC_HEADER_
+#define _GTK_FM_TUNER_TMC_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "tuner.h"
+
+// Maximum number of messages kept in the store.
+#define TMC_MAX_MESSAGES        256
+
+// Size of the duplicate suppression table (power of 2, twice the store size).
+#define TMC_HASH_BITS           9
+#define TMC_HASH_SIZE           (1 << TMC_HASH_BITS)
+
+// Multi group messages have up to 4 continuation groups with 28 free format bits each.
+#define TMC_MAX_FREE_GROUPS     4
+
+// Number of multi group assembly slots (one per continuity index).
+#define TMC_ASSEMBLY_SLOTS      8
+
+// Incomplete multi group message is dropped after this time (us).
+#define TMC_ASSEMBLY_TIMEOUT    (2 * G_USEC_PER_SEC)
+
+// Expired messages are removed at most once per this period (us).
+#define TMC_EXPIRY_CHECK_PERIOD G_USEC_PER_SEC
+
+typedef struct TMCMessage
+{
+    uint32_t key;               // Location, direction, extent and event packed into the hash key.
+    uint16_t location;
+    uint16_t event;
+    uint8_t direction;          // 0 = positive, 1 = negative direction.
+    uint8_t extent;
+    uint8_t duration;           // Duration and persistence code (0-7).
+    uint8_t diversion;
+    uint8_t groupCount;         // Number of groups of the message (1 for single group messages).
+    uint16_t pi;                // Program identification of the service carrying the message.
+    uint32_t freeFormat[TMC_MAX_FREE_GROUPS];
+    uint32_t repeatCount;       // Number of duplicates received.
+    gint64 receivedTime;
+    gint64 updateTime;
+    gint64 expiryTime;
+} TMCMessage;
+
+typedef struct TMCAssembly
+{
+    gboolean active;
+    uint8_t nextSequence;       // Expected group sequence identifier, 0xFF until the second group.
+    uint8_t groupCount;
+    uint16_t location;
+    uint16_t event;
+    uint8_t direction;
+    uint8_t extent;
+    uint16_t pi;
+    uint32_t freeFormat[TMC_MAX_FREE_GROUPS];
+    gint64 startTime;
+} TMCAssembly;
+
+typedef struct TMCStats
+{
+    uint32_t groups;            // Received 8A groups with valid blocks.
+    uint32_t errorGroups;       // 8A groups dropped because of block errors.
+    uint32_t repeatGroups;      // Immediately repeated groups.
+    uint32_t systemGroups;      // Tuning and system information groups.
+    uint32_t singleMessages;
+    uint32_t multiMessages;
+    uint32_t assemblyErrors;    // Multi group messages dropped because of missing groups.
+    uint32_t duplicates;
+    uint32_t expired;
+    uint32_t evicted;           // Messages replaced because the store was full.
+    uint32_t messageCount;      // Messages in the store.
+} TMCStats;
+
+typedef struct TMCDecoder
+{
+    GMutex storeLock;                       // Guards the message store, the assembly state and the statistics.
+    TMCMessage messages[TMC_MAX_MESSAGES];
+    uint32_t messageCount;
+    uint16_t hashTable[TMC_HASH_SIZE];      // Message index, TMC_HASH_EMPTY for a free slot.
+    TMCAssembly assembly[TMC_ASSEMBLY_SLOTS];
+    uint16_t lastBlockB;
+    uint16_t lastBlockC;
+    uint16_t lastBlockD;
+    gint64 lastExpiryCheck;
+    TMCStats stats;
+} TMCDecoder;
+
+#define TMC_HASH_EMPTY          0xFFFF
+
+void tmc_init(void);
+void tmc_decode_group(RDSGroup *group);
+
+uint32_t tmc_find_location(uint16_t location, TMCMessage *messages, uint32_t maxMessages);
+uint32_t tmc_get_messages(TMCMessage *messages, uint32_t maxMessages);
+void tmc_get_stats(TMCStats *stats);
+
+#endif /* _GTK_FM_TUNER_TMC_HEADER_ */
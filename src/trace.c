@@ -0,0 +1,527 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Low overhead binary trace logger.                                             *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "trace.h"
+
+// All subsystems stay silent until the trace logger is initialized.
+volatile uint8_t traceLevels[TS_COUNT];
+
+static TraceContext traceContext = { .fileHandle = -1 };
+static __thread TraceRing *threadRing;
+
+static inline uint64_t trace_get_time(clockid_t clockId)
+{
+    struct timespec timeValue;
+
+    clock_gettime(clockId, &timeValue);
+    return ((uint64_t)timeValue.tv_sec * 1000000000ULL) + (uint64_t)timeValue.tv_nsec;
+}
+
+static void on_trace_thread_exit(void *ring)
+{
+    // Records of the finished thread stay in the ring until they are flushed or overwritten.
+    g_atomic_int_set(&((TraceRing *)ring)->active, 0);
+}
+
+static TraceRing *trace_register_thread()
+{
+    TraceRing *ring = NULL;
+    gint pos, ringCount;
+
+    g_mutex_lock(&traceContext.ringLock);
+
+    ringCount = g_atomic_int_get(&traceContext.ringCount);
+    for(pos = 0; pos < ringCount; pos++)
+    {
+        if(g_atomic_int_get(&traceContext.rings[pos]->active) == 0)
+        {
+            ring = traceContext.rings[pos];
+            break;
+        }
+    }
+
+    if((ring == NULL) && (ringCount < TRACE_MAX_THREADS))
+    {
+        ring = g_new0(TraceRing, 1);
+        traceContext.rings[ringCount] = ring;
+        g_atomic_int_set(&traceContext.ringCount, ringCount + 1);
+    }
+
+    if(ring != NULL)
+    {
+        ring->threadId = ++traceContext.threadSerial;
+        g_atomic_int_set(&ring->active, 1);
+        pthread_setspecific(traceContext.threadKey, ring);
+        threadRing = ring;
+    }
+
+    g_mutex_unlock(&traceContext.ringLock);
+    return ring;
+}
+
+void trace_write(uint16_t eventId, int32_t arg0, int32_t arg1, int32_t arg2, int32_t arg3)
+{
+    TraceRing *ring = threadRing;
+    FMTraceRecord *record;
+    uint64_t head;
+
+    if(G_UNLIKELY(ring == NULL))
+    {
+        ring = trace_register_thread();
+        if(ring == NULL)
+        {
+            return;
+        }
+    }
+
+    // Single producer: the ring always accepts the record, the oldest one is overwritten if nobody drained it.
+    head = ring->head;
+    record = &ring->records[head & (TRACE_RING_SIZE - 1)];
+    record->timestamp = trace_get_time(CLOCK_MONOTONIC);
+    record->eventId = eventId;
+    record->threadId = ring->threadId;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    record->args[3] = arg3;
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static void trace_write_file(int fileHandle, const void *data, size_t dataSize)
+{
+    const uint8_t *dataPtr = (const uint8_t *)data;
+    ssize_t writeSize;
+
+    // Only async signal safe calls here, this is also used by the crash handler.
+    while(dataSize > 0)
+    {
+        writeSize = write(fileHandle, dataPtr, dataSize);
+        if(writeSize <= 0)
+        {
+            if((writeSize < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+
+            return;
+        }
+
+        dataPtr += writeSize;
+        dataSize -= (size_t)writeSize;
+    }
+}
+
+static void trace_write_header(int fileHandle)
+{
+    FMTraceHeader header;
+
+    memset(&header, 0, sizeof(FMTraceHeader));
+    header.magic = FMTRACE_MAGIC;
+    header.version = FMTRACE_VERSION;
+    header.recordSize = sizeof(FMTraceRecord);
+    header.eventCount = TE_COUNT;
+    header.startRealTime = traceContext.startRealTime;
+    header.startTime = traceContext.startTime;
+
+    trace_write_file(fileHandle, &header, sizeof(FMTraceHeader));
+}
+
+static uint64_t trace_write_ring(TraceRing *ring, int fileHandle, uint64_t position, gboolean consume)
+{
+    FMTraceRecord batch[TRACE_FLUSH_BATCH];
+    uint64_t head, firstValid;
+    uint32_t count, skip, pos;
+
+    for(;;)
+    {
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if(position >= head)
+        {
+            return position;
+        }
+
+        // Producer lapped the reader, skip the overwritten records.
+        if((head - position) > TRACE_RING_SIZE)
+        {
+            if(consume)
+            {
+                g_atomic_int_add(&traceContext.lostRecords, (gint)(head - position - TRACE_RING_SIZE));
+            }
+
+            position = head - TRACE_RING_SIZE;
+        }
+
+        count = (uint32_t)MIN(head - position, TRACE_FLUSH_BATCH);
+        for(pos = 0; pos < count; pos++)
+        {
+            batch[pos] = ring->records[(position + pos) & (TRACE_RING_SIZE - 1)];
+        }
+
+        // Records the producer started to overwrite while they were copied are dropped.
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        firstValid = (head >= TRACE_RING_SIZE) ? (head - TRACE_RING_SIZE + 1) : 0;
+        skip = (firstValid > position) ? (uint32_t)MIN(firstValid - position, count) : 0;
+
+        if(count > skip)
+        {
+            trace_write_file(fileHandle, &batch[skip], (count - skip) * sizeof(FMTraceRecord));
+        }
+
+        // Statistics cover the trace file only, dumps are snapshots of the rings.
+        if(consume)
+        {
+            g_atomic_int_add(&traceContext.lostRecords, (gint)skip);
+            g_atomic_int_add(&traceContext.writtenRecords, (gint)(count - skip));
+        }
+
+        position += count;
+    }
+}
+
+static void trace_drain_rings()
+{
+    gint pos, ringCount;
+
+    ringCount = g_atomic_int_get(&traceContext.ringCount);
+    for(pos = 0; pos < ringCount; pos++)
+    {
+        traceContext.rings[pos]->tail = trace_write_ring(traceContext.rings[pos], traceContext.fileHandle, traceContext.rings[pos]->tail, TRUE);
+    }
+}
+
+static void *trace_flusher_thread(void *threadData)
+{
+    while(g_atomic_int_get(&traceContext.flusherRunning))
+    {
+        g_usleep(TRACE_FLUSH_INTERVAL * 1000);
+
+        g_mutex_lock(&traceContext.flushLock);
+        trace_drain_rings();
+        g_mutex_unlock(&traceContext.flushLock);
+    }
+
+    return NULL;
+}
+
+static void on_trace_crash(int signalNumber)
+{
+    int fileHandle;
+    gint pos, ringCount;
+
+    // Append the pending records to the trace file, or write all rings into a new crash dump file.
+    // Dump directory may be shared, existing files and symbolic links are never opened.
+    fileHandle = traceContext.fileHandle;
+    if((fileHandle < 0) && (traceContext.crashPath[0] != 0x00))
+    {
+        fileHandle = open(traceContext.crashPath, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+        if(fileHandle >= 0)
+        {
+            trace_write_header(fileHandle);
+        }
+    }
+
+    if(fileHandle >= 0)
+    {
+        ringCount = g_atomic_int_get(&traceContext.ringCount);
+        for(pos = 0; pos < ringCount; pos++)
+        {
+            if(traceContext.fileHandle >= 0)
+            {
+                trace_write_ring(traceContext.rings[pos], fileHandle, traceContext.rings[pos]->tail, TRUE);
+            }
+            else
+            {
+                trace_write_ring(traceContext.rings[pos], fileHandle, 0, FALSE);
+            }
+        }
+
+        fsync(fileHandle);
+    }
+
+    // Handler is installed with SA_RESETHAND, default action terminates the process.
+    raise(signalNumber);
+}
+
+static void trace_set_dump_dir(const char *dumpDir)
+{
+    int dumpLength, crashLength;
+
+    if((dumpDir == NULL) || (dumpDir[0] == 0x00))
+    {
+        dumpDir = g_getenv("XDG_RUNTIME_DIR");
+    }
+
+    if((dumpDir == NULL) || (dumpDir[0] == 0x00))
+    {
+        dumpDir = g_get_tmp_dir();
+    }
+
+    dumpLength = g_snprintf(traceContext.dumpPath, TRACE_PATH_MAX, "%s/" TRACE_DUMP_NAME, dumpDir);
+    crashLength = g_snprintf(traceContext.crashPath, TRACE_PATH_MAX, "%s/" TRACE_CRASH_NAME, dumpDir, (int)getpid());
+
+    // Room for the mkstemp suffix of the on demand dump is kept as well.
+    if((dumpLength + 8 >= TRACE_PATH_MAX) || (crashLength >= TRACE_PATH_MAX))
+    {
+        g_warning("Trace dump directory %s is too long, dumps are disabled", dumpDir);
+        traceContext.dumpPath[0] = 0x00;
+        traceContext.crashPath[0] = 0x00;
+    }
+}
+
+uint8_t trace_init(const char *path, const char *dumpDir)
+{
+    struct sigaction crashAction;
+    int crashSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+    uint8_t pos;
+
+    g_mutex_init(&traceContext.ringLock);
+    g_mutex_init(&traceContext.flushLock);
+    pthread_key_create(&traceContext.threadKey, on_trace_thread_exit);
+
+    traceContext.startRealTime = trace_get_time(CLOCK_REALTIME);
+    traceContext.startTime = trace_get_time(CLOCK_MONOTONIC);
+    trace_set_dump_dir(dumpDir);
+
+    for(pos = 0; pos < TS_COUNT; pos++)
+    {
+        traceLevels[pos] = TRACE_DEFAULT_LEVEL;
+    }
+
+    memset(&crashAction, 0, sizeof(struct sigaction));
+    crashAction.sa_handler = on_trace_crash;
+    crashAction.sa_flags = SA_RESETHAND;
+    sigemptyset(&crashAction.sa_mask);
+
+    for(pos = 0; pos < G_N_ELEMENTS(crashSignals); pos++)
+    {
+        sigaction(crashSignals[pos], &crashAction, NULL);
+    }
+
+    // Without a trace file the rings only keep the latest records for dumps.
+    if(path == NULL)
+    {
+        return RESULT_SUCCESS;
+    }
+
+    traceContext.fileHandle = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(traceContext.fileHandle < 0)
+    {
+        g_warning("Unable to create trace file %s: %s", path, strerror(errno));
+        return RESULT_FAIL;
+    }
+
+    trace_write_header(traceContext.fileHandle);
+
+    g_atomic_int_set(&traceContext.flusherRunning, 1);
+    pthread_create(&traceContext.flusherThread, NULL, trace_flusher_thread, NULL);
+
+    return RESULT_SUCCESS;
+}
+
+void trace_shutdown()
+{
+    if(traceContext.fileHandle < 0)
+    {
+        return;
+    }
+
+    g_atomic_int_set(&traceContext.flusherRunning, 0);
+    pthread_join(traceContext.flusherThread, NULL);
+
+    trace_flush();
+
+#ifdef DEBUG_LOGS
+    g_message("Trace file closed with %d records, %d records lost", g_atomic_int_get(&traceContext.writtenRecords),
+        g_atomic_int_get(&traceContext.lostRecords));
+#endif
+
+    close(traceContext.fileHandle);
+    traceContext.fileHandle = -1;
+}
+
+void trace_flush()
+{
+    if(traceContext.fileHandle < 0)
+    {
+        return;
+    }
+
+    g_mutex_lock(&traceContext.flushLock);
+    trace_drain_rings();
+    g_mutex_unlock(&traceContext.flushLock);
+}
+
+uint8_t trace_dump()
+{
+    char tempPath[TRACE_PATH_MAX];
+    int fileHandle;
+    gint pos, ringCount;
+
+    if(traceContext.dumpPath[0] == 0x00)
+    {
+        return RESULT_FAIL;
+    }
+
+    // Dump is written into a new private file and renamed over the previous one, a planted link is replaced, not followed.
+    g_snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", traceContext.dumpPath);
+    fileHandle = mkstemp(tempPath);
+    if(fileHandle < 0)
+    {
+        return RESULT_FAIL;
+    }
+
+    // Dump copies everything still in the rings without consuming it.
+    trace_write_header(fileHandle);
+
+    ringCount = g_atomic_int_get(&traceContext.ringCount);
+    for(pos = 0; pos < ringCount; pos++)
+    {
+        trace_write_ring(traceContext.rings[pos], fileHandle, 0, FALSE);
+    }
+
+    close(fileHandle);
+
+    if(rename(tempPath, traceContext.dumpPath) < 0)
+    {
+        unlink(tempPath);
+        return RESULT_FAIL;
+    }
+
+    return RESULT_SUCCESS;
+}
+
+const char *trace_get_dump_path()
+{
+    return traceContext.dumpPath;
+}
+
+static int8_t trace_parse_level(const char *levelText)
+{
+    uint8_t pos;
+
+    for(pos = 0; pos < G_N_ELEMENTS(fmtraceLevelName); pos++)
+    {
+        if(g_ascii_strcasecmp(levelText, fmtraceLevelName[pos]) == 0)
+        {
+            return (int8_t)pos;
+        }
+    }
+
+    // Numeric level is accepted as well.
+    if((levelText[0] >= '0') && (levelText[0] <= '0' + TL_DEBUG) && (levelText[1] == 0x00))
+    {
+        return (int8_t)(levelText[0] - '0');
+    }
+
+    return -1;
+}
+
+uint8_t trace_set_levels(const char *levelSpec)
+{
+    gchar **levelItems, *separator;
+    uint8_t newLevels[TS_COUNT];
+    int8_t level;
+    uint8_t pos, subsystem, result = RESULT_SUCCESS;
+    gboolean found;
+
+    for(pos = 0; pos < TS_COUNT; pos++)
+    {
+        newLevels[pos] = __atomic_load_n(&traceLevels[pos], __ATOMIC_RELAXED);
+    }
+
+    // Comma separated list of subsystem=level items, "all" selects every subsystem.
+    levelItems = g_strsplit(levelSpec, ",", -1);
+    for(pos = 0; (levelItems[pos] != NULL) && (result == RESULT_SUCCESS); pos++)
+    {
+        separator = strchr(levelItems[pos], '=');
+        if(separator == NULL)
+        {
+            result = RESULT_FAIL;
+            break;
+        }
+
+        *separator = 0x00;
+        level = trace_parse_level(separator + 1);
+        found = FALSE;
+
+        for(subsystem = 0; (subsystem < TS_COUNT) && (level >= 0); subsystem++)
+        {
+            if((g_ascii_strcasecmp(levelItems[pos], "all") == 0) || (g_ascii_strcasecmp(levelItems[pos], fmtraceSubsystemName[subsystem]) == 0))
+            {
+                newLevels[subsystem] = (uint8_t)level;
+                found = TRUE;
+            }
+        }
+
+        result = found ? RESULT_SUCCESS : RESULT_FAIL;
+    }
+
+    g_strfreev(levelItems);
+
+    // Invalid specification leaves all levels unchanged.
+    if(result == RESULT_SUCCESS)
+    {
+        for(pos = 0; pos < TS_COUNT; pos++)
+        {
+            __atomic_store_n(&traceLevels[pos], newLevels[pos], __ATOMIC_RELAXED);
+        }
+    }
+
+    return result;
+}
+
+void trace_get_levels(char *levelText, size_t textSize)
+{
+    uint8_t pos;
+    size_t textPos = 0;
+
+    levelText[0] = 0x00;
+    for(pos = 0; (pos < TS_COUNT) && (textPos < textSize); pos++)
+    {
+        textPos += g_snprintf(levelText + textPos, textSize - textPos, "%s%s=%s", ((pos > 0) ? "," : ""), fmtraceSubsystemName[pos],
+            fmtraceLevelName[MIN(__atomic_load_n(&traceLevels[pos], __ATOMIC_RELAXED), TL_DEBUG)]);
+    }
+}
+
+void trace_get_stats(uint32_t *writtenRecords, uint32_t *lostRecords)
+{
+    *writtenRecords = (uint32_t)g_atomic_int_get(&traceContext.writtenRecords);
+    *lostRecords = (uint32_t)g_atomic_int_get(&traceContext.lostRecords);
+}
@@ -0,0 +1,121 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Low overhead binary trace logger.                                             *
+ *                                                                               *
+ * Every thread writes fixed size records into its own lock free ring. The       *
+ * rings are drained into the trace file by a background flusher, dumped on      *
+ * demand, or written out by the crash handler. Verbosity is set at runtime      *
+ * for each subsystem, disabled events cost a single compare.                    *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_TRACE_HEADER_
+#define _GTK_FM_TUNER_TRACE_HEADER_
+
+#include <glib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "fmtrace.h"
+
+// Number of records in every thread ring, must be a power of two.
+#define TRACE_RING_SIZE         4096
+
+// Maximum number of threads with a trace ring (rings of finished threads are reused).
+#define TRACE_MAX_THREADS       32
+
+// Flusher period in ms.
+#define TRACE_FLUSH_INTERVAL    250
+
+// Number of records copied out of a ring in one step.
+#define TRACE_FLUSH_BATCH       64
+
+// Verbosity of all subsystems unless specified with --trace-level.
+#define TRACE_DEFAULT_LEVEL     TL_INFO
+
+// On demand dump and crash dump (without a trace file) are written into the dump directory: --trace-dir,
+// $XDG_RUNTIME_DIR or the temporary directory. Crash dumps carry the process ID in their name.
+#define TRACE_DUMP_NAME         "gtk-fm-tuner.trace"
+#define TRACE_CRASH_NAME        "gtk-fm-tuner-crash-%d.trace"
+
+// Maximum length of the dump file paths.
+#define TRACE_PATH_MAX          256
+
+typedef struct TraceRing
+{
+    FMTraceRecord records[TRACE_RING_SIZE];
+    volatile uint64_t head;     // Next record to write, updated only by the owner thread.
+    uint64_t tail;              // Next record to flush, updated only by the flusher.
+    volatile gint active;       // Ring is owned by a running thread.
+    uint16_t threadId;
+} TraceRing;
+
+typedef struct TraceContext
+{
+    GMutex ringLock;            // Serializes ring registration.
+    GMutex flushLock;           // Serializes ring consumers (flusher, flush and dump).
+    pthread_key_t threadKey;
+    TraceRing *rings[TRACE_MAX_THREADS];
+    volatile gint ringCount;
+    uint16_t threadSerial;
+
+    int fileHandle;
+    pthread_t flusherThread;
+    volatile gint flusherRunning;
+
+    uint64_t startRealTime;
+    uint64_t startTime;
+    char dumpPath[TRACE_PATH_MAX];  // Empty if the dump directory path is too long.
+    char crashPath[TRACE_PATH_MAX]; // Built in advance, the crash handler cannot format it.
+    volatile gint lostRecords;
+    volatile gint writtenRecords;
+} TraceContext;
+
+extern volatile uint8_t traceLevels[TS_COUNT];
+
+// Record a trace event with up to FMTRACE_MAX_ARGS integer arguments.
+#define TRACE_LOG(...) TRACE_LOG_ARGS(__VA_ARGS__, 0, 0, 0, 0, 0)
+#define TRACE_LOG_ARGS(event, arg0, arg1, arg2, arg3, ...) \
+    do \
+    { \
+        if(__atomic_load_n(&traceLevels[fmtraceEventSubsystem[event]], __ATOMIC_RELAXED) >= fmtraceEventLevel[event]) \
+        { \
+            trace_write((event), (int32_t)(arg0), (int32_t)(arg1), (int32_t)(arg2), (int32_t)(arg3)); \
+        } \
+    } \
+    while(0)
+
+uint8_t trace_init(const char *path, const char *dumpDir);
+void trace_shutdown(void);
+void trace_write(uint16_t eventId, int32_t arg0, int32_t arg1, int32_t arg2, int32_t arg3);
+
+uint8_t trace_set_levels(const char *levelSpec);
+void trace_get_levels(char *levelText, size_t textSize);
+void trace_get_stats(uint32_t *writtenRecords, uint32_t *lostRecords);
+
+void trace_flush(void);
+uint8_t trace_dump(void);
+const char *trace_get_dump_path(void);
+
+#endif /* _GTK_FM_TUNER_TRACE_HEADER_ */
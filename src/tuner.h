@@ -31,6 +31,9 @@
 #include <gtk/gtk.h>
 #include <stdint.h>
 
+#include "lockstats.h"
+#include "bandplan.h"
+
 typedef enum 
 {
     SCAN_DOWN,
@@ -50,6 +53,23 @@ typedef enum
     MPXS_UNKNOWN
 } StereoMPXState;
 
+// Block error flags of the RDS group status, tuner drivers report uncorrectable blocks with these bits.
+#define RDS_STATUS_ERR_A    0x08
+#define RDS_STATUS_ERR_B    0x04
+#define RDS_STATUS_ERR_C    0x02
+#define RDS_STATUS_ERR_D    0x01
+
+// Raw RDS group with the receiver status captured with it.
+typedef struct RDSGroup
+{
+    uint16_t blockA;
+    uint16_t blockB;
+    uint16_t blockC;
+    uint16_t blockD;
+    uint8_t status;     // RDS_STATUS_ERR_* flags, other bits are tuner specific (sync etc.).
+    gint64 captureTime; // CLOCK_MONOTONIC time (us) when the group was detected by the driver.
+} RDSGroup;
+
 // Core tuner functions.
 
 // Initialize the FM tuner.
@@ -61,8 +81,22 @@ typedef uint8_t (*shutdown_tuner)(void);
 typedef uint8_t (*set_tuner_frequency)(double frequency);
 // Get tuner frequency (freq * 100).
 typedef double (*get_tuner_frequency)(void);
+// Tune to the channel index of the active band plan.
+typedef uint8_t (*set_tuner_channel)(uint16_t channel);
+// Channel index of the active band plan nearest to the tuned frequency, BAND_PLAN_NO_CHANNEL if busy or outside the plan.
+typedef int32_t (*get_tuner_channel)(void);
+// Switch band plan, the tuner rebuilds its channel tables and limits seeks to the band.
+typedef uint8_t (*set_tuner_band_plan)(const BandPlan *plan);
 // Scan for new channel. (SCAN_DIRECTION_UP/SCAN_DIRECTION_DOWN)
 typedef uint8_t (*tuner_scan_channel)(ScanDirection direction);
+// Abort running channel scan and return to the last tuned channel.
+typedef uint8_t (*tuner_cancel_scan)(void);
+// Ask a running channel scan to stop without bus access (any thread), the seek returns on its next poll.
+typedef void (*tuner_preempt_scan)(void);
+// Receive the channel checked by a running scan (called from the scanning thread).
+typedef void (*tuner_scan_progress_handler)(double frequency);
+// Install scan progress handler (NULL to remove).
+typedef void (*tuner_set_scan_progress)(tuner_scan_progress_handler handler);
 
 // Set tuner volume control.
 typedef uint8_t (*tuner_set_volume)(uint16_t level);
@@ -79,6 +113,16 @@ typedef int16_t (*get_tuner_snr)(void);
 typedef StereoMPXState (*get_tuner_stereo_mpx_status)(void);
 // Current RSSI (Received Signal Strength Indicator) value from the tuner.
 typedef int16_t (*get_tuner_rssi)(void);
+// Read next received RDS group, returns RESULT_FAIL if no new group is available.
+typedef uint8_t (*tuner_rds_read_group)(RDSGroup *group);
+// Feed RDS group into the RDS decoder (output is available through rdsData).
+typedef void (*tuner_rds_decode_group)(RDSGroup *group);
+// Verify that the tuner still answers and is configured, RESULT_FAIL if it has to be reconnected.
+typedef uint8_t (*tuner_check_device)(void);
+// Reopen the bus, initialize the tuner and restore the last channel and volume.
+typedef uint8_t (*tuner_reconnect)(void);
+// Contention statistics of the tuner mutex, one entry for each caller (LOCK_STATS_CALLERS).
+typedef void (*tuner_get_lock_stats)(LockCallerStats *callerStats);
 
 typedef struct Tuner 
 {
@@ -87,7 +131,13 @@ typedef struct Tuner
 
     set_tuner_frequency set_frequency;
     get_tuner_frequency get_frequency;
+    set_tuner_channel set_channel;
+    get_tuner_channel get_channel;
+    set_tuner_band_plan set_band_plan;
     tuner_scan_channel scan_channel;
+    tuner_cancel_scan cancel_scan;
+    tuner_preempt_scan preempt_scan;
+    tuner_set_scan_progress set_scan_progress;
 
     tuner_set_volume set_volume;
     tuner_get_volume get_volume;
@@ -96,8 +146,14 @@ typedef struct Tuner
     get_tuner_snr snr;
     get_tuner_stereo_mpx_status stereo_mpx;
     get_tuner_rssi rssi;
+    tuner_rds_read_group rds_read_group;
+    tuner_rds_decode_group rds_decode_group;
+    tuner_get_lock_stats get_lock_stats;
+    tuner_check_device check_device;
+    tuner_reconnect reconnect;
 
     char *rdsData;
+    uint16_t maxVolume;
 } Tuner;
 
 #endif /* _GTK_FM_TUNER_BASETUNER_HEADER_ */
\ No newline at end of file
@@ -0,0 +1,405 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner event core: command execution, RDS capture and telemetry.               *
+ *                                                                               *
+ * All periodic tuner work runs from a single event loop, either on the          *
+ * caller's GMainContext (headless mode) or on a dedicated core thread (GUI).    *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <glib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "defconfig.h"
+#include "defmain.h"
+#include "tunercore.h"
+#include "command.h"
+#include "sweep.h"
+#include "history.h"
+#include "shmstatus.h"
+#include "recorder.h"
+#include "tmc.h"
+#include "rdsstats.h"
+#include "rdsclock.h"
+#include "trace.h"
+#include "i2cstats.h"
+#include "metrics.h"
+#include "clocksource.h"
+
+static TunerCore tunerCore;
+
+void tuner_core_read_status(Tuner *tuner, TunerStatus *status)
+{
+    const BandPlan *plan = band_plan_get();
+
+    // Channel index maps to the frequency through the band plan table, without a second register read.
+    status->channel = tuner->get_channel();
+    status->frequency = (status->channel != BAND_PLAN_NO_CHANNEL) ? plan->frequencies[status->channel] : tuner->get_frequency();
+    status->rssi = (tuner->rssi != NULL) ? tuner->rssi() : -1;
+    status->snr = (tuner->snr != NULL) ? tuner->snr() : -1;
+    status->mpxState = (tuner->stereo_mpx != NULL) ? tuner->stereo_mpx() : MPXS_UNKNOWN;
+    status->volume = tuner->get_volume();
+
+    if(tuner->rdsData != NULL)
+    {
+        g_strlcpy(status->rdsText, tuner->rdsData, sizeof(status->rdsText));
+    }
+    else
+    {
+        status->rdsText[0] = 0x00;
+    }
+}
+
+static void on_rds_capture_timer(gpointer userData)
+{
+    Tuner *tuner = tunerCore.tunerRef;
+    RDSGroup group;
+    uint8_t groupCount = 0;
+    gboolean sweepRunning = sweep_is_running();
+    guint captureRate;
+
+    // Drain all pending groups, replayed captures can deliver more than one per poll.
+    while((groupCount < RDS_MAX_GROUPS_PER_POLL) && (tuner->rds_read_group(&group) == RESULT_SUCCESS))
+    {
+        recorder_write_rds(&group);
+        tuner->rds_decode_group(&group);
+        tmc_decode_group(&group);
+        groupCount++;
+
+        // Groups caught while the band scope sweeps belong to other channels.
+        if(!sweepRunning)
+        {
+            rds_stats_add_group(&group);
+            rds_clock_add_group(&group);
+        }
+    }
+
+    // Group counters are aggregated per poll, so the exporter costs one atomic add per capture.
+    if(groupCount > 0)
+    {
+        metrics_count((sweepRunning ? MC_RDS_GROUPS_DISCARDED : MC_RDS_GROUPS), groupCount);
+        if(groupCount == RDS_MAX_GROUPS_PER_POLL)
+        {
+            metrics_count(MC_RDS_POLL_LIMIT, 1);
+        }
+    }
+
+    // Clock service polls faster around the expected minute edge to reduce the clock jitter.
+    captureRate = rds_clock_get_capture_rate(RDS_CAPTURE_RATE);
+    if(captureRate != tunerCore.rdsCaptureRate)
+    {
+        tunerCore.rdsCaptureRate = captureRate;
+        TRACE_LOG(TE_CORE_RDS_RATE, captureRate);
+        event_loop_set_timer(tunerCore.eventLoop, tunerCore.rdsTimer, captureRate);
+    }
+}
+
+static void on_meter_sample_timer(gpointer userData)
+{
+    int16_t rssi, snr;
+    guint32 sampleTime;
+
+    rssi = tunerCore.tunerRef->rssi();
+    snr = tunerCore.tunerRef->snr();
+
+    // Skip the sample if the tuner is busy with another thread.
+    if((rssi < 0) || (snr < 0))
+    {
+        g_atomic_int_inc(&tunerCore.meterSkips);
+        return;
+    }
+
+    // Readings and their time are packed into one word, so readers never see a torn or misdated sample.
+    sampleTime = (guint32)(clock_source_now() / 1000);
+    __atomic_store_n(&tunerCore.signalSample, (((guint64)sampleTime << 32) | (uint32_t)SIGNAL_SAMPLE_PACK(rssi, snr)), __ATOMIC_RELAXED);
+}
+
+static void on_history_timer(gpointer userData)
+{
+    Tuner *tuner = tunerCore.tunerRef;
+    double frequency;
+    gboolean retuned;
+    guint64 expirations;
+
+    // Timer periods missed while the loop was busy are recorded as gaps before the current reading.
+    expirations = event_loop_get_expirations(tunerCore.eventLoop, tunerCore.historyTimer);
+    if(expirations > 1)
+    {
+        signal_history_add_gap(expirations - 1);
+    }
+
+    // Mark samples taken after a station change.
+    frequency = tuner->get_frequency();
+    retuned = (frequency > 0) && (frequency != tunerCore.historyFrequency);
+    if(frequency > 0)
+    {
+        tunerCore.historyFrequency = frequency;
+    }
+
+    signal_history_add(tuner->rssi(), tuner->snr(), ((tuner->stereo_mpx != NULL) ? tuner->stereo_mpx() : MPXS_UNKNOWN), retuned);
+}
+
+static void on_i2c_stats_timer(gpointer userData)
+{
+    i2c_stats_log_summary();
+}
+
+static void on_telemetry_timer(gpointer userData)
+{
+    TunerStatus status;
+    TunerStatus *lastStatus = &tunerCore.lastStatus;
+    FMStatusRDSStats rdsStats;
+    gint64 readTime;
+
+    tuner_core_read_status(tunerCore.tunerRef, &status);
+    g_atomic_int_inc(&tunerCore.telemetryPolls);
+
+    // Every value is dated separately, getters fail independently when the tuner is busy.
+    readTime = clock_source_now();
+    if(status.rssi >= 0)
+    {
+        __atomic_store_n(&tunerCore.rssiTime, readTime, __ATOMIC_RELAXED);
+    }
+
+    if(status.snr >= 0)
+    {
+        __atomic_store_n(&tunerCore.snrTime, readTime, __ATOMIC_RELAXED);
+    }
+
+    if(status.mpxState != MPXS_UNKNOWN)
+    {
+        __atomic_store_n(&tunerCore.stereoTime, readTime, __ATOMIC_RELAXED);
+    }
+
+    // Tuner is busy with another thread, keep previous status.
+    if(status.frequency < 0)
+    {
+        g_atomic_int_inc(&tunerCore.telemetrySkips);
+        return;
+    }
+
+    __atomic_store_n(&tunerCore.frequencyTime, readTime, __ATOMIC_RELAXED);
+
+    recorder_write_telemetry(&status);
+
+    // Tuning outside of the command layer (replay, startup) also selects the statistics station.
+    if(!sweep_is_running())
+    {
+        rds_stats_set_station(status.frequency);
+    }
+
+    shm_status_publish(status.frequency, status.rssi, status.snr, status.mpxState, status.volume, status.rdsText,
+        ((rds_stats_read(&rdsStats) != 0) ? &rdsStats : NULL));
+
+    // Notify listeners only when something has changed.
+    if((status.frequency != lastStatus->frequency) || (status.rssi != lastStatus->rssi) || (status.snr != lastStatus->snr) ||
+       (status.mpxState != lastStatus->mpxState) || (status.volume != lastStatus->volume) || (strcmp(status.rdsText, lastStatus->rdsText) != 0))
+    {
+        *lastStatus = status;
+
+        if(tunerCore.statusHandler != NULL)
+        {
+            tunerCore.statusHandler(&status);
+        }
+    }
+}
+
+uint8_t tuner_core_init(Tuner *tuner, GMainContext *context, tuner_status_handler handler)
+{
+    tunerCore.tunerRef = tuner;
+    tunerCore.context = context;
+    tunerCore.statusHandler = handler;
+    tunerCore.lastStatus.frequency = -1;
+    tunerCore.lastStatus.channel = BAND_PLAN_NO_CHANNEL;
+    tunerCore.meterTimer = -1;
+    tunerCore.historyTimer = -1;
+    tunerCore.signalSample = 0;
+
+    tunerCore.eventLoop = event_loop_new(context);
+    if(tunerCore.eventLoop == NULL)
+    {
+        return RESULT_FAIL;
+    }
+
+    // Scheduled telemetry and RDS capture.
+    tunerCore.telemetryTimer = event_loop_add_timer(tunerCore.eventLoop, on_telemetry_timer, NULL);
+    event_loop_set_timer(tunerCore.eventLoop, tunerCore.telemetryTimer, TELEMETRY_UPDATE_RATE);
+
+    if((tuner->rds_read_group != NULL) && (tuner->rds_decode_group != NULL))
+    {
+        tmc_init();
+        rds_stats_init();
+        tunerCore.rdsCaptureRate = rds_clock_get_capture_rate(RDS_CAPTURE_RATE);
+        tunerCore.rdsTimer = event_loop_add_timer(tunerCore.eventLoop, on_rds_capture_timer, NULL);
+        event_loop_set_timer(tunerCore.eventLoop, tunerCore.rdsTimer, tunerCore.rdsCaptureRate);
+    }
+
+    // Signal meter sampler stays disarmed until the meter is shown.
+    if((tuner->rssi != NULL) && (tuner->snr != NULL))
+    {
+        tunerCore.meterTimer = event_loop_add_timer(tunerCore.eventLoop, on_meter_sample_timer, NULL);
+    }
+
+    // Signal history is recorded all the time, independent of the UI.
+    if((tuner->rssi != NULL) && (tuner->snr != NULL))
+    {
+        signal_history_init();
+        tunerCore.historyFrequency = tuner->get_frequency();
+        tunerCore.historyTimer = event_loop_add_timer(tunerCore.eventLoop, on_history_timer, NULL);
+        event_loop_set_timer(tunerCore.eventLoop, tunerCore.historyTimer, (HISTORY_L0_PERIOD * 1000));
+    }
+
+#ifdef DEBUG_LOGS
+    // Periodic I2C bus summary shows where the bus time goes.
+    tunerCore.i2cStatsTimer = event_loop_add_timer(tunerCore.eventLoop, on_i2c_stats_timer, NULL);
+    event_loop_set_timer(tunerCore.eventLoop, tunerCore.i2cStatsTimer, I2C_STATS_SUMMARY_PERIOD);
+#endif
+
+    // Commands are posted to the event loop through an eventfd notifier.
+    command_init(tuner, tunerCore.eventLoop);
+    sweep_init(tuner, tunerCore.eventLoop);
+
+    // Publish initial status without waiting for the first timer period.
+    on_telemetry_timer(NULL);
+
+    return RESULT_SUCCESS;
+}
+
+static void *tuner_core_thread(void *threadStruct)
+{
+    TunerCore *core = (TunerCore *)threadStruct;
+
+    g_main_context_push_thread_default(core->context);
+    g_main_loop_run(core->mainLoop);
+    g_main_context_pop_thread_default(core->context);
+
+    return NULL;
+}
+
+uint8_t tuner_core_start_thread(Tuner *tuner, tuner_status_handler handler)
+{
+    GMainContext *context;
+
+    // Core thread has its own main context, so tuner I/O never runs on the UI thread.
+    context = g_main_context_new();
+    if(tuner_core_init(tuner, context, handler) == RESULT_FAIL)
+    {
+        g_main_context_unref(context);
+        return RESULT_FAIL;
+    }
+
+    tunerCore.ownThread = TRUE;
+    tunerCore.mainLoop = g_main_loop_new(context, FALSE);
+    pthread_create(&tunerCore.coreThread, NULL, tuner_core_thread, (void*)(&tunerCore));
+
+    return RESULT_SUCCESS;
+}
+
+void tuner_core_shutdown()
+{
+    if(tunerCore.eventLoop == NULL)
+    {
+        return;
+    }
+
+#ifdef DEBUG_LOGS
+    g_message("Tuner event loop average wakeup rate = %.2lf/s", event_loop_get_wakeup_rate(tunerCore.eventLoop));
+#endif
+
+    if(tunerCore.ownThread)
+    {
+        g_main_loop_quit(tunerCore.mainLoop);
+        pthread_join(tunerCore.coreThread, NULL);
+        g_main_loop_unref(tunerCore.mainLoop);
+    }
+
+    command_shutdown();
+    recorder_close();
+    rds_clock_shutdown();
+    event_loop_destroy(tunerCore.eventLoop);
+    tunerCore.eventLoop = NULL;
+
+    if(tunerCore.ownThread)
+    {
+        g_main_context_unref(tunerCore.context);
+        tunerCore.ownThread = FALSE;
+    }
+}
+
+void tuner_core_set_telemetry_rate(guint intervalMs)
+{
+    // Timer descriptor can be re-armed from any thread.
+    if(tunerCore.eventLoop != NULL)
+    {
+        event_loop_set_timer(tunerCore.eventLoop, tunerCore.telemetryTimer, intervalMs);
+    }
+}
+
+void tuner_core_set_meter_rate(guint intervalMs)
+{
+    // Zero interval stops the signal meter sampler.
+    if(tunerCore.eventLoop != NULL)
+    {
+        event_loop_set_timer(tunerCore.eventLoop, tunerCore.meterTimer, intervalMs);
+    }
+}
+
+guint32 tuner_core_get_signal_sample(int16_t *rssi, int16_t *snr)
+{
+    guint64 sample;
+
+    // Lock free read, returns the sample time (ms, 0 before the first sample) to let the caller detect new samples.
+    sample = __atomic_load_n(&tunerCore.signalSample, __ATOMIC_RELAXED);
+
+    *rssi = SIGNAL_SAMPLE_RSSI((uint32_t)sample);
+    *snr = SIGNAL_SAMPLE_SNR((uint32_t)sample);
+
+    return (guint32)(sample >> 32);
+}
+
+EventLoop *tuner_core_get_event_loop()
+{
+    return tunerCore.eventLoop;
+}
+
+static uint32_t tuner_core_value_age(gint64 *valueTime, gint64 currentTime)
+{
+    gint64 readTime = __atomic_load_n(valueTime, __ATOMIC_RELAXED);
+
+    return (readTime > 0) ? (uint32_t)MIN((currentTime - readTime) / 1000, G_MAXUINT32 - 1) : TUNER_STATUS_AGE_NONE;
+}
+
+void tuner_core_get_status_age(TunerStatusAge *statusAge)
+{
+    gint64 currentTime = clock_source_now();
+
+    statusAge->frequencyAge = tuner_core_value_age(&tunerCore.frequencyTime, currentTime);
+    statusAge->rssiAge = tuner_core_value_age(&tunerCore.rssiTime, currentTime);
+    statusAge->snrAge = tuner_core_value_age(&tunerCore.snrTime, currentTime);
+    statusAge->stereoAge = tuner_core_value_age(&tunerCore.stereoTime, currentTime);
+    statusAge->telemetryPolls = (uint32_t)g_atomic_int_get(&tunerCore.telemetryPolls);
+    statusAge->telemetrySkips = (uint32_t)g_atomic_int_get(&tunerCore.telemetrySkips);
+    statusAge->meterSkips = (uint32_t)g_atomic_int_get(&tunerCore.meterSkips);
+}
@@ -0,0 +1,111 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Tuner event core: command execution, RDS capture and telemetry.               *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_TUNERCORE_HEADER_
+#define _GTK_FM_TUNER_TUNERCORE_HEADER_
+
+#include <glib.h>
+#include <pthread.h>
+
+#include "defmain.h"
+#include "tuner.h"
+#include "evloop.h"
+
+// Refresh rate of frequency and other channel/tuner information in ms.
+#define TELEMETRY_UPDATE_RATE   500
+
+// Telemetry rate in ms while nobody is watching the tuner status (e.g. minimized window).
+#define TELEMETRY_IDLE_RATE     2000
+
+// Signal meter sample rate in ms (40 Hz) while the meter is shown.
+#define METER_SAMPLE_RATE       25
+
+// RDS capture rate in ms, must be shorter than half of the RDS group period (87.6ms).
+#define RDS_CAPTURE_RATE        40
+
+// Maximum number of RDS groups processed by a single capture poll.
+#define RDS_MAX_GROUPS_PER_POLL 64
+
+// Age of the status values in ms, getters return no value while another thread holds the tuner.
+typedef struct TunerStatusAge
+{
+    uint32_t frequencyAge;
+    uint32_t rssiAge;
+    uint32_t snrAge;
+    uint32_t stereoAge;
+    uint32_t telemetryPolls;
+    uint32_t telemetrySkips;    // Telemetry polls dropped because the tuner was busy.
+    uint32_t meterSkips;        // Signal meter samples dropped because the tuner was busy.
+} TunerStatusAge;
+
+// Status value age reported for values which were never read.
+#define TUNER_STATUS_AGE_NONE   G_MAXUINT32
+
+// Receive tuner status whenever it changes (called on the tuner core thread).
+typedef void (*tuner_status_handler)(TunerStatus *status);
+
+typedef struct TunerCore
+{
+    Tuner *tunerRef;
+    GMainContext *context;
+    GMainLoop *mainLoop;
+    pthread_t coreThread;
+    gboolean ownThread;
+    EventLoop *eventLoop;
+    int rdsTimer;
+    guint rdsCaptureRate;           // Current RDS capture period in ms.
+    int telemetryTimer;
+    int meterTimer;
+    int historyTimer;
+    int i2cStatsTimer;
+    double historyFrequency;        // Tuner frequency at the previous history sample.
+    guint64 signalSample;           // Sample time in ms (high 32 bits), RSSI and SNR as SIGNAL_SAMPLE_PACK (low 32 bits).
+    tuner_status_handler statusHandler;
+    TunerStatus lastStatus;
+
+    // CLOCK_MONOTONIC time of the last successful reading of every status value.
+    gint64 frequencyTime;
+    gint64 rssiTime;
+    gint64 snrTime;
+    gint64 stereoTime;
+    volatile gint telemetryPolls;
+    volatile gint telemetrySkips;
+    volatile gint meterSkips;
+} TunerCore;
+
+uint8_t tuner_core_init(Tuner *tuner, GMainContext *context, tuner_status_handler handler);
+uint8_t tuner_core_start_thread(Tuner *tuner, tuner_status_handler handler);
+void tuner_core_shutdown(void);
+
+void tuner_core_set_telemetry_rate(guint intervalMs);
+void tuner_core_set_meter_rate(guint intervalMs);
+guint32 tuner_core_get_signal_sample(int16_t *rssi, int16_t *snr);
+void tuner_core_read_status(Tuner *tuner, TunerStatus *status);
+EventLoop *tuner_core_get_event_loop(void);
+void tuner_core_get_status_age(TunerStatusAge *statusAge);
+
+#endif /* _GTK_FM_TUNER_TUNERCORE_HEADER_ */
@@ -0,0 +1,219 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Command line client for the headless tuner daemon.                            *
+ *                                                                               *
+ * Usage: fmctl [-s socket] <command> [argument]                                 *
+ *        fmctl [-s socket] -b <count>   (measure command round-trip time)       *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_SOCKET_PATH "/tmp/gtk-fm-tuner.sock"
+#define LINE_MAX_SIZE       256
+
+static int connect_daemon(const char *socketPath)
+{
+    int socketHandle;
+    struct sockaddr_un address;
+
+    socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(socketHandle < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+    if(connect(socketHandle, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        perror(socketPath);
+        close(socketHandle);
+        return -1;
+    }
+
+    return socketHandle;
+}
+
+// Read one line from the daemon, returns length of the line or -1 on error.
+static int read_line(int socketHandle, char *buffer, int bufferSize)
+{
+    int pos = 0;
+    char data;
+
+    while(pos < (bufferSize - 1))
+    {
+        if(recv(socketHandle, &data, 1, 0) != 1)
+        {
+            return -1;
+        }
+
+        if(data == '\n')
+        {
+            break;
+        }
+
+        buffer[pos++] = data;
+    }
+
+    buffer[pos] = 0x00;
+    return pos;
+}
+
+static uint64_t get_time_ns()
+{
+    struct timespec timeNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeNow);
+    return ((uint64_t)timeNow.tv_sec * 1000000000ULL) + timeNow.tv_nsec;
+}
+
+static int run_benchmark(int socketHandle, long count)
+{
+    char line[LINE_MAX_SIZE];
+    uint64_t startTime, roundTrip, minTime = UINT64_MAX, maxTime = 0, totalTime = 0;
+    long pos;
+
+    for(pos = 0; pos < count; pos++)
+    {
+        startTime = get_time_ns();
+
+        if((send(socketHandle, "PING\n", 5, 0) != 5) || (read_line(socketHandle, line, sizeof(line)) < 0))
+        {
+            fprintf(stderr, "Connection lost after %ld commands\n", pos);
+            return 1;
+        }
+
+        roundTrip = get_time_ns() - startTime;
+        totalTime += roundTrip;
+        minTime = (roundTrip < minTime) ? roundTrip : minTime;
+        maxTime = (roundTrip > maxTime) ? roundTrip : maxTime;
+    }
+
+    printf("%ld commands, round-trip min %.1lf us, avg %.1lf us, max %.1lf us\n", count,
+        minTime / 1000.0, (totalTime / (double)count) / 1000.0, maxTime / 1000.0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socketPath = DEFAULT_SOCKET_PATH;
+    char command[LINE_MAX_SIZE];
+    char line[LINE_MAX_SIZE];
+    const char *waitEvent = NULL;
+    int socketHandle, argPos = 1, result = 0, isSubscribe;
+    long benchCount = 0;
+
+    if((argc > 2) && (strcmp(argv[1], "-s") == 0))
+    {
+        socketPath = argv[2];
+        argPos = 3;
+    }
+
+    if((argc > (argPos + 1)) && (strcmp(argv[argPos], "-b") == 0))
+    {
+        benchCount = strtol(argv[argPos + 1], NULL, 10);
+    }
+    else if(argc <= argPos)
+    {
+        fprintf(stderr, "Usage: %s [-s socket] <command> [argument]\n       %s [-s socket] -b <count>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    socketHandle = connect_daemon(socketPath);
+    if(socketHandle < 0)
+    {
+        return 1;
+    }
+
+    if(benchCount > 0)
+    {
+        result = run_benchmark(socketHandle, benchCount);
+        close(socketHandle);
+        return result;
+    }
+
+    // Build command line from the remaining arguments.
+    command[0] = 0x00;
+    for(; argPos < argc; argPos++)
+    {
+        strncat(command, argv[argPos], sizeof(command) - strlen(command) - 2);
+        strncat(command, (argPos == (argc - 1)) ? "\n" : " ", sizeof(command) - strlen(command) - 1);
+    }
+
+    isSubscribe = (strncmp(command, "SUB", 3) == 0);
+    send(socketHandle, command, strlen(command), 0);
+
+    // Seek and survey jobs complete asynchronously, wait for their final event.
+    if(strncmp(command, "SEEK", 4) == 0)
+    {
+        waitEvent = "EVT SEEK";
+    }
+    else if(strncmp(command, "SURVEY", 6) == 0)
+    {
+        waitEvent = "EVT SURVEY";
+    }
+
+    // Print replies, subscriptions stay connected and print every pushed event.
+    while(read_line(socketHandle, line, sizeof(line)) >= 0)
+    {
+        if((waitEvent != NULL) && (strncmp(line, "EVT", 3) == 0) && (strncmp(line, waitEvent, strlen(waitEvent)) != 0) && (strncmp(line, "EVT STATION", 11) != 0))
+        {
+            // Ignore events caused by other clients.
+            continue;
+        }
+
+        printf("%s\n", line);
+        fflush(stdout);
+
+        if(strncmp(line, "ERR", 3) == 0)
+        {
+            result = 1;
+            break;
+        }
+
+        if(isSubscribe)
+        {
+            continue;
+        }
+
+        if((waitEvent == NULL) ? (strncmp(line, "OK", 2) == 0) : (strncmp(line, waitEvent, strlen(waitEvent)) == 0))
+        {
+            break;
+        }
+    }
+
+    close(socketHandle);
+    return result;
+}
@@ -0,0 +1,559 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Offline bulk RDS decoder for capture files recorded with --record.            *
+ * Extracts PI, PS, RadioText and clock time timelines. Groups are gathered      *
+ * into a structure of arrays and classified by vector kernels on a pool of      *
+ * threads in fixed size chunks across all files, then timelines are built       *
+ * per file. Decoding throughput is reported on stderr.                          *
+ *                                                                               *
+ * Usage: fmrds [-j threads] [-S] [-q] <capture> [capture...]                    *
+ *        (-S forces the scalar kernel, -q only reports throughput)              *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../src/fmcapture.h"
+#include "rdskernel.h"
+
+// Number of records gathered and classified by one job.
+#define DECODE_CHUNK_RECORDS    65536
+
+#define PS_LENGTH               8
+#define RT_LENGTH               64
+
+typedef struct CaptureSource
+{
+    const char *path;
+    const uint8_t *fileData;
+    size_t fileSize;
+    uint32_t recordCount;
+    uint32_t groupCount;
+
+    RDSGroupArray groups;
+    RDSDecodeArray decoded;
+
+    // Timeline text produced by the reduction pass.
+    char *timeline;
+    size_t timelineLength;
+    size_t timelineSize;
+} CaptureSource;
+
+typedef struct DecodeJob
+{
+    CaptureSource *source;
+    size_t first;
+    size_t last;
+} DecodeJob;
+
+typedef struct DecodeContext
+{
+    CaptureSource *sources;
+    int sourceCount;
+    DecodeJob *jobs;
+    int jobCount;
+    int nextJob;
+    int nextSource;
+    int scalarKernel;
+    int quietMode;
+    uint64_t kernelTime;        // Time spent in the classification kernels by all threads in ns.
+} DecodeContext;
+
+static DecodeContext decodeContext;
+
+static double get_time()
+{
+    struct timespec timeValue;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeValue);
+    return timeValue.tv_sec + (timeValue.tv_nsec / 1e9);
+}
+
+static const FMCaptureRecord *get_record(CaptureSource *source, uint32_t index)
+{
+    return (const FMCaptureRecord *)(source->fileData + fmcapture_record_offset(index));
+}
+
+static int open_source(CaptureSource *source)
+{
+    int fileHandle;
+    struct stat fileInfo;
+    const FMCaptureHeader *header;
+    size_t count;
+
+    fileHandle = open(source->path, O_RDONLY);
+    if(fileHandle < 0)
+    {
+        perror(source->path);
+        return -1;
+    }
+
+    if((fstat(fileHandle, &fileInfo) < 0) || (fileInfo.st_size < (off_t)sizeof(FMCaptureHeader)))
+    {
+        fprintf(stderr, "%s: not a capture file\n", source->path);
+        close(fileHandle);
+        return -1;
+    }
+
+    source->fileSize = (size_t)fileInfo.st_size;
+    source->fileData = (const uint8_t *)mmap(NULL, source->fileSize, PROT_READ, MAP_PRIVATE, fileHandle, 0);
+    close(fileHandle);
+
+    if(source->fileData == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+
+    madvise((void *)source->fileData, source->fileSize, MADV_SEQUENTIAL);
+
+    header = (const FMCaptureHeader *)source->fileData;
+    if((header->magic != FMCAPTURE_MAGIC) || (header->version != FMCAPTURE_VERSION) || (header->recordSize != sizeof(FMCaptureRecord)) ||
+       (header->blockSize != sizeof(FMCaptureBlock)) || (header->blockRecords != FMCAPTURE_BLOCK_RECORDS))
+    {
+        fprintf(stderr, "%s: unsupported capture format\n", source->path);
+        return -1;
+    }
+
+    // Structure of arrays indexed by record number, non RDS records are marked as invalid groups.
+    source->recordCount = fmcapture_record_count(source->fileSize);
+    count = (source->recordCount > 0) ? source->recordCount : 1;
+
+    source->groups.count = source->recordCount;
+    source->groups.blockA = (uint16_t *)malloc(count * sizeof(uint16_t));
+    source->groups.blockB = (uint16_t *)malloc(count * sizeof(uint16_t));
+    source->groups.blockC = (uint16_t *)malloc(count * sizeof(uint16_t));
+    source->groups.blockD = (uint16_t *)malloc(count * sizeof(uint16_t));
+    source->groups.status = (uint8_t *)malloc(count);
+    source->decoded.kind = (uint8_t *)malloc(count);
+    source->decoded.address = (uint8_t *)malloc(count);
+    source->decoded.text = (uint8_t *)malloc(count * 4);
+
+    if((source->groups.blockA == NULL) || (source->groups.blockB == NULL) || (source->groups.blockC == NULL) || (source->groups.blockD == NULL) ||
+       (source->groups.status == NULL) || (source->decoded.kind == NULL) || (source->decoded.address == NULL) || (source->decoded.text == NULL))
+    {
+        fprintf(stderr, "%s: out of memory\n", source->path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void gather_groups(CaptureSource *source, size_t first, size_t last)
+{
+    size_t pos;
+    uint32_t groupCount = 0;
+    const FMCaptureRecord *record;
+
+    for(pos = first; pos < last; pos++)
+    {
+        record = get_record(source, (uint32_t)pos);
+
+        if(record->type == FMCAPTURE_RECORD_RDS)
+        {
+            source->groups.blockA[pos] = record->data[0];
+            source->groups.blockB[pos] = record->data[1];
+            source->groups.blockC[pos] = record->data[2];
+            source->groups.blockD[pos] = record->data[3];
+            source->groups.status[pos] = record->status;
+            groupCount++;
+        }
+        else
+        {
+            source->groups.blockA[pos] = 0;
+            source->groups.blockB[pos] = 0;
+            source->groups.blockC[pos] = 0;
+            source->groups.blockD[pos] = 0;
+            source->groups.status[pos] = RDS_STATUS_INVALID;
+        }
+    }
+
+    __atomic_fetch_add(&source->groupCount, groupCount, __ATOMIC_RELAXED);
+}
+
+static void *decode_worker(void *threadStruct)
+{
+    DecodeContext *context = (DecodeContext *)threadStruct;
+    DecodeJob *job;
+    int jobIndex;
+    double kernelStart;
+
+    while((jobIndex = __atomic_fetch_add(&context->nextJob, 1, __ATOMIC_RELAXED)) < context->jobCount)
+    {
+        job = &context->jobs[jobIndex];
+        gather_groups(job->source, job->first, job->last);
+
+        kernelStart = get_time();
+        if(context->scalarKernel)
+        {
+            rds_kernel_decode_scalar(&job->source->groups, &job->source->decoded, job->first, job->last);
+        }
+        else
+        {
+            rds_kernel_decode(&job->source->groups, &job->source->decoded, job->first, job->last);
+        }
+
+        __atomic_fetch_add(&context->kernelTime, (uint64_t)((get_time() - kernelStart) * 1e9), __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static void timeline_add(CaptureSource *source, uint32_t recordIndex, const char *format, ...)
+{
+    va_list args;
+    const FMCaptureBlock *block;
+    uint64_t eventTime;
+    time_t eventSeconds;
+    struct tm eventDate;
+    char line[RT_LENGTH + 64];
+    int lineLength;
+
+    // Wall clock time of the record.
+    block = (const FMCaptureBlock *)(source->fileData + fmcapture_block_offset(recordIndex));
+    eventTime = block->realTime + get_record(source, recordIndex)->timeOffset;
+    eventSeconds = (time_t)(eventTime / 1000000);
+    gmtime_r(&eventSeconds, &eventDate);
+
+    lineLength = (int)strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S", &eventDate);
+    lineLength += snprintf(line + lineLength, sizeof(line) - lineLength, ".%03u ", (unsigned int)((eventTime / 1000) % 1000));
+
+    va_start(args, format);
+    lineLength += vsnprintf(line + lineLength, sizeof(line) - lineLength, format, args);
+    va_end(args);
+
+    if(lineLength >= (int)sizeof(line))
+    {
+        lineLength = sizeof(line) - 1;
+    }
+
+    if((source->timelineLength + lineLength + 2) > source->timelineSize)
+    {
+        source->timelineSize = (source->timelineSize > 0) ? (source->timelineSize * 2) : 4096;
+        source->timeline = (char *)realloc(source->timeline, source->timelineSize);
+    }
+
+    memcpy(source->timeline + source->timelineLength, line, lineLength);
+    source->timelineLength += lineLength;
+    source->timeline[source->timelineLength++] = '\n';
+    source->timeline[source->timelineLength] = 0x00;
+}
+
+static void decode_clock_time(CaptureSource *source, uint32_t recordIndex, uint32_t *lastTime)
+{
+    uint32_t mjd, yearPart, monthPart, yearCorrection;
+    uint16_t blockB, blockC, blockD;
+    uint8_t hour, minute, offset;
+
+    blockB = source->groups.blockB[recordIndex];
+    blockC = source->groups.blockC[recordIndex];
+    blockD = source->groups.blockD[recordIndex];
+
+    mjd = ((uint32_t)(blockB & 0x03) << 15) | (blockC >> 1);
+    hour = (uint8_t)(((blockC & 0x01) << 4) | (blockD >> 12));
+    minute = (uint8_t)((blockD >> 6) & 0x3F);
+    offset = (uint8_t)(blockD & 0x1F);
+
+    if((mjd < 15079) || (hour > 23) || (minute > 59))
+    {
+        return;
+    }
+
+    // Clock time is repeated by some stations, report only the changes.
+    if((((mjd * 1440) + (hour * 60) + minute) ^ ((uint32_t)(blockD & 0x3F) << 26)) == *lastTime)
+    {
+        return;
+    }
+
+    *lastTime = ((mjd * 1440) + (hour * 60) + minute) ^ ((uint32_t)(blockD & 0x3F) << 26);
+
+    // Modified Julian Day to calendar date (IEC 62106 annex G).
+    yearPart = (uint32_t)((mjd - 15078.2) / 365.25);
+    monthPart = (uint32_t)((mjd - 14956.1 - (uint32_t)(yearPart * 365.25)) / 30.6001);
+    yearCorrection = ((monthPart == 14) || (monthPart == 15)) ? 1 : 0;
+
+    timeline_add(source, recordIndex, "CT %04u-%02u-%02u %02u:%02u UTC%c%02u:%02u", 1900 + yearPart + yearCorrection, monthPart - 1 - (yearCorrection * 12),
+        mjd - 14956 - (uint32_t)(yearPart * 365.25) - (uint32_t)(monthPart * 30.6001), hour, minute, ((blockD & 0x20) ? '-' : '+'), offset / 2, (offset % 2) * 30);
+}
+
+static void build_timeline(CaptureSource *source)
+{
+    uint32_t pos;
+    uint32_t lastClockTime = 0;
+    uint16_t piCode = 0, piCandidate = 0, rtMask = 0, rtRequired;
+    int piValid = 0, rtFlag = -1, rtMode = -1, segmentChars;
+    uint8_t kind, address, psMask = 0;
+    const uint8_t *text;
+    char psText[PS_LENGTH + 1], lastPS[PS_LENGTH + 1];
+    char rtText[RT_LENGTH + 1], lastRT[RT_LENGTH + 1];
+    char *rtEnd;
+    size_t rtLength;
+
+    memset(psText, ' ', PS_LENGTH);
+    psText[PS_LENGTH] = 0x00;
+    lastPS[0] = 0x00;
+    memset(rtText, ' ', RT_LENGTH);
+    rtText[RT_LENGTH] = 0x00;
+    lastRT[0] = 0x00;
+
+    // Only the groups marked by the kernel are visited, no per character branching here.
+    for(pos = 0; pos < source->recordCount; pos++)
+    {
+        kind = source->decoded.kind[pos];
+        if(kind == RDS_KIND_NONE)
+        {
+            continue;
+        }
+
+        // New program identification must be received twice before it is accepted.
+        if(kind & RDS_KIND_PI_VALID)
+        {
+            if(source->groups.blockA[pos] != piCandidate)
+            {
+                piCandidate = source->groups.blockA[pos];
+            }
+            else if((!piValid) || (piCandidate != piCode))
+            {
+                piCode = piCandidate;
+                piValid = 1;
+                psMask = 0;
+                rtMask = 0;
+                lastPS[0] = 0x00;
+                lastRT[0] = 0x00;
+                timeline_add(source, pos, "PI 0x%04X", piCode);
+            }
+        }
+
+        address = source->decoded.address[pos];
+        text = source->decoded.text + (pos * 4);
+
+        switch(kind & RDS_KIND_MASK)
+        {
+        case RDS_KIND_PS:
+            memcpy(psText + ((address & 0x03) * 2), text + 2, 2);
+            psMask |= (uint8_t)(1 << (address & 0x03));
+
+            if(psMask == 0x0F)
+            {
+                psMask = 0;
+                if(strcmp(psText, lastPS) != 0)
+                {
+                    strcpy(lastPS, psText);
+                    timeline_add(source, pos, "PS \"%s\"", psText);
+                }
+            }
+            break;
+
+        case RDS_KIND_RT_A:
+        case RDS_KIND_RT_B:
+            // Text A/B flag or group version change starts a new message.
+            if((rtFlag != (address & 0x10)) || (rtMode != (kind & RDS_KIND_MASK)))
+            {
+                rtFlag = address & 0x10;
+                rtMode = kind & RDS_KIND_MASK;
+                rtMask = 0;
+                memset(rtText, ' ', RT_LENGTH);
+            }
+
+            segmentChars = ((kind & RDS_KIND_MASK) == RDS_KIND_RT_A) ? 4 : 2;
+            memcpy(rtText + ((address & 0x0F) * segmentChars), ((segmentChars == 4) ? text : (text + 2)), segmentChars);
+            rtMask |= (uint16_t)(1 << (address & 0x0F));
+
+            // Message ends at the carriage return or after all 16 segments.
+            rtEnd = memchr(rtText, 0x0D, 16 * segmentChars);
+            rtLength = (rtEnd != NULL) ? (size_t)(rtEnd - rtText) : (size_t)(16 * segmentChars);
+            rtRequired = (rtEnd != NULL) ? (uint16_t)((1 << ((rtLength / segmentChars) + 1)) - 1) : 0xFFFF;
+
+            if((rtMask & rtRequired) == rtRequired)
+            {
+                rtMask = 0;
+                while((rtLength > 0) && (rtText[rtLength - 1] == ' '))
+                {
+                    rtLength--;
+                }
+
+                if((strlen(lastRT) != rtLength) || (strncmp(rtText, lastRT, rtLength) != 0))
+                {
+                    memcpy(lastRT, rtText, rtLength);
+                    lastRT[rtLength] = 0x00;
+                    timeline_add(source, pos, "RT \"%s\"", lastRT);
+                }
+            }
+            break;
+
+        case RDS_KIND_CT:
+            decode_clock_time(source, pos, &lastClockTime);
+            break;
+        }
+    }
+}
+
+static void *timeline_worker(void *threadStruct)
+{
+    DecodeContext *context = (DecodeContext *)threadStruct;
+    int sourceIndex;
+
+    while((sourceIndex = __atomic_fetch_add(&context->nextSource, 1, __ATOMIC_RELAXED)) < context->sourceCount)
+    {
+        build_timeline(&context->sources[sourceIndex]);
+    }
+
+    return NULL;
+}
+
+static void run_workers(void *(*worker)(void *), int threadCount)
+{
+    pthread_t *threads;
+    int threadPos;
+
+    threads = (pthread_t *)malloc(threadCount * sizeof(pthread_t));
+    for(threadPos = 0; threadPos < threadCount; threadPos++)
+    {
+        pthread_create(&threads[threadPos], NULL, worker, &decodeContext);
+    }
+
+    for(threadPos = 0; threadPos < threadCount; threadPos++)
+    {
+        pthread_join(threads[threadPos], NULL);
+    }
+
+    free(threads);
+}
+
+int main(int argc, char *argv[])
+{
+    int argPos, sourcePos, threadCount;
+    size_t first;
+    uint64_t groupCount = 0, recordCount = 0;
+    double startTime, decodeTime, kernelTime, totalTime;
+
+    threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    memset(&decodeContext, 0, sizeof(decodeContext));
+
+    for(argPos = 1; (argPos < argc) && (argv[argPos][0] == '-'); argPos++)
+    {
+        if((strcmp(argv[argPos], "-j") == 0) && ((argPos + 1) < argc))
+        {
+            threadCount = atoi(argv[++argPos]);
+        }
+        else if(strcmp(argv[argPos], "-S") == 0)
+        {
+            decodeContext.scalarKernel = 1;
+        }
+        else if(strcmp(argv[argPos], "-q") == 0)
+        {
+            decodeContext.quietMode = 1;
+        }
+        else
+        {
+            argPos = argc;
+        }
+    }
+
+    if((argPos >= argc) || (threadCount < 1))
+    {
+        fprintf(stderr, "Usage: %s [-j threads] [-S] [-q] <capture> [capture...]\n", argv[0]);
+        return 1;
+    }
+
+    decodeContext.sourceCount = argc - argPos;
+    decodeContext.sources = (CaptureSource *)calloc(decodeContext.sourceCount, sizeof(CaptureSource));
+
+    for(sourcePos = 0; sourcePos < decodeContext.sourceCount; sourcePos++)
+    {
+        decodeContext.sources[sourcePos].path = argv[argPos + sourcePos];
+        if(open_source(&decodeContext.sources[sourcePos]) != 0)
+        {
+            return 1;
+        }
+
+        decodeContext.jobCount += (decodeContext.sources[sourcePos].recordCount + DECODE_CHUNK_RECORDS - 1) / DECODE_CHUNK_RECORDS;
+        recordCount += decodeContext.sources[sourcePos].recordCount;
+    }
+
+    // Split all files into equal chunks, so a single long capture also uses every thread.
+    decodeContext.jobs = (DecodeJob *)malloc(((decodeContext.jobCount > 0) ? decodeContext.jobCount : 1) * sizeof(DecodeJob));
+    decodeContext.jobCount = 0;
+
+    for(sourcePos = 0; sourcePos < decodeContext.sourceCount; sourcePos++)
+    {
+        for(first = 0; first < decodeContext.sources[sourcePos].recordCount; first += DECODE_CHUNK_RECORDS)
+        {
+            decodeContext.jobs[decodeContext.jobCount].source = &decodeContext.sources[sourcePos];
+            decodeContext.jobs[decodeContext.jobCount].first = first;
+            decodeContext.jobs[decodeContext.jobCount].last = first + DECODE_CHUNK_RECORDS;
+            if(decodeContext.jobs[decodeContext.jobCount].last > decodeContext.sources[sourcePos].recordCount)
+            {
+                decodeContext.jobs[decodeContext.jobCount].last = decodeContext.sources[sourcePos].recordCount;
+            }
+
+            decodeContext.jobCount++;
+        }
+    }
+
+    startTime = get_time();
+    run_workers(decode_worker, threadCount);
+    decodeTime = get_time() - startTime;
+    kernelTime = decodeContext.kernelTime / 1e9;
+
+    // Timelines are sequential within a file, files are processed in parallel.
+    run_workers(timeline_worker, threadCount);
+    totalTime = get_time() - startTime;
+
+    for(sourcePos = 0; sourcePos < decodeContext.sourceCount; sourcePos++)
+    {
+        groupCount += decodeContext.sources[sourcePos].groupCount;
+
+        if(!decodeContext.quietMode)
+        {
+            if(decodeContext.sourceCount > 1)
+            {
+                printf("== %s\n", decodeContext.sources[sourcePos].path);
+            }
+
+            if(decodeContext.sources[sourcePos].timeline != NULL)
+            {
+                fputs(decodeContext.sources[sourcePos].timeline, stdout);
+            }
+        }
+    }
+
+    fprintf(stderr, "%llu groups (%llu records) in %d file(s), %d thread(s), %s kernel\n", (unsigned long long)groupCount, (unsigned long long)recordCount,
+        decodeContext.sourceCount, threadCount, (decodeContext.scalarKernel ? "scalar" : rds_kernel_name()));
+    fprintf(stderr, "Kernels: %.3lf s (%.0lf groups/s per thread), gather + kernels: %.3lf s (%.0lf groups/s)\n", kernelTime,
+        ((kernelTime > 0) ? (groupCount / kernelTime) : 0), decodeTime, ((decodeTime > 0) ? (groupCount / decodeTime) : 0));
+    fprintf(stderr, "Total with timelines: %.3lf s (%.0lf groups/s)\n", totalTime, ((totalTime > 0) ? (groupCount / totalTime) : 0));
+
+    return 0;
+}
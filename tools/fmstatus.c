@@ -0,0 +1,125 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Example reader of the shared memory tuner status segment.                     *
+ *                                                                               *
+ * Usage: fmstatus [-w]   (-w keeps printing every new snapshot)                 *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "../src/fmstatus.h"
+
+static void print_snapshot(FMStatusSnapshot *snapshot)
+{
+    const char *mpxText[] = {"STEREO", "MONO", "UNKNOWN"};
+
+    printf("%u.%02u MHz  RSSI: %d  SNR: %d  %s  VOL: %u  RDS: %s\n", snapshot->frequency / 1000, (snapshot->frequency % 1000) / 10,
+        snapshot->rssi, snapshot->snr, mpxText[(snapshot->stereo <= FMSTATUS_MPX_UNKNOWN) ? snapshot->stereo : FMSTATUS_MPX_UNKNOWN],
+        snapshot->volume, snapshot->rdsText);
+
+    if(snapshot->rdsStats.groups > 0)
+    {
+        printf("  RDS PI: %04X  groups: %u (%u valid)  %.1f groups/s  BLER: %.2f%%  missed: %u  PI: %d ms  PS: %d ms\n", snapshot->rdsStats.pi,
+            snapshot->rdsStats.groups, snapshot->rdsStats.validGroups, snapshot->rdsStats.groupRate / 100.0,
+            (snapshot->rdsStats.blockErrors * 100.0) / snapshot->rdsStats.blocks, snapshot->rdsStats.missedGroups,
+            ((snapshot->rdsStats.timeToPI != FMSTATUS_RDS_TIME_NONE) ? (int)snapshot->rdsStats.timeToPI : -1),
+            ((snapshot->rdsStats.timeToPS != FMSTATUS_RDS_TIME_NONE) ? (int)snapshot->rdsStats.timeToPS : -1));
+    }
+
+    if(snapshot->rdsClock.utcTime != 0)
+    {
+        time_t clockTime = (time_t)(snapshot->rdsClock.utcTime / 1000000);
+        char clockText[32];
+
+        strftime(clockText, sizeof(clockText), "%Y-%m-%d %H:%M", gmtime(&clockTime));
+        printf("  RDS CT: %s UTC  offset: %+d min  quality: %u%%  %s  latency: %u us\n", clockText, snapshot->rdsClock.localOffset,
+            snapshot->rdsClock.quality, (snapshot->rdsClock.locked ? "LOCKED" : "UNLOCKED"), snapshot->rdsClock.latency);
+    }
+
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    int shmHandle, watchMode;
+    uint32_t lastGeneration = 0;
+    const FMStatusSegment *segment;
+    FMStatusSnapshot snapshot;
+
+    watchMode = ((argc > 1) && (strcmp(argv[1], "-w") == 0));
+
+    shmHandle = shm_open(FMSTATUS_SHM_NAME, O_RDONLY, 0);
+    if(shmHandle < 0)
+    {
+        perror(FMSTATUS_SHM_NAME);
+        return 1;
+    }
+
+    segment = (const FMStatusSegment *)mmap(NULL, sizeof(FMStatusSegment), PROT_READ, MAP_SHARED, shmHandle, 0);
+    close(shmHandle);
+
+    if(segment == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    do
+    {
+        // Reading the segment does not involve any system call, sleep is only to pace the output.
+        if(fmstatus_generation(segment) != lastGeneration)
+        {
+            if(fmstatus_read(segment, &snapshot) != 0)
+            {
+                fprintf(stderr, "Status segment is not valid\n");
+                return 1;
+            }
+
+            lastGeneration = fmstatus_generation(segment);
+            print_snapshot(&snapshot);
+        }
+        else if(!watchMode)
+        {
+            // No snapshot is published yet.
+            fprintf(stderr, "Status segment is empty\n");
+            return 1;
+        }
+
+        if(watchMode)
+        {
+            usleep(100000);
+        }
+    }
+    while(watchMode);
+
+    munmap((void *)segment, sizeof(FMStatusSegment));
+    return 0;
+}
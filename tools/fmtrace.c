@@ -0,0 +1,180 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Trace file decoder, prints binary trace records written with --trace,         *
+ * TRACE DUMP or the crash handler as text, sorted by the timestamp.             *
+ *                                                                               *
+ * Usage: fmtrace [-l level] [-s subsystem] <trace-file>                         *
+ *        (-l hides events above the level, -s shows one subsystem only)         *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/fmtrace.h"
+
+static int compare_records(const void *recordA, const void *recordB)
+{
+    const FMTraceRecord *traceA = (const FMTraceRecord *)recordA;
+    const FMTraceRecord *traceB = (const FMTraceRecord *)recordB;
+
+    return (traceA->timestamp > traceB->timestamp) - (traceA->timestamp < traceB->timestamp);
+}
+
+static int find_name(const char *name, const char *const *nameList, int nameCount)
+{
+    int pos;
+
+    for(pos = 0; pos < nameCount; pos++)
+    {
+        if(strcasecmp(name, nameList[pos]) == 0)
+        {
+            return pos;
+        }
+    }
+
+    return -1;
+}
+
+static void print_record(const FMTraceHeader *header, const FMTraceRecord *record)
+{
+    uint64_t realTime;
+    time_t recordSec;
+    char timeText[32];
+
+    // Monotonic timestamps are mapped to the wall clock of the trace start.
+    realTime = header->startRealTime + (record->timestamp - header->startTime);
+    recordSec = (time_t)(realTime / 1000000000ULL);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", localtime(&recordSec));
+
+    printf("%s.%09llu [%3u] ", timeText, (unsigned long long)(realTime % 1000000000ULL), record->threadId);
+
+    if(record->eventId >= TE_COUNT)
+    {
+        printf("?      ?     Unknown event %u (%d, %d, %d, %d)\n", record->eventId, record->args[0], record->args[1], record->args[2],
+            record->args[3]);
+        return;
+    }
+
+    printf("%-6s %-5s ", fmtraceSubsystemName[fmtraceEventSubsystem[record->eventId]], fmtraceLevelName[fmtraceEventLevel[record->eventId]]);
+    printf(fmtraceEventText[record->eventId], record->args[0], record->args[1], record->args[2], record->args[3]);
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *traceFile;
+    FMTraceHeader header;
+    FMTraceRecord *records;
+    size_t recordCount, recordCapacity, pos;
+    int option, maxLevel = TL_DEBUG, subsystem = -1;
+
+    while((option = getopt(argc, argv, "l:s:")) != -1)
+    {
+        if((option == 'l') && ((maxLevel = find_name(optarg, fmtraceLevelName, TL_DEBUG + 1)) < 0))
+        {
+            fprintf(stderr, "Unknown trace level %s\n", optarg);
+            return 1;
+        }
+        else if((option == 's') && ((subsystem = find_name(optarg, fmtraceSubsystemName, TS_COUNT)) < 0))
+        {
+            fprintf(stderr, "Unknown trace subsystem %s\n", optarg);
+            return 1;
+        }
+        else if(option == '?')
+        {
+            fprintf(stderr, "Usage: fmtrace [-l level] [-s subsystem] <trace-file>\n");
+            return 1;
+        }
+    }
+
+    if(optind >= argc)
+    {
+        fprintf(stderr, "Usage: fmtrace [-l level] [-s subsystem] <trace-file>\n");
+        return 1;
+    }
+
+    traceFile = fopen(argv[optind], "rb");
+    if(traceFile == NULL)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    if((fread(&header, sizeof(FMTraceHeader), 1, traceFile) != 1) || (header.magic != FMTRACE_MAGIC) ||
+       (header.version != FMTRACE_VERSION) || (header.recordSize != sizeof(FMTraceRecord)))
+    {
+        fprintf(stderr, "%s is not a supported trace file\n", argv[optind]);
+        fclose(traceFile);
+        return 1;
+    }
+
+    if(header.eventCount != TE_COUNT)
+    {
+        fprintf(stderr, "Trace file has %u event types, decoder knows %u\n", header.eventCount, TE_COUNT);
+    }
+
+    // Rings are flushed one after the other, records are ordered by time only after sorting.
+    recordCount = 0;
+    recordCapacity = 4096;
+    records = (FMTraceRecord *)malloc(recordCapacity * sizeof(FMTraceRecord));
+
+    while((records != NULL) && (fread(&records[recordCount], sizeof(FMTraceRecord), 1, traceFile) == 1))
+    {
+        if(++recordCount == recordCapacity)
+        {
+            recordCapacity *= 2;
+            records = (FMTraceRecord *)realloc(records, recordCapacity * sizeof(FMTraceRecord));
+        }
+    }
+
+    fclose(traceFile);
+
+    if(records == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    qsort(records, recordCount, sizeof(FMTraceRecord), compare_records);
+
+    for(pos = 0; pos < recordCount; pos++)
+    {
+        if((records[pos].eventId < TE_COUNT) && ((fmtraceEventLevel[records[pos].eventId] > maxLevel) ||
+           ((subsystem >= 0) && (fmtraceEventSubsystem[records[pos].eventId] != subsystem))))
+        {
+            continue;
+        }
+
+        print_record(&header, &records[pos]);
+    }
+
+    free(records);
+    return 0;
+}
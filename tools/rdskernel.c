@@ -0,0 +1,229 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Bulk RDS group classification and character extraction kernels.               *
+ * Vector kernels are branch free: every lane computes all group kinds and       *
+ * text characters, masks select the result. Scalar kernel defines the exact     *
+ * semantics and must produce identical output.                                  *
+ *                                                                               *
+ *********************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RDS_KERNEL_NEON
+#endif
+
+#include "rdskernel.h"
+
+// Replace control and non ASCII characters (except the RT end marker) with space.
+static inline uint8_t rds_text_char(uint8_t value)
+{
+    return (((value < 0x20) && (value != 0x0D)) || (value >= 0x7F)) ? ' ' : value;
+}
+
+void rds_kernel_decode_scalar(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last)
+{
+    size_t pos;
+    uint16_t blockB, blockC, blockD;
+    uint8_t status, kind, groupType;
+    uint8_t *text;
+
+    for(pos = first; pos < last; pos++)
+    {
+        blockB = groups->blockB[pos];
+        blockC = groups->blockC[pos];
+        blockD = groups->blockD[pos];
+        status = groups->status[pos];
+
+        // Group type code and version bit.
+        groupType = (uint8_t)(blockB >> 11);
+        kind = RDS_KIND_NONE;
+
+        if(((groupType >> 1) == 0) && ((status & (RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_D)) == 0))
+        {
+            kind = RDS_KIND_PS;
+        }
+        else if((groupType == 4) && ((status & (RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_C | RDS_ERR_BLOCK_D)) == 0))
+        {
+            kind = RDS_KIND_RT_A;
+        }
+        else if((groupType == 5) && ((status & (RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_D)) == 0))
+        {
+            kind = RDS_KIND_RT_B;
+        }
+        else if((groupType == 8) && ((status & (RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_C | RDS_ERR_BLOCK_D)) == 0))
+        {
+            kind = RDS_KIND_CT;
+        }
+
+        if((status & RDS_ERR_BLOCK_A) == 0)
+        {
+            kind |= RDS_KIND_PI_VALID;
+        }
+
+        output->kind[pos] = kind;
+        output->address[pos] = (uint8_t)(blockB & 0x1F);
+
+        text = output->text + (pos * 4);
+        text[0] = rds_text_char((uint8_t)(blockC >> 8));
+        text[1] = rds_text_char((uint8_t)(blockC & 0xFF));
+        text[2] = rds_text_char((uint8_t)(blockD >> 8));
+        text[3] = rds_text_char((uint8_t)(blockD & 0xFF));
+    }
+}
+
+#if defined(__SSE2__)
+
+static inline __m128i rds_sse_text(__m128i text)
+{
+    __m128i invalid;
+
+    // Signed compare also catches all characters above 0x7F.
+    invalid = _mm_andnot_si128(_mm_cmpeq_epi8(text, _mm_set1_epi8(0x0D)), _mm_cmplt_epi8(text, _mm_set1_epi8(0x20)));
+    invalid = _mm_or_si128(invalid, _mm_cmpeq_epi8(text, _mm_set1_epi8(0x7F)));
+
+    return _mm_or_si128(_mm_andnot_si128(invalid, text), _mm_and_si128(invalid, _mm_set1_epi8(' ')));
+}
+
+static size_t rds_kernel_decode_vector(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last)
+{
+    size_t pos;
+    __m128i blockB, blockC, blockD, status, groupType, kind;
+    __m128i okBD, okBCD, okA;
+    const __m128i zero = _mm_setzero_si128();
+
+    for(pos = first; (pos + RDS_KERNEL_LANES) <= last; pos += RDS_KERNEL_LANES)
+    {
+        blockB = _mm_loadu_si128((const __m128i *)(groups->blockB + pos));
+        blockC = _mm_loadu_si128((const __m128i *)(groups->blockC + pos));
+        blockD = _mm_loadu_si128((const __m128i *)(groups->blockD + pos));
+        status = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(groups->status + pos)), zero);
+
+        okBD = _mm_cmpeq_epi16(_mm_and_si128(status, _mm_set1_epi16(RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_D)), zero);
+        okBCD = _mm_cmpeq_epi16(_mm_and_si128(status, _mm_set1_epi16(RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_C | RDS_ERR_BLOCK_D)), zero);
+        okA = _mm_cmpeq_epi16(_mm_and_si128(status, _mm_set1_epi16(RDS_ERR_BLOCK_A)), zero);
+
+        // Group types are exclusive, so the kind values can be merged with OR.
+        groupType = _mm_srli_epi16(blockB, 11);
+        kind = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(_mm_srli_epi16(blockB, 12), zero), okBD), _mm_set1_epi16(RDS_KIND_PS));
+        kind = _mm_or_si128(kind, _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(groupType, _mm_set1_epi16(4)), okBCD), _mm_set1_epi16(RDS_KIND_RT_A)));
+        kind = _mm_or_si128(kind, _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(groupType, _mm_set1_epi16(5)), okBD), _mm_set1_epi16(RDS_KIND_RT_B)));
+        kind = _mm_or_si128(kind, _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(groupType, _mm_set1_epi16(8)), okBCD), _mm_set1_epi16(RDS_KIND_CT)));
+        kind = _mm_or_si128(kind, _mm_and_si128(okA, _mm_set1_epi16(RDS_KIND_PI_VALID)));
+
+        _mm_storel_epi64((__m128i *)(output->kind + pos), _mm_packus_epi16(kind, zero));
+        _mm_storel_epi64((__m128i *)(output->address + pos), _mm_packus_epi16(_mm_and_si128(blockB, _mm_set1_epi16(0x1F)), zero));
+
+        // Swap bytes to get the characters in transmission order, then interleave C and D words.
+        blockC = _mm_or_si128(_mm_slli_epi16(blockC, 8), _mm_srli_epi16(blockC, 8));
+        blockD = _mm_or_si128(_mm_slli_epi16(blockD, 8), _mm_srli_epi16(blockD, 8));
+
+        _mm_storeu_si128((__m128i *)(output->text + (pos * 4)), rds_sse_text(_mm_unpacklo_epi16(blockC, blockD)));
+        _mm_storeu_si128((__m128i *)(output->text + (pos * 4) + 16), rds_sse_text(_mm_unpackhi_epi16(blockC, blockD)));
+    }
+
+    return pos;
+}
+
+#elif defined(RDS_KERNEL_NEON)
+
+static inline uint8x16_t rds_neon_text(uint16x8_t textWords)
+{
+    uint8x16_t text, invalid;
+
+    text = vreinterpretq_u8_u16(textWords);
+    invalid = vandq_u8(vcltq_u8(text, vdupq_n_u8(0x20)), vmvnq_u8(vceqq_u8(text, vdupq_n_u8(0x0D))));
+    invalid = vorrq_u8(invalid, vcgeq_u8(text, vdupq_n_u8(0x7F)));
+
+    return vbslq_u8(invalid, vdupq_n_u8(' '), text);
+}
+
+static size_t rds_kernel_decode_vector(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last)
+{
+    size_t pos;
+    uint16x8_t blockB, blockC, blockD, status, groupType, kind;
+    uint16x8_t okBD, okBCD, okA;
+    uint16x8x2_t textWords;
+    const uint16x8_t zero = vdupq_n_u16(0);
+
+    for(pos = first; (pos + RDS_KERNEL_LANES) <= last; pos += RDS_KERNEL_LANES)
+    {
+        blockB = vld1q_u16(groups->blockB + pos);
+        blockC = vld1q_u16(groups->blockC + pos);
+        blockD = vld1q_u16(groups->blockD + pos);
+        status = vmovl_u8(vld1_u8(groups->status + pos));
+
+        okBD = vceqq_u16(vandq_u16(status, vdupq_n_u16(RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_D)), zero);
+        okBCD = vceqq_u16(vandq_u16(status, vdupq_n_u16(RDS_ERR_BLOCK_B | RDS_ERR_BLOCK_C | RDS_ERR_BLOCK_D)), zero);
+        okA = vceqq_u16(vandq_u16(status, vdupq_n_u16(RDS_ERR_BLOCK_A)), zero);
+
+        // Group types are exclusive, so the kind values can be merged with OR.
+        groupType = vshrq_n_u16(blockB, 11);
+        kind = vandq_u16(vandq_u16(vceqq_u16(vshrq_n_u16(blockB, 12), zero), okBD), vdupq_n_u16(RDS_KIND_PS));
+        kind = vorrq_u16(kind, vandq_u16(vandq_u16(vceqq_u16(groupType, vdupq_n_u16(4)), okBCD), vdupq_n_u16(RDS_KIND_RT_A)));
+        kind = vorrq_u16(kind, vandq_u16(vandq_u16(vceqq_u16(groupType, vdupq_n_u16(5)), okBD), vdupq_n_u16(RDS_KIND_RT_B)));
+        kind = vorrq_u16(kind, vandq_u16(vandq_u16(vceqq_u16(groupType, vdupq_n_u16(8)), okBCD), vdupq_n_u16(RDS_KIND_CT)));
+        kind = vorrq_u16(kind, vandq_u16(okA, vdupq_n_u16(RDS_KIND_PI_VALID)));
+
+        vst1_u8(output->kind + pos, vmovn_u16(kind));
+        vst1_u8(output->address + pos, vmovn_u16(vandq_u16(blockB, vdupq_n_u16(0x1F))));
+
+        // Swap bytes to get the characters in transmission order, then interleave C and D words.
+        blockC = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(blockC)));
+        blockD = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(blockD)));
+        textWords = vzipq_u16(blockC, blockD);
+
+        vst1q_u8(output->text + (pos * 4), rds_neon_text(textWords.val[0]));
+        vst1q_u8(output->text + (pos * 4) + 16, rds_neon_text(textWords.val[1]));
+    }
+
+    return pos;
+}
+
+#endif
+
+const char *rds_kernel_name()
+{
+#if defined(__SSE2__)
+    return "SSE2";
+#elif defined(RDS_KERNEL_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void rds_kernel_decode(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last)
+{
+#if defined(__SSE2__) || defined(RDS_KERNEL_NEON)
+    first = rds_kernel_decode_vector(groups, output, first, last);
+#endif
+
+    // Remaining groups which do not fill a vector.
+    rds_kernel_decode_scalar(groups, output, first, last);
+}
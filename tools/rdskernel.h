@@ -0,0 +1,83 @@
+/*********************************************************************************
+ * Copyright 2021 Dilshan R Jayakody. [jayakody2000lk@gmail.com]                 *
+ *                                                                               *
+ * Permission is hereby granted, free of charge, to any person obtaining a       *
+ * copy of this software and associated documentation files (the "Software"),    *
+ *  to deal in the Software without restriction, including without limitation    *
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,      *
+ * and/or sell copies of the Software, and to permit persons to whom the         *
+ * Software is furnished to do so, subject to the following conditions:          *
+ *                                                                               *
+ * The above copyright notice and this permission notice shall be included in    *
+ * all copies or substantial portions of the Software.                           *
+ *                                                                               *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     *
+ * THE SOFTWARE.                                                                 *
+ * *******************************************************************************
+ *                                                                               *
+ * GTK FM Radio                                                                  *
+ * Bulk RDS group classification and character extraction kernels.               *
+ * Groups are kept in a structure of arrays, kernels process them in vectors     *
+ * (SSE2/NEON) with a scalar implementation for other targets and for tails.     *
+ *                                                                               *
+ *********************************************************************************/
+
+#ifndef _GTK_FM_TUNER_RDSKERNEL_HEADER_
+#define _GTK_FM_TUNER_RDSKERNEL_HEADER_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Block error flags in the group status (QN8035 REG_STATUS2 layout).
+#define RDS_ERR_BLOCK_A     0x08
+#define RDS_ERR_BLOCK_B     0x04
+#define RDS_ERR_BLOCK_C     0x02
+#define RDS_ERR_BLOCK_D     0x01
+
+// Status value used for records that are not RDS groups (all blocks in error).
+#define RDS_STATUS_INVALID  0x0F
+
+// Group kinds produced by the classification kernel (low bits), RDS_KIND_PI_VALID is set independently.
+#define RDS_KIND_NONE       0x00
+#define RDS_KIND_PS         0x01    // 0A/0B with blocks B and D received.
+#define RDS_KIND_RT_A       0x02    // 2A with blocks B, C and D received.
+#define RDS_KIND_RT_B       0x03    // 2B with blocks B and D received.
+#define RDS_KIND_CT         0x04    // 4A with blocks B, C and D received.
+#define RDS_KIND_MASK       0x07
+#define RDS_KIND_PI_VALID   0x80    // Block A received.
+
+// Number of groups processed by one vector iteration.
+#define RDS_KERNEL_LANES    8
+
+// Raw groups in structure of arrays layout.
+typedef struct RDSGroupArray
+{
+    size_t count;
+    uint16_t *blockA;
+    uint16_t *blockB;
+    uint16_t *blockC;
+    uint16_t *blockD;
+    uint8_t *status;
+} RDSGroupArray;
+
+// Per group kernel output.
+typedef struct RDSDecodeArray
+{
+    uint8_t *kind;          // RDS_KIND_* value.
+    uint8_t *address;       // Low 5 bits of block B (text A/B flag and segment address).
+    uint8_t *text;          // 4 printable characters per group (block C high/low, block D high/low).
+} RDSDecodeArray;
+
+// Name of the kernel implementation selected at compile time.
+const char *rds_kernel_name(void);
+
+// Classify groups and extract text characters from the range [first, last).
+void rds_kernel_decode(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last);
+void rds_kernel_decode_scalar(const RDSGroupArray *groups, RDSDecodeArray *output, size_t first, size_t last);
+
+#endif /* _GTK_FM_TUNER_RDSKERNEL_HEADER_ */